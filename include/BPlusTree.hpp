@@ -3,99 +3,1455 @@
 
 #include <string>
 #include <vector>
-#include <fstream>
 #include <unordered_map>
+#include <algorithm> //std::sort e std::lower_bound
+#include <cstring>   //std::memcpy
+#include <stdexcept>
+#include <functional>
+#include <chrono>
 
-//sizeof(is_leaf) + sizeof(key_count) + sizeof(keys) + sizeof(children) + sizeof(next_leaf) <= 4096
-//1 + 4 + (4 * (m - 1)) + (8 * m) + 8 <= 4096
-//m <= 340.58
-const int ORDER = 340;
+#include "external_sort.hpp"
+#include "mmap_file.hpp"
+#include "page_io.hpp"
+#include "buffer_pool.hpp"
+#include "wal.hpp"
+#include "log.hpp"
+#include "node_search.hpp"
 
 // long para representar os ponteiros para outros blocos no arquivo
 using f_ptr = long; //-1 para nulo
 
-// layout dos metadados PERMANENTES do arquivo
+// tamanho padrão de um nó (e da página de metadados), igual à página do sistema operacional
+constexpr size_t BPLUS_TREE_PAGE_SIZE = 4096;
+
+// layout dos metadados PERMANENTES do arquivo (ocupam a primeira página inteira, os nós começam alinhados na segunda)
 struct BPlusTreeMetadata {
     f_ptr root_ptr_offset; // Offset do nó raiz atual
-    long block_count;      // Número total de blocos
+    long block_count;      // Número total de blocos (incluindo os livres)
+    f_ptr free_list_head;  // Primeiro nó da lista de livres, encadeada por next_leaf (0 = vazia; arquivos antigos têm 0 aqui)
 };
 
-// constante que define onde os blocos de nós começam
-const f_ptr DATA_START_OFFSET = sizeof(BPlusTreeMetadata);
-
-// layout de um unico nó da B+ tree
-struct BPlusTreeNode {
+// campos de um nó da B+ tree com M filhos
+template <typename Key, int M>
+struct BPlusTreeNodeFields {
     bool is_leaf;                 //flag para indicar se o nó é uma folha
     int key_count;                //número de chaves atualmente no nó
-    int keys[ORDER - 1];          //array para armazenar as chaves (ex: IDs dos artigos), precisa do hashing para mapear o id do artigo para a chave
-    f_ptr children[ORDER];        //array de ponteiros para os nós filhos
-    
+    Key keys[M - 1];              //array para armazenar as chaves (ex: IDs dos artigos ou hash dos títulos)
+    f_ptr children[M];            //array de ponteiros para os nós filhos
+
     f_ptr next_leaf; // ponteiro para o próximo nó folha
     // (para nós folha, os ponteiros podem apontar para os registros no arquivo de dados ou para um próximo nó folha)
+};
+
+// bytes que sobram no fim da página (base vazia quando o nó ocupa a página exatamente)
+template <size_t N>
+struct BPlusTreeNodePadding { unsigned char padding[N]; };
+template <>
+struct BPlusTreeNodePadding<0> {};
+
+// maior ordem (quantidade de filhos) cujo nó cabe em PageSize bytes, calculada a partir do layout real
+template <typename Key, size_t PageSize, int M = 3>
+constexpr int bplus_tree_order() {
+    if constexpr (sizeof(BPlusTreeNodeFields<Key, M + 1>) > PageSize) {
+        return M;
+    } else {
+        return bplus_tree_order<Key, PageSize, M + 1>();
+    }
+}
+
+// layout de um unico nó da B+ tree: ocupa exatamente uma página
+template <typename Key, size_t PageSize>
+struct BPlusTreeNode
+    : BPlusTreeNodeFields<Key, bplus_tree_order<Key, PageSize>()>,
+      BPlusTreeNodePadding<PageSize - sizeof(BPlusTreeNodeFields<Key, bplus_tree_order<Key, PageSize>()>)> {
+
+    static constexpr int ORDER = bplus_tree_order<Key, PageSize>();
 
     //construtor para inicializar um nó vazio
-    BPlusTreeNode() : is_leaf(false), key_count(0), next_leaf(-1) {
-        for (int i = 0; i < ORDER - 1; ++i) keys[i] = 0; // inicializa o array de chaves com zeros
-        for (int i = 0; i < ORDER; ++i) children[i] = -1; // inicializa o array de filhos com ponteiros nulos
+    BPlusTreeNode() {
+        std::memset(static_cast<void*>(this), 0, sizeof(*this)); // zera também o padding, o arquivo fica determinístico
+        this->is_leaf = false;
+        this->key_count = 0;
+        this->next_leaf = -1;
+        for (int i = 0; i < ORDER; ++i) this->children[i] = -1; // inicializa o array de filhos com ponteiros nulos
     }
 };
 
 // gerencia o arquivo de índice e as operações de alto nível
+// Key: tipo da chave, PageSize: tamanho de cada nó no disco (a ordem da árvore é derivada dele)
+template <typename Key = int, size_t PageSize = BPLUS_TREE_PAGE_SIZE>
 class BPlusTree {
 public:
+    using Node = BPlusTreeNode<Key, PageSize>;
+
+    static constexpr int ORDER = Node::ORDER;                // filhos por nó
+    static constexpr f_ptr DATA_START_OFFSET = PageSize;     // os nós começam depois da página de metadados
+
+    static_assert(ORDER >= 3, "PageSize pequeno demais para um nó da B+ tree");
+    static_assert(sizeof(Node) == PageSize, "o nó da B+ tree precisa ocupar exatamente uma página");
+    static_assert(sizeof(BPlusTreeMetadata) <= PageSize, "os metadados precisam caber na primeira página");
+
     // abre/cria o arquivo de índice
-    BPlusTree(const std::string& index_file_path);
-    
-    // fecha o arquivo "~" 
+    // em READ_ONLY o arquivo precisa existir e é mapeado em memória (buscas sem cópia dos nós)
+    BPlusTree(const std::string& index_file_path, OpenMode mode = OpenMode::READ_WRITE);
+
+    // fecha o arquivo "~"
     ~BPlusTree();
 
     // função principal para inserir uma chave e o ponteiro para o registro de dados
-    void insert(int key, f_ptr data_ptr);
+    void insert(Key key, f_ptr data_ptr);
+
+    // inserção em lote de pares ordenados pela chave (carga incremental): a árvore é descida uma vez por trecho,
+    // cada folha que recebe entradas é lida e gravada uma vez só e, se passar da ordem, vira de uma vez quantas
+    // folhas precisar; os separadores sobem do mesmo jeito pelos nós internos (a raiz pode ganhar um nível)
+    void insert_batch(const std::vector<std::pair<Key, f_ptr>>& entries);
 
     // função principal para buscar uma chave, retornando o ponteiro para o registro de dados e o numero de blocos lidos
-    f_ptr search(int key, int& blocks_read);
+    f_ptr search(Key key, int& blocks_read);
+
+    // busca em lote: 'keys' precisa estar ordenado e sem repetições, out[i] recebe o ponteiro de keys[i] (ou -1)
+    // a árvore é percorrida uma vez de cima para baixo e cada nó é lido uma vez só, mesmo servindo várias chaves
+    // retorna a quantidade de nós lidos
+    long search_batch(const std::vector<Key>& keys, std::vector<f_ptr>& out);
+
+    // busca em lote com chaves repetidas: visit(i, ponteiro) é chamado para cada entrada igual a keys[i]
+    // (as repetições de uma chave podem continuar nas folhas seguintes); 'keys' ordenado e sem repetições
+    // retorna a quantidade de nós lidos
+    long search_batch_all(const std::vector<Key>& keys, const std::function<void(size_t, f_ptr)>& visit);
+
+    // varredura por faixa: visita em ordem crescente todas as chaves em [lo, hi] com seus ponteiros
+    // desce uma vez até a folha de 'lo' e depois segue a lista encadeada das folhas (next_leaf)
+    // visit retorna false para encerrar antes do fim da faixa; retorna a quantidade de nós lidos
+    long scan(Key lo, Key hi, const std::function<bool(Key, f_ptr)>& visit);
+
+    // folhas pedidas antecipadamente ao kernel durante a varredura (modo somente leitura)
+    static constexpr long SCAN_READAHEAD_LEAVES = 32;
+
+    // remove a entrada (key, data_ptr); com chaves repetidas só sai a entrada com esse ponteiro
+    // um nó que fica abaixo da ocupação mínima pega uma entrada de um irmão ou é fundido com ele, e os nós
+    // liberados vão para a lista de livres (reaproveitada por allocate_new_block). Retorna false se a entrada não existir
+    bool remove(Key key, f_ptr data_ptr);
+
+    // troca, na folha, a entrada (key, old_ptr) por (new_key, new_ptr) sem mudar a forma da árvore
+    // new_key precisa comparar igual a key (ex.: CoveringKey com outros atributos, posting com outro endereço)
+    // retorna false se a entrada não existir
+    bool replace_entry(Key key, f_ptr old_ptr, Key new_key, f_ptr new_ptr);
+
+    // carga em lote: constrói a árvore de baixo para cima a partir de pares (chave, ponteiro) ordenados externamente
+    // só pode ser usada em uma árvore vazia, fill_factor (0 < f <= 1) define a ocupação dos nós
+    void bulk_load(ExternalSorter<Key>& entries, double fill_factor);
 
     // função que retorna a quantidade de blocos
     long get_total_blocks();
 
+    // contadores do buffer pool de nós (acertos, faltas, substituições e gravações)
+    const BufferPoolStats& get_cache_stats() const { return node_cache.get_stats(); }
+
+    // contadores de E/S do arquivo no modo leitura e escrita
+    const PageIoStats& get_io_stats() const { return index_file.get_stats(); }
+
+    // liga a árvore ao log de escrita antecipada: a partir daqui os nós sujos só vão para o arquivo nos commits,
+    // feitos no início de uma inserção quando o grupo fecha (WAL_GROUP_INSERTS / WAL_GROUP_MS) ou metade do pool está suja
+    void attach_wal(WriteAheadLog& wal_log);
+
+    // grava no log os nós sujos e os metadados e, depois do fdatasync do log, no próprio arquivo
+    // (sem log equivale a um flush do cache com os metadados)
+    void commit();
+
 private:
 
-    std::unordered_map<f_ptr, BPlusTreeNode> node_cache;
-    static const int MAX_CACHE_SIZE = 2000;
+    // buffer pool dos nós (CLOCK + bit de sujo), capacidade em bytes definida por INDEX_CACHE_BYTES
+    BufferPool<Node> node_cache;
+    static constexpr size_t DEFAULT_CACHE_BYTES = 2000 * sizeof(Node);
+    static constexpr long BULK_WRITE_NODES = 64; // nós vizinhos gravados numa escrita só na carga em lote
+    static constexpr int MIN_LEAF_KEYS = ORDER / 2;             // ocupação mínima de uma folha, teto de (ORDER - 1) / 2
+    static constexpr int MIN_INTERNAL_KEYS = (ORDER + 1) / 2 - 1; // e de um nó interno (teto de ORDER / 2 filhos)
 
-    std::fstream index_file;    // gerencia conexão para ler e escrever no arquivo de índice
+    std::string index_path;     // caminho do arquivo (identifica a árvore nas mensagens de log)
+    PageFile index_file;        // conexão de leitura e escrita (pread/pwrite, lotes pelo io_uring)
     f_ptr root_ptr;             // ponteiro para o nó raiz no arquivo
     long block_count;           // contador total de blocos no arquivo
+    f_ptr free_list = 0;        // nós liberados pelas remoções, reaproveitados antes de o arquivo crescer
+    bool read_only = false;     // true quando aberto em OpenMode::READ_ONLY
+    MappedFile mapped_file;     // mapeamento do arquivo no modo somente leitura
+
+    WriteAheadLog* wal = nullptr; // log de escrita antecipada (opcional, ligado por attach_wal)
+    int wal_id = -1;
+    long pending_inserts = 0;     // inserções desde o último commit
+    std::chrono::steady_clock::time_point last_commit;
+
+    // commit entre duas operações quando o grupo do log fecha ou metade do pool está suja
+    void commit_if_due();
+
+    // grava os metadados de uma árvore nova (ou truncada) e a raiz folha vazia
+    void initialize_empty_tree();
+
+    // grava os metadados (página 0 inteira)
+    void write_metadata();
+    void fill_metadata_page(AlignedBuffer& page) const;
 
     // lê um bloco do arquivo de índice e o carrega em uma struct de nó
-    BPlusTreeNode read_block(f_ptr block_ptr);
+    Node read_block(f_ptr block_ptr);
+
+    // retorna o nó: no modo somente leitura aponta direto para o mapeamento, senão lê em 'scratch'
+    const Node& fetch_node(f_ptr block_ptr, Node& scratch);
+
+    // pede de uma vez os nós que vão ser visitados em seguida: no modo mmap vira leitura antecipada do kernel,
+    // senão os que não estão no pool são lidos num lote só e carregados nele
+    void prefetch_nodes(const std::vector<f_ptr>& block_ptrs);
+    // O_DIRECT só quando cada nó é um múltiplo do alinhamento (as árvores de teste com páginas pequenas usam o cache do kernel)
+    static bool direct_io() { return PageSize % PAGE_IO_ALIGNMENT == 0 && page_io_direct(); }
+
+    // abre o arquivo mapeado em memória e pede ao kernel para trazer os níveis de cima da árvore
+    void open_read_only(const std::string& index_file_path);
 
     // escreve todos os itens presentes no cache de volta
     void flush_cache();
 
     // escreve o conteúdo de uma struct de nó em um bloco específico do arquivo
-    void write_block(f_ptr block_ptr, const BPlusTreeNode& node);
-    
-    // aloca um novo bloco no final do arquivo e retorna seu ponteiro
+    void write_block(f_ptr block_ptr, const Node& node);
+
+    // escreve nós direto no disco, sem passar pelo cache (o lote vem do pool em ordem de endereço)
+    void write_blocks_to_disk(const std::vector<std::pair<f_ptr, const Node*>>& nodes);
+
+    // escreve 'count' nós vizinhos a partir de first_ptr numa escrita só (carga em lote)
+    void write_run_to_disk(f_ptr first_ptr, const Node* nodes, size_t count);
+
+    // aloca um novo bloco (da lista de livres ou no final do arquivo) e retorna seu ponteiro
     f_ptr allocate_new_block();
 
-    // função auxiliar de insert_internal para inserir em uma folha 
-    void insert_into_leaf(BPlusTreeNode& leaf, int key, f_ptr data_ptr);
+    // devolve um nó que saiu da árvore para a lista de livres
+    void free_block(f_ptr block_ptr);
+
+    // função auxiliar recursiva da remoção: underflow diz se o nó ficou abaixo da ocupação mínima
+    bool remove_internal(f_ptr node_ptr, Key key, f_ptr data_ptr, bool& underflow);
+
+    // o filho pos de parent ficou abaixo do mínimo: empresta de um irmão vizinho ou funde com ele (parent não é gravado)
+    void rebalance_child(Node& parent, int pos);
+
+    // ponteiro válido para um nó? (depois dos metadados e alinhado ao tamanho do nó)
+    static bool valid_block_ptr(f_ptr block_ptr) {
+        return block_ptr >= DATA_START_OFFSET && (block_ptr - DATA_START_OFFSET) % static_cast<f_ptr>(sizeof(Node)) == 0;
+    }
+
+    // função auxiliar recursiva de insert_batch: entries[0, count) na subárvore de node_ptr (mesma descida do insert)
+    // os nós criados à direita de node_ptr saem em promoted como (separador, nó), em ordem
+    void insert_batch_node(f_ptr node_ptr, const std::pair<Key, f_ptr>* entries, size_t count,
+                           std::vector<std::pair<Key, f_ptr>>& promoted);
+
+    // grava as entradas em folhas de ocupação parecida, a primeira em leaf_ptr e as outras em nós novos
+    void write_leaf_run(f_ptr leaf_ptr, f_ptr next_leaf, const std::vector<std::pair<Key, f_ptr>>& entries,
+                        std::vector<std::pair<Key, f_ptr>>& promoted);
+
+    // idem para um nó interno com children.size() == keys.size() + 1; a chave entre dois nós sobe para o pai
+    void write_internal_run(f_ptr node_ptr, const std::vector<Key>& keys, const std::vector<f_ptr>& children,
+                            std::vector<std::pair<Key, f_ptr>>& promoted);
+
+    // função auxiliar de insert_internal para inserir em uma folha
+    void insert_into_leaf(Node& leaf, Key key, f_ptr data_ptr);
 
     // função auxiliar de insert_internal para separar uma folha
-    void split_leaf(BPlusTreeNode& leaf, int key, f_ptr data_ptr, int& promoted_key_out, f_ptr& new_leaf_ptr_out);
+    void split_leaf(Node& leaf, Key key, f_ptr data_ptr, Key& promoted_key_out, f_ptr& new_leaf_ptr_out);
 
     //função axuiliar de insert_internal para inserir um valor
-    void insert_into_internal(BPlusTreeNode& node, int key, f_ptr child_ptr);
+    // pos é o índice do filho que foi separado: a chave entra em keys[pos] e o novo filho logo à direita dele
+    // (com chaves repetidas a posição não pode ser deduzida só pela chave)
+    void insert_into_internal(Node& node, int pos, Key key, f_ptr child_ptr);
 
-    // função auxiliar de insert_internal para separar um nó interno
-    void split_internal(BPlusTreeNode& node, int& key_in_out, f_ptr& child_in_out);
+    // função auxiliar de insert_internal para separar um nó interno (pos como em insert_into_internal)
+    void split_internal(Node& node, int pos, Key& key_in_out, f_ptr& child_in_out);
 
-    // função auxiliar recursiva para a inserção
-    bool insert_internal(f_ptr current_ptr, int key, f_ptr data_ptr, int& promoted_key_out, f_ptr& new_child_ptr_out);
+    // função auxiliar recursiva da busca em lote: resolve keys[0, count) na subárvore de node_ptr
+    // lower: separador logo à esquerda do nó (nulo no caminho mais à esquerda)
+    void search_batch_node(f_ptr node_ptr, const Key* keys, f_ptr* out, size_t count, const Key* lower, long& blocks_read);
+
+    // última entrada da folha mais à direita da subárvore, se for igual a key (resto da busca depois de remoções)
+    f_ptr search_rightmost_leaf(f_ptr node_ptr, Key key, int& blocks_read);
+
+    // função auxiliar recursiva de search_batch_all: keys[first, first + count) na subárvore de node_ptr
+    void search_batch_all_node(f_ptr node_ptr, const std::vector<Key>& keys, size_t first, size_t count,
+                               const std::function<void(size_t, f_ptr)>& visit, long& blocks_read);
 
-    // função para lidar com a divisão de um nó que está cheio
-    void split_node(f_ptr parent_ptr, int child_index, f_ptr child_ptr);
+    // função auxiliar recursiva para a inserção
+    bool insert_internal(f_ptr current_ptr, Key key, f_ptr data_ptr, Key& promoted_key_out, f_ptr& new_child_ptr_out);
 };
 
-#endif // BPLUSTREE_HPP
\ No newline at end of file
+//abrir o arquivo e incializar caso seja um arquivo novo
+template <typename Key, size_t PageSize>
+BPlusTree<Key, PageSize>::BPlusTree(const std::string& index_file_path, OpenMode mode)
+    : node_cache(cache_bytes_from_env("INDEX_CACHE_BYTES", DEFAULT_CACHE_BYTES),
+                 [this](const std::vector<std::pair<f_ptr, const Node*>>& nodes) { write_blocks_to_disk(nodes); }),
+      index_path(index_file_path) {
+    ensure_no_pending_recovery(index_file_path, mode);
+    if (mode == OpenMode::READ_ONLY) {
+        open_read_only(index_file_path);
+        return;
+    }
+
+    if(!index_file.open(index_file_path, false, direct_io())) {
+        // arquivo novo
+        LOG_DEBUG("CONSTRUTOR DA ARVORE B+ (" << index_path << "): Arquivo não existe. Criando...");
+        if(!index_file.open(index_file_path, true, direct_io())) {
+            LOG_ERROR("Erro na criação do índice " << index_path);
+            throw std::runtime_error("ERRO: Não foi possível criar o arquivo de índice"); }
+
+        initialize_empty_tree();
+        LOG_DEBUG("CONSTRUTOR DA ARVORE B+ (" << index_path << "): Arquivo criado e inicializado. root_ptr=" << root_ptr << ", block_count=" << block_count);
+
+    } else {
+        // arquivo existente
+        LOG_DEBUG("CONSTRUTOR DA ARVORE B+ (" << index_path << "): Arquivo existente aberto.");
+
+        // verifica tamanho mínimo para conter metadados
+        long file_size = index_file.size();
+
+        if ((unsigned long)file_size < sizeof(BPlusTreeMetadata)) {
+            // arquivo existe mas é muito pequeno, deve ser tratado como novo
+            LOG_DEBUG("CONSTRUTOR DA ARVORE B+ (" << index_path << "): Arquivo existente muito pequeno. Re-inicializando...");
+            if(!index_file.open(index_file_path, true, direct_io())) { // reabre truncando
+                LOG_ERROR("Falha em reabrir o arquivo de índice muito pequeno " << index_path);
+                throw std::runtime_error("ERRO: Não foi possível reabrir/truncar arquivo pequeno.");
+            }
+            initialize_empty_tree();
+
+        } else {
+            // arquivo tem tamanho suficiente, lê metadados
+            BPlusTreeMetadata metadata;
+            if (!index_file.read(0, &metadata, sizeof(BPlusTreeMetadata))) {
+                LOG_ERROR("Falha ao ler metadados do índice " << index_path);
+                throw std::runtime_error("ERRO: Falha ao ler metadados do arquivo existente.");
+            }
+
+            // inicializa variáveis membro com valores lidos
+            root_ptr = metadata.root_ptr_offset;
+            block_count = metadata.block_count;
+            free_list = metadata.free_list_head;
+            if (free_list != 0 && (!valid_block_ptr(free_list) || static_cast<size_t>(free_list) + sizeof(Node) > static_cast<size_t>(file_size))) {
+                LOG_WARN("Lista de nos livres do indice " << index_path << " invalida, descartada");
+                free_list = 0;
+            }
+
+             // validação básica (arquivos do layout antigo, com os nós logo depois dos metadados, caem aqui)
+            if (!valid_block_ptr(root_ptr) || block_count == 0 ||
+                static_cast<size_t>(root_ptr) + sizeof(Node) > static_cast<size_t>(file_size)) {
+                LOG_ERROR("Metadados do indice " << index_path << " invalidos (root_ptr=" << root_ptr
+                          << ", block_count=" << block_count << "). Refaca o upload.");
+                throw std::runtime_error("ERRO: arquivo de índice em formato inválido.");
+            }
+        }
+    }
+    // Verificação final do estado do arquivo
+    if (!index_file.is_open()) {
+        LOG_ERROR("ERRO FATAL no Construtor BPlusTree: Estado do arquivo invalido apos inicializacao!");
+        throw std::runtime_error("Estado invalido do arquivo no construtor.");
+    }
+    LOG_DEBUG("CONSTRUTOR DA ARVORE B+ (" << index_path << "): Arvore criada com sucesso!");
+}
+
+template <typename Key, size_t PageSize>
+BPlusTree<Key, PageSize>::~BPlusTree() {
+    if(index_file.is_open() && wal != nullptr) {
+        // último commit; os nós que não chegaram ao log são descartados, o arquivo fica no estado do último commit
+        try {
+            commit();
+        } catch (const std::exception& e) {
+            LOG_ERROR("Falha no commit final da árvore B+ (" << index_path << "): " << e.what());
+        }
+        try {
+            wal->detach(wal_id);
+        } catch (const std::exception& e) {
+            LOG_ERROR("Falha ao sincronizar o indice " << index_path << ": " << e.what());
+        }
+        index_file.close();
+    }
+    if(index_file.is_open()) {
+
+        LOG_DEBUG("Tentando destruir árvore B+ (" << index_path << ")");
+        flush_cache(); // descarrega nós modificados para o disco
+        LOG_DEBUG("Cache transferido para a memória secundária com sucesso");
+
+        // salvando metadados atualizados
+        try {
+            write_metadata();
+            LOG_DEBUG("DESTRUTOR DA AROVRE B+ (" << index_path << "): Metadados salvos.");
+        } catch (const std::exception&) {
+            LOG_ERROR("Falha ao salvar metadados no destrutor da árvore B+ (" << index_path << ")!");
+        }
+
+        index_file.close();
+        LOG_DEBUG("DESTRUTOR DA AROVRE B+ (" << index_path << "): Arquivo de indice fechado.");
+    }
+}
+
+//encontra uma chave e retorna o seu ponteiro
+template <typename Key, size_t PageSize>
+f_ptr BPlusTree<Key, PageSize>::search(Key key, int& blocks_read) {
+
+    blocks_read = 0;
+
+    if (block_count == 0) {
+        return -1; //arvore vazia
+    }
+
+    f_ptr ptr_atual = root_ptr;
+    Node scratch;
+    f_ptr left_of_key = -1; // filho logo à esquerda do separador mais baixo igual à chave
+
+    while (true) {
+        const Node& node_atual = fetch_node(ptr_atual, scratch); // no modo mmap não copia o nó
+        blocks_read++;
+
+        if (node_atual.is_leaf == true) { //em um no folha procuramos pela chave exata
+            int i = node_lower_bound(node_atual.keys, node_atual.key_count, key); // primeira chave >= key
+            if (i < node_atual.key_count && node_atual.keys[i] == key) {
+                return node_atual.children[i]; //retornar o ponteiro com a localização do dado
+            }
+            if (left_of_key == -1) return -1; //key não achada na folha
+            // a chave é um separador e não está à direita dele: depois de remoções, repetições dela podem ter ficado
+            // só no fim da subárvore da esquerda (com chaves únicas isso só acontece se a chave foi removida)
+            return search_rightmost_leaf(left_of_key, key, blocks_read);
+        }
+        else {
+            int i = node_upper_bound(node_atual.keys, node_atual.key_count, key); // primeira chave > key
+            if (i > 0 && node_atual.keys[i - 1] == key) left_of_key = node_atual.children[i - 1];
+            ptr_atual = node_atual.children[i];
+        }
+    }
+}
+
+template <typename Key, size_t PageSize>
+f_ptr BPlusTree<Key, PageSize>::search_rightmost_leaf(f_ptr node_ptr, Key key, int& blocks_read) {
+    Node scratch;
+    const Node* node = &fetch_node(node_ptr, scratch);
+    blocks_read++;
+    while (!node->is_leaf) {
+        node = &fetch_node(node->children[node->key_count], scratch);
+        blocks_read++;
+    }
+    int last = node->key_count - 1;
+    return (last >= 0 && node->keys[last] == key) ? node->children[last] : -1;
+}
+
+template <typename Key, size_t PageSize>
+long BPlusTree<Key, PageSize>::search_batch(const std::vector<Key>& keys, std::vector<f_ptr>& out) {
+    out.assign(keys.size(), -1);
+    long blocks_read = 0;
+    if (block_count == 0 || keys.empty()) return 0;
+    search_batch_node(root_ptr, keys.data(), out.data(), keys.size(), nullptr, blocks_read);
+    return blocks_read;
+}
+
+template <typename Key, size_t PageSize>
+void BPlusTree<Key, PageSize>::search_batch_node(f_ptr node_ptr, const Key* keys, f_ptr* out, size_t count, const Key* lower,
+                                                 long& blocks_read) {
+    Node scratch;
+    const Node& node = fetch_node(node_ptr, scratch);
+    blocks_read++;
+
+    if (node.is_leaf) {
+        for (size_t k = 0; k < count; k++) {
+            int i = node_lower_bound(node.keys, node.key_count, keys[k]);
+            out[k] = (i < node.key_count && node.keys[i] == keys[k]) ? node.children[i] : -1;
+            if (out[k] == -1 && lower != nullptr && *lower == keys[k]) {
+                // igual ao separador e ausente à direita dele: mesma verificação da busca simples
+                int fallback_reads = 0;
+                out[k] = search(keys[k], fallback_reads);
+                blocks_read += fallback_reads;
+            }
+        }
+        return;
+    }
+
+    // as chaves ordenadas são repartidas entre os filhos: cada filho recebe o trecho contíguo das chaves dele
+    // os filhos visitados são conhecidos antes da descida, então são pedidos todos juntos
+    struct Part {
+        f_ptr child;
+        size_t end;       // fim do trecho de chaves do filho
+        bool has_lower;
+        Key lower;        // separador logo à esquerda do filho
+    };
+    std::vector<Part> parts;
+    size_t begin = 0;
+    while (begin < count) {
+        int child = node_upper_bound(node.keys, node.key_count, keys[begin]);
+        size_t end = (child < node.key_count)
+            ? static_cast<size_t>(std::lower_bound(keys + begin, keys + count, node.keys[child]) - keys)
+            : count;
+        Part part{node.children[child], end, child > 0 || lower != nullptr, Key()};
+        if (child > 0) part.lower = node.keys[child - 1];
+        else if (lower != nullptr) part.lower = *lower;
+        parts.push_back(part);
+        begin = end;
+    }
+    if (parts.size() > 1) {
+        std::vector<f_ptr> children;
+        for (const Part& part : parts) children.push_back(part.child);
+        prefetch_nodes(children);
+    }
+    begin = 0;
+    for (const Part& part : parts) {
+        search_batch_node(part.child, keys + begin, out + begin, part.end - begin, part.has_lower ? &part.lower : nullptr, blocks_read);
+        begin = part.end;
+    }
+}
+
+template <typename Key, size_t PageSize>
+long BPlusTree<Key, PageSize>::search_batch_all(const std::vector<Key>& keys, const std::function<void(size_t, f_ptr)>& visit) {
+    long blocks_read = 0;
+    if (block_count == 0 || keys.empty()) return 0;
+    search_batch_all_node(root_ptr, keys, 0, keys.size(), visit, blocks_read);
+    return blocks_read;
+}
+
+template <typename Key, size_t PageSize>
+void BPlusTree<Key, PageSize>::search_batch_all_node(f_ptr node_ptr, const std::vector<Key>& keys, size_t first, size_t count,
+                                                     const std::function<void(size_t, f_ptr)>& visit, long& blocks_read) {
+    Node scratch;
+    const Node& node = fetch_node(node_ptr, scratch);
+    blocks_read++;
+
+    if (node.is_leaf) {
+        for (size_t k = first; k < first + count; k++) {
+            const Node* leaf = &node;
+            Node next_scratch;
+            int i = node_lower_bound(leaf->keys, leaf->key_count, keys[k]);
+            while (true) {
+                for (; i < leaf->key_count && leaf->keys[i] == keys[k]; i++) visit(k, leaf->children[i]);
+                // a sequência só pode continuar na próxima folha se chegou ao fim desta
+                if (i < leaf->key_count || leaf->next_leaf == -1) break;
+                leaf = &fetch_node(leaf->next_leaf, next_scratch);
+                blocks_read++;
+                i = 0;
+            }
+        }
+        return;
+    }
+
+    // como na varredura, a descida usa o filho mais à esquerda: repetições de um separador podem estar à esquerda dele
+    std::vector<std::pair<f_ptr, size_t>> parts; // (filho, fim do trecho de chaves dele), pedidos juntos
+    size_t begin = first, end_all = first + count;
+    while (begin < end_all) {
+        int child = node_lower_bound(node.keys, node.key_count, keys[begin]);
+        size_t end = (child < node.key_count)
+            ? static_cast<size_t>(std::upper_bound(keys.begin() + begin, keys.begin() + end_all, node.keys[child]) - keys.begin())
+            : end_all;
+        parts.push_back({node.children[child], end});
+        begin = end;
+    }
+    if (parts.size() > 1) {
+        std::vector<f_ptr> children;
+        for (const auto& part : parts) children.push_back(part.first);
+        prefetch_nodes(children);
+    }
+    begin = first;
+    for (const auto& part : parts) {
+        search_batch_all_node(part.first, keys, begin, part.second - begin, visit, blocks_read);
+        begin = part.second;
+    }
+}
+
+template <typename Key, size_t PageSize>
+long BPlusTree<Key, PageSize>::scan(Key lo, Key hi, const std::function<bool(Key, f_ptr)>& visit) {
+    long blocks_read = 0;
+    if (block_count == 0 || hi < lo) return 0;
+
+    // descida até a primeira folha que pode ter chaves >= lo (filho mais à esquerda, por causa de chaves repetidas)
+    Node scratch;
+    f_ptr node_ptr = root_ptr;
+    const Node* node = &fetch_node(node_ptr, scratch);
+    blocks_read++;
+    while (!node->is_leaf) {
+        node_ptr = node->children[node_lower_bound(node->keys, node->key_count, lo)];
+        node = &fetch_node(node_ptr, scratch);
+        blocks_read++;
+    }
+
+    const f_ptr node_size = static_cast<f_ptr>(sizeof(Node));
+    f_ptr readahead_end = node_ptr + node_size; // fim do trecho já pedido ao kernel
+    int i = node_lower_bound(node->keys, node->key_count, lo);
+    while (true) {
+        for (; i < node->key_count; i++) {
+            if (hi < node->keys[i]) return blocks_read;
+            if (!visit(node->keys[i], node->children[i])) return blocks_read;
+        }
+        f_ptr next = node->next_leaf;
+        if (next == -1) return blocks_read;
+
+        // leitura antecipada: as folhas da carga em lote ficam lado a lado no arquivo, então o trecho seguinte
+        // é pedido quando a varredura passa da metade do trecho anterior (sem esperar no modo mmap, num lote só sem ele)
+        if (next + (SCAN_READAHEAD_LEAVES / 2) * node_size >= readahead_end) {
+            f_ptr file_end = read_only ? static_cast<f_ptr>(mapped_file.size()) : DATA_START_OFFSET + block_count * node_size;
+            f_ptr from = std::max(next, readahead_end);
+            f_ptr to = std::min<f_ptr>(next + SCAN_READAHEAD_LEAVES * node_size, file_end);
+            if (to > from && read_only) {
+                mapped_file.advise_range(from, to - from, MADV_WILLNEED);
+            } else if (to > from) {
+                std::vector<f_ptr> leaves;
+                for (f_ptr ptr = from; ptr < to; ptr += node_size) leaves.push_back(ptr);
+                prefetch_nodes(leaves);
+            }
+            readahead_end = std::max(readahead_end, to);
+        }
+        node = &fetch_node(next, scratch);
+        blocks_read++;
+        i = 0;
+    }
+}
+
+template <typename Key, size_t PageSize>
+void BPlusTree<Key, PageSize>::insert(Key key, f_ptr data_ptr) {
+    if (read_only) {
+        LOG_ERROR("Tentativa de inserir no indice " << index_path << " aberto somente para leitura");
+        throw std::runtime_error("ERRO: índice aberto somente para leitura.");
+    }
+    commit_if_due();
+    pending_inserts++;
+    Key promoted_key;
+    f_ptr new_child_ptr;
+
+    //se retornar true a chave foi promovida até a categoria de nova raiz
+    if (insert_internal(root_ptr, key, data_ptr, promoted_key, new_child_ptr)) {
+
+        Node new_root;
+        new_root.children[0] = root_ptr;
+        new_root.children[1] = new_child_ptr;
+        new_root.is_leaf = false;
+        new_root.keys[0] = promoted_key;
+        new_root.key_count = 1;
+        new_root.next_leaf = -1;
+
+        f_ptr new_root_ptr = allocate_new_block();
+        write_block(new_root_ptr, new_root);
+        root_ptr = new_root_ptr;
+    }
+}
+
+template <typename Key, size_t PageSize>
+void BPlusTree<Key, PageSize>::insert_batch(const std::vector<std::pair<Key, f_ptr>>& entries) {
+    if (read_only) {
+        LOG_ERROR("Tentativa de inserir no indice " << index_path << " aberto somente para leitura");
+        throw std::runtime_error("ERRO: índice aberto somente para leitura.");
+    }
+    // trechos pequenos o bastante para os nós sujos de um trecho caberem no pool entre dois commits
+    const size_t chunk = std::max<size_t>(1, node_cache.capacity_frames() / 4);
+    for (size_t first = 0; first < entries.size(); first += chunk) {
+        commit_if_due();
+        size_t count = std::min(chunk, entries.size() - first);
+        pending_inserts += static_cast<long>(count);
+        std::vector<std::pair<Key, f_ptr>> promoted;
+        insert_batch_node(root_ptr, entries.data() + first, count, promoted);
+        // a raiz se dividiu: ela e os irmãos novos ficam embaixo de uma raiz nova (que também pode se dividir)
+        while (!promoted.empty()) {
+            std::vector<Key> keys;
+            std::vector<f_ptr> children{root_ptr};
+            for (const auto& sibling : promoted) {
+                keys.push_back(sibling.first);
+                children.push_back(sibling.second);
+            }
+            promoted.clear();
+            root_ptr = allocate_new_block();
+            write_internal_run(root_ptr, keys, children, promoted);
+        }
+    }
+}
+
+template <typename Key, size_t PageSize>
+bool BPlusTree<Key, PageSize>::remove(Key key, f_ptr data_ptr) {
+    if (read_only) {
+        LOG_ERROR("Tentativa de remover do indice " << index_path << " aberto somente para leitura");
+        throw std::runtime_error("ERRO: índice aberto somente para leitura.");
+    }
+    commit_if_due();
+    bool underflow = false;
+    if (!remove_internal(root_ptr, key, data_ptr, underflow)) return false;
+    pending_inserts++;
+
+    // a raiz pode ficar abaixo do mínimo; sem nenhuma chave, o único filho vira a raiz e a árvore perde um nível
+    Node root = read_block(root_ptr);
+    if (!root.is_leaf && root.key_count == 0) {
+        f_ptr old_root = root_ptr;
+        root_ptr = root.children[0];
+        free_block(old_root);
+    }
+    return true;
+}
+
+template <typename Key, size_t PageSize>
+bool BPlusTree<Key, PageSize>::replace_entry(Key key, f_ptr old_ptr, Key new_key, f_ptr new_ptr) {
+    if (read_only) {
+        LOG_ERROR("Tentativa de alterar o indice " << index_path << " aberto somente para leitura");
+        throw std::runtime_error("ERRO: índice aberto somente para leitura.");
+    }
+    if (key < new_key || new_key < key) {
+        LOG_ERROR("replace_entry no indice " << index_path << " com chaves diferentes");
+        throw std::invalid_argument("ERRO: replace_entry exige chaves equivalentes.");
+    }
+    commit_if_due();
+
+    // descida pelo filho mais à esquerda (as repetições da chave podem estar à esquerda do separador)
+    f_ptr node_ptr = root_ptr;
+    Node node = read_block(node_ptr);
+    while (!node.is_leaf) {
+        node_ptr = node.children[node_lower_bound(node.keys, node.key_count, key)];
+        node = read_block(node_ptr);
+    }
+    int i = node_lower_bound(node.keys, node.key_count, key);
+    while (true) {
+        for (; i < node.key_count && !(key < node.keys[i]); i++) {
+            if (node.children[i] != old_ptr) continue;
+            node.keys[i] = new_key;
+            node.children[i] = new_ptr;
+            write_block(node_ptr, node);
+            pending_inserts++;
+            return true;
+        }
+        if (i < node.key_count || node.next_leaf == -1) return false;
+        node_ptr = node.next_leaf;
+        node = read_block(node_ptr);
+        i = 0;
+    }
+}
+
+template <typename Key, size_t PageSize>
+long BPlusTree<Key, PageSize>::get_total_blocks() {
+    return block_count;
+}
+
+// constrói a árvore de baixo para cima: primeiro todas as folhas em sequência, depois cada nível interno
+// os nós são gravados direto no disco, um atrás do outro, sem passar pelo cache
+template <typename Key, size_t PageSize>
+void BPlusTree<Key, PageSize>::bulk_load(ExternalSorter<Key>& entries, double fill_factor) {
+    if (read_only) {
+        throw std::runtime_error("ERRO: índice aberto somente para leitura.");
+    }
+    Node root_node = read_block(root_ptr);
+    if (block_count != 1 || !root_node.is_leaf || root_node.key_count != 0) {
+        LOG_ERROR("Carga em lote do indice " << index_path << " exige uma arvore vazia (block_count=" << block_count << ")");
+        throw std::runtime_error("ERRO: bulk_load só pode ser usado em uma árvore vazia.");
+    }
+    if (fill_factor <= 0.0 || fill_factor > 1.0) {
+        LOG_WARN("Fator de preenchimento invalido (" << fill_factor << "). Usando 1.0");
+        fill_factor = 1.0;
+    }
+
+    entries.finish();
+    long total = entries.size();
+    if (total == 0) return; // continua com a raiz folha vazia
+
+    node_cache.clear(); // a raiz vazia em cache seria regravada por cima da primeira folha
+    block_count = 0;
+    free_list = 0;
+
+    // nível das folhas: (primeira chave, ponteiro) de cada folha, usado para montar o nível de cima
+    int leaf_capacity = std::max(1, static_cast<int>(fill_factor * (ORDER - 1)));
+    long leaf_total = (total + leaf_capacity - 1) / leaf_capacity;
+    std::vector<std::pair<Key, f_ptr>> level;
+    level.reserve(leaf_total);
+
+    // os nós saem em ordem de endereço e são gravados em grupos de BULK_WRITE_NODES vizinhos
+    AlignedArray<Node> pending(BULK_WRITE_NODES);
+    size_t pending_count = 0;
+    f_ptr pending_start = DATA_START_OFFSET;
+    auto emit = [&](const Node& node) {
+        if (pending_count == 0) pending_start = DATA_START_OFFSET + block_count * sizeof(Node);
+        pending[pending_count++] = node;
+        block_count++;
+        if (static_cast<long>(pending_count) == BULK_WRITE_NODES) {
+            write_run_to_disk(pending_start, pending.data(), pending_count);
+            pending_count = 0;
+        }
+    };
+
+    typename ExternalSorter<Key>::Entry entry;
+    for (long l = 0; l < leaf_total; ++l) {
+        // espalha as chaves por igual para a última folha não ficar quase vazia
+        int count = static_cast<int>(total / leaf_total + (l < total % leaf_total ? 1 : 0));
+        Node leaf;
+        leaf.is_leaf = true;
+        for (int i = 0; i < count; ++i) {
+            entries.next(entry);
+            leaf.keys[i] = entry.first;
+            leaf.children[i] = entry.second;
+        }
+        leaf.key_count = count;
+        f_ptr leaf_ptr = DATA_START_OFFSET + block_count * sizeof(Node);
+        leaf.next_leaf = (l + 1 < leaf_total) ? leaf_ptr + static_cast<f_ptr>(sizeof(Node)) : -1;
+        emit(leaf);
+        level.push_back({leaf.keys[0], leaf_ptr});
+    }
+
+    // níveis internos: cada nó recebe um grupo de filhos e as chaves separadoras são as primeiras chaves dos filhos
+    int fanout = std::max(2, static_cast<int>(fill_factor * ORDER));
+    while (level.size() > 1) {
+        long level_size = static_cast<long>(level.size());
+        long node_total = (level_size + fanout - 1) / fanout;
+        std::vector<std::pair<Key, f_ptr>> upper_level;
+        upper_level.reserve(node_total);
+        long child = 0;
+        for (long n = 0; n < node_total; ++n) {
+            int count = static_cast<int>(level_size / node_total + (n < level_size % node_total ? 1 : 0));
+            Node node;
+            node.is_leaf = false;
+            for (int i = 0; i < count; ++i) {
+                node.children[i] = level[child + i].second;
+                if (i > 0) node.keys[i - 1] = level[child + i].first;
+            }
+            node.key_count = count - 1;
+            f_ptr node_ptr = DATA_START_OFFSET + block_count * sizeof(Node);
+            emit(node);
+            upper_level.push_back({level[child].first, node_ptr});
+            child += count;
+        }
+        level.swap(upper_level);
+    }
+
+    if (pending_count > 0) write_run_to_disk(pending_start, pending.data(), pending_count);
+    root_ptr = level[0].second;
+    LOG_DEBUG("BULK LOAD B+ (" << index_path << "): " << total << " chaves, " << leaf_total << " folhas, " << block_count << " blocos, raiz em " << root_ptr);
+    if (wal != nullptr) {
+        // os nós da carga em lote não passam pelo log: vão para o disco antes dos metadados que apontam para eles
+        if (!index_file.sync()) {
+            LOG_ERROR("Falha ao sincronizar a carga em lote do indice " << index_path);
+            throw std::runtime_error("Falha na escrita do bloco do indice.");
+        }
+        commit();
+    }
+}
+
+template <typename Key, size_t PageSize>
+void BPlusTree<Key, PageSize>::attach_wal(WriteAheadLog& wal_log) {
+    if (read_only) {
+        LOG_ERROR("Tentativa de ligar o log ao indice " << index_path << " aberto somente para leitura");
+        throw std::runtime_error("ERRO: índice aberto somente para leitura.");
+    }
+    wal = &wal_log;
+    node_cache.set_hold_dirty(true);
+    wal_id = wal->attach([this] {
+        if (!index_file.sync()) throw std::runtime_error("ERRO: falha ao sincronizar o índice " + index_path);
+    });
+    pending_inserts = 0;
+    last_commit = std::chrono::steady_clock::now();
+}
+
+template <typename Key, size_t PageSize>
+void BPlusTree<Key, PageSize>::commit() {
+    if (wal == nullptr) {
+        flush_cache();
+        write_metadata();
+        return;
+    }
+    AlignedBuffer metadata(PageSize);
+    fill_metadata_page(metadata);
+    std::vector<PageRequest> pages{{0, metadata.data(), PageSize}};
+    for (const auto& entry : node_cache.dirty_pages()) {
+        pages.push_back({entry.first, reinterpret_cast<char*>(const_cast<Node*>(entry.second)), sizeof(Node)});
+    }
+    wal->commit(index_path, pages, [this] {
+        flush_cache();
+        write_metadata();
+    });
+    pending_inserts = 0;
+    last_commit = std::chrono::steady_clock::now();
+}
+
+//INICIO DAS FUNÇÕES PRIVATE
+
+// o commit acontece entre duas operações, quando a árvore está consistente
+template <typename Key, size_t PageSize>
+void BPlusTree<Key, PageSize>::commit_if_due() {
+    if (wal != nullptr && (wal->group_due(pending_inserts, last_commit) || node_cache.dirty_count() * 2 >= node_cache.capacity_frames())) {
+        commit();
+    }
+}
+
+template <typename Key, size_t PageSize>
+void BPlusTree<Key, PageSize>::fill_metadata_page(AlignedBuffer& page) const {
+    std::memset(page.data(), 0, PageSize);
+    BPlusTreeMetadata metadata;
+    metadata.root_ptr_offset = root_ptr; // usa o valor atual da variável
+    metadata.block_count = block_count;  // usa o valor atual da variável
+    metadata.free_list_head = free_list;
+    std::memcpy(page.data(), &metadata, sizeof(metadata));
+}
+
+template <typename Key, size_t PageSize>
+void BPlusTree<Key, PageSize>::initialize_empty_tree() {
+    root_ptr = DATA_START_OFFSET; // raiz começa após a página de metadados
+    block_count = 1;
+    free_list = 0;
+    write_metadata();
+
+    // cria e escreve o nó raiz inicial
+    Node root_node;
+    root_node.is_leaf = true;
+    write_block(root_ptr, root_node); // escreve o primeiro nó no DATA_START_OFFSET
+}
+
+template <typename Key, size_t PageSize>
+void BPlusTree<Key, PageSize>::write_metadata() {
+    AlignedBuffer page(PageSize);
+    fill_metadata_page(page);
+
+    if (!index_file.write(0, page.data(), PageSize)) { // início do arquivo
+        LOG_ERROR("Falha em escrever metadados do índice " << index_path);
+        throw std::runtime_error("ERRO: Falha ao escrever metadados.");
+    }
+}
+
+template <typename Key, size_t PageSize>
+void BPlusTree<Key, PageSize>::open_read_only(const std::string& index_file_path) {
+    read_only = true;
+    mapped_file.open(index_file_path);
+    if (mapped_file.size() < static_cast<size_t>(DATA_START_OFFSET) + sizeof(Node)) {
+        LOG_ERROR("Arquivo de indice muito pequeno para leitura: " << index_file_path);
+        throw std::runtime_error("ERRO: arquivo de índice inválido.");
+    }
+
+    BPlusTreeMetadata metadata;
+    std::memcpy(&metadata, mapped_file.data(), sizeof(BPlusTreeMetadata));
+    root_ptr = metadata.root_ptr_offset;
+    block_count = metadata.block_count;
+
+    // as buscas descem por caminhos aleatórios, então desligamos o readahead...
+    mapped_file.advise(MADV_RANDOM);
+    // ...mas a raiz e o nível logo abaixo dela são usados por toda busca, pedimos para já trazer
+    Node root_scratch;
+    const Node& root = fetch_node(root_ptr, root_scratch);
+    mapped_file.advise_range(root_ptr, sizeof(Node), MADV_WILLNEED);
+    if (!root.is_leaf) {
+        for (int i = 0; i <= root.key_count; i++) {
+            mapped_file.advise_range(root.children[i], sizeof(Node), MADV_WILLNEED);
+        }
+    }
+    LOG_DEBUG("CONSTRUTOR DA ARVORE B+ (" << index_path << "): Arquivo mapeado em memoria. root_ptr=" << root_ptr << ", block_count=" << block_count);
+}
+
+template <typename Key, size_t PageSize>
+const typename BPlusTree<Key, PageSize>::Node& BPlusTree<Key, PageSize>::fetch_node(f_ptr block_ptr, Node& scratch) {
+    if (!read_only) {
+        scratch = read_block(block_ptr);
+        return scratch;
+    }
+    // mesma validação do read_block, mais o limite do mapeamento
+    if (!valid_block_ptr(block_ptr) || static_cast<size_t>(block_ptr) + sizeof(Node) > mapped_file.size()) {
+        LOG_ERROR("(READ B+ " << index_path << ") ERRO FATAL: Tentativa de ler bloco em offset invalido: " << block_ptr);
+        throw std::runtime_error("Offset de leitura invalido.");
+    }
+    return *reinterpret_cast<const Node*>(mapped_file.data() + block_ptr);
+}
+
+template <typename Key, size_t PageSize>
+void BPlusTree<Key, PageSize>::prefetch_nodes(const std::vector<f_ptr>& block_ptrs) {
+    if (read_only) {
+        for (f_ptr block_ptr : block_ptrs) {
+            if (valid_block_ptr(block_ptr)) mapped_file.advise_range(block_ptr, sizeof(Node), MADV_WILLNEED);
+        }
+        return;
+    }
+    std::vector<f_ptr> missing;
+    for (f_ptr block_ptr : block_ptrs) {
+        if (valid_block_ptr(block_ptr) && !node_cache.contains(block_ptr)) missing.push_back(block_ptr);
+    }
+    if (missing.size() < 2) return; // um nó só vai pelo read_block normal
+    // no máximo metade do pool, senão o próprio lote tiraria os primeiros nós antes do uso
+    missing.resize(std::min(missing.size(), std::max<size_t>(2, node_cache.capacity_frames() / 2)));
+
+    AlignedArray<Node> nodes(missing.size());
+    std::vector<PageRequest> requests;
+    requests.reserve(missing.size());
+    for (size_t i = 0; i < missing.size(); ++i) {
+        requests.push_back({missing[i], reinterpret_cast<char*>(&nodes[i]), sizeof(Node)});
+    }
+    if (!index_file.read_batch(requests)) {
+        LOG_ERROR("(READ B+ " << index_path << ") ERRO FATAL: Falha ao ler um lote de " << missing.size() << " blocos do disco!");
+        throw std::runtime_error("Falha na leitura do bloco do indice.");
+    }
+    for (size_t i = 0; i < missing.size(); ++i) node_cache.load(missing[i], nodes[i]);
+}
+
+
+// retorna true se uma chave foi promovida, false caso contrário
+// promoted_key e new_child_ptr_out são passados para ser usados em caso de retorno de valores para a promoção
+// com chaves repetidas a entrada pode estar em qualquer filho entre o primeiro e o último que aceitam a chave
+template <typename Key, size_t PageSize>
+bool BPlusTree<Key, PageSize>::remove_internal(f_ptr node_ptr, Key key, f_ptr data_ptr, bool& underflow) {
+    Node node = read_block(node_ptr);
+
+    if (node.is_leaf) {
+        for (int i = node_lower_bound(node.keys, node.key_count, key); i < node.key_count && !(key < node.keys[i]); i++) {
+            if (node.children[i] != data_ptr) continue;
+            for (int j = i; j + 1 < node.key_count; j++) {
+                node.keys[j] = node.keys[j + 1];
+                node.children[j] = node.children[j + 1];
+            }
+            node.key_count--;
+            node.children[node.key_count] = -1;
+            write_block(node_ptr, node);
+            underflow = node.key_count < MIN_LEAF_KEYS;
+            return true;
+        }
+        return false;
+    }
+
+    int first = node_lower_bound(node.keys, node.key_count, key);
+    int last = node_upper_bound(node.keys, node.key_count, key);
+    for (int pos = first; pos <= last; pos++) {
+        bool child_underflow = false;
+        if (!remove_internal(node.children[pos], key, data_ptr, child_underflow)) continue;
+        if (child_underflow) {
+            rebalance_child(node, pos);
+            write_block(node_ptr, node);
+        }
+        underflow = node.key_count < MIN_INTERNAL_KEYS;
+        return true;
+    }
+    return false;
+}
+
+template <typename Key, size_t PageSize>
+void BPlusTree<Key, PageSize>::rebalance_child(Node& parent, int pos) {
+    f_ptr child_ptr = parent.children[pos];
+    Node child = read_block(child_ptr);
+    int min_keys = child.is_leaf ? MIN_LEAF_KEYS : MIN_INTERNAL_KEYS;
+
+    // empréstimo do irmão da esquerda: a última entrada dele vai para o começo do filho
+    if (pos > 0) {
+        f_ptr left_ptr = parent.children[pos - 1];
+        Node left = read_block(left_ptr);
+        if (left.key_count > min_keys) {
+            for (int i = child.key_count; i > 0; i--) child.keys[i] = child.keys[i - 1];
+            for (int i = child.key_count + (child.is_leaf ? 0 : 1); i > 0; i--) child.children[i] = child.children[i - 1];
+            if (child.is_leaf) {
+                child.keys[0] = left.keys[left.key_count - 1];
+                child.children[0] = left.children[left.key_count - 1];
+                left.children[left.key_count - 1] = -1;
+                parent.keys[pos - 1] = child.keys[0];
+            } else {
+                child.keys[0] = parent.keys[pos - 1];
+                child.children[0] = left.children[left.key_count];
+                left.children[left.key_count] = -1;
+                parent.keys[pos - 1] = left.keys[left.key_count - 1];
+            }
+            left.key_count--;
+            child.key_count++;
+            write_block(left_ptr, left);
+            write_block(child_ptr, child);
+            return;
+        }
+    }
+
+    // empréstimo do irmão da direita: a primeira entrada dele vai para o fim do filho
+    if (pos < parent.key_count) {
+        f_ptr right_ptr = parent.children[pos + 1];
+        Node right = read_block(right_ptr);
+        if (right.key_count > min_keys) {
+            if (child.is_leaf) {
+                child.keys[child.key_count] = right.keys[0];
+                child.children[child.key_count] = right.children[0];
+            } else {
+                child.keys[child.key_count] = parent.keys[pos];
+                child.children[child.key_count + 1] = right.children[0];
+                parent.keys[pos] = right.keys[0];
+            }
+            child.key_count++;
+            int right_children = right.key_count + (right.is_leaf ? 0 : 1);
+            for (int i = 0; i + 1 < right.key_count; i++) right.keys[i] = right.keys[i + 1];
+            for (int i = 0; i + 1 < right_children; i++) right.children[i] = right.children[i + 1];
+            right.children[right_children - 1] = -1;
+            right.key_count--;
+            if (child.is_leaf) parent.keys[pos] = right.keys[0];
+            write_block(right_ptr, right);
+            write_block(child_ptr, child);
+            return;
+        }
+    }
+
+    // nenhum irmão pode emprestar: o filho é fundido com um deles (o da direita entra no da esquerda)
+    int left_pos = pos > 0 ? pos - 1 : pos;
+    f_ptr left_ptr = parent.children[left_pos];
+    f_ptr right_ptr = parent.children[left_pos + 1];
+    Node left = left_pos == pos ? child : read_block(left_ptr);
+    Node right = left_pos == pos ? read_block(right_ptr) : child;
+    if (left.is_leaf) {
+        for (int i = 0; i < right.key_count; i++) {
+            left.keys[left.key_count + i] = right.keys[i];
+            left.children[left.key_count + i] = right.children[i];
+        }
+        left.key_count += right.key_count;
+        left.next_leaf = right.next_leaf;
+    } else {
+        left.keys[left.key_count] = parent.keys[left_pos];
+        for (int i = 0; i < right.key_count; i++) left.keys[left.key_count + 1 + i] = right.keys[i];
+        for (int i = 0; i <= right.key_count; i++) left.children[left.key_count + 1 + i] = right.children[i];
+        left.key_count += right.key_count + 1;
+    }
+    write_block(left_ptr, left);
+    free_block(right_ptr);
+
+    // o separador e o ponteiro do nó fundido saem do pai
+    for (int i = left_pos; i + 1 < parent.key_count; i++) parent.keys[i] = parent.keys[i + 1];
+    for (int i = left_pos + 1; i < parent.key_count; i++) parent.children[i] = parent.children[i + 1];
+    parent.children[parent.key_count] = -1;
+    parent.key_count--;
+}
+
+template <typename Key, size_t PageSize>
+bool BPlusTree<Key, PageSize>::insert_internal(f_ptr current_ptr, Key key, f_ptr data_ptr, Key& promoted_key_out, f_ptr& new_child_ptr_out) {
+
+    Node current_node = read_block(current_ptr);
+
+    if (current_node.is_leaf) { //casos base
+        if (current_node.key_count < ORDER - 1) { //podemos inserir aqui
+            insert_into_leaf(current_node, key, data_ptr);
+            write_block(current_ptr, current_node);
+            return false;
+        } else { //precisamos inserir mas temos que promover alguém
+            split_leaf(current_node, key, data_ptr, promoted_key_out, new_child_ptr_out);
+            write_block(current_ptr, current_node);
+            return true;
+        }
+    } else {
+        int child_index = node_upper_bound(current_node.keys, current_node.key_count, key); //achando o child que vamos descer
+
+        f_ptr child_ptr = current_node.children[child_index];
+
+        if (insert_internal(child_ptr, key, data_ptr, promoted_key_out, new_child_ptr_out)) {
+            if (current_node.key_count < ORDER - 1) {
+                insert_into_internal(current_node, child_index, promoted_key_out, new_child_ptr_out);
+                write_block(current_ptr, current_node);
+                return false;
+            } else {
+                split_internal(current_node, child_index, promoted_key_out, new_child_ptr_out);
+                write_block(current_ptr, current_node); //gravando lado esquerdo
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+template <typename Key, size_t PageSize>
+void BPlusTree<Key, PageSize>::insert_batch_node(f_ptr node_ptr, const std::pair<Key, f_ptr>* entries, size_t count,
+                                                 std::vector<std::pair<Key, f_ptr>>& promoted) {
+    Node node = read_block(node_ptr);
+
+    if (node.is_leaf) {
+        // intercala a folha com o trecho; as entradas novas ficam depois das iguais que já estavam nela
+        std::vector<std::pair<Key, f_ptr>> merged;
+        merged.reserve(node.key_count + count);
+        int i = 0;
+        size_t j = 0;
+        while (i < node.key_count || j < count) {
+            if (j == count || (i < node.key_count && !(entries[j].first < node.keys[i]))) {
+                merged.push_back({node.keys[i], node.children[i]});
+                i++;
+            } else {
+                merged.push_back(entries[j++]);
+            }
+        }
+        if (merged.size() <= static_cast<size_t>(ORDER - 1)) {
+            for (size_t k = 0; k < merged.size(); k++) {
+                node.keys[k] = merged[k].first;
+                node.children[k] = merged[k].second;
+            }
+            node.key_count = static_cast<int>(merged.size());
+            write_block(node_ptr, node);
+            return;
+        }
+        write_leaf_run(node_ptr, node.next_leaf, merged, promoted);
+        return;
+    }
+
+    // cada filho recebe as chaves que o insert mandaria para ele (upper_bound); os que se dividem devolvem os
+    // irmãos novos, que entram logo à direita deles
+    std::vector<Key> keys;
+    std::vector<f_ptr> children;
+    size_t first = 0;
+    for (int i = 0; i <= node.key_count; i++) {
+        size_t end = count;
+        if (i < node.key_count) {
+            Key separator = node.keys[i];
+            end = static_cast<size_t>(std::lower_bound(entries + first, entries + count, separator,
+                                                       [](const std::pair<Key, f_ptr>& entry, const Key& key) { return entry.first < key; }) - entries);
+        }
+        children.push_back(node.children[i]);
+        if (end > first) {
+            std::vector<std::pair<Key, f_ptr>> siblings;
+            insert_batch_node(node.children[i], entries + first, end - first, siblings);
+            for (const auto& sibling : siblings) {
+                keys.push_back(sibling.first);
+                children.push_back(sibling.second);
+            }
+        }
+        if (i < node.key_count) keys.push_back(node.keys[i]);
+        first = end;
+    }
+    if (children.size() == static_cast<size_t>(node.key_count) + 1) return; // nenhum filho se dividiu
+    write_internal_run(node_ptr, keys, children, promoted);
+}
+
+template <typename Key, size_t PageSize>
+void BPlusTree<Key, PageSize>::write_leaf_run(f_ptr leaf_ptr, f_ptr next_leaf, const std::vector<std::pair<Key, f_ptr>>& entries,
+                                              std::vector<std::pair<Key, f_ptr>>& promoted) {
+    // o menor número de folhas que comporta as entradas, com a sobra distribuída (todas ficam acima do mínimo)
+    size_t pieces = (entries.size() + ORDER - 2) / (ORDER - 1);
+    std::vector<f_ptr> ptrs{leaf_ptr};
+    for (size_t p = 1; p < pieces; p++) ptrs.push_back(allocate_new_block());
+    size_t first = 0;
+    for (size_t p = 0; p < pieces; p++) {
+        size_t size = entries.size() / pieces + (p < entries.size() % pieces ? 1 : 0);
+        Node leaf;
+        leaf.is_leaf = true;
+        leaf.key_count = static_cast<int>(size);
+        for (size_t k = 0; k < size; k++) {
+            leaf.keys[k] = entries[first + k].first;
+            leaf.children[k] = entries[first + k].second;
+        }
+        leaf.next_leaf = (p + 1 < pieces) ? ptrs[p + 1] : next_leaf;
+        write_block(ptrs[p], leaf);
+        if (p > 0) promoted.push_back({entries[first].first, ptrs[p]});
+        first += size;
+    }
+}
+
+template <typename Key, size_t PageSize>
+void BPlusTree<Key, PageSize>::write_internal_run(f_ptr node_ptr, const std::vector<Key>& keys, const std::vector<f_ptr>& children,
+                                                  std::vector<std::pair<Key, f_ptr>>& promoted) {
+    size_t pieces = (children.size() + ORDER - 1) / ORDER;
+    std::vector<f_ptr> ptrs{node_ptr};
+    for (size_t p = 1; p < pieces; p++) ptrs.push_back(allocate_new_block());
+    size_t first = 0;
+    for (size_t p = 0; p < pieces; p++) {
+        size_t size = children.size() / pieces + (p < children.size() % pieces ? 1 : 0);
+        Node node;
+        node.is_leaf = false;
+        node.key_count = static_cast<int>(size) - 1;
+        for (size_t k = 0; k < size; k++) node.children[k] = children[first + k];
+        for (size_t k = 0; k + 1 < size; k++) node.keys[k] = keys[first + k];
+        write_block(ptrs[p], node);
+        if (p > 0) promoted.push_back({keys[first - 1], ptrs[p]}); // a chave entre o nó anterior e este
+        first += size;
+    }
+}
+
+template <typename Key, size_t PageSize>
+void BPlusTree<Key, PageSize>::insert_into_leaf(Node& leaf, Key key, f_ptr data_ptr) {
+    int pos = node_lower_bound(leaf.keys, leaf.key_count, key); //descobre aonde vamos enfiar
+
+    for (int i = leaf.key_count; i > pos; --i) { //move todo mundo pra direita (abrindo espaço)
+        leaf.keys[i] = leaf.keys[i-1];
+        leaf.children[i] = leaf.children[i-1];
+    }
+
+    leaf.keys[pos] = key;
+    leaf.children[pos] = data_ptr;
+    leaf.key_count++;
+}
+
+template <typename Key, size_t PageSize>
+void BPlusTree<Key, PageSize>::split_leaf(Node& leaf, Key key, f_ptr data_ptr, Key& promoted_key_out, f_ptr& new_leaf_ptr_out) {
+    std::vector<std::pair<Key, f_ptr>> temp_vet_pairs;
+    temp_vet_pairs.reserve(ORDER);
+    for (int i = 0; i < leaf.key_count; i++) {
+        temp_vet_pairs.push_back({leaf.keys[i], leaf.children[i]});
+    }
+    temp_vet_pairs.push_back({key, data_ptr});
+    std::sort(temp_vet_pairs.begin(), temp_vet_pairs.end(),[](auto &a, auto &b){ return a.first < b.first; });
+
+    Node new_leaf;
+    new_leaf.is_leaf = true;
+    new_leaf_ptr_out = allocate_new_block();
+
+    int split_point = (int)temp_vet_pairs.size() / 2;
+    // preenche leaf
+    leaf.key_count = 0;
+    for (int i = 0; i < split_point; ++i) {
+        leaf.keys[leaf.key_count] = temp_vet_pairs[i].first;
+        leaf.children[leaf.key_count] = temp_vet_pairs[i].second;
+        ++leaf.key_count;
+    }
+    // preenche new_leaf
+    new_leaf.key_count = 0;
+    for (int i = split_point; i < (int)temp_vet_pairs.size(); ++i) {
+        new_leaf.keys[new_leaf.key_count] = temp_vet_pairs[i].first;
+        new_leaf.children[new_leaf.key_count] = temp_vet_pairs[i].second;
+        ++new_leaf.key_count;
+    }
+
+    new_leaf.next_leaf = leaf.next_leaf;
+    leaf.next_leaf = new_leaf_ptr_out;
+
+    promoted_key_out = new_leaf.keys[0];
+
+    //função que chamou já vai gravar a leaf antiga
+    write_block(new_leaf_ptr_out, new_leaf);
+}
+
+
+template <typename Key, size_t PageSize>
+void BPlusTree<Key, PageSize>::insert_into_internal(Node& node, int pos, Key key, f_ptr child_ptr) {
+    for (int i = node.key_count; i > pos; --i) { //logica mudou em relação a insert_into_leaf pois os childrens dos Nodes devem ser inseridos depois das chaves
+        node.keys[i] = node.keys[i-1];
+        node.children[i+1] = node.children[i];
+    }
+
+    node.keys[pos] = key;
+    node.children[pos+1] = child_ptr;
+    node.key_count++;
+}
+
+template <typename Key, size_t PageSize>
+void BPlusTree<Key, PageSize>::split_internal(Node& node, int pos, Key& promoted_key, f_ptr& child_ptr) {
+    // copiando temporariamente as chaves e ponteiros do nó atual
+    std::vector<Key> temp_vet_keys(node.keys, node.keys + node.key_count);
+    std::vector<f_ptr> temp_vet_children(node.children, node.children + node.key_count + 1);
+
+    // inserindo a nova chave e o novo filho na posição adequada
+    temp_vet_keys.insert(temp_vet_keys.begin() + pos, promoted_key);
+    temp_vet_children.insert(temp_vet_children.begin() + pos + 1, child_ptr); // filho sempre à direita da key
+
+
+    int split_point = ORDER / 2;
+
+    // a chave do meio é promovida para o nível superior
+    promoted_key = temp_vet_keys[split_point];
+
+    // criando o novo node
+    Node new_internal_node;
+    new_internal_node.is_leaf = false;
+    child_ptr = allocate_new_block();
+
+    // ajeirando os dois nodes
+    node.key_count = split_point;
+    std::copy(temp_vet_keys.begin(), temp_vet_keys.begin() + split_point, node.keys);
+    std::copy(temp_vet_children.begin(), temp_vet_children.begin() + split_point + 1, node.children);
+
+    new_internal_node.key_count = static_cast<int>(temp_vet_keys.size()) - split_point - 1;
+    std::copy(temp_vet_keys.begin() + split_point + 1, temp_vet_keys.end(), new_internal_node.keys);
+    std::copy(temp_vet_children.begin() + split_point + 1, temp_vet_children.end(), new_internal_node.children);
+
+    // a função que chamou já vai gravar o primeiro bloco
+    write_block(child_ptr, new_internal_node);
+}
+
+
+template <typename Key, size_t PageSize>
+typename BPlusTree<Key, PageSize>::Node BPlusTree<Key, PageSize>::read_block(f_ptr block_ptr) {
+     // validação básica do ponteiro
+     if (!valid_block_ptr(block_ptr)) {
+        LOG_ERROR("(READ B+ " << index_path << ") ERRO FATAL: Tentativa de ler bloco em offset invalido: " << block_ptr);
+        throw std::runtime_error("Offset de leitura invalido.");
+     }
+
+    const Node* cached = node_cache.lookup(block_ptr);
+    if (cached != nullptr) { return *cached; }
+
+    alignas(PAGE_IO_ALIGNMENT) Node node; // alinhado para o O_DIRECT ler direto nele
+    if (!index_file.read(block_ptr, &node, sizeof(Node))) {
+        LOG_ERROR("(READ B+ " << index_path << ") ERRO FATAL: Falha ao ler o bloco " << block_ptr << " do disco!");
+        throw std::runtime_error("Falha na leitura do bloco do indice.");
+    }
+
+    node_cache.load(block_ptr, node); // se o pool estiver cheio o CLOCK escolhe quem sai
+    return node;
+}
+
+template <typename Key, size_t PageSize>
+void BPlusTree<Key, PageSize>::flush_cache() {
+    if (!index_file.is_open()) {return; }
+    node_cache.flush_all(); // só os nós sujos vão para o disco (num lote só), o pool continua aquecido
+}
+
+template <typename Key, size_t PageSize>
+void BPlusTree<Key, PageSize>::write_block(f_ptr block_ptr, const Node& node) {
+     // validação básica do ponteiro
+    if (!valid_block_ptr(block_ptr)) {
+        LOG_ERROR("ERRO FATAL: Tentativa de escrever bloco em offset invalido: " << block_ptr);
+        throw std::runtime_error("Offset de escrita invalido.");
+    }
+
+    node_cache.put(block_ptr, node); // marca como sujo, vai para o disco no flush ou quando for substituído
+}
+
+template <typename Key, size_t PageSize>
+f_ptr BPlusTree<Key, PageSize>::allocate_new_block() {
+    if (free_list != 0) {
+        // reaproveita um nó liberado por uma remoção
+        f_ptr reused_ptr = free_list;
+        free_list = read_block(reused_ptr).next_leaf;
+        write_block(reused_ptr, Node());
+        return reused_ptr;
+    }
+    // as escritas vão direto para o arquivo (pwrite), então o tamanho dele já está atualizado
+    f_ptr current_end = index_file.size(); // onde o arquivo termina ATUALMENTE
+
+    // calculando onde o NOVO bloco DEVE começar
+    f_ptr new_block_ptr;
+    if (block_count == 0) { // situação de inicialização, embora o construtor deva cuidar disso
+         new_block_ptr = DATA_START_OFFSET;
+    } else {
+
+        // o novo bloco começa no final atual, mas garantimos que está alinhado
+        new_block_ptr = DATA_START_OFFSET + block_count * sizeof(Node);
+        // se o cálculo acima for diferente do final real, pode indicar corrupção
+         if (new_block_ptr < current_end) {
+            LOG_WARN("AVISO (" << index_path << "): allocate_new_block detectou tamanho de arquivo inesperado. current_end=" << current_end << ", new_block_ptr_calc=" << new_block_ptr);
+            new_block_ptr = current_end;
+            // realinhar se necessário (garante que não escrevamos em um offset "quebrado")
+            if ((new_block_ptr - DATA_START_OFFSET) % sizeof(Node) != 0) {
+                new_block_ptr = DATA_START_OFFSET + ((new_block_ptr - DATA_START_OFFSET + sizeof(Node) - 1) / sizeof(Node)) * sizeof(Node);
+            }
+         }
+    }
+
+
+    alignas(PAGE_IO_ALIGNMENT) Node empty_node;
+    // escreve DIRETAMENTE no disco para estender o arquivo
+    if (!index_file.write(new_block_ptr, &empty_node, sizeof(Node))) {
+        LOG_ERROR("ERRO FATAL: Falha ao alocar novo bloco " << new_block_ptr << " no disco!");
+        throw std::runtime_error("Falha ao estender o arquivo de indice.");
+    }
+
+    // adiciona o nó vazio ao cache
+    node_cache.load(new_block_ptr, empty_node);
+
+    block_count++; // incrementa o contador APÓS alocar com sucesso
+    return new_block_ptr;
+}
+
+template <typename Key, size_t PageSize>
+void BPlusTree<Key, PageSize>::free_block(f_ptr block_ptr) {
+    Node free_node; // nó vazio, fora da árvore, só com o próximo da lista
+    free_node.next_leaf = free_list;
+    write_block(block_ptr, free_node);
+    free_list = block_ptr;
+}
+
+// grava os nós sujos que saem do pool (ou no flush) num lote só
+template <typename Key, size_t PageSize>
+void BPlusTree<Key, PageSize>::write_blocks_to_disk(const std::vector<std::pair<f_ptr, const Node*>>& nodes) {
+    std::vector<PageRequest> requests;
+    requests.reserve(nodes.size());
+    for (const auto& entry : nodes) {
+        requests.push_back({entry.first, reinterpret_cast<char*>(const_cast<Node*>(entry.second)), sizeof(Node)});
+    }
+    if (!index_file.write_batch(requests)) {
+        LOG_ERROR("ERRO FATAL: Falha ao gravar um lote de " << nodes.size() << " blocos do indice " << index_path << "!");
+        throw std::runtime_error("Falha na escrita do bloco do indice.");
+    }
+}
+
+// grava nós vizinhos direto no disco, sem passar pelo cache (usado pela carga em lote)
+template <typename Key, size_t PageSize>
+void BPlusTree<Key, PageSize>::write_run_to_disk(f_ptr first_ptr, const Node* nodes, size_t count) {
+    if (!index_file.write(first_ptr, nodes, count * sizeof(Node))) {
+        LOG_ERROR("ERRO FATAL: Falha ao gravar o bloco " << first_ptr << " do indice " << index_path << "!");
+        throw std::runtime_error("Falha na escrita do bloco do indice.");
+    }
+}
+
+// as duas árvores usadas pelos programas são instanciadas uma única vez em src/BPlusTree.cpp
+extern template class BPlusTree<int>;
+extern template class BPlusTree<long long>;
+
+#endif // BPLUSTREE_HPP
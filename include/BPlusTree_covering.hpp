@@ -0,0 +1,31 @@
+#ifndef BPlusTree_covering_HPP
+#define BPlusTree_covering_HPP
+
+#include <cstdint>
+
+#include "BPlusTree.hpp"
+#include "record.hpp"
+
+// Índice primário de cobertura (primary_covering.idx, opcional no upload): a mesma árvore do índice primário,
+// mas cada chave leva junto o Ano e as Citacoes do artigo. As comparações usam só o ID, então a árvore se
+// comporta como o índice primário; nas folhas os dois atributos respondem às consultas sem ler o arquivo de dados
+// (nos nós internos os atributos dos separadores não são usados)
+struct CoveringKey {
+    int32_t id;
+    int32_t ano;
+    int32_t citacoes;
+};
+
+inline bool operator<(const CoveringKey& a, const CoveringKey& b) { return a.id < b.id; }
+inline bool operator==(const CoveringKey& a, const CoveringKey& b) { return a.id == b.id; }
+
+// chave de busca (os atributos não entram na comparação)
+inline CoveringKey covering_key(int id) { return {id, 0, 0}; }
+inline CoveringKey covering_key(const Artigo& artigo) { return {artigo.ID, artigo.Ano, artigo.Citacoes}; }
+
+using BPlusTree_covering = BPlusTree<CoveringKey>;
+
+// instanciada uma única vez em src/BPlusTree.cpp, como as outras árvores
+extern template class BPlusTree<CoveringKey>;
+
+#endif // BPlusTree_covering_HPP
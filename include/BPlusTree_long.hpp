@@ -2,102 +2,50 @@
 #define BPlusTree_long_HPP
 
 #include <string>
-#include <vector>
-#include <fstream>
-#include <unordered_map>
-
-//sizeof(is_leaf) + sizeof(key_count) + sizeof(keys) + sizeof(children) + sizeof(next_leaf) <= 4096
-//1 + 4 + (8 * (m - 1)) + (8 * m) + 8 <= 4096
-//m <= 255.68
-const int ORDER_LONG = 255;
-
-// long para representar os ponteiros para outros blocos no arquivo
-using f_ptr = long; //-1 para nulo
-
-// layout dos metadados PERMANENTES do arquivo
-struct BPlusTree_long_Metadata {
-    f_ptr root_ptr_offset; // Offset do nó raiz atual
-    long block_count;      // Número total de blocos
-};
-
-// constante que define onde os blocos de nós começam
-const f_ptr DATA_START_OFFSET_LONG = sizeof(BPlusTree_long_Metadata);
-
-// layout de um unico nó da B+ tree
-struct BPlusTree_long_Node {
-    bool is_leaf;                 //flag para indicar se o nó é uma folha
-    int key_count;                //número de chaves atualmente no nó
-    long long keys[ORDER_LONG - 1];          //array para armazenar as chaves (ex: IDs dos artigos), precisa do hashing para mapear o id do artigo para a chave
-    f_ptr children[ORDER_LONG];        //array de ponteiros para os nós filhos
-    
-    f_ptr next_leaf; // ponteiro para o próximo nó folha
-    // (para nós folha, os ponteiros podem apontar para os registros no arquivo de dados ou para um próximo nó folha)
-
-    //construtor para inicializar um nó vazio
-    BPlusTree_long_Node() : is_leaf(false), key_count(0), next_leaf(-1) {
-        for (int i = 0; i < ORDER_LONG - 1; ++i) keys[i] = 0; // inicializa o array de chaves com zeros
-        for (int i = 0; i < ORDER_LONG; ++i) children[i] = -1; // inicializa o array de filhos com ponteiros nulos
+#include <functional>
+#include <cstdint>
+
+#include "BPlusTree.hpp"
+
+// índice secundário: a mesma árvore com chaves long long (hash do título)
+using BPlusTree_long = BPlusTree<long long>;
+
+// função para transformar o titulo em long long usando o hash
+inline long long hash_string_to_long(const char* str) {
+    std::hash<std::string> hasher;
+    return static_cast<long long>(hasher(str));
+}
+
+// Lista de postagens: títulos iguais (ou com o mesmo hash) ficam como chaves repetidas, lado a lado nas folhas
+// Cada postagem guarda no valor o ponteiro do registro (47 bits) e uma impressão digital de 16 bits do título,
+// independente do hash da chave; só as postagens com a impressão certa precisam ser lidas no arquivo de dados
+// Impressão 0 = índice antigo sem impressão (a postagem sempre é lida e verificada)
+constexpr int TITLE_POSTING_PTR_BITS = 47;
+constexpr f_ptr TITLE_POSTING_PTR_MASK = (f_ptr(1) << TITLE_POSTING_PTR_BITS) - 1;
+
+// FNV-1a de 32 bits dobrado em 16 bits, nunca 0
+inline uint16_t title_fingerprint(const char* str) {
+    uint32_t h = 2166136261u;
+    for (const unsigned char* p = reinterpret_cast<const unsigned char*>(str); *p != '\0'; ++p) {
+        h = (h ^ *p) * 16777619u;
     }
-};
-
-// gerencia o arquivo de índice e as operações de alto nível
-class BPlusTree_long {
-public:
-    // abre/cria o arquivo de índice
-    BPlusTree_long(const std::string& index_file_path);
-    
-    // fecha o arquivo "~" 
-    ~BPlusTree_long();
-
-    // função principal para inserir uma chave e o ponteiro para o registro de dados
-    void insert(long long key, f_ptr data_ptr);
-
-    // função principal para buscar uma chave, retornando o ponteiro para o registro de dados e o numero de blocos lidos
-    f_ptr search(long long key, int& blocks_read);
-
-    // função para transformar o titulo em long long usando o hash
-    static long long hash_string_to_long(const char* str);
-
-    long get_total_blocks();
+    uint16_t folded = static_cast<uint16_t>(h ^ (h >> 16));
+    return folded == 0 ? 1 : folded;
+}
 
-private:
-
-    std::unordered_map<f_ptr, BPlusTree_long_Node> node_cache; //estabelecendo o cache
-    static const int MAX_CACHE_SIZE = 2000; //para compensar pela menor quantidade de itens por node
-
-    std::fstream index_file;    // gerencia conexão para ler e escrever no arquivo de índice
-    f_ptr root_ptr;             // ponteiro para o nó raiz no arquivo
-    long block_count;           // contador total de blocos no arquivo
-
-    // lê um bloco do arquivo de índice e o carrega em uma struct de nó
-    BPlusTree_long_Node read_block(f_ptr block_ptr);
-
-    // escreve os dados do cache de volta
-    void flush_cache();
-
-    // escreve o conteúdo de uma struct de nó em um bloco específico do arquivo
-    void write_block(f_ptr block_ptr, const BPlusTree_long_Node& node);
-    
-    // aloca um novo bloco no final do arquivo e retorna seu ponteiro
-    f_ptr allocate_new_block();
-
-    // função auxiliar de insert_internal para inserir em uma folha 
-    void insert_into_leaf(BPlusTree_long_Node& leaf, long long key, f_ptr data_ptr);
-
-    // função auxiliar de insert_internal para separar uma folha
-    void split_leaf(BPlusTree_long_Node& leaf, long long key, f_ptr data_ptr, long long& promoted_key_out, f_ptr& new_leaf_ptr_out);
-
-    //função axuiliar de insert_internal para inserir um valor
-    void insert_into_internal(BPlusTree_long_Node& node, long long key, f_ptr child_ptr);
-
-    // função auxiliar de insert_internal para separar um nó interno
-    void split_internal(BPlusTree_long_Node& node, long long& key_in_out, f_ptr& child_in_out);
+inline f_ptr make_title_posting(f_ptr data_ptr, uint16_t fingerprint) {
+    if (data_ptr < 0 || data_ptr > TITLE_POSTING_PTR_MASK) {
+        throw std::runtime_error("ERRO: ponteiro de dados grande demais para o índice secundário.");
+    }
+    return data_ptr | (static_cast<f_ptr>(fingerprint) << TITLE_POSTING_PTR_BITS);
+}
 
-    // função auxiliar recursiva para a inserção
-    bool insert_internal(f_ptr current_ptr, long long key, f_ptr data_ptr, long long& promoted_key_out, f_ptr& new_child_ptr_out);
+inline f_ptr title_posting_ptr(f_ptr posting) { return posting & TITLE_POSTING_PTR_MASK; }
 
-    // função para lidar com a divisão de um nó que está cheio
-    void split_node(f_ptr parent_ptr, int child_index, f_ptr child_ptr);
-};
+// a postagem pode ser do título com essa impressão? (postagens sem impressão sempre podem)
+inline bool title_posting_matches(f_ptr posting, uint16_t fingerprint) {
+    uint16_t stored = static_cast<uint16_t>(posting >> TITLE_POSTING_PTR_BITS);
+    return stored == 0 || stored == fingerprint;
+}
 
-#endif // BPlusTree_long_HPP
\ No newline at end of file
+#endif // BPlusTree_long_HPP
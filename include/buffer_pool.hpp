@@ -0,0 +1,246 @@
+#ifndef BUFFER_POOL_HPP
+#define BUFFER_POOL_HPP
+
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <stdexcept>
+
+#include "log.hpp"
+#include "page_io.hpp"
+
+using f_ptr = long; // Endereço dentro de um arquivo
+
+// Contadores do buffer pool
+struct BufferPoolStats {
+    long hits = 0;        // páginas encontradas no pool
+    long misses = 0;      // páginas que tiveram que vir do disco
+    long evictions = 0;   // frames reaproveitados pela política de substituição
+    long writebacks = 0;  // páginas sujas gravadas de volta no disco
+
+    double hit_rate() const {
+        long total = hits + misses;
+        return total == 0 ? 0.0 : static_cast<double>(hits) / total;
+    }
+};
+
+// Lê a capacidade (em bytes) de um buffer pool a partir de uma variável de ambiente
+// Aceita sufixos K, M e G (ex: 64M). Sem a variável usa default_bytes
+inline size_t cache_bytes_from_env(const char* name, size_t default_bytes) {
+    const char* env = std::getenv(name);
+    if (env == nullptr) return default_bytes;
+    char* end_ptr = nullptr;
+    double value = std::strtod(env, &end_ptr);
+    if (end_ptr == env || value <= 0) {
+        LOG_WARN(name << " invalido ('" << env << "'). Usando o padrao de " << default_bytes << " bytes");
+        return default_bytes;
+    }
+    switch (*end_ptr) {
+        case 'k': case 'K': value *= 1024.0; break;
+        case 'm': case 'M': value *= 1024.0 * 1024.0; break;
+        case 'g': case 'G': value *= 1024.0 * 1024.0 * 1024.0; break;
+        default: break;
+    }
+    return static_cast<size_t>(value);
+}
+
+// Buffer pool de páginas de tamanho fixo com substituição CLOCK (segunda chance)
+// Cada frame tem um bit de referência (setado a cada acesso) e um bit de sujo:
+// só as páginas modificadas são gravadas de volta quando saem do pool ou no flush.
+// As páginas ficam numa área alinhada a PAGE_IO_ALIGNMENT (com páginas de 4 KiB cada frame pode ser
+// lido e gravado com O_DIRECT sem cópia) e os dados de controle de cada frame ficam à parte
+template <typename Page>
+class BufferPool {
+public:
+    // grava no disco um lote de páginas sujas (endereço, página), já em ordem de endereço
+    using WriteBack = std::function<void(const std::vector<std::pair<f_ptr, const Page*>>&)>;
+
+    // capacity_bytes: memória máxima dos frames, write_back: grava as páginas sujas no disco
+    // writeback_batch: quando a vítima está suja, grava junto até esse número de páginas sujas (em ordem de endereço)
+    BufferPool(size_t capacity_bytes, WriteBack write_back, size_t writeback_batch = 1)
+        : capacity(std::max<size_t>(MIN_FRAMES, capacity_bytes / sizeof(Page))), write_back(std::move(write_back)),
+          writeback_batch(std::max<size_t>(1, writeback_batch)) {}
+
+    // procura a página no pool, retorna nullptr se ela não estiver carregada
+    const Page* lookup(f_ptr page_ptr) {
+        auto it = page_table.find(page_ptr);
+        if (it == page_table.end()) {
+            stats.misses++;
+            return nullptr;
+        }
+        stats.hits++;
+        frames[it->second].referenced = true;
+        return &page_at(it->second);
+    }
+
+    // a página está no pool? (sem contar acerto ou falta)
+    bool contains(f_ptr page_ptr) const {
+        return page_table.count(page_ptr) != 0;
+    }
+
+    // coloca uma página lida do disco (limpa) no pool
+    void load(f_ptr page_ptr, const Page& page) {
+        store(page_ptr, page, false);
+    }
+
+    // atualiza (ou insere) a página e marca como suja
+    void put(f_ptr page_ptr, const Page& page) {
+        store(page_ptr, page, true);
+    }
+
+    // páginas sujas em ordem de endereço, sem gravar nem limpar (o log de escrita antecipada copia as imagens)
+    std::vector<std::pair<f_ptr, const Page*>> dirty_pages() {
+        std::vector<size_t> dirty_frames = collect_dirty();
+        std::vector<std::pair<f_ptr, const Page*>> batch;
+        batch.reserve(dirty_frames.size());
+        for (size_t i : dirty_frames) batch.push_back({frames[i].page_ptr, &page_at(i)});
+        return batch;
+    }
+
+    // sem roubo (no-steal): páginas sujas não saem do pool, só vão para o disco no flush
+    // (com o log de escrita antecipada o arquivo só recebe páginas cujo grupo já está no log)
+    void set_hold_dirty(bool hold) { hold_dirty = hold; }
+    size_t dirty_count() const { return dirty; }
+
+    // grava todas as páginas sujas em ordem de endereço (escrita mais sequencial) e mantém tudo no pool
+    void flush_all() {
+        std::vector<size_t> dirty_frames = collect_dirty();
+        write_frames(dirty_frames);
+    }
+
+    // descarta todas as páginas sem gravar nada (usado quando o arquivo é reescrito por fora do pool)
+    void clear() {
+        destroy_pages();
+        page_table.clear();
+        hand = 0;
+        dirty = 0;
+    }
+
+    size_t size() const { return page_table.size(); }
+    size_t capacity_frames() const { return capacity; }
+    const BufferPoolStats& get_stats() const { return stats; }
+
+    ~BufferPool() { destroy_pages(); }
+
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+private:
+    static constexpr size_t MIN_FRAMES = 16; // precisa caber pelo menos um caminho raiz-folha e os splits
+
+    struct Frame {
+        f_ptr page_ptr = -1;
+        bool in_use = false;
+        bool dirty = false;
+        bool referenced = false;
+    };
+
+    size_t capacity;
+    WriteBack write_back;
+    size_t writeback_batch;
+    std::vector<Frame> frames; // cresce sob demanda até a capacidade
+    AlignedBuffer pages;       // página do frame i em pages.data() + i * sizeof(Page)
+    std::unordered_map<f_ptr, size_t> page_table; // endereço da página -> frame
+    size_t hand = 0;           // ponteiro do relógio
+    size_t dirty = 0;          // frames sujos
+    bool hold_dirty = false;   // sem roubo: a vítima do CLOCK nunca é uma página suja
+    BufferPoolStats stats;
+
+    void store(f_ptr page_ptr, const Page& page, bool is_dirty) {
+        auto it = page_table.find(page_ptr);
+        if (it != page_table.end()) {
+            Frame& frame = frames[it->second];
+            page_at(it->second) = page;
+            if (is_dirty && !frame.dirty) this->dirty++;
+            frame.dirty = frame.dirty || is_dirty;
+            frame.referenced = true;
+            return;
+        }
+        size_t index = free_frame();
+        Frame& frame = frames[index];
+        page_at(index) = page;
+        frame.page_ptr = page_ptr;
+        frame.in_use = true;
+        frame.dirty = is_dirty;
+        if (is_dirty) dirty++;
+        frame.referenced = true;
+        page_table[page_ptr] = index;
+    }
+
+    // grava a vítima junto com outras páginas sujas que provavelmente sairão em breve (sem referência recente)
+    // as outras continuam no pool, só ficam limpas
+    void write_back_batch(size_t victim) {
+        std::vector<size_t> batch{victim};
+        for (size_t i = 0; i < frames.size() && batch.size() < writeback_batch; ++i) {
+            if (i != victim && frames[i].in_use && frames[i].dirty && !frames[i].referenced) batch.push_back(i);
+        }
+        write_frames(batch);
+    }
+
+    // entrega os frames sujos ao write_back num lote só, em ordem de endereço, e marca como limpos
+    void write_frames(std::vector<size_t>& dirty_frames) {
+        if (dirty_frames.empty()) return;
+        std::sort(dirty_frames.begin(), dirty_frames.end(),
+                  [this](size_t a, size_t b) { return frames[a].page_ptr < frames[b].page_ptr; });
+        std::vector<std::pair<f_ptr, const Page*>> batch;
+        batch.reserve(dirty_frames.size());
+        for (size_t i : dirty_frames) batch.push_back({frames[i].page_ptr, &page_at(i)});
+        write_back(batch);
+        for (size_t i : dirty_frames) frames[i].dirty = false;
+        dirty -= dirty_frames.size();
+        stats.writebacks += static_cast<long>(dirty_frames.size());
+    }
+
+    std::vector<size_t> collect_dirty() const {
+        std::vector<size_t> dirty_frames;
+        for (size_t i = 0; i < frames.size(); ++i) {
+            if (frames[i].in_use && frames[i].dirty) dirty_frames.push_back(i);
+        }
+        return dirty_frames;
+    }
+
+    Page& page_at(size_t index) { return reinterpret_cast<Page*>(pages.data())[index]; }
+
+    void destroy_pages() {
+        for (size_t i = 0; i < frames.size(); ++i) page_at(i).~Page();
+        frames.clear();
+    }
+
+    // devolve um frame livre, escolhendo uma vítima pelo CLOCK quando o pool está cheio
+    size_t free_frame() {
+        if (frames.size() < capacity) {
+            if (frames.empty()) {
+                // reserva só o endereço, as páginas são criadas (e a memória tocada) aos poucos
+                frames.reserve(capacity);
+                pages.reserve(capacity * sizeof(Page));
+            }
+            new (pages.data() + frames.size() * sizeof(Page)) Page();
+            frames.emplace_back();
+            return frames.size() - 1;
+        }
+        // duas voltas do relógio bastam: na primeira os bits de referência são zerados
+        for (size_t steps = 0; steps < 2 * frames.size() + 1; ++steps) {
+            Frame& frame = frames[hand];
+            size_t current = hand;
+            hand = (hand + 1) % frames.size();
+            if (frame.referenced) {
+                frame.referenced = false; // segunda chance
+                continue;
+            }
+            if (frame.dirty && hold_dirty) continue;
+            if (frame.dirty) write_back_batch(current);
+            page_table.erase(frame.page_ptr);
+            frame.in_use = false;
+            frame.dirty = false;
+            stats.evictions++;
+            return current;
+        }
+        LOG_ERROR("[BUFFER POOL] Todas as " << frames.size() << " paginas estao sujas e presas ate o proximo commit");
+        throw std::runtime_error("ERRO: buffer pool sem páginas limpas (aumente o cache)");
+    }
+};
+
+#endif // BUFFER_POOL_HPP
@@ -0,0 +1,117 @@
+#ifndef COLUMN_STORE_HPP
+#define COLUMN_STORE_HPP
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+
+#include "record.hpp"
+#include "data_page.hpp"
+#include "mmap_file.hpp"
+
+// Colunas numéricas do arquivo de dados (columns.dat, opcional no upload com --columns)
+// Página 0: ColumnFileHeader. Depois cada coluna é um array contíguo que começa numa página própria:
+//   id, ano, citacoes (int32), atualizacao (int64, o timestamp) e data_ptr (int64, o f_ptr do registro)
+// A linha i de todas as colunas é o mesmo artigo; as linhas seguem a ordem da varredura do arquivo de dados
+// no upload. Os filtros numéricos leem só as colunas (4 ou 8 bytes por artigo) e o registro só é lido
+// para as linhas que passaram. Cada coluna tem uma folga depois da última linha (até o offset da seguinte, ou
+// o fim do arquivo na última) para as linhas das cargas incrementais
+
+const uint32_t COLUMN_FILE_MAGIC = 0x534C4F43; // "COLS"
+const uint32_t COLUMN_FILE_VERSION = 1;
+
+struct ColumnFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    int64_t row_count;
+    int64_t id_offset;          // offset de cada coluna no arquivo (múltiplo de PAGE_SIZE)
+    int64_t ano_offset;
+    int64_t citacoes_offset;
+    int64_t atualizacao_offset;
+    int64_t data_ptr_offset;
+};
+
+// Monta as colunas em memória durante o upload e grava o arquivo no finish
+class ColumnWriter {
+public:
+    explicit ColumnWriter(const std::string& path) : path(path) {}
+
+    void add(const Artigo& artigo, f_ptr data_ptr);
+    void finish();
+
+    long row_count() const { return static_cast<long>(ids.size()); }
+
+private:
+    std::string path;
+    std::vector<int32_t> ids;
+    std::vector<int32_t> anos;
+    std::vector<int32_t> citacoes;
+    std::vector<int64_t> atualizacoes;
+    std::vector<int64_t> data_ptrs;
+};
+
+// Atualiza columns.dat no lugar na carga incremental: a linha de um ID que já existe é regravada, a de um ID
+// apagado recebe a última linha, e as linhas novas vão para a folga das colunas. Só as linhas que mudaram são
+// gravadas; sem folga para as novas, o arquivo inteiro é regravado com folga nova
+class ColumnUpdater {
+public:
+    explicit ColumnUpdater(const std::string& path);
+
+    void put(const Artigo& artigo, f_ptr data_ptr); // linha nova ou nova versão da linha do ID
+    void remove(int id);
+    void finish();
+
+    long row_count() const { return static_cast<long>(ids.size()); }
+
+private:
+    std::string path;
+    ColumnFileHeader header{};
+    size_t capacity = 0;       // linhas que cabem em todas as colunas sem regravar o arquivo
+    std::vector<int32_t> ids;
+    std::vector<int32_t> anos;
+    std::vector<int32_t> citacoes;
+    std::vector<int64_t> atualizacoes;
+    std::vector<int64_t> data_ptrs;
+    std::unordered_map<int, size_t> rows; // ID -> linha
+    std::vector<size_t> dirty_rows;
+
+    void set_row(size_t row, const Artigo& artigo, f_ptr data_ptr);
+};
+
+// Leitura das colunas (somente leitura, arquivo mapeado em memória)
+class ColumnStore {
+public:
+    explicit ColumnStore(const std::string& path);
+
+    long row_count() const { return static_cast<long>(header.row_count); }
+    const int32_t* ids() const { return column<int32_t>(header.id_offset); }
+    const int32_t* anos() const { return column<int32_t>(header.ano_offset); }
+    const int32_t* citacoes() const { return column<int32_t>(header.citacoes_offset); }
+    const int64_t* atualizacoes() const { return column<int64_t>(header.atualizacao_offset); }
+    const int64_t* data_ptrs() const { return column<int64_t>(header.data_ptr_offset); }
+
+private:
+    MappedFile file;
+    ColumnFileHeader header{};
+
+    template <typename T>
+    const T* column(int64_t offset) const { return reinterpret_cast<const T*>(file.data() + offset); }
+};
+
+// Seleção de linhas: 1 bit por linha, 64 linhas por palavra (os bits depois da última linha ficam zerados)
+std::vector<uint64_t> column_select_all(size_t rows);
+
+// Filtros por faixa inclusiva [lo, hi]: zeram na seleção as linhas com o valor fora da faixa
+// O kernel (escalar ou AVX2) é escolhido na inicialização pelas instruções da CPU; COLUMN_KERNEL força um deles
+void column_filter_i32(const int32_t* values, size_t rows, int64_t lo, int64_t hi, uint64_t* selection);
+void column_filter_i64(const int64_t* values, size_t rows, int64_t lo, int64_t hi, uint64_t* selection);
+
+// nome do kernel em uso ("scalar" ou "avx2")
+const char* column_kernel_name();
+
+// troca o kernel em uso ("scalar" ou "avx2"; usado pelos testes), retorna false se não for suportado
+bool set_column_kernel(const std::string& name);
+
+#endif // COLUMN_STORE_HPP
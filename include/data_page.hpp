@@ -0,0 +1,152 @@
+#ifndef DATA_PAGE_HPP
+#define DATA_PAGE_HPP
+
+#include <cstdint>
+#include <cstddef>
+
+#include "record.hpp"
+
+using f_ptr = long; // Endereço dentro de um arquivo
+
+// Tamanho da página do arquivo de dados, igual à página do sistema operacional
+const size_t PAGE_SIZE = 4096;
+
+// Formato em disco do arquivo de dados
+// versão 1: DataBlock com 2 Artigos de tamanho fixo, versão 2: páginas com slots e quantidade fixa de blocos,
+// versão 3: hashing linear (buckets com páginas de overflow, o arquivo cresce junto com os dados)
+const uint32_t DATA_FILE_MAGIC = 0x44325054; // "TP2D"
+const uint32_t DATA_FILE_FORMAT_VERSION = 3;
+
+// Cabeçalho do arquivo de dados, ocupa a página 0 inteira (as páginas de dados começam na 1)
+// Quantidade de buckets = initial_buckets * 2^level + next_split
+struct DataFileHeader {
+    uint32_t magic;           // DATA_FILE_MAGIC
+    uint32_t format_version;  // DATA_FILE_FORMAT_VERSION
+    uint32_t page_size;       // PAGE_SIZE de quem criou o arquivo
+    uint32_t initial_buckets; // buckets na criação do arquivo
+    uint32_t level;           // quantas vezes a quantidade de buckets já dobrou
+    uint32_t reserved;
+    int64_t next_split;       // próximo bucket a ser dividido nesta rodada
+    int64_t total_pages;      // páginas de dados em uso (primárias, overflow e livres)
+    int64_t free_page;        // início da lista de páginas livres (0 = vazia)
+    int64_t used_bytes;       // bytes ocupados pelos registros e slots (controla o fator de carga)
+    int64_t record_count;     // registros no arquivo
+};
+
+// Tipo de cada página de dados
+enum PageKind : uint16_t {
+    PAGE_UNUSED = 0,   // página ainda não usada (buraco do arquivo esparso)
+    PAGE_PRIMARY = 1,  // primeira página de um bucket
+    PAGE_OVERFLOW = 2, // continuação de um bucket
+    PAGE_FREE = 3      // devolvida por um split, fica na lista de páginas livres
+};
+
+// Cabeçalho de cada página
+struct PageHeader {
+    uint16_t slot_count; // entradas no diretório de slots
+    uint16_t free_end;   // onde começa a área de registros (0 = página vazia, como vem de um buraco do arquivo esparso)
+    uint32_t next_page;  // próxima página do bucket (ou da lista de livres), 0 = fim
+    uint32_t bucket;     // bucket dono da página
+    uint16_t kind;       // PageKind
+    uint16_t dead_bytes; // bytes de registros apagados ou substituídos, recuperados quando a página é compactada
+};
+
+// Entrada do diretório de slots
+// Um registro apagado vira uma lápide (length 0): o slot continua no diretório, então o endereço
+// dos outros registros da página não muda, e é reaproveitado pela próxima inserção na página
+struct SlotEntry {
+    uint16_t offset; // posição do registro dentro da página
+    uint16_t length; // tamanho do registro codificado (0 = lápide)
+};
+
+// Registro codificado: ID(4) + Ano(4) + Citacoes(4) + Atualizacao(8) + tamanho de cada texto(2 * 3)
+// seguido dos textos sem '\0' e sem padding
+const size_t RECORD_FIXED_SIZE = 26;
+
+// Codifica o artigo no formato acima (dest precisa de DataBlock::encoded_size bytes), retorna o tamanho gravado
+size_t encode_record(const Artigo& artigo, unsigned char* dest);
+
+// Decodifica um registro de 'length' bytes, retorna false se o tamanho não bater com o conteúdo
+bool decode_record(const unsigned char* src, size_t length, Artigo& out);
+
+// Registro visto direto na página, sem decodificar: os números já convertidos e os textos apontando para
+// os bytes da página (sem '\0', com o tamanho ao lado). Só vale enquanto a página estiver na memória
+struct RecordView {
+    int32_t id;
+    int32_t ano;
+    int32_t citacoes;
+    int64_t atualizacao;
+    const char* titulo;
+    const char* autores;
+    const char* snippet;
+    uint16_t titulo_len;
+    uint16_t autores_len;
+    uint16_t snippet_len;
+};
+
+// Espaço livre de uma página sem nenhum registro
+const size_t EMPTY_PAGE_FREE_SPACE = PAGE_SIZE - sizeof(PageHeader);
+
+// Página com diretório de slots:
+// | cabeçalho | slot 0 | slot 1 | ... -> espaço livre <- ... | registro 1 | registro 0 |
+// O diretório cresce para frente e os registros crescem do fim da página para trás
+struct alignas(8) DataBlock {
+    PageHeader header;
+    unsigned char body[PAGE_SIZE - sizeof(PageHeader)];
+
+    DataBlock(); // Página vazia
+    DataBlock(PageKind kind, uint32_t bucket); // Página vazia já marcada com o tipo e o bucket dono
+
+    // Slots do diretório (incluindo as lápides)
+    int record_count() const { return header.slot_count; }
+
+    // Bytes livres para uma inserção: o espaço entre o diretório e os registros mais o dos registros apagados
+    size_t free_space() const;
+
+    // Insere o artigo (numa lápide, se houver) e retorna o slot, ou -1 se não couber
+    int insert(const Artigo& artigo);
+
+    // Apaga o registro do slot deixando uma lápide, false se o slot não tiver registro
+    bool erase(int slot);
+
+    // Troca o registro do slot pela nova versão do artigo, sem mudar o slot (o endereço continua o mesmo)
+    // Uma versão maior vai para o espaço livre, compactando a página se preciso; false se não couber
+    bool replace(int slot, const Artigo& artigo);
+
+    // Bytes do registro do slot (0 se o slot não existir)
+    size_t record_size(int slot) const;
+
+    // Decodifica o registro do slot, retorna false se o slot não existir
+    bool read(int slot, Artigo& out) const;
+
+    // ID do registro do slot sem decodificar os textos (-1 numa lápide)
+    int record_id(int slot) const;
+
+    // Registro do slot sem copiar os textos, retorna false se o slot não existir
+    bool view(int slot, RecordView& out) const;
+
+    // Bytes que o artigo ocupa no registro e na página (registro + entrada no diretório)
+    static size_t encoded_size(const Artigo& artigo);
+    static size_t space_needed(const Artigo& artigo) { return encoded_size(artigo) + sizeof(SlotEntry); }
+
+    // Espaço livre calculado só pelo cabeçalho (usado para reconstruir o mapa de ocupação)
+    static size_t free_space(const PageHeader& header);
+    // Só o trecho contíguo entre o diretório e os registros
+    static size_t contiguous_space(const PageHeader& header);
+
+private:
+    const unsigned char* page_bytes() const { return reinterpret_cast<const unsigned char*>(this); }
+    unsigned char* page_bytes() { return reinterpret_cast<unsigned char*>(this); }
+    SlotEntry slot_entry(int slot) const;
+    void set_slot_entry(int slot, const SlotEntry& entry);
+    void compact(int skip_slot); // junta os registros no fim da página, descartando o do slot skip_slot (-1 = nenhum)
+};
+
+static_assert(sizeof(DataBlock) == PAGE_SIZE, "DataBlock precisa ocupar exatamente uma página");
+
+// O f_ptr de um registro é o offset da página somado ao número do slot (slot < PAGE_SIZE)
+inline f_ptr make_record_ptr(long page_number, int slot) { return page_number * static_cast<long>(PAGE_SIZE) + slot; }
+inline long record_page(f_ptr record_ptr) { return record_ptr / static_cast<long>(PAGE_SIZE); }
+inline int record_slot(f_ptr record_ptr) { return static_cast<int>(record_ptr % static_cast<long>(PAGE_SIZE)); }
+
+#endif // DATA_PAGE_HPP
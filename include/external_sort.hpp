@@ -0,0 +1,189 @@
+#ifndef EXTERNAL_SORT_HPP
+#define EXTERNAL_SORT_HPP
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <queue>
+#include <memory>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdio>
+#include <cstdint>
+#include <type_traits>
+
+#include "log.hpp"
+
+using f_ptr = long; // Endereço dentro de um arquivo
+
+// Ordenação externa de pares (chave, ponteiro) usada na carga em lote das árvores B+
+// Os pares ficam num buffer em memória até atingir o orçamento, aí o buffer é ordenado e despejado
+// em um arquivo temporário (run). No final as runs são intercaladas (k-way merge) em ordem crescente
+// Key pode ser um tipo de tamanho fixo (gravado como está) ou std::string (gravada com o tamanho na frente)
+template <typename Key>
+class ExternalSorter {
+public:
+    using Entry = std::pair<Key, f_ptr>;
+
+    // spill_dir: diretório dos arquivos temporários, name: prefixo dos arquivos, memory_budget: bytes do buffer
+    ExternalSorter(const std::string& spill_dir, const std::string& name, size_t memory_budget)
+        : spill_prefix(spill_dir + "/" + name), memory_budget(memory_budget) {
+        buffer.reserve(std::min<size_t>(std::max<size_t>(MIN_BUFFER_ENTRIES, memory_budget / sizeof(Entry)), 1 << 20));
+    }
+
+    // apaga as runs que ainda estiverem no disco
+    ~ExternalSorter() {
+        runs.clear();
+        for (const std::string& path : run_paths) std::remove(path.c_str());
+    }
+
+    ExternalSorter(const ExternalSorter&) = delete;
+    ExternalSorter& operator=(const ExternalSorter&) = delete;
+
+    // adiciona um par (fora de ordem) ao conjunto
+    void add(Key key, f_ptr ptr) {
+        if (finished) throw std::runtime_error("ExternalSorter: add depois de finish");
+        buffer_bytes += entry_bytes(key);
+        buffer.push_back({std::move(key), ptr});
+        total++;
+        if (buffer_bytes >= memory_budget && buffer.size() >= MIN_BUFFER_ENTRIES) spill();
+    }
+
+    // termina a fase de inserção e prepara a leitura ordenada
+    void finish() {
+        if (finished) return;
+        finished = true;
+        std::sort(buffer.begin(), buffer.end());
+        if (run_paths.empty()) return; // tudo coube na memória, lemos direto do buffer
+
+        if (!buffer.empty()) spill(); // o resto também vira uma run para o merge ficar uniforme
+        buffer.clear();
+        buffer.shrink_to_fit();
+
+        for (size_t i = 0; i < run_paths.size(); ++i) {
+            auto run = std::make_unique<RunReader>();
+            run->file.open(run_paths[i], std::ios::in | std::ios::binary);
+            if (!run->file) {
+                LOG_ERROR("[SORT] Falha ao reabrir a run " << run_paths[i]);
+                throw std::runtime_error("ERRO: não foi possível reabrir arquivo temporário da ordenação");
+            }
+            runs.push_back(std::move(run));
+            Entry first;
+            if (read_from_run(i, first)) heap.push({first, i});
+        }
+        LOG_DEBUG("[SORT] Intercalando " << run_paths.size() << " runs de " << spill_prefix);
+    }
+
+    // próximo par em ordem crescente, retorna false quando acabou
+    bool next(Entry& out) {
+        if (!finished) finish();
+        if (runs.empty()) {
+            if (buffer_pos >= buffer.size()) return false;
+            out = buffer[buffer_pos++];
+            return true;
+        }
+        if (heap.empty()) return false;
+        HeapItem top = heap.top();
+        heap.pop();
+        out = top.entry;
+        Entry following;
+        if (read_from_run(top.run, following)) heap.push({following, top.run});
+        return true;
+    }
+
+    // quantidade total de pares adicionados
+    long size() const { return total; }
+
+    // quantidade de runs despejadas no disco
+    size_t spilled_runs() const { return run_paths.size(); }
+
+private:
+    static constexpr size_t READ_CHUNK = 4096; // pares lidos de uma vez de cada run durante o merge
+    static constexpr size_t MIN_BUFFER_ENTRIES = 1024; // uma run tem pelo menos isso de pares
+    static constexpr bool FIXED_SIZE = std::is_trivially_copyable<Key>::value;
+
+    struct RunReader {
+        std::ifstream file;
+        std::vector<Entry> chunk;
+        size_t pos = 0;
+    };
+
+    struct HeapItem {
+        Entry entry;
+        size_t run;
+        // priority_queue é de máximo, então invertemos a comparação
+        bool operator<(const HeapItem& other) const { return other.entry < entry; }
+    };
+
+    std::string spill_prefix;
+    size_t memory_budget;
+    size_t buffer_bytes = 0; // memória ocupada pelos pares do buffer
+    std::vector<Entry> buffer;
+    size_t buffer_pos = 0;
+    long total = 0;
+    bool finished = false;
+
+    std::vector<std::string> run_paths;
+    std::vector<std::unique_ptr<RunReader>> runs;
+    std::priority_queue<HeapItem> heap;
+
+    // ordena o buffer e grava como uma nova run
+    void spill() {
+        std::sort(buffer.begin(), buffer.end());
+        std::string path = spill_prefix + ".run" + std::to_string(run_paths.size()) + ".tmp";
+        std::ofstream out(path, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!out || !write_entries(out)) {
+            LOG_ERROR("[SORT] Falha ao gravar a run " << path);
+            throw std::runtime_error("ERRO: não foi possível gravar arquivo temporário da ordenação");
+        }
+        run_paths.push_back(path);
+        LOG_DEBUG("[SORT] Run " << path << " gravada com " << buffer.size() << " pares");
+        buffer.clear();
+        buffer_bytes = 0;
+    }
+
+    // memória usada por um par no buffer (as strings contam o texto também)
+    static size_t entry_bytes(const Key& key) {
+        if constexpr (FIXED_SIZE) return sizeof(Entry);
+        else return sizeof(Entry) + key.size();
+    }
+
+    // grava o buffer ordenado numa run: tipos fixos de uma vez só, strings como (tamanho, texto, ponteiro)
+    bool write_entries(std::ofstream& out) {
+        if constexpr (FIXED_SIZE) {
+            return static_cast<bool>(out.write(reinterpret_cast<const char*>(buffer.data()), buffer.size() * sizeof(Entry)));
+        } else {
+            for (const Entry& entry : buffer) {
+                uint32_t length = static_cast<uint32_t>(entry.first.size());
+                out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+                out.write(entry.first.data(), length);
+                out.write(reinterpret_cast<const char*>(&entry.second), sizeof(entry.second));
+            }
+            return static_cast<bool>(out);
+        }
+    }
+
+    // lê o próximo par de uma run, recarregando o pedaço em memória quando necessário
+    bool read_from_run(size_t index, Entry& out) {
+        RunReader& run = *runs[index];
+        if constexpr (!FIXED_SIZE) { // strings: o ifstream já lê em blocos
+            uint32_t length;
+            if (!run.file.read(reinterpret_cast<char*>(&length), sizeof(length))) return false;
+            out.first.resize(length);
+            run.file.read(&out.first[0], length);
+            run.file.read(reinterpret_cast<char*>(&out.second), sizeof(out.second));
+            return static_cast<bool>(run.file);
+        }
+        if (run.pos >= run.chunk.size()) {
+            run.chunk.resize(READ_CHUNK);
+            run.file.read(reinterpret_cast<char*>(run.chunk.data()), READ_CHUNK * sizeof(Entry));
+            run.chunk.resize(static_cast<size_t>(run.file.gcount()) / sizeof(Entry));
+            run.pos = 0;
+            if (run.chunk.empty()) return false;
+        }
+        out = run.chunk[run.pos++];
+        return true;
+    }
+};
+
+#endif // EXTERNAL_SORT_HPP
@@ -2,29 +2,52 @@
 #define HASHING_HPP
 
 #include "record.hpp" // Inclui a definição de artigo
-#include <string> 
-#include <fstream>  // Biblioteca para manipular arquivos de disco
+#include <string>
 #include <unordered_map>
+#include <vector>
+#include <cstdint>
+#include <functional>
+#include <chrono>
+
+#include "mmap_file.hpp"
+#include "page_io.hpp"
+#include "buffer_pool.hpp"
+#include "wal.hpp"
+
+#include "data_page.hpp" // Página com diretório de slots (DataBlock) e formato do arquivo
+
+// Cabeçalho do sidecar com os metadados dos buckets (<arquivo de dados>.occ)
+// Depois do cabeçalho vem um uint32_t por bucket com a página primária do bucket,
+// um uint32_t por página com a próxima página do bucket e um uint16_t por página com os bytes livres
+struct OccupancyHeader {
+    uint32_t magic;       // OCCUPANCY_MAGIC
+    uint32_t clean;       // 1 se foi gravado no fechamento normal, 0 enquanto o arquivo está aberto para escrita
+    int64_t total_pages;  // tem que bater com o cabeçalho do arquivo de dados
+    int64_t bucket_count; // idem
+};
+const uint32_t OCCUPANCY_MAGIC = 0x3343434F; // "OCC3"
 
-using f_ptr = long; // Endereço dentro de um arquivo
-
-//id(4) + titulo(301) + ano(4) + autores(151) + citacoes(4) + atualização(20) + snippet(1025) ≃ 1509 bytes
-// 1059*N + record_count(4) = 4096
-//N <= 2.71
-const int RECORDS_PER_BLOCK = 2;
-
-struct DataBlock {
-    Artigo records[RECORDS_PER_BLOCK]; // Lista para guardar os registros de artigos
-    int record_count; // Quantos registros estão ocupando o bloco
-    DataBlock() : record_count(0) {} // Construtor que começa a struct com 0 artigos
+// Resultado de uma leitura em lote (read_records)
+struct BatchReadStats {
+    long records = 0; // registros entregues
+    long pages = 0;   // páginas distintas lidas
+    long runs = 0;    // trechos de páginas vizinhas (cada um vira uma única leitura antecipada no modo mmap)
 };
 
 // Classe que vai gerenciar todo o hashing
+// Hashing linear: quando o fator de carga passa de MAX_LOAD_FACTOR o bucket next_split é dividido em dois,
+// então o arquivo cresce um bucket por vez junto com os dados. Cada bucket é uma lista de páginas
+// (a primária e as de overflow), e a busca lê só as páginas do bucket da chave
 class HashingFile {
 public:
 
-    // Construtor: prepara o arquivo para o uso 
-    HashingFile(const std::string& data_file_path, long num_total_blocks); 
+    // Chamado para cada registro que mudou de endereço num split (os índices guardam o f_ptr antigo)
+    using RelocationListener = std::function<void(const Artigo& artigo, f_ptr old_ptr, f_ptr new_ptr)>;
+
+    // Construtor: prepara o arquivo para o uso
+    // Um arquivo novo começa com INITIAL_BUCKETS buckets, um arquivo existente usa os dados do próprio cabeçalho
+    // Em READ_ONLY o arquivo precisa existir e é mapeado em memória
+    explicit HashingFile(const std::string& data_file_path, OpenMode mode = OpenMode::READ_WRITE);
 
     // Destrutor: fecha o arquivo quando o objeto é destruido
     ~HashingFile();
@@ -32,26 +55,130 @@ public:
     // Inserção: insere novo artigo no arquivo
     f_ptr insert(const Artigo& new_artigo);
 
+    // Atualização: troca o registro de mesmo ID pela nova versão dentro da própria página, sem mudar o endereço
+    // (os índices continuam válidos). Retorna o endereço, ou -1 se o ID não existir ou a nova versão não couber na página
+    f_ptr update_in_place(const Artigo& artigo);
+
+    // Atualização geral: no lugar quando cabe, senão a versão antiga é apagada e a nova inserida (pode mudar de página)
+    // old_ptr recebe o endereço antigo; retorna o novo endereço, ou -1 se o ID não existir
+    f_ptr update(const Artigo& artigo, f_ptr& old_ptr);
+
+    // Remoção pelo ID: o slot vira uma lápide e o espaço volta para a página (as páginas do bucket continuam na lista)
+    // removed recebe o registro apagado; retorna o endereço que ele ocupava, ou -1 se o ID não existir
+    f_ptr remove(int id, Artigo& removed);
+
     // Busca pelo ID: retorna o artigo encontrado pelo ID e quantos blocos foram lidos
     // Se não encontrar o artigo retorna um artigo com ID -1
     Artigo find_by_id(int id, int& blocks_read);
 
-private:
+    // Lê o registro que está no endereço f_ptr (retornado pelo insert e guardado nos índices)
+    // Retorna false se o endereço não apontar para um registro
+    bool read_record(f_ptr record_ptr, Artigo& out);
+
+    // Lê vários registros de uma vez, em ordem crescente de offset: cada página é lida uma vez só e
+    // páginas vizinhas são pedidas juntas ao kernel. Ponteiros repetidos são visitados uma vez
+    BatchReadStats read_records(std::vector<f_ptr> record_ptrs, const std::function<void(f_ptr, const Artigo&)>& visit);
+
+    // Percorre todos os registros, bucket por bucket, com o endereço atual de cada um
+    void for_each_record(const std::function<void(const Artigo&, f_ptr)>& visit);
 
-    std::unordered_map<long, DataBlock> block_cache; // Bloco_número -> bloco em memória
-    const size_t CACHE_LIMIT = 10000; // Maior que os outros por conta das colisões constantes
-    std::fstream data_file; // Gerencia a conexão para ler e escrever
-    long total_blocks;  // Quantidade total de blocos atualmente 
+    // Percorre as páginas com registros de [first_page, end_page) em ordem física, sem seguir os buckets
+    // Só no modo somente leitura: várias threads podem varrer trechos diferentes ao mesmo tempo
+    void scan_pages(long first_page, long end_page, const std::function<void(long page, const DataBlock&)>& visit);
 
+    // Registra quem deve ser avisado quando um split mover registros
+    void set_relocation_listener(RelocationListener listener) { relocation_listener = std::move(listener); }
 
-    long hash_function(int key); // Transforma a key em um ID
+    // Quantidade total de blocos (páginas de dados) do arquivo
+    long get_total_blocks() const { return static_cast<long>(file_header.total_pages); }
 
-    DataBlock read_block(long block_number); // Lê um bloco do disco
+    // Quantidade atual de buckets do hashing linear
+    long get_bucket_count() const { return static_cast<long>(bucket_directory.size()); }
+
+    // Quantidade de registros no arquivo
+    long get_record_count() const { return static_cast<long>(file_header.record_count); }
+
+    // Contadores do cache de blocos (acertos, faltas, substituições e gravações)
+    const BufferPoolStats& get_cache_stats() const { return block_cache.get_stats(); }
+
+    // Contadores de E/S do arquivo no modo leitura e escrita (pedidos, lotes e submissões ao io_uring)
+    const PageIoStats& get_io_stats() const { return data_file.get_stats(); }
+
+    // Liga o arquivo ao log de escrita antecipada: os blocos sujos só vão para o arquivo nos commits,
+    // feitos no início de uma inserção quando o grupo fecha ou metade do cache está suja
+    void attach_wal(WriteAheadLog& wal_log);
+
+    // Grava no log os blocos sujos e o cabeçalho e, depois do fdatasync do log, no próprio arquivo
+    // (sem log equivale a um flush do cache)
+    void commit();
+
+    static constexpr uint32_t INITIAL_BUCKETS = 64;   // buckets de um arquivo novo
+    static constexpr double MAX_LOAD_FACTOR = 0.8;    // fração do espaço dos buckets ocupada antes de um split
+
+private:
+
+    // Cache write-back das páginas (chave = número da página), capacidade em bytes definida por DATA_CACHE_BYTES
+    BufferPool<DataBlock> block_cache;
+    static constexpr size_t CACHE_LIMIT = 10000; // Maior que os outros por conta das colisões constantes
+    static constexpr size_t WRITEBACK_BATCH = 64; // Blocos sujos gravados juntos quando um deles sai do cache
+    static constexpr long GROWTH_PAGES = 1024;    // O arquivo cresce (esparso) de tantas páginas por vez
+    static constexpr size_t READ_BATCH = 64;      // Páginas pedidas juntas nas leituras em lote
+    std::string data_file_path;
+    PageFile data_file; // Conexão de leitura e escrita (pread/pwrite, lotes pelo io_uring)
+    DataFileHeader file_header{}; // Cópia em memória da página 0 (gravada no flush e no fechamento)
+    long allocated_pages = 0; // Páginas de dados que o arquivo já comporta (pode ser mais que total_pages)
+    bool read_only = false; // true quando aberto em OpenMode::READ_ONLY
+    MappedFile mapped_file; // Mapeamento do arquivo no modo somente leitura
+    RelocationListener relocation_listener;
+
+    WriteAheadLog* wal = nullptr; // Log de escrita antecipada (opcional, ligado por attach_wal)
+    int wal_id = -1;
+    long pending_inserts = 0;     // Inserções desde o último commit
+    std::chrono::steady_clock::time_point last_commit;
+
+    // Metadados reconstruíveis a partir das páginas, persistidos no sidecar para não varrer o arquivo
+    std::string occupancy_path;              // Sidecar onde os metadados são persistidos
+    std::vector<uint32_t> bucket_directory;  // Página primária de cada bucket
+    std::vector<uint32_t> page_links;        // Próxima página de cada página (índice = página - 1)
+    std::vector<uint16_t> occupancy;         // Bytes livres de cada página (índice = página - 1)
+
+    bool load_occupancy();              // Carrega o sidecar, false se estiver ausente ou inconsistente
+    void rebuild_occupancy();           // Reconstrói os metadados lendo o cabeçalho de cada página
+    void save_occupancy(bool clean);    // Grava o sidecar
+
+    void commit_if_due();              // Commit entre duas operações quando o grupo do log fecha
+
+    long hash_function(int key) const; // Transforma a key no número do bucket
+    long expected_bucket_count() const; // Quantidade de buckets segundo o cabeçalho do arquivo
+
+    // A página N fica no offset N * PAGE_SIZE (a página 0 é o cabeçalho do arquivo)
+    static f_ptr page_offset(long page_number) { return page_number * static_cast<long>(PAGE_SIZE); }
+
+    void write_file_header();                       // Grava a página 0
+    void check_file_header(const DataFileHeader&);  // Valida o formato do arquivo
+
+    long allocate_page();               // Reaproveita uma página livre ou acrescenta uma no fim do arquivo
+    void free_page(long page_number);   // Coloca a página na lista de livres
+    void split_next_bucket();           // Divide o bucket next_split (um passo do hashing linear)
+    bool over_load_factor() const;      // Fator de carga passou do limite?
+
+    DataBlock read_block(long page_number); // Lê uma página do disco
+
+    // Traz para o cache, num lote só, as páginas da lista que ainda não estão nele (só no modo leitura e escrita)
+    void prefetch_blocks(const std::vector<long>& pages);
+
+    // Páginas do bucket, na ordem da lista (pelo mapa em memória, sem ler nenhuma)
+    std::vector<long> bucket_pages(long bucket) const;
+    // Retorna a página: no modo somente leitura aponta direto para o mapeamento, senão lê em 'scratch'
+    const DataBlock& fetch_block(long page_number, DataBlock& scratch);
 
     void flush_cache(); // Transfere as mudanças feitas no bloco cache para o bloco no disco
 
-    void write_block(long block_number, const DataBlock& block); // Escreve um bloco no disco
+    void write_block(long page_number, const DataBlock& block); // Atualiza uma página (vai para o disco no flush ou quando sair do cache)
+
+    // Escreve um lote de páginas direto no disco (as páginas sujas que saem do cache ou no flush)
+    void write_blocks_to_disk(const std::vector<std::pair<f_ptr, const DataBlock*>>& blocks);
 
 };
 
-#endif 
\ No newline at end of file
+#endif
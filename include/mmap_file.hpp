@@ -0,0 +1,45 @@
+#ifndef MMAP_FILE_HPP
+#define MMAP_FILE_HPP
+
+#include <string>
+#include <cstddef>
+#include <sys/mman.h> // constantes MADV_* usadas com advise
+
+// Modo de abertura dos arquivos do banco
+enum class OpenMode {
+    READ_WRITE, // leitura e escrita via fstream (usado pelo upload)
+    READ_ONLY   // somente leitura com o arquivo mapeado em memória (usado pelas buscas)
+};
+
+// Arquivo inteiro mapeado em memória somente para leitura
+// Depois que as páginas estão residentes, ler um bloco é só acessar um ponteiro (sem syscall e sem cópia)
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // abre e mapeia o arquivo, lança runtime_error se não existir ou estiver vazio
+    void open(const std::string& path);
+
+    // desfaz o mapeamento
+    void close();
+
+    bool is_open() const { return base != nullptr; }
+    const char* data() const { return base; }
+    size_t size() const { return length; }
+
+    // dica para o kernel sobre o padrão de acesso do arquivo inteiro (ex: MADV_RANDOM)
+    void advise(int advice);
+
+    // dica para um trecho do arquivo (o trecho é alinhado às páginas do sistema)
+    void advise_range(size_t offset, size_t range_length, int advice);
+
+private:
+    char* base = nullptr;
+    size_t length = 0;
+};
+
+#endif // MMAP_FILE_HPP
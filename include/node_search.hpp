@@ -0,0 +1,69 @@
+#ifndef NODE_SEARCH_HPP
+#define NODE_SEARCH_HPP
+
+// Busca da posição de uma chave dentro de um nó da B+ tree (chaves ordenadas)
+// As duas buscas contam quantas chaves satisfazem um predicado, o que vale porque as chaves estão ordenadas:
+//   node_lower_bound: quantidade de chaves < key  (posição de inserção / chave exata na folha)
+//   node_upper_bound: quantidade de chaves <= key (filho para descer num nó interno)
+// Para int e long long o kernel (busca linear, binária sem desvios, SSE4.2 ou AVX2) é escolhido uma vez,
+// na inicialização, pelas instruções que a CPU suporta. A variável NODE_SEARCH_KERNEL força um kernel
+
+enum class NodeSearchKernel {
+    LINEAR = 0, // busca linear (o laço original, referência)
+    BINARY = 1, // busca binária sem desvios (padrão fora do x86)
+    SSE4   = 2, // busca binária até uma janela pequena + comparação SSE4.2 e popcount
+    AVX2   = 3  // idem com vetores de 256 bits
+};
+
+// nome do kernel ("linear", "binary", "sse4", "avx2")
+const char* node_search_kernel_name(NodeSearchKernel kernel);
+
+// a CPU (e o compilador) suportam o kernel?
+bool node_search_kernel_supported(NodeSearchKernel kernel);
+
+// kernel em uso
+NodeSearchKernel node_search_kernel();
+
+// troca o kernel em uso (usado pelo benchmark), retorna false se não for suportado
+bool set_node_search_kernel(NodeSearchKernel kernel);
+
+namespace node_search_detail {
+
+// predicado contado por cada busca
+template <bool Upper, typename Key>
+inline bool key_before(Key k, Key key) { return Upper ? !(key < k) : k < key; }
+
+// busca binária sem desvios: o passo só decide o deslocamento da base (cmov), nunca o fluxo
+template <bool Upper, typename Key>
+inline int binary_count(const Key* keys, int n, Key key) {
+    if (n <= 0) return 0;
+    const Key* base = keys;
+    int len = n;
+    while (len > 1) {
+        int half = len / 2;
+        base += key_before<Upper>(base[half], key) ? half : 0;
+        len -= half;
+    }
+    return static_cast<int>(base - keys) + (key_before<Upper>(*base, key) ? 1 : 0);
+}
+
+// kernels ativos, trocados na inicialização de node_search.cpp (até lá a busca binária é usada)
+extern int (*lower_int)(const int*, int, int);
+extern int (*upper_int)(const int*, int, int);
+extern int (*lower_long)(const long long*, int, long long);
+extern int (*upper_long)(const long long*, int, long long);
+
+} // namespace node_search_detail
+
+// outros tipos de chave usam a busca binária sem desvios
+template <typename Key>
+inline int node_lower_bound(const Key* keys, int n, Key key) { return node_search_detail::binary_count<false>(keys, n, key); }
+template <typename Key>
+inline int node_upper_bound(const Key* keys, int n, Key key) { return node_search_detail::binary_count<true>(keys, n, key); }
+
+inline int node_lower_bound(const int* keys, int n, int key) { return node_search_detail::lower_int(keys, n, key); }
+inline int node_upper_bound(const int* keys, int n, int key) { return node_search_detail::upper_int(keys, n, key); }
+inline int node_lower_bound(const long long* keys, int n, long long key) { return node_search_detail::lower_long(keys, n, key); }
+inline int node_upper_bound(const long long* keys, int n, long long key) { return node_search_detail::upper_long(keys, n, key); }
+
+#endif // NODE_SEARCH_HPP
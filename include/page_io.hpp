@@ -0,0 +1,148 @@
+#ifndef PAGE_IO_HPP
+#define PAGE_IO_HPP
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <utility>
+
+// Alinhamento das páginas no modo O_DIRECT: endereço do buffer, offset e tamanho de cada pedido
+// (4 KiB cobre dispositivos com blocos lógicos de 512 bytes e de 4 KiB)
+constexpr size_t PAGE_IO_ALIGNMENT = 4096;
+
+// Memória alinhada a PAGE_IO_ALIGNMENT, reservada de uma vez (as páginas do sistema só são usadas quando tocadas)
+class AlignedBuffer {
+public:
+    AlignedBuffer() = default;
+    explicit AlignedBuffer(size_t bytes) { reserve(bytes); }
+    ~AlignedBuffer() { std::free(base); }
+
+    AlignedBuffer(const AlignedBuffer&) = delete;
+    AlignedBuffer& operator=(const AlignedBuffer&) = delete;
+    AlignedBuffer(AlignedBuffer&& other) noexcept : base(other.base), length(other.length) {
+        other.base = nullptr;
+        other.length = 0;
+    }
+
+    // garante pelo menos 'bytes' bytes (size() fica arredondado para o alinhamento); se precisar crescer o conteúdo anterior é descartado
+    void reserve(size_t bytes) {
+        if (bytes <= length) return;
+        size_t rounded = (bytes + PAGE_IO_ALIGNMENT - 1) / PAGE_IO_ALIGNMENT * PAGE_IO_ALIGNMENT;
+        void* memory = std::aligned_alloc(PAGE_IO_ALIGNMENT, rounded);
+        if (memory == nullptr) throw std::bad_alloc();
+        std::free(base);
+        base = static_cast<char*>(memory);
+        length = rounded;
+    }
+
+    char* data() const { return base; }
+    size_t size() const { return length; }
+
+private:
+    char* base = nullptr;
+    size_t length = 0;
+};
+
+// Array de objetos de página (DataBlock, nós da B+ tree) em memória alinhada: com páginas de 4 KiB
+// todo elemento fica alinhado e pode ir direto para um pedido O_DIRECT, sem cópia intermediária
+template <typename T>
+class AlignedArray {
+public:
+    explicit AlignedArray(size_t count) : buffer(count * sizeof(T)), count(count) {
+        for (size_t i = 0; i < count; ++i) new (buffer.data() + i * sizeof(T)) T();
+    }
+    ~AlignedArray() {
+        for (size_t i = 0; i < count; ++i) (*this)[i].~T();
+    }
+
+    AlignedArray(const AlignedArray&) = delete;
+    AlignedArray& operator=(const AlignedArray&) = delete;
+
+    T& operator[](size_t i) { return reinterpret_cast<T*>(buffer.data())[i]; }
+    const T& operator[](size_t i) const { return reinterpret_cast<const T*>(buffer.data())[i]; }
+    T* data() { return reinterpret_cast<T*>(buffer.data()); }
+    size_t size() const { return count; }
+
+private:
+    AlignedBuffer buffer;
+    size_t count;
+};
+
+// Um pedido de E/S de um trecho do arquivo (normalmente uma página inteira)
+struct PageRequest {
+    long offset;    // posição no arquivo
+    char* buffer;   // destino da leitura ou origem da escrita
+    size_t length;  // bytes
+};
+
+// Contadores de E/S de um arquivo
+struct PageIoStats {
+    long reads = 0;        // pedidos de leitura (isolados ou em lote)
+    long writes = 0;       // pedidos de escrita
+    long batches = 0;      // lotes (read_batch / write_batch) com mais de um pedido
+    long submissions = 0;  // chamadas io_uring_enter
+};
+
+class IoRing; // anel do io_uring, definido em page_io.cpp
+
+// Arquivo acessado por E/S posicional: cada pedido isolado é um pread/pwrite (sem seek e sem buffer do fstream)
+// e os lotes vão para o kernel de uma vez pelo io_uring, com até PAGE_IO_DEPTH pedidos em voo (padrão 64).
+// Sem io_uring (kernel antigo, syscall bloqueada ou PAGE_IO=sync) os lotes viram pread/pwrite em sequência.
+// Com direct o arquivo é aberto com O_DIRECT (sem o cache de páginas do kernel): pedidos alinhados vão direto,
+// os outros passam por um buffer alinhado (leitura do trecho alinhado que os contém e, na escrita, regravação dele).
+// Um PageFile não é thread-safe: cada arquivo aberto para escrita é usado por uma thread só
+class PageFile {
+public:
+    PageFile();
+    ~PageFile();
+
+    PageFile(const PageFile&) = delete;
+    PageFile& operator=(const PageFile&) = delete;
+
+    // abre para leitura e escrita; com create o arquivo é criado (ou truncado) vazio
+    // direct pede O_DIRECT (se o sistema de arquivos recusar, o arquivo abre com cache normal e um aviso)
+    // retorna false se não conseguiu abrir
+    bool open(const std::string& path, bool create = false, bool direct = false);
+    void close();
+    bool is_open() const { return fd >= 0; }
+    bool is_direct() const { return direct; }
+
+    // leitura/escrita de um trecho; false se não transferiu tudo (fim do arquivo ou erro)
+    bool read(long offset, void* buffer, size_t length);
+    bool write(long offset, const void* buffer, size_t length);
+
+    // vários pedidos de uma vez (em qualquer ordem); false se algum deles falhou
+    bool read_batch(const std::vector<PageRequest>& requests);
+    bool write_batch(const std::vector<PageRequest>& requests);
+
+    long size() const;             // tamanho atual do arquivo em bytes
+    bool resize(long new_size);    // ftruncate (cresce esparso)
+    bool sync();                   // fdatasync: o que já foi gravado chega ao disco
+
+    const PageIoStats& get_stats() const { return stats; }
+
+private:
+    int fd = -1;
+    bool direct = false;          // aberto com O_DIRECT
+    AlignedBuffer bounce;         // trecho alinhado dos pedidos desalinhados no modo O_DIRECT
+    std::unique_ptr<IoRing> ring; // criado no primeiro lote
+    bool ring_failed = false;     // o io_uring não pôde ser criado para este arquivo, os lotes ficam síncronos
+    PageIoStats stats;
+
+    bool run_batch(const std::vector<PageRequest>& requests, bool write);
+    bool transfer(const PageRequest& request, size_t done, bool write); // termina um pedido com pread/pwrite
+    bool transfer_unaligned(const PageRequest& request, bool write);   // O_DIRECT: pedido pelo buffer alinhado
+    bool aligned(const PageRequest& request) const;
+};
+
+// backend escolhido na inicialização ("io_uring" ou "sync") e a profundidade da fila dos lotes
+const char* page_io_backend();
+unsigned page_io_depth();
+
+// PAGE_IO_DIRECT=1: os arquivos abertos para leitura e escrita usam O_DIRECT e o cache do próprio banco é o único
+bool page_io_direct();
+
+#endif // PAGE_IO_HPP
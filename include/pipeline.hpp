@@ -0,0 +1,115 @@
+#ifndef PIPELINE_HPP
+#define PIPELINE_HPP
+
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <string>
+#include <chrono>
+#include <exception>
+
+// Fila limitada e thread-safe usada para ligar os estágios do pipeline de carga
+// push bloqueia quando a fila está cheia (segura o produtor mais rápido) e pop bloqueia quando está vazia
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity) : capacity(capacity) {}
+
+    // insere um item no final da fila, retorna false se a fila foi abortada
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(mtx);
+        not_full.wait(lock, [this] { return aborted || items.size() < capacity; });
+        if (aborted) return false;
+        items.push_back(std::move(item));
+        not_empty.notify_one();
+        return true;
+    }
+
+    // retira o primeiro item da fila, retorna false quando a fila foi fechada e já está vazia (ou foi abortada)
+    bool pop(T& out) {
+        std::unique_lock<std::mutex> lock(mtx);
+        not_empty.wait(lock, [this] { return aborted || closed || !items.empty(); });
+        if (aborted || items.empty()) return false;
+        out = std::move(items.front());
+        items.pop_front();
+        not_full.notify_one();
+        return true;
+    }
+
+    // fecha a fila: os consumidores ainda esvaziam o que sobrou e depois terminam
+    void close() {
+        std::lock_guard<std::mutex> lock(mtx);
+        closed = true;
+        not_empty.notify_all();
+    }
+
+    // aborta a fila: descarta os itens e acorda todo mundo (usado quando algum estágio falha)
+    void abort() {
+        std::lock_guard<std::mutex> lock(mtx);
+        aborted = true;
+        items.clear();
+        not_empty.notify_all();
+        not_full.notify_all();
+    }
+
+private:
+    std::mutex mtx;
+    std::condition_variable not_empty;
+    std::condition_variable not_full;
+    std::deque<T> items;
+    size_t capacity;
+    bool closed = false;
+    bool aborted = false;
+};
+
+// Métricas de um estágio do pipeline
+struct StageStats {
+    std::string name;    // nome do estágio (aparece no log)
+    long items = 0;      // quantidade de registros processados
+    double busy_ms = 0;  // tempo gasto trabalhando (sem contar a espera nas filas)
+    double wall_ms = 0;  // tempo entre o início e o fim do estágio
+
+    // soma as métricas de outra thread do mesmo estágio (usado pelos parsers)
+    void merge(const StageStats& other) {
+        items += other.items;
+        busy_ms += other.busy_ms;
+        if (other.wall_ms > wall_ms) wall_ms = other.wall_ms;
+    }
+};
+
+// Acumula em 'target' o tempo (ms) em que o objeto ficou vivo
+class BusyTimer {
+public:
+    explicit BusyTimer(double& target) : target(target), start(std::chrono::steady_clock::now()) {}
+    ~BusyTimer() {
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        target += elapsed.count();
+    }
+private:
+    double& target;
+    std::chrono::steady_clock::time_point start;
+};
+
+// Guarda o primeiro erro lançado por qualquer thread do pipeline para ser relançado na thread principal
+class PipelineError {
+public:
+    // registra o erro, retorna true se foi o primeiro (quem registrou deve abortar as filas)
+    bool set(std::exception_ptr error) {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (first_error) return false;
+        first_error = error;
+        return true;
+    }
+
+    // relança o erro guardado, se existir
+    void rethrow_if_set() {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (first_error) std::rethrow_exception(first_error);
+    }
+
+private:
+    std::mutex mtx;
+    std::exception_ptr first_error;
+};
+
+#endif // PIPELINE_HPP
@@ -0,0 +1,89 @@
+#ifndef QUERY_PROTOCOL_HPP
+#define QUERY_PROTOCOL_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "record.hpp"
+
+// Protocolo do dbserver (socket Unix, ordem de bytes da máquina, cliente e servidor rodam no mesmo host)
+// Cada mensagem é um quadro: uint32 com o tamanho do conteúdo seguido do conteúdo
+//   pedido:   uint8 operação | int32 ID (FIND_BY_ID_HASH e FIND_BY_ID_INDEX) ou bytes do título (FIND_BY_TITLE)
+//   resposta: uint8 status | int32 blocos lidos | int64 total de blocos
+//             | uint32 quantidade de registros e, para cada um, uint32 tamanho + registro codificado (só se FOUND)
+//             ou mensagem de erro (status ERROR)
+// As buscas por ID devolvem um registro; FIND_BY_TITLE devolve todos os registros cujo título confere
+// O registro usa a mesma codificação das páginas de dados (encode_record / decode_record)
+// Uma conexão pode mandar vários pedidos em sequência, cada um recebe uma resposta na mesma ordem
+
+enum class QueryOp : uint8_t {
+    FIND_BY_ID_HASH  = 1, // busca pelo ID direto no arquivo de dados (findrec)
+    FIND_BY_ID_INDEX = 2, // busca pelo ID no índice primário (seek1)
+    FIND_BY_TITLE    = 3  // busca pelo título no índice secundário (seek2)
+};
+
+enum class QueryStatus : uint8_t {
+    FOUND     = 0,
+    NOT_FOUND = 1,
+    ERROR     = 2
+};
+
+const uint32_t MAX_QUERY_FRAME = 64 * 1024;           // pedidos maiores são recusados pelo servidor
+const uint32_t MAX_RESPONSE_FRAME = 64 * 1024 * 1024; // respostas maiores são recusadas pelo cliente
+
+struct QueryRequest {
+    QueryOp op = QueryOp::FIND_BY_ID_HASH;
+    int id = 0;          // FIND_BY_ID_HASH e FIND_BY_ID_INDEX
+    std::string titulo;  // FIND_BY_TITLE (já truncado em 300 caracteres)
+};
+
+struct QueryResponse {
+    QueryStatus status = QueryStatus::NOT_FOUND;
+    int blocks_read = 0;     // blocos lidos no arquivo consultado (dados ou índice)
+    long total_blocks = 0;   // total de blocos desse arquivo
+    std::vector<Artigo> artigos; // preenchido quando status == FOUND (títulos repetidos trazem vários)
+    std::string error;       // preenchido quando status == ERROR
+};
+
+// conteúdo dos quadros
+std::vector<unsigned char> encode_request(const QueryRequest& request);
+bool decode_request(const std::vector<unsigned char>& frame, QueryRequest& out);
+std::vector<unsigned char> encode_response(const QueryResponse& response);
+bool decode_response(const std::vector<unsigned char>& frame, QueryResponse& out);
+
+// envia/recebe um quadro inteiro (repete as chamadas até completar)
+// recv_frame retorna false no fim da conexão ou em quadro inválido (maior que max_length), send_frame retorna false
+// se a conexão caiu
+bool send_frame(int fd, const std::vector<unsigned char>& payload);
+bool recv_frame(int fd, std::vector<unsigned char>& payload, uint32_t max_length = MAX_QUERY_FRAME);
+
+// caminho do socket: DBSERVER_SOCKET se estiver definida, senão <DATA_DIR>/dbserver.sock
+std::string default_socket_path(const std::string& data_dir);
+
+// Cliente do dbserver, usado pelos programas de busca quando DBSERVER_SOCKET está definida
+class QueryClient {
+public:
+    QueryClient() = default;
+    ~QueryClient();
+
+    QueryClient(const QueryClient&) = delete;
+    QueryClient& operator=(const QueryClient&) = delete;
+
+    // conecta ao servidor, retorna false se não houver servidor escutando no caminho
+    bool connect(const std::string& socket_path);
+
+    // envia o pedido e espera a resposta, lança runtime_error se a conexão cair
+    QueryResponse query(const QueryRequest& request);
+
+    void close();
+
+private:
+    int fd = -1;
+};
+
+// se DBSERVER_SOCKET estiver definida, manda o pedido para o servidor e retorna true com a resposta em 'out'
+// retorna false (e os programas fazem a busca local) se a variável não existir ou o servidor não responder
+bool forward_to_server(const QueryRequest& request, QueryResponse& out);
+
+#endif // QUERY_PROTOCOL_HPP
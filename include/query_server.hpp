@@ -0,0 +1,40 @@
+#ifndef QUERY_SERVER_HPP
+#define QUERY_SERVER_HPP
+
+#include <string>
+#include <atomic>
+
+#include "hashing.hpp"
+#include "BPlusTree.hpp"
+#include "BPlusTree_long.hpp"
+#include "query_protocol.hpp"
+
+// Arquivos do banco abertos em modo somente leitura pelo dbserver: as buscas só leem o mapeamento, então as threads
+// podem usar os mesmos objetos ao mesmo tempo sem trava
+class QueryDatabase {
+public:
+    explicit QueryDatabase(const std::string& data_dir);
+
+    // responde um pedido; FIND_BY_TITLE devolve todos os registros cujo título confere, como o seek2 local
+    QueryResponse answer(const QueryRequest& request);
+
+private:
+    HashingFile data_file;
+    BPlusTree<int> primary_index;
+    BPlusTree_long secondary_index;
+
+    QueryStatus read_record(f_ptr data_ptr, Artigo& out, QueryResponse& response);
+};
+
+// Contadores do servidor (mostrados no encerramento)
+struct ServerStats {
+    std::atomic<long> connections{0};
+    std::atomic<long> requests{0};
+    std::atomic<long> found{0};
+    std::atomic<long> errors{0};
+};
+
+// atende uma conexão até o cliente fechar: um pedido, uma resposta
+void serve_connection(int fd, QueryDatabase& database, ServerStats& stats);
+
+#endif // QUERY_SERVER_HPP
@@ -0,0 +1,132 @@
+#ifndef STRING_BPLUSTREE_HPP
+#define STRING_BPLUSTREE_HPP
+
+#include <string>
+#include <fstream>
+#include <functional>
+#include <cstdint>
+
+#include "external_sort.hpp"
+#include "mmap_file.hpp"
+
+// Árvore B+ com chaves de tamanho variável (strings), usada no índice de títulos (title_index.idx)
+// As chaves são comparadas byte a byte (ordem lexicográfica) e podem se repetir
+//   folhas: codificação frontal, cada chave guarda só o tamanho do prefixo comum com a anterior e o resto
+//           (a primeira chave de cada folha é completa); tamanhos e ponteiros são gravados como varint
+//   nós internos: separadores truncados, o menor prefixo da primeira chave da direita que ainda é
+//           maior que a última chave da esquerda
+// A árvore é construída pela carga em lote (folhas lado a lado no arquivo) e recebe as cargas incrementais por
+// merge_batch (folhas e nós novos vão para o fim do arquivo); as buscas funcionam nos dois modos
+
+const uint32_t STRING_TREE_MAGIC = 0x45525453; // "STRE"
+const uint32_t STRING_TREE_VERSION = 1;
+const size_t STRING_TREE_PAGE_SIZE = 4096;
+
+// Página 0 do arquivo
+struct StringTreeMetadata {
+    uint32_t magic;
+    uint32_t version;
+    int64_t root_page;    // página da raiz (as páginas começam em 1)
+    int64_t page_count;   // páginas de nós (sem contar a página 0)
+    int64_t entry_count;  // quantidade de chaves
+    int64_t leaf_count;   // folhas da carga em lote, lado a lado nas páginas 1 até leaf_count
+    int32_t height;       // níveis da árvore (1 = só a raiz folha)
+    int32_t reserved;
+};
+
+// Cabeçalho de cada nó
+struct StringNodeHeader {
+    uint8_t is_leaf;
+    uint8_t reserved;
+    uint16_t count;      // chaves na folha / filhos no nó interno
+    uint16_t used;       // bytes ocupados na página (com o cabeçalho)
+    uint16_t reserved2;
+    int64_t next_leaf;   // próxima folha (página), -1 na última
+};
+
+// Um nó ocupa exatamente uma página
+struct alignas(8) StringTreePage {
+    StringNodeHeader header;
+    unsigned char body[STRING_TREE_PAGE_SIZE - sizeof(StringNodeHeader)];
+};
+static_assert(sizeof(StringTreePage) == STRING_TREE_PAGE_SIZE, "StringTreePage precisa ocupar exatamente uma página");
+
+class StringBPlusTree {
+public:
+    // recebe cada chave visitada e o ponteiro do registro; retorna false para encerrar a varredura
+    using Visitor = std::function<bool(const std::string& key, f_ptr data_ptr)>;
+    using Entry = std::pair<std::string, f_ptr>;
+
+    static constexpr size_t MAX_KEY_SIZE = 1024;          // chaves maiores são recusadas (garante vários itens por nó)
+    static constexpr long SCAN_READAHEAD_LEAVES = 32;     // folhas pedidas antecipadamente ao kernel na varredura
+
+    // abre/cria o arquivo do índice; em READ_ONLY o arquivo precisa existir e é mapeado em memória
+    StringBPlusTree(const std::string& index_file_path, OpenMode mode = OpenMode::READ_WRITE);
+    ~StringBPlusTree();
+
+    StringBPlusTree(const StringBPlusTree&) = delete;
+    StringBPlusTree& operator=(const StringBPlusTree&) = delete;
+
+    // carga em lote a partir dos pares (chave, ponteiro) ordenados externamente; só em uma árvore vazia
+    // fill_factor (0 < f <= 1) define a ocupação dos nós
+    void bulk_load(ExternalSorter<std::string>& entries, double fill_factor);
+
+    // mudanças em lote (carga incremental): cada par de 'removals' sai e cada par de 'insertions' entra, os dois
+    // ordenados pela chave. A árvore é descida uma vez e cada folha tocada é lida e gravada uma vez só; a folha que
+    // não cabe mais numa página vira várias no fim do arquivo e os separadores sobem pelos nós internos (a raiz pode
+    // ganhar um nível). Folhas que esvaziam ficam na árvore até a próxima carga completa
+    // retorna quantas remoções não acharam o par
+    long merge_batch(const std::vector<Entry>& insertions, const std::vector<Entry>& removals);
+
+    // busca exata: ponteiro da primeira ocorrência da chave (ou -1) e a quantidade de nós lidos
+    f_ptr search(const std::string& key, int& blocks_read);
+
+    // faixa lexicográfica [lo, hi] em ordem; retorna a quantidade de nós lidos
+    long scan(const std::string& lo, const std::string& hi, const Visitor& visit);
+
+    // todas as chaves que começam com 'prefix', em ordem; retorna a quantidade de nós lidos
+    long scan_prefix(const std::string& prefix, const Visitor& visit);
+
+    long get_total_blocks() const { return static_cast<long>(metadata.page_count); }
+    long get_entry_count() const { return static_cast<long>(metadata.entry_count); }
+    int get_height() const { return metadata.height; }
+
+private:
+    std::string index_path;
+    std::fstream index_file;
+    bool read_only = false;
+    MappedFile mapped_file;
+    StringTreeMetadata metadata{};
+
+    // nó criado por merge_batch à direita de outro, com o separador que o antecede no pai
+    struct Sibling {
+        std::string separator;
+        int64_t page;
+    };
+
+    void initialize_empty_tree();
+    void write_metadata();
+    void write_page(long page_number, const StringTreePage& page);
+
+    // no modo somente leitura aponta direto para o mapeamento, senão lê em 'scratch'
+    const StringTreePage& fetch_page(long page_number, StringTreePage& scratch);
+
+    // desce até a primeira folha que pode ter chaves >= lo e visita as chaves >= lo em ordem
+    // até visit retornar false ou as folhas acabarem; retorna a quantidade de nós lidos
+    long scan_from(const std::string& lo, const Visitor& visit);
+
+    // merge_batch na subárvore de page_number: as inserções vão para o filho mais à esquerda que pode ter a chave
+    // (o mesmo da busca), e as remoções que a subárvore não tem mas podem estar na folha seguinte (chaves repetidas)
+    // voltam em 'removals' para o vizinho da direita; os nós criados à direita saem em siblings
+    void merge_node(long page_number, const Entry* insertions, size_t count, std::vector<Entry>& removals,
+                    long& missing, std::vector<Sibling>& siblings);
+
+    // grava as entradas a partir de page_number, em folhas de ocupação parecida quando não cabem numa só
+    void write_leaves(long page_number, int64_t next_leaf, const std::vector<Entry>& entries, std::vector<Sibling>& siblings);
+    // idem para um nó interno (separators[i] fica entre children[i] e children[i + 1])
+    void write_internal(long page_number, const std::vector<int64_t>& children, const std::vector<std::string>& separators,
+                        std::vector<Sibling>& siblings);
+    long allocate_page() { return static_cast<long>(++metadata.page_count); }
+};
+
+#endif // STRING_BPLUSTREE_HPP
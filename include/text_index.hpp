@@ -0,0 +1,148 @@
+#ifndef TEXT_INDEX_HPP
+#define TEXT_INDEX_HPP
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <memory>
+#include <cstdint>
+
+#include "record.hpp"
+#include "external_sort.hpp"
+#include "mmap_file.hpp"
+#include "string_bplus_tree.hpp"
+
+// Índice invertido (busca por palavras) sobre Titulo, Autores e Snippet, construído pelo upload
+// Arquivos:
+//   text_index.dict: dicionário de termos, uma StringBPlusTree termo -> offset da lista em text_index.post
+//   text_index.post: listas de postagens em segmentos; cada segmento é varint(quantidade), varint(offset do
+//                    segmento anterior do mesmo termo, 0 se não houver) e os números de documento crescentes
+//                    codificados como diferença para o anterior (varint). A carga completa grava um segmento por
+//                    termo; cada carga incremental acrescenta no fim do arquivo um segmento com os documentos novos
+//   text_index.docs: tabela de documentos (registro no arquivo de dados, ID e Citacoes), indexada pelo número
+//                    do documento; usada para o ranking sem ler o arquivo de dados. Documentos apagados ficam
+//                    como lápide (data_ptr -1) e são ignorados na leitura das listas
+// Os números de documento seguem a ordem da varredura do arquivo de dados no upload (os das cargas incrementais
+// vêm depois, então os de um segmento são sempre maiores que os dos segmentos anteriores)
+
+const uint32_t TEXT_INDEX_MAGIC = 0x54584554; // "TEXT"
+const uint32_t TEXT_INDEX_VERSION = 2;
+const size_t TEXT_INDEX_HEADER_SIZE = 16;    // magic, versão e quantidade (documentos ou termos) no início dos arquivos
+
+// Uma linha da tabela de documentos
+struct TextDocument {
+    int64_t data_ptr;
+    int32_t id;
+    int32_t citacoes;
+};
+
+// Quebra o texto em termos: letras e dígitos, minúsculos e sem acento (UTF-8 latino);
+// termos com 1 caractere ou mais de MAX_TERM_SIZE bytes são ignorados
+const size_t MAX_TERM_SIZE = 64;
+void tokenize_text(const char* text, const std::function<void(const std::string&)>& emit);
+
+// Quebra o campo Autores (separado por vírgula, ';' ou '|') em nomes normalizados como os termos, com as partes
+// separadas por um espaço ("KM Carter" -> "km carter"); o último nome é ignorado se o campo estiver cheio (cortado)
+void split_authors(const char* autores, const std::function<void(const std::string&)>& emit);
+
+// Monta o índice durante o upload: os documentos chegam em ordem e as listas ficam comprimidas em memória;
+// quando passam de memory_budget bytes viram uma run no disco, e no final as runs são intercaladas por termo
+class TextIndexBuilder {
+public:
+    TextIndexBuilder(const std::string& data_dir, size_t memory_budget);
+    ~TextIndexBuilder();
+
+    TextIndexBuilder(const TextIndexBuilder&) = delete;
+    TextIndexBuilder& operator=(const TextIndexBuilder&) = delete;
+
+    // próximo documento (recebe o número seguinte ao último)
+    void add_document(const Artigo& artigo, f_ptr data_ptr);
+
+    // grava os três arquivos; fill_factor é repassado à carga em lote do dicionário
+    void finish(double fill_factor);
+
+    long document_count() const { return static_cast<long>(documents.size()); }
+    long term_count() const { return terms_written; }
+    long posting_count() const { return postings_total; }
+    size_t spilled_runs() const { return run_paths.size(); }
+
+private:
+    struct TermPostings {
+        uint32_t count = 0;
+        uint32_t first_doc = 0;
+        uint32_t last_doc = 0;
+        std::vector<unsigned char> bytes; // documentos depois do primeiro, como diferenças em varint
+    };
+
+    std::string data_dir;
+    size_t memory_budget;
+    size_t memory_used = 0;
+    std::unordered_map<std::string, TermPostings> postings;
+    std::vector<TextDocument> documents;
+    std::vector<std::string> run_paths;
+    std::vector<std::string> doc_terms; // termos do documento atual (para tirar as repetições)
+    long terms_written = 0;
+    long postings_total = 0;
+
+    void add_posting(const std::string& term, uint32_t doc);
+    void spill();
+};
+
+// Atualiza o índice na carga incremental sem refazer as listas que já existem: os documentos novos ganham os
+// números seguintes, cada termo deles ganha um segmento no fim de text_index.post e o dicionário passa a apontar
+// para ele (merge_batch); os documentos apagados viram lápides e os que só mudaram de endereço trocam o data_ptr
+class TextIndexUpdater {
+public:
+    explicit TextIndexUpdater(const std::string& data_dir);
+
+    void add_document(const Artigo& artigo, f_ptr data_ptr);
+    void move_document(int id, f_ptr data_ptr); // mesmo conteúdo em outro endereço
+    void remove_document(int id);
+
+    // grava a tabela de documentos, os segmentos novos e as mudanças do dicionário
+    void finish();
+
+    long added_count() const { return added; }
+    long removed_count() const { return removed; }
+
+private:
+    std::string data_dir;
+    std::vector<TextDocument> documents;
+    std::unordered_map<int, uint32_t> live_documents; // ID -> número do documento (sem as lápides)
+    std::vector<uint32_t> changed_documents;          // linhas já existentes a regravar na tabela
+    uint32_t first_new_document = 0;
+    std::unordered_map<std::string, std::vector<uint32_t>> new_postings;
+    std::vector<std::string> doc_terms;
+    long added = 0;
+    long removed = 0;
+};
+
+// Leitura do índice (somente leitura, arquivos mapeados em memória)
+class TextIndex {
+public:
+    explicit TextIndex(const std::string& data_dir);
+
+    // lista de documentos do termo já normalizado, sem as lápides (vazia se o termo não existe); soma os nós lidos
+    // no dicionário
+    std::vector<uint32_t> postings(const std::string& term, long& dict_blocks);
+
+    const TextDocument& document(uint32_t doc) const { return documents[doc]; }
+    long document_count() const { return static_cast<long>(document_total); }
+    long term_count() const { return dictionary.get_entry_count(); }
+
+private:
+    StringBPlusTree dictionary;
+    MappedFile postings_file;
+    MappedFile documents_file;
+    const TextDocument* documents = nullptr;
+    uint64_t document_total = 0;
+};
+
+// Operações sobre listas ordenadas de documentos
+// interseção: percorre a lista menor e procura cada documento na maior com busca galopante (exponencial)
+std::vector<uint32_t> intersect_postings(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b);
+// união sem repetições
+std::vector<uint32_t> unite_postings(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b);
+
+#endif // TEXT_INDEX_HPP
@@ -0,0 +1,38 @@
+#ifndef VARINT_HPP
+#define VARINT_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+
+// Inteiros sem sinal em 7 bits por byte (o bit alto indica que vem mais um byte)
+// Valores pequenos, como tamanhos e diferenças entre números vizinhos, ocupam 1 ou 2 bytes
+
+inline size_t put_varint(unsigned char* out, uint64_t value) {
+    size_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = static_cast<unsigned char>(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = static_cast<unsigned char>(value);
+    return n;
+}
+
+inline size_t varint_size(uint64_t value) {
+    size_t n = 1;
+    while (value >= 0x80) { value >>= 7; n++; }
+    return n;
+}
+
+// lê um valor e avança 'in'; lança runtime_error se o valor passar de 'end'
+inline uint64_t get_varint(const unsigned char*& in, const unsigned char* end) {
+    uint64_t value = 0;
+    for (int shift = 0; in < end && shift < 64; shift += 7) {
+        unsigned char byte = *in++;
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) return value;
+    }
+    throw std::runtime_error("ERRO: varint inválido (arquivo corrompido).");
+}
+
+#endif // VARINT_HPP
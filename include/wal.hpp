@@ -0,0 +1,95 @@
+#ifndef WAL_HPP
+#define WAL_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <condition_variable>
+
+#include "page_io.hpp"
+#include "mmap_file.hpp"
+
+// Nomes fixos, em DATA_DIR, do log e do marcador da carga incremental (upload --append/--delete)
+const char* const WAL_FILE_NAME = "wal.log";
+const char* const APPEND_MARKER_NAME = "append.pending";
+
+// Contadores do log
+struct WalStats {
+    long groups = 0;     // grupos gravados (um por commit de um arquivo)
+    long pages = 0;      // imagens de página gravadas
+    long bytes = 0;      // bytes acrescentados ao log
+    long syncs = 0;      // fdatasync do log (cada um pode cobrir grupos de várias threads)
+    long checkpoints = 0; // vezes em que o log foi esvaziado
+    long recovered = 0;  // grupos reaplicados na abertura
+};
+
+// Log de escrita antecipada (write-ahead log) compartilhado pelo arquivo de dados e pelos índices
+// Cada commit de um arquivo vira um grupo no log com a imagem das páginas sujas (e da página de metadados),
+// protegido por um CRC32: um grupo só vale se chegou inteiro ao disco. O arquivo só recebe as páginas depois
+// que o grupo delas está no disco, então depois de uma queda a reaplicação dos grupos completos (redo) deixa
+// cada arquivo no estado do seu último commit. Os commits de várias threads dividem o mesmo fdatasync.
+// Os arquivos participantes ficam no mesmo diretório do log (o grupo guarda só o nome do arquivo)
+class WriteAheadLog {
+public:
+    // abre (ou cria) o log; se ele tiver grupos de uma execução interrompida, eles são reaplicados antes
+    explicit WriteAheadLog(const std::string& path);
+    // com todos os participantes desligados o log é esvaziado (os arquivos já estão sincronizados)
+    ~WriteAheadLog();
+
+    WriteAheadLog(const WriteAheadLog&) = delete;
+    WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+    // registra um arquivo: sync_file deve sincronizar o arquivo no disco (chamado antes de o log ser esvaziado)
+    int attach(std::function<void()> sync_file);
+    // sincroniza o arquivo uma última vez e o remove dos participantes
+    void detach(int id);
+
+    // grava o grupo com as páginas do arquivo, espera ele chegar ao disco e chama apply (que grava as páginas
+    // no próprio arquivo, sem sincronizar); depois, se o log passou do limite, faz um checkpoint
+    void commit(const std::string& file_path, const std::vector<PageRequest>& pages, const std::function<void()>& apply);
+
+    // hora do próximo commit? (WAL_GROUP_INSERTS inserções ou WAL_GROUP_MS milissegundos desde o último)
+    bool group_due(long pending_inserts, std::chrono::steady_clock::time_point last_commit) const;
+
+    const std::string& get_path() const { return path; }
+    WalStats get_stats();
+
+    // o log tem grupos que ainda não foram reaplicados? (não vazio e não aberto por este processo)
+    static bool has_pending_groups(const std::string& log_path);
+
+private:
+    std::string path;
+    std::string directory;  // onde ficam os arquivos participantes
+    int fd = -1;
+    long group_inserts = 1000;   // WAL_GROUP_INSERTS
+    long group_ms = 50;          // WAL_GROUP_MS
+    long checkpoint_bytes = 64L * 1024 * 1024; // WAL_CHECKPOINT_MB
+
+    std::mutex mutex;
+    std::condition_variable synced;
+    uint64_t written_lsn = 0;  // bytes já acrescentados (cresce sempre, mesmo depois de esvaziar o log)
+    uint64_t durable_lsn = 0;  // até onde o log está no disco
+    bool syncing = false;      // uma thread está no fdatasync
+    int inflight = 0;          // commits entre a gravação do grupo e o fim do apply
+    long log_bytes = 0;        // tamanho atual do arquivo de log
+    int next_id = 0;
+    std::map<int, std::function<void()>> participants;
+    WalStats stats;
+
+    void recover();                   // reaplica os grupos completos e esvazia o log
+    void wait_durable(uint64_t lsn);  // commit em grupo: um fdatasync cobre todos os grupos já gravados
+    void checkpoint();                // sincroniza os participantes e esvazia o log (com o mutex)
+    void truncate_log();
+};
+
+// Recusa abrir um arquivo do banco enquanto o diretório dele tem trabalho de recuperação pendente: um wal.log com
+// grupos a reaplicar ou, na abertura somente leitura, o append.pending de uma carga incremental interrompida (ou
+// ainda rodando), quando os índices podem não bater com o arquivo de dados. Lança runtime_error pedindo o
+// upload --recover. O upload que está com o log aberto continua podendo abrir os arquivos para escrita
+void ensure_no_pending_recovery(const std::string& file_path, OpenMode mode);
+
+#endif // WAL_HPP
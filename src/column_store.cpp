@@ -0,0 +1,352 @@
+#include "column_store.hpp"
+
+#include <fstream>
+#include <climits>
+#include <cstring>
+#include <cstdlib>
+#include <stdexcept>
+#include <algorithm>
+
+#include "log.hpp"
+#include "wal.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define COLUMN_STORE_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// folga de cada coluna para as cargas incrementais (em linhas): um oitavo das linhas, no mínimo uma página cheia
+size_t reserve_rows(size_t rows) {
+    return std::max<size_t>(rows / 8, PAGE_SIZE / sizeof(int32_t));
+}
+
+// grava um array começando no offset (já alinhado à página) com espaço para 'capacity' valores e devolve o
+// offset da página seguinte ao fim dele
+template <typename T>
+int64_t write_column(std::ofstream& out, int64_t offset, const std::vector<T>& values, size_t capacity) {
+    out.seekp(offset);
+    out.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+    int64_t end = offset + static_cast<int64_t>(capacity * sizeof(T));
+    return (end + PAGE_SIZE - 1) / PAGE_SIZE * PAGE_SIZE;
+}
+
+// grava o arquivo inteiro (cabeçalho e as cinco colunas, cada uma com a folga)
+void write_column_file(const std::string& path, const std::vector<int32_t>& ids, const std::vector<int32_t>& anos,
+                       const std::vector<int32_t>& citacoes, const std::vector<int64_t>& atualizacoes,
+                       const std::vector<int64_t>& data_ptrs) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        LOG_ERROR("Nao foi possivel criar o arquivo de colunas " << path);
+        throw std::runtime_error("ERRO: falha ao criar o arquivo de colunas.");
+    }
+    size_t capacity = ids.size() + reserve_rows(ids.size());
+    ColumnFileHeader header{};
+    header.magic = COLUMN_FILE_MAGIC;
+    header.version = COLUMN_FILE_VERSION;
+    header.row_count = static_cast<int64_t>(ids.size());
+    int64_t offset = PAGE_SIZE;
+    header.id_offset = offset;
+    offset = write_column(out, offset, ids, capacity);
+    header.ano_offset = offset;
+    offset = write_column(out, offset, anos, capacity);
+    header.citacoes_offset = offset;
+    offset = write_column(out, offset, citacoes, capacity);
+    header.atualizacao_offset = offset;
+    offset = write_column(out, offset, atualizacoes, capacity);
+    header.data_ptr_offset = offset;
+    offset = write_column(out, offset, data_ptrs, capacity);
+
+    std::vector<char> page(PAGE_SIZE, 0);
+    std::memcpy(page.data(), &header, sizeof(header));
+    out.seekp(0);
+    out.write(page.data(), page.size());
+    // a folga da última coluna também precisa existir no arquivo
+    out.seekp(offset - 1);
+    out.put('\0');
+    if (!out.flush()) {
+        LOG_ERROR("Falha ao gravar o arquivo de colunas " << path);
+        throw std::runtime_error("ERRO: falha ao gravar o arquivo de colunas.");
+    }
+}
+
+// regrava as linhas 'rows' (ordenadas, sem repetição) de uma coluna, um trecho contíguo por escrita
+template <typename T>
+void write_rows(std::fstream& out, int64_t offset, const std::vector<T>& values, const std::vector<size_t>& rows) {
+    for (size_t i = 0; i < rows.size();) {
+        size_t j = i + 1;
+        while (j < rows.size() && rows[j] == rows[j - 1] + 1) j++;
+        out.seekp(offset + static_cast<int64_t>(rows[i] * sizeof(T)));
+        out.write(reinterpret_cast<const char*>(values.data() + rows[i]), (rows[j - 1] - rows[i] + 1) * sizeof(T));
+        i = j;
+    }
+}
+
+// linhas [first, rows) uma a uma (kernel escalar e o resto que não completa uma palavra nos kernels vetoriais)
+template <typename T>
+void scalar_filter(const T* values, size_t first, size_t rows, int64_t lo, int64_t hi, uint64_t* selection) {
+    for (size_t i = first; i < rows; ++i) {
+        int64_t value = values[i];
+        if (value < lo || value > hi) selection[i / 64] &= ~(uint64_t(1) << (i % 64));
+    }
+}
+
+void scalar_filter_i32(const int32_t* values, size_t rows, int64_t lo, int64_t hi, uint64_t* selection) {
+    scalar_filter(values, 0, rows, lo, hi, selection);
+}
+
+void scalar_filter_i64(const int64_t* values, size_t rows, int64_t lo, int64_t hi, uint64_t* selection) {
+    scalar_filter(values, 0, rows, lo, hi, selection);
+}
+
+#ifdef COLUMN_STORE_X86
+
+// AVX2: 8 vetores de 8 valores por palavra da seleção; fora da faixa = lo > x ou x > hi
+// palavras já zeradas por um filtro anterior são puladas sem ler a coluna
+__attribute__((target("avx2")))
+void avx2_filter_i32(const int32_t* values, size_t rows, int64_t lo, int64_t hi, uint64_t* selection) {
+    if (lo > INT32_MAX || hi < INT32_MIN) {
+        std::fill(selection, selection + (rows + 63) / 64, 0);
+        return;
+    }
+    const __m256i vlo = _mm256_set1_epi32(static_cast<int32_t>(std::max<int64_t>(lo, INT32_MIN)));
+    const __m256i vhi = _mm256_set1_epi32(static_cast<int32_t>(std::min<int64_t>(hi, INT32_MAX)));
+    size_t words = rows / 64;
+    for (size_t w = 0; w < words; ++w) {
+        if (selection[w] == 0) continue;
+        const int32_t* base = values + w * 64;
+        uint64_t keep = 0;
+        for (int v = 0; v < 8; ++v) {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(base + v * 8));
+            __m256i outside = _mm256_or_si256(_mm256_cmpgt_epi32(vlo, x), _mm256_cmpgt_epi32(x, vhi));
+            unsigned mask = ~static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(outside))) & 0xFFu;
+            keep |= static_cast<uint64_t>(mask) << (v * 8);
+        }
+        selection[w] &= keep;
+    }
+    scalar_filter(values, words * 64, rows, lo, hi, selection);
+}
+
+// AVX2, int64: 16 vetores de 4 valores por palavra
+__attribute__((target("avx2")))
+void avx2_filter_i64(const int64_t* values, size_t rows, int64_t lo, int64_t hi, uint64_t* selection) {
+    const __m256i vlo = _mm256_set1_epi64x(lo);
+    const __m256i vhi = _mm256_set1_epi64x(hi);
+    size_t words = rows / 64;
+    for (size_t w = 0; w < words; ++w) {
+        if (selection[w] == 0) continue;
+        const int64_t* base = values + w * 64;
+        uint64_t keep = 0;
+        for (int v = 0; v < 16; ++v) {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(base + v * 4));
+            __m256i outside = _mm256_or_si256(_mm256_cmpgt_epi64(vlo, x), _mm256_cmpgt_epi64(x, vhi));
+            unsigned mask = ~static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(outside))) & 0xFu;
+            keep |= static_cast<uint64_t>(mask) << (v * 4);
+        }
+        selection[w] &= keep;
+    }
+    scalar_filter(values, words * 64, rows, lo, hi, selection);
+}
+
+bool avx2_supported() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+
+#endif // COLUMN_STORE_X86
+
+void (*filter_i32)(const int32_t*, size_t, int64_t, int64_t, uint64_t*) = scalar_filter_i32;
+void (*filter_i64)(const int64_t*, size_t, int64_t, int64_t, uint64_t*) = scalar_filter_i64;
+const char* kernel_name = "scalar";
+
+// escolhe o kernel antes do main (COLUMN_KERNEL=scalar|avx2 força um deles)
+struct ColumnKernelSelector {
+    ColumnKernelSelector() {
+        const char* env = std::getenv("COLUMN_KERNEL");
+        std::string wanted = (env != nullptr) ? trim(env) : "avx2";
+        if (wanted != "scalar" && wanted != "avx2") {
+            LOG_WARN("COLUMN_KERNEL invalido ('" << env << "'). Usando o padrao");
+            wanted = "avx2";
+        }
+        if (set_column_kernel(wanted)) return;
+        if (env != nullptr) LOG_WARN("COLUMN_KERNEL=avx2 nao suportado nesta CPU. Usando scalar");
+        set_column_kernel("scalar");
+    }
+};
+ColumnKernelSelector kernel_selector;
+
+} // namespace
+
+bool set_column_kernel(const std::string& name) {
+    if (name == "scalar") {
+        filter_i32 = scalar_filter_i32;
+        filter_i64 = scalar_filter_i64;
+        kernel_name = "scalar";
+        return true;
+    }
+#ifdef COLUMN_STORE_X86
+    if (name == "avx2" && avx2_supported()) {
+        filter_i32 = avx2_filter_i32;
+        filter_i64 = avx2_filter_i64;
+        kernel_name = "avx2";
+        return true;
+    }
+#endif
+    return false;
+}
+
+void ColumnWriter::add(const Artigo& artigo, f_ptr data_ptr) {
+    ids.push_back(artigo.ID);
+    anos.push_back(artigo.Ano);
+    citacoes.push_back(artigo.Citacoes);
+    atualizacoes.push_back(static_cast<int64_t>(artigo.Atualizacao_timestamp));
+    data_ptrs.push_back(static_cast<int64_t>(data_ptr));
+}
+
+void ColumnWriter::finish() {
+    write_column_file(path, ids, anos, citacoes, atualizacoes, data_ptrs);
+}
+
+ColumnUpdater::ColumnUpdater(const std::string& path) : path(path) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    int64_t file_size = static_cast<int64_t>(in.tellg());
+    in.seekg(0);
+    in.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!in || header.magic != COLUMN_FILE_MAGIC || header.version != COLUMN_FILE_VERSION ||
+        header.data_ptr_offset + header.row_count * static_cast<int64_t>(sizeof(int64_t)) > file_size) {
+        LOG_ERROR("Arquivo " << path << " nao e um arquivo de colunas valido. Refaca o upload com --columns.");
+        throw std::runtime_error("ERRO: arquivo de colunas em formato inválido.");
+    }
+    size_t count = static_cast<size_t>(header.row_count);
+    auto load = [&](auto& values, int64_t offset) {
+        values.resize(count);
+        in.seekg(offset);
+        in.read(reinterpret_cast<char*>(values.data()), count * sizeof(values[0]));
+    };
+    load(ids, header.id_offset);
+    load(anos, header.ano_offset);
+    load(citacoes, header.citacoes_offset);
+    load(atualizacoes, header.atualizacao_offset);
+    load(data_ptrs, header.data_ptr_offset);
+    if (!in) throw std::runtime_error("ERRO: arquivo de colunas truncado.");
+    // a folga de cada coluna vai até a seguinte; a da última, até o fim do arquivo
+    capacity = std::min({static_cast<size_t>(header.ano_offset - header.id_offset) / sizeof(int32_t),
+                         static_cast<size_t>(header.citacoes_offset - header.ano_offset) / sizeof(int32_t),
+                         static_cast<size_t>(header.atualizacao_offset - header.citacoes_offset) / sizeof(int32_t),
+                         static_cast<size_t>(header.data_ptr_offset - header.atualizacao_offset) / sizeof(int64_t),
+                         static_cast<size_t>(std::max<int64_t>(0, file_size - header.data_ptr_offset)) / sizeof(int64_t)});
+    rows.reserve(count);
+    for (size_t row = 0; row < count; ++row) rows[ids[row]] = row;
+}
+
+void ColumnUpdater::set_row(size_t row, const Artigo& artigo, f_ptr data_ptr) {
+    ids[row] = artigo.ID;
+    anos[row] = artigo.Ano;
+    citacoes[row] = artigo.Citacoes;
+    atualizacoes[row] = static_cast<int64_t>(artigo.Atualizacao_timestamp);
+    data_ptrs[row] = static_cast<int64_t>(data_ptr);
+    dirty_rows.push_back(row);
+}
+
+void ColumnUpdater::put(const Artigo& artigo, f_ptr data_ptr) {
+    auto it = rows.find(artigo.ID);
+    if (it != rows.end()) {
+        set_row(it->second, artigo, data_ptr);
+        return;
+    }
+    size_t row = ids.size();
+    ids.push_back(0);
+    anos.push_back(0);
+    citacoes.push_back(0);
+    atualizacoes.push_back(0);
+    data_ptrs.push_back(0);
+    rows[artigo.ID] = row;
+    set_row(row, artigo, data_ptr);
+}
+
+void ColumnUpdater::remove(int id) {
+    auto it = rows.find(id);
+    if (it == rows.end()) {
+        LOG_WARN("AVISO: Registro apagado sem linha nas colunas. ID: " << id);
+        return;
+    }
+    size_t row = it->second;
+    size_t last = ids.size() - 1;
+    rows.erase(it);
+    if (row != last) {
+        // a última linha ocupa o lugar da apagada
+        ids[row] = ids[last];
+        anos[row] = anos[last];
+        citacoes[row] = citacoes[last];
+        atualizacoes[row] = atualizacoes[last];
+        data_ptrs[row] = data_ptrs[last];
+        rows[ids[row]] = row;
+        dirty_rows.push_back(row);
+    }
+    ids.pop_back();
+    anos.pop_back();
+    citacoes.pop_back();
+    atualizacoes.pop_back();
+    data_ptrs.pop_back();
+}
+
+void ColumnUpdater::finish() {
+    if (ids.size() > capacity) {
+        LOG_INFO("[COLUNAS] Sem folga para " << ids.size() << " linhas, regravando " << path);
+        write_column_file(path, ids, anos, citacoes, atualizacoes, data_ptrs);
+        return;
+    }
+    std::sort(dirty_rows.begin(), dirty_rows.end());
+    dirty_rows.erase(std::unique(dirty_rows.begin(), dirty_rows.end()), dirty_rows.end());
+    // linhas apagadas do fim não são regravadas
+    dirty_rows.erase(std::lower_bound(dirty_rows.begin(), dirty_rows.end(), ids.size()), dirty_rows.end());
+
+    std::fstream out(path, std::ios::in | std::ios::out | std::ios::binary);
+    write_rows(out, header.id_offset, ids, dirty_rows);
+    write_rows(out, header.ano_offset, anos, dirty_rows);
+    write_rows(out, header.citacoes_offset, citacoes, dirty_rows);
+    write_rows(out, header.atualizacao_offset, atualizacoes, dirty_rows);
+    write_rows(out, header.data_ptr_offset, data_ptrs, dirty_rows);
+    header.row_count = static_cast<int64_t>(ids.size());
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (!out.flush()) {
+        LOG_ERROR("Falha ao gravar o arquivo de colunas " << path);
+        throw std::runtime_error("ERRO: falha ao gravar o arquivo de colunas.");
+    }
+    LOG_DEBUG("[COLUNAS] " << dirty_rows.size() << " linhas regravadas em " << path);
+}
+
+ColumnStore::ColumnStore(const std::string& path) {
+    ensure_no_pending_recovery(path, OpenMode::READ_ONLY);
+    file.open(path);
+    if (file.size() < PAGE_SIZE) throw std::runtime_error("ERRO: arquivo de colunas inválido.");
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (header.magic != COLUMN_FILE_MAGIC || header.version != COLUMN_FILE_VERSION) {
+        LOG_ERROR("Arquivo " << path << " nao e um arquivo de colunas valido. Refaca o upload com --columns.");
+        throw std::runtime_error("ERRO: arquivo de colunas em formato inválido.");
+    }
+    size_t rows = static_cast<size_t>(header.row_count);
+    if (static_cast<size_t>(header.data_ptr_offset) + rows * sizeof(int64_t) > file.size()) {
+        throw std::runtime_error("ERRO: arquivo de colunas truncado.");
+    }
+}
+
+std::vector<uint64_t> column_select_all(size_t rows) {
+    std::vector<uint64_t> selection((rows + 63) / 64, ~uint64_t(0));
+    if (rows % 64 != 0) selection.back() = (uint64_t(1) << (rows % 64)) - 1;
+    return selection;
+}
+
+void column_filter_i32(const int32_t* values, size_t rows, int64_t lo, int64_t hi, uint64_t* selection) {
+    filter_i32(values, rows, lo, hi, selection);
+}
+
+void column_filter_i64(const int64_t* values, size_t rows, int64_t lo, int64_t hi, uint64_t* selection) {
+    filter_i64(values, rows, lo, hi, selection);
+}
+
+const char* column_kernel_name() {
+    return kernel_name;
+}
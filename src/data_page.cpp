@@ -0,0 +1,224 @@
+#include <cstring>
+
+#include "data_page.hpp"
+
+namespace {
+
+// Escreve/lê valores sem depender do alinhamento dentro da página
+template <typename T>
+void put_value(unsigned char*& pos, T value) {
+    std::memcpy(pos, &value, sizeof(T));
+    pos += sizeof(T);
+}
+
+template <typename T>
+T get_value(const unsigned char*& pos) {
+    T value;
+    std::memcpy(&value, pos, sizeof(T));
+    pos += sizeof(T);
+    return value;
+}
+
+// Copia um texto de tamanho len e termina com '\0' (o destino tem capacity bytes)
+void get_text(const unsigned char*& pos, size_t len, char* dest, size_t capacity) {
+    size_t copied = len < capacity ? len : capacity - 1;
+    std::memcpy(dest, pos, copied);
+    dest[copied] = '\0';
+    pos += len;
+}
+
+} // namespace
+
+size_t encode_record(const Artigo& artigo, unsigned char* dest) {
+    uint16_t titulo_len = static_cast<uint16_t>(strnlen(artigo.Titulo, sizeof(artigo.Titulo)));
+    uint16_t autores_len = static_cast<uint16_t>(strnlen(artigo.Autores, sizeof(artigo.Autores)));
+    uint16_t snippet_len = static_cast<uint16_t>(strnlen(artigo.Snippet, sizeof(artigo.Snippet)));
+
+    unsigned char* pos = dest;
+    put_value<int32_t>(pos, artigo.ID);
+    put_value<int32_t>(pos, artigo.Ano);
+    put_value<int32_t>(pos, artigo.Citacoes);
+    put_value<int64_t>(pos, static_cast<int64_t>(artigo.Atualizacao_timestamp));
+    put_value<uint16_t>(pos, titulo_len);
+    put_value<uint16_t>(pos, autores_len);
+    put_value<uint16_t>(pos, snippet_len);
+    std::memcpy(pos, artigo.Titulo, titulo_len);
+    pos += titulo_len;
+    std::memcpy(pos, artigo.Autores, autores_len);
+    pos += autores_len;
+    std::memcpy(pos, artigo.Snippet, snippet_len);
+    pos += snippet_len;
+    return static_cast<size_t>(pos - dest);
+}
+
+bool decode_record(const unsigned char* src, size_t length, Artigo& out) {
+    if (length < RECORD_FIXED_SIZE) return false;
+    const unsigned char* pos = src;
+    out.ID = get_value<int32_t>(pos);
+    out.Ano = get_value<int32_t>(pos);
+    out.Citacoes = get_value<int32_t>(pos);
+    out.Atualizacao_timestamp = static_cast<time_t>(get_value<int64_t>(pos));
+    uint16_t titulo_len = get_value<uint16_t>(pos);
+    uint16_t autores_len = get_value<uint16_t>(pos);
+    uint16_t snippet_len = get_value<uint16_t>(pos);
+    if (RECORD_FIXED_SIZE + titulo_len + autores_len + snippet_len != length) return false;
+    get_text(pos, titulo_len, out.Titulo, sizeof(out.Titulo));
+    get_text(pos, autores_len, out.Autores, sizeof(out.Autores));
+    get_text(pos, snippet_len, out.Snippet, sizeof(out.Snippet));
+    return true;
+}
+
+DataBlock::DataBlock() {
+    std::memset(this, 0, sizeof(DataBlock));
+}
+
+DataBlock::DataBlock(PageKind kind, uint32_t bucket) : DataBlock() {
+    header.kind = kind;
+    header.bucket = bucket;
+}
+
+size_t DataBlock::contiguous_space(const PageHeader& header) {
+    size_t free_end = header.free_end == 0 ? PAGE_SIZE : header.free_end;
+    size_t directory_end = sizeof(PageHeader) + header.slot_count * sizeof(SlotEntry);
+    return free_end > directory_end ? free_end - directory_end : 0;
+}
+
+size_t DataBlock::free_space(const PageHeader& header) {
+    return contiguous_space(header) + header.dead_bytes;
+}
+
+size_t DataBlock::free_space() const {
+    return free_space(header);
+}
+
+size_t DataBlock::encoded_size(const Artigo& artigo) {
+    return RECORD_FIXED_SIZE + strnlen(artigo.Titulo, sizeof(artigo.Titulo)) +
+           strnlen(artigo.Autores, sizeof(artigo.Autores)) + strnlen(artigo.Snippet, sizeof(artigo.Snippet));
+}
+
+int DataBlock::insert(const Artigo& artigo) {
+    size_t record_size = encoded_size(artigo);
+    int slot = header.slot_count;
+    for (int s = 0; s < header.slot_count; s++) {
+        if (slot_entry(s).length == 0) { // lápide: o diretório não cresce
+            slot = s;
+            break;
+        }
+    }
+    size_t needed = record_size + (slot == header.slot_count ? sizeof(SlotEntry) : 0);
+    if (needed > free_space()) return -1;
+    if (needed > contiguous_space(header)) compact(-1);
+
+    size_t free_end = header.free_end == 0 ? PAGE_SIZE : header.free_end;
+    size_t offset = free_end - record_size;
+    encode_record(artigo, page_bytes() + offset);
+
+    if (slot == header.slot_count) header.slot_count++;
+    set_slot_entry(slot, SlotEntry{static_cast<uint16_t>(offset), static_cast<uint16_t>(record_size)});
+    header.free_end = static_cast<uint16_t>(offset);
+    return slot;
+}
+
+bool DataBlock::erase(int slot) {
+    if (slot < 0 || slot >= header.slot_count) return false;
+    SlotEntry entry = slot_entry(slot);
+    if (entry.length == 0) return false;
+    header.dead_bytes = static_cast<uint16_t>(header.dead_bytes + entry.length);
+    set_slot_entry(slot, SlotEntry{0, 0});
+    return true;
+}
+
+bool DataBlock::replace(int slot, const Artigo& artigo) {
+    if (slot < 0 || slot >= header.slot_count) return false;
+    size_t new_size = encoded_size(artigo);
+    SlotEntry entry = slot_entry(slot);
+    if (entry.length == 0) return false;
+    if (new_size <= entry.length) {
+        // cabe no lugar da versão antiga (o resto dela fica sem uso até a próxima compactação)
+        encode_record(artigo, page_bytes() + entry.offset);
+        header.dead_bytes = static_cast<uint16_t>(header.dead_bytes + entry.length - new_size);
+        entry.length = static_cast<uint16_t>(new_size);
+        set_slot_entry(slot, entry);
+        return true;
+    }
+    // a versão antiga vira espaço morto; a nova precisa caber no espaço livre somado a ele
+    if (new_size > free_space() + entry.length) return false;
+
+    header.dead_bytes = static_cast<uint16_t>(header.dead_bytes + entry.length);
+    if (new_size > contiguous_space(header)) compact(slot);
+    size_t free_end = header.free_end == 0 ? PAGE_SIZE : header.free_end;
+    size_t offset = free_end - new_size;
+    encode_record(artigo, page_bytes() + offset);
+    set_slot_entry(slot, SlotEntry{static_cast<uint16_t>(offset), static_cast<uint16_t>(new_size)});
+    header.free_end = static_cast<uint16_t>(offset);
+    return true;
+}
+
+size_t DataBlock::record_size(int slot) const {
+    if (slot < 0 || slot >= header.slot_count) return 0;
+    return slot_entry(slot).length;
+}
+
+void DataBlock::compact(int skip_slot) {
+    DataBlock original = *this;
+    size_t end = PAGE_SIZE;
+    for (int s = 0; s < header.slot_count; s++) {
+        SlotEntry entry = original.slot_entry(s);
+        if (s == skip_slot || entry.length == 0) {
+            entry = SlotEntry{0, 0};
+        } else {
+            end -= entry.length;
+            std::memcpy(page_bytes() + end, original.page_bytes() + entry.offset, entry.length);
+            entry.offset = static_cast<uint16_t>(end);
+        }
+        set_slot_entry(s, entry);
+    }
+    header.free_end = static_cast<uint16_t>(end);
+    header.dead_bytes = 0;
+}
+
+void DataBlock::set_slot_entry(int slot, const SlotEntry& entry) {
+    std::memcpy(page_bytes() + sizeof(PageHeader) + slot * sizeof(SlotEntry), &entry, sizeof(SlotEntry));
+}
+
+SlotEntry DataBlock::slot_entry(int slot) const {
+    SlotEntry entry;
+    std::memcpy(&entry, page_bytes() + sizeof(PageHeader) + slot * sizeof(SlotEntry), sizeof(SlotEntry));
+    return entry;
+}
+
+bool DataBlock::read(int slot, Artigo& out) const {
+    if (slot < 0 || slot >= header.slot_count) return false;
+    SlotEntry entry = slot_entry(slot);
+    if (entry.length < RECORD_FIXED_SIZE || entry.offset + entry.length > PAGE_SIZE) return false;
+
+    return decode_record(page_bytes() + entry.offset, entry.length, out);
+}
+
+bool DataBlock::view(int slot, RecordView& out) const {
+    if (slot < 0 || slot >= header.slot_count) return false;
+    SlotEntry entry = slot_entry(slot);
+    if (entry.length < RECORD_FIXED_SIZE || entry.offset + entry.length > PAGE_SIZE) return false;
+
+    const unsigned char* pos = page_bytes() + entry.offset;
+    out.id = get_value<int32_t>(pos);
+    out.ano = get_value<int32_t>(pos);
+    out.citacoes = get_value<int32_t>(pos);
+    out.atualizacao = get_value<int64_t>(pos);
+    out.titulo_len = get_value<uint16_t>(pos);
+    out.autores_len = get_value<uint16_t>(pos);
+    out.snippet_len = get_value<uint16_t>(pos);
+    if (RECORD_FIXED_SIZE + out.titulo_len + out.autores_len + out.snippet_len != entry.length) return false;
+    out.titulo = reinterpret_cast<const char*>(pos);
+    out.autores = out.titulo + out.titulo_len;
+    out.snippet = out.autores + out.autores_len;
+    return true;
+}
+
+int DataBlock::record_id(int slot) const {
+    SlotEntry entry = slot_entry(slot);
+    if (entry.length == 0) return -1;
+    int32_t id;
+    std::memcpy(&id, page_bytes() + entry.offset, sizeof(id));
+    return id;
+}
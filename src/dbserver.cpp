@@ -0,0 +1,175 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <unordered_set>
+#include <algorithm>
+#include <stdexcept>
+#include <cstring>
+#include <cstdlib>
+#include <cerrno>
+#include <csignal>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "record.hpp"
+#include "pipeline.hpp"       // BoundedQueue
+#include "query_protocol.hpp"
+#include "query_server.hpp"   // QueryDatabase, serve_connection
+#include "log.hpp"
+
+// dbserver: abre o arquivo de dados e os dois índices uma única vez (mapeados, somente leitura)
+// e responde as buscas do findrec, seek1 e seek2 por um socket Unix, com um grupo de threads
+// Os arquivos mapeados não mudam depois de abertos: depois de um novo upload o servidor precisa ser reiniciado
+
+namespace {
+
+// pipe usado pelo tratador de sinal para acordar o laço do accept (write é seguro dentro do tratador)
+int stop_pipe[2] = {-1, -1};
+
+void handle_stop_signal(int) {
+    char byte = 1;
+    ssize_t ignored = write(stop_pipe[1], &byte, 1);
+    (void)ignored;
+}
+
+// Conexões abertas: no encerramento todas recebem shutdown para os workers saírem do recv
+class ConnectionSet {
+public:
+    void add(int fd) { std::lock_guard<std::mutex> lock(mtx); fds.insert(fd); }
+    void remove(int fd) { std::lock_guard<std::mutex> lock(mtx); fds.erase(fd); }
+    void shutdown_all() {
+        std::lock_guard<std::mutex> lock(mtx);
+        for (int fd : fds) ::shutdown(fd, SHUT_RDWR);
+    }
+private:
+    std::mutex mtx;
+    std::unordered_set<int> fds;
+};
+
+// cria o socket de escuta; recusa se já houver um servidor respondendo no mesmo caminho
+int open_listen_socket(const std::string& socket_path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(address.sun_path)) {
+        LOG_ERROR("Caminho do socket muito longo: " << socket_path);
+        throw std::runtime_error("ERRO: caminho do socket muito longo.");
+    }
+    std::strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+
+    QueryClient probe;
+    if (probe.connect(socket_path)) {
+        LOG_ERROR("Ja existe um dbserver escutando em " << socket_path);
+        throw std::runtime_error("ERRO: socket em uso.");
+    }
+    ::unlink(socket_path.c_str()); // socket antigo de um servidor que não foi encerrado corretamente
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) throw std::runtime_error("ERRO: não foi possível criar o socket.");
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || ::listen(fd, SOMAXCONN) < 0) {
+        LOG_ERROR("Falha ao escutar em " << socket_path << ": " << std::strerror(errno));
+        ::close(fd);
+        throw std::runtime_error("ERRO: não foi possível escutar no socket.");
+    }
+    return fd;
+}
+
+// threads de atendimento: DBSERVER_THREADS ou a quantidade de núcleos (mínimo 2)
+int worker_count() {
+    int threads = static_cast<int>(std::thread::hardware_concurrency());
+    const char* env = std::getenv("DBSERVER_THREADS");
+    if (env != nullptr) {
+        int value = std::atoi(env);
+        if (value > 0) threads = value;
+        else LOG_WARN("DBSERVER_THREADS invalido ('" << env << "'). Usando o padrao");
+    }
+    return std::max(2, threads);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc > 2) {
+        LOG_ERROR("Uso: " << argv[0] << " [caminho_do_socket]");
+        return 1;
+    }
+
+    const char* data_dir_env = std::getenv("DATA_DIR");
+    if (data_dir_env == nullptr) {
+        LOG_ERROR("ERRO FATAL: Variavel de ambiente DATA_DIR nao definida.");
+        LOG_INFO("Execute: export DATA_DIR=./data");
+        return 1;
+    }
+    std::string data_dir(data_dir_env);
+    std::string socket_path = (argc == 2) ? argv[1] : default_socket_path(data_dir);
+
+    try {
+        QueryDatabase database(data_dir);
+        int listen_fd = open_listen_socket(socket_path);
+
+        if (pipe(stop_pipe) < 0) throw std::runtime_error("ERRO: não foi possível criar o pipe de encerramento.");
+        std::signal(SIGINT, handle_stop_signal);
+        std::signal(SIGTERM, handle_stop_signal);
+        std::signal(SIGPIPE, SIG_IGN);
+
+        ServerStats stats;
+        ConnectionSet connections;
+        int threads = worker_count();
+        BoundedQueue<int> pending(static_cast<size_t>(threads) * 64); // conexões aceitas esperando uma thread
+
+        std::vector<std::thread> workers;
+        for (int i = 0; i < threads; ++i) {
+            workers.emplace_back([&]() {
+                int fd;
+                while (pending.pop(fd)) {
+                    serve_connection(fd, database, stats);
+                    connections.remove(fd);
+                    ::close(fd);
+                }
+            });
+        }
+        LOG_INFO("dbserver escutando em " << socket_path << " com " << threads << " threads (DATA_DIR=" << data_dir << ")");
+
+        // laço do accept: termina quando chega SIGINT/SIGTERM pelo pipe
+        pollfd watched[2] = {{listen_fd, POLLIN, 0}, {stop_pipe[0], POLLIN, 0}};
+        while (true) {
+            if (poll(watched, 2, -1) < 0) {
+                if (errno == EINTR) continue;
+                LOG_ERROR("Falha no poll: " << std::strerror(errno));
+                break;
+            }
+            if (watched[1].revents != 0) break;
+            if (watched[0].revents & POLLIN) {
+                int client_fd = ::accept(listen_fd, nullptr, nullptr);
+                if (client_fd < 0) continue;
+                stats.connections++;
+                connections.add(client_fd);
+                if (!pending.push(client_fd)) {
+                    connections.remove(client_fd);
+                    ::close(client_fd);
+                }
+            }
+        }
+
+        LOG_INFO("Encerrando o dbserver...");
+        ::close(listen_fd);
+        ::unlink(socket_path.c_str());
+        pending.close();
+        connections.shutdown_all();
+        for (auto& worker : workers) worker.join();
+
+        LOG_INFO("--- Metricas do dbserver ---");
+        LOG_INFO("Conexoes atendidas: " << stats.connections.load());
+        LOG_INFO("Pedidos: " << stats.requests.load() << " (encontrados: " << stats.found.load()
+                 << ", erros: " << stats.errors.load() << ")");
+
+    } catch (const std::runtime_error& e) {
+        LOG_ERROR("ERRO FATAL no dbserver: " << e.what());
+        return 1;
+    }
+    return 0;
+}
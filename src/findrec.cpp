@@ -10,9 +10,7 @@
 #include "hashing.hpp"
 #include "log.hpp"
 #include "findrec.hpp"
-
-//quantidade de blocos
-long blocks_qntd = 750000;
+#include "query_protocol.hpp"
 
 // Função auxiliar para imprimir os campos de um artigo de forma legível
 //não precisa de log
@@ -77,9 +75,34 @@ int main(int argc, char* argv[]) {
 
    LOG_INFO("Buscando pelo ID: " << search_id);
 
+    // modo cliente: com DBSERVER_SOCKET definida a busca é respondida pelo dbserver (arquivos já abertos e quentes)
+    QueryRequest request;
+    request.op = QueryOp::FIND_BY_ID_HASH;
+    request.id = search_id;
+    QueryResponse response;
+    if (forward_to_server(request, response)) {
+        if (response.status == QueryStatus::ERROR) {
+            LOG_ERROR("ERRO FATAL durante a busca no dbserver: " << response.error);
+            return 1;
+        }
+        if (response.status == QueryStatus::FOUND) {
+            LOG_INFO("\nRegistro encontrado com sucesso!");
+            print_artigo(response.artigos.front());
+            std::cout.flush();
+        } else {
+            LOG_INFO("\nRegistro com ID " << search_id << " nao foi encontrado.");
+        }
+        LOG_INFO("\n--- Métricas da Busca (dbserver) ---");
+        LOG_INFO("Blocos lidos para encontrar o registro: " << response.blocks_read);
+        LOG_INFO("Total de blocos no arquivo de dados: " << response.total_blocks);
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start_time;
+        LOG_INFO("Tempo de execucao do findrec: " << std::fixed << std::setprecision(3) << elapsed.count() << " ms");
+        return 0;
+    }
+
     try {
-        // 2. Inicializa o HashingFile (que deve ABRIR o arquivo existente)
-        HashingFile data_file(data_file_path, blocks_qntd);
+        // 2. Inicializa o HashingFile (ABRE o arquivo existente, mapeado em memória somente para leitura)
+        HashingFile data_file(data_file_path, OpenMode::READ_ONLY); // a quantidade de blocos vem do cabeçalho do arquivo
 
         int blocks_read = 0;
 
@@ -95,12 +118,12 @@ int main(int argc, char* argv[]) {
 
            LOG_INFO("\n--- Métricas da Busca ---");
            LOG_INFO("Blocos lidos para encontrar o registro: " << blocks_read);
-           LOG_INFO("Total de blocos no arquivo de dados: " << blocks_qntd);
+           LOG_INFO("Total de blocos no arquivo de dados: " << data_file.get_total_blocks());
         } else {
            LOG_INFO("\nRegistro com ID " << search_id << " nao foi encontrado.");
            LOG_INFO("--- Métricas da Busca ---");
            LOG_INFO("Blocos lidos durante a tentativa: " << blocks_read);
-           LOG_INFO("Total de blocos no arquivo de dados: " << blocks_qntd);
+           LOG_INFO("Total de blocos no arquivo de dados: " << data_file.get_total_blocks());
         }
 
         auto end_time = std::chrono::high_resolution_clock::now();
@@ -3,164 +3,718 @@
 #include <sstream>
 #include <string>
 #include <stdexcept>
+#include <cstring>
+#include <cstddef>
+#include <algorithm>
 
-#include "hashing.hpp" 
+#include "hashing.hpp"
 #include "record.hpp"
 #include "log.hpp"
 
-// Construtor 
-HashingFile::HashingFile(const std::string& data_file_path, long num_total_blocks) {
-    total_blocks = num_total_blocks;
-    //Tentando abrir data file
-    data_file.open(data_file_path, std::ios::in | std::ios::out | std::ios::binary);
+// Construtor
+HashingFile::HashingFile(const std::string& data_file_path, OpenMode mode)
+    : block_cache(cache_bytes_from_env("DATA_CACHE_BYTES", CACHE_LIMIT * sizeof(DataBlock)),
+                  [this](const std::vector<std::pair<f_ptr, const DataBlock*>>& blocks) { write_blocks_to_disk(blocks); },
+                  WRITEBACK_BATCH),
+      data_file_path(data_file_path) {
+    occupancy_path = data_file_path + ".occ";
+    ensure_no_pending_recovery(data_file_path, mode);
+
+    if (mode == OpenMode::READ_ONLY) {
+        read_only = true;
+        mapped_file.open(data_file_path);
+        if (mapped_file.size() >= sizeof(file_header)) std::memcpy(&file_header, mapped_file.data(), sizeof(file_header));
+        check_file_header(file_header);
+        if (mapped_file.size() < static_cast<size_t>(page_offset(file_header.total_pages + 1))) {
+            LOG_ERROR("[HASHING]: Arquivo de dados menor que o indicado no cabecalho");
+            throw std::runtime_error("ERRO: arquivo de dados inválido");
+        }
+        allocated_pages = static_cast<long>(file_header.total_pages);
+        // o acesso pelo hash é aleatório, readahead só traria blocos inúteis
+        mapped_file.advise(MADV_RANDOM);
+        LOG_DEBUG("[HASHING]: Arquivo de dados mapeado em memoria com " << file_header.total_pages << " blocos");
+        if (!load_occupancy()) {
+            LOG_WARN("[HASHING]: Metadados dos buckets ausentes ou inconsistentes, reconstruindo a partir do arquivo de dados...");
+            rebuild_occupancy();
+        }
+        return;
+    }
 
-    if (!data_file.is_open()) {
+    //Tentando abrir data file
+    if (!data_file.open(data_file_path, false, page_io_direct())) {
         LOG_DEBUG("[HASHING]: Arquivo de dados inexistente, tentando criar agora...");
-        // Criando novo arquivo zerado
-        std::ofstream create_file(data_file_path, std::ios::out | std::ios::binary | std::ios::trunc);
-        if (!create_file) {
+        // Criando novo arquivo zerado, já aberto para leitura e escrita
+        if (!data_file.open(data_file_path, true, page_io_direct())) {
             LOG_ERROR("[HASHING]: Arquivo de dados não pôde ser criado");
             throw std::runtime_error("ERRO: não foi possível criar o arquivo de dados");
         }
-        create_file.close();
 
-        // Reabrindo o arquivo para leitura e escrita
-        data_file.open(data_file_path, std::ios::in | std::ios::out | std::ios::binary);
-        if (!data_file.is_open()) {
-            LOG_ERROR("[HASHING]: Arquivo de dados não pôde ser reaberto");
-            throw std::runtime_error("ERRO: não foi possível reabrir o arquivo de dados");
+        file_header.magic = DATA_FILE_MAGIC;
+        file_header.format_version = DATA_FILE_FORMAT_VERSION;
+        file_header.page_size = static_cast<uint32_t>(PAGE_SIZE);
+        file_header.initial_buckets = INITIAL_BUCKETS;
+        write_file_header();
+
+        // só os buckets iniciais são criados, o resto aparece com os splits
+        for (uint32_t bucket = 0; bucket < INITIAL_BUCKETS; bucket++) {
+            long page = allocate_page();
+            write_block(page, DataBlock(PAGE_PRIMARY, bucket));
+            bucket_directory.push_back(static_cast<uint32_t>(page));
         }
 
         LOG_DEBUG("[HASHING]: Arquivo de dados criado com sucesso");
-
-        // Inicializando todos os blocos vazios
-        DataBlock empty_block{};
-        for (long i = 0; i < total_blocks; i++) {
-            write_block(i, empty_block);
+    } else {
+        if (!data_file.read(0, &file_header, sizeof(file_header))) {
+            file_header = DataFileHeader{};
+        }
+        check_file_header(file_header);
+        // o arquivo pode ter páginas reservadas além das usadas (ele cresce em pedaços)
+        long file_pages = data_file.size() / static_cast<long>(PAGE_SIZE) - 1;
+        allocated_pages = std::max(file_pages, static_cast<long>(file_header.total_pages));
+        if (!load_occupancy()) {
+            LOG_WARN("[HASHING]: Metadados dos buckets ausentes ou inconsistentes, reconstruindo a partir do arquivo de dados...");
+            rebuild_occupancy();
         }
-        data_file.flush();
     }
+
+    // marca o sidecar no disco como "em uso": se o processo morrer antes do destrutor, a próxima abertura reconstrói
+    save_occupancy(false);
 }
 
 //Fechando o arquivo
 HashingFile::~HashingFile() {
     LOG_DEBUG("[HASHING]: Tentando fechar arquivo de dados");
-    if (!block_cache.empty()) {
-        LOG_DEBUG("[HASHING]: Limpando cache antes de fechar o arquivo de dados");
-        flush_cache();
-    }
-    if (data_file.is_open()) {
-        data_file.close();
+    if (!read_only && wal != nullptr) {
+        // último commit; se ele falhar o arquivo fica no estado do commit anterior e o sidecar continua marcado como sujo
+        try {
+            commit();
+            wal->detach(wal_id);
+            save_occupancy(true);
+        } catch (const std::exception& e) {
+            LOG_ERROR("[HASHING]: Falha no commit final do arquivo de dados: " << e.what());
+        }
+    } else if (!read_only) {
+        LOG_DEBUG("[HASHING]: Gravando os blocos sujos do cache antes de fechar o arquivo de dados");
+        try {
+            flush_cache();
+            save_occupancy(true);
+        } catch (const std::exception& e) {
+            LOG_ERROR("[HASHING]: Falha ao gravar o arquivo de dados no destrutor: " << e.what());
+        }
     }
+    data_file.close();
     LOG_DEBUG("[HASHING]: Arquivo de dados fechado com sucesso");
 }
 
 f_ptr HashingFile::insert(const Artigo& new_artigo) {
-    //Calculando endereço do bloco inicial
-    long initial_block = hash_function(new_artigo.ID);
-    long current_block_num = initial_block;
+    if (read_only) {
+        LOG_ERROR("[HASHING]: Tentativa de inserir com o arquivo aberto somente para leitura");
+        throw std::runtime_error("ERRO: arquivo de dados aberto somente para leitura");
+    }
+    commit_if_due();
+    pending_inserts++;
+    size_t needed = DataBlock::space_needed(new_artigo);
 
-    for (int i = 0; i < total_blocks; i++) { 
-        DataBlock block = read_block(current_block_num); 
+    // os splits acontecem antes da inserção, assim o endereço devolvido já é o definitivo
+    file_header.used_bytes += static_cast<int64_t>(needed);
+    while (over_load_factor()) {
+        split_next_bucket();
+    }
 
-        if (block.record_count < RECORDS_PER_BLOCK) { //Achamos onde vamos inserir
-            int record_pos = block.record_count;
-            block.records[record_pos] = new_artigo;
-            block.record_count++;
-            write_block(current_block_num, block);
-            return (current_block_num * sizeof(DataBlock)) + (record_pos * sizeof(Artigo)); //Retornando o endereço exato onde inserimos 
-        } 
+    //Calculando o bucket e percorrendo as páginas dele só pelo mapa de ocupação, sem ler nenhuma
+    long bucket = hash_function(new_artigo.ID);
+    long page = bucket_directory[bucket];
+    long last_page = page;
+    while (page != 0) {
+        if (occupancy[page - 1] >= needed) { //Achamos onde vamos inserir
+            DataBlock block = read_block(page);
+            int slot = block.insert(new_artigo);
+            occupancy[page - 1] = static_cast<uint16_t>(block.free_space());
+            if (slot >= 0) {
+                write_block(page, block);
+                file_header.record_count++;
+                return make_record_ptr(page, slot); //Retornando a página e o slot onde inserimos
+            }
+        }
+        last_page = page;
+        page = page_links[page - 1];
+    }
 
-        //Se o bloco estiver cheio, tentamos inserir ao proximo bloco, se chegar no final de arquivo volta ao começo 
-        current_block_num = (current_block_num + 1) % total_blocks;
-        //Se voltamos ao bloco inicial, não temos mais espaço para inserir o novo arquivo
-        if (current_block_num == initial_block) {
-            LOG_ERROR("ERRO: Arquivo de dados está cheio!");
-            return -1;
+    //Nenhuma página do bucket tem espaço: acrescenta uma página de overflow no fim da lista
+    long new_page = allocate_page();
+    DataBlock overflow(PAGE_OVERFLOW, static_cast<uint32_t>(bucket));
+    int slot = overflow.insert(new_artigo);
+    if (slot < 0) {
+        file_header.used_bytes -= static_cast<int64_t>(needed);
+        LOG_ERROR("ERRO: Registro maior que uma pagina. ID: " << new_artigo.ID);
+        return -1;
+    }
+    write_block(new_page, overflow);
+    occupancy[new_page - 1] = static_cast<uint16_t>(overflow.free_space());
+
+    DataBlock previous = read_block(last_page);
+    previous.header.next_page = static_cast<uint32_t>(new_page);
+    write_block(last_page, previous);
+    page_links[last_page - 1] = static_cast<uint32_t>(new_page);
+
+    file_header.record_count++;
+    return make_record_ptr(new_page, slot);
+}
+
+f_ptr HashingFile::update_in_place(const Artigo& artigo) {
+    if (read_only) {
+        LOG_ERROR("[HASHING]: Tentativa de atualizar com o arquivo aberto somente para leitura");
+        throw std::runtime_error("ERRO: arquivo de dados aberto somente para leitura");
+    }
+    commit_if_due();
+    long bucket = hash_function(artigo.ID);
+    prefetch_blocks(bucket_pages(bucket));
+    for (long page = bucket_directory[bucket]; page != 0; page = page_links[page - 1]) {
+        DataBlock block = read_block(page);
+        for (int slot = 0; slot < block.record_count(); slot++) {
+            if (block.record_id(slot) != artigo.ID) continue;
+            size_t old_size = block.record_size(slot);
+            if (!block.replace(slot, artigo)) return -1;
+            pending_inserts++;
+            write_block(page, block);
+            occupancy[page - 1] = static_cast<uint16_t>(block.free_space());
+            file_header.used_bytes += static_cast<int64_t>(DataBlock::encoded_size(artigo)) - static_cast<int64_t>(old_size);
+            return make_record_ptr(page, slot);
+        }
+    }
+    return -1;
+}
+
+f_ptr HashingFile::update(const Artigo& artigo, f_ptr& old_ptr) {
+    old_ptr = update_in_place(artigo);
+    if (old_ptr != -1) return old_ptr;
+    Artigo removed;
+    old_ptr = remove(artigo.ID, removed);
+    if (old_ptr == -1) return -1;
+    return insert(artigo);
+}
+
+f_ptr HashingFile::remove(int id, Artigo& removed) {
+    if (read_only) {
+        LOG_ERROR("[HASHING]: Tentativa de remover com o arquivo aberto somente para leitura");
+        throw std::runtime_error("ERRO: arquivo de dados aberto somente para leitura");
+    }
+    commit_if_due();
+    long bucket = hash_function(id);
+    prefetch_blocks(bucket_pages(bucket));
+    for (long page = bucket_directory[bucket]; page != 0; page = page_links[page - 1]) {
+        DataBlock block = read_block(page);
+        for (int slot = 0; slot < block.record_count(); slot++) {
+            if (block.record_id(slot) != id || !block.read(slot, removed)) continue;
+            size_t size = block.record_size(slot);
+            block.erase(slot);
+            pending_inserts++;
+            write_block(page, block);
+            occupancy[page - 1] = static_cast<uint16_t>(block.free_space());
+            file_header.used_bytes -= static_cast<int64_t>(size); // a lápide continua ocupando o diretório
+            file_header.record_count--;
+            return make_record_ptr(page, slot);
         }
     }
-    return -1; //Falha na inserção
+    return -1;
 }
 
 Artigo HashingFile::find_by_id(int id, int& blocks_read) {
     blocks_read = 0;
-    long initial_block = hash_function(id);
-    long current_block_num = initial_block;
+    long bucket = hash_function(id);
+    long page = bucket_directory[bucket];
 
-    for (int i = 0; i < total_blocks; i++) { //Loop seguindo a mesma logica do insert
-        DataBlock block = read_block(current_block_num);
-        blocks_read++; 
+    // só as páginas do bucket da chave são lidas (sem mmap, todas num lote só)
+    if (!read_only) prefetch_blocks(bucket_pages(bucket));
+    DataBlock scratch;
+    for (long i = 0; page != 0 && i < file_header.total_pages; i++) {
+        const DataBlock& block = fetch_block(page, scratch); // no modo mmap não copia o bloco
+        blocks_read++;
 
-        for (int j = 0; j < block.record_count; j++) {
-            if (block.records[j].ID == id) { //Checa se o artigo está no bloco
-                return block.records[j];
+        for (int slot = 0; slot < block.record_count(); slot++) {
+            if (block.record_id(slot) == id) { //Checa se o artigo está no bloco (só o ID, sem decodificar os textos)
+                Artigo found;
+                if (block.read(slot, found)) return found;
             }
         }
+        page = block.header.next_page;
+    }
+
+    Artigo not_found_artigo;
+    not_found_artigo.ID = -1;
+    return not_found_artigo;
 
-    
-        if (block.record_count < RECORDS_PER_BLOCK) { //Artigo deveria estar nesse bloco
-            break;
+}
+
+bool HashingFile::read_record(f_ptr record_ptr, Artigo& out) {
+    long page = record_page(record_ptr);
+    if (record_ptr < 0 || page < 1 || page > file_header.total_pages) {
+        LOG_ERROR("[HASHING]: Ponteiro de registro invalido: " << record_ptr);
+        return false;
+    }
+
+    // no modo mmap o registro é decodificado direto da página mapeada,
+    // senão o bloco pode estar no cache com alterações que ainda não foram para o disco
+    DataBlock scratch;
+    const DataBlock& block = fetch_block(page, scratch);
+    if ((block.header.kind != PAGE_PRIMARY && block.header.kind != PAGE_OVERFLOW) ||
+        !block.read(record_slot(record_ptr), out)) {
+        LOG_ERROR("[HASHING]: Slot invalido no ponteiro de registro: " << record_ptr);
+        return false;
+    }
+    return true;
+}
+
+BatchReadStats HashingFile::read_records(std::vector<f_ptr> record_ptrs, const std::function<void(f_ptr, const Artigo&)>& visit) {
+    BatchReadStats stats;
+    std::sort(record_ptrs.begin(), record_ptrs.end());
+    record_ptrs.erase(std::unique(record_ptrs.begin(), record_ptrs.end()), record_ptrs.end());
+
+    // no modo mmap cada trecho de páginas vizinhas vira um único pedido de leitura antecipada,
+    // no modo leitura e escrita as páginas que não estão no cache são lidas em lotes de READ_BATCH
+    long run_first = -1, run_last = -1;
+    std::vector<long> pages;
+    for (f_ptr record_ptr : record_ptrs) {
+        long page = record_page(record_ptr);
+        if (record_ptr < 0 || page < 1 || page > file_header.total_pages) continue;
+        if (page == run_last) continue;
+        stats.pages++;
+        if (!read_only) pages.push_back(page);
+        if (page != run_last + 1) {
+            if (run_first != -1 && read_only) {
+                mapped_file.advise_range(page_offset(run_first), (run_last - run_first + 1) * PAGE_SIZE, MADV_WILLNEED);
+            }
+            run_first = page;
+            stats.runs++;
+        }
+        run_last = page;
+    }
+    if (run_first != -1 && read_only) {
+        mapped_file.advise_range(page_offset(run_first), (run_last - run_first + 1) * PAGE_SIZE, MADV_WILLNEED);
+    }
+
+    DataBlock scratch;
+    const DataBlock* block = nullptr;
+    long current_page = -1;
+    size_t page_index = 0, prefetched = 0;
+    Artigo artigo;
+    for (f_ptr record_ptr : record_ptrs) {
+        long page = record_page(record_ptr);
+        if (record_ptr < 0 || page < 1 || page > file_header.total_pages) {
+            LOG_ERROR("[HASHING]: Ponteiro de registro invalido: " << record_ptr);
+            continue;
+        }
+        if (page != current_page) { // a página só é lida quando muda
+            if (!read_only && page_index++ == prefetched) {
+                size_t end = std::min(pages.size(), prefetched + READ_BATCH);
+                prefetch_blocks(std::vector<long>(pages.begin() + prefetched, pages.begin() + end));
+                prefetched = end;
+            }
+            block = &fetch_block(page, scratch);
+            current_page = page;
+        }
+        if ((block->header.kind != PAGE_PRIMARY && block->header.kind != PAGE_OVERFLOW) ||
+            !block->read(record_slot(record_ptr), artigo)) {
+            LOG_ERROR("[HASHING]: Slot invalido no ponteiro de registro: " << record_ptr);
+            continue;
+        }
+        stats.records++;
+        visit(record_ptr, artigo);
+    }
+    return stats;
+}
+
+void HashingFile::for_each_record(const std::function<void(const Artigo&, f_ptr)>& visit) {
+    DataBlock scratch;
+    Artigo artigo;
+    for (long bucket = 0; bucket < get_bucket_count(); bucket++) {
+        if (!read_only) prefetch_blocks(bucket_pages(bucket));
+        long page = bucket_directory[bucket];
+        while (page != 0) {
+            const DataBlock& block = fetch_block(page, scratch);
+            for (int slot = 0; slot < block.record_count(); slot++) {
+                if (block.read(slot, artigo)) visit(artigo, make_record_ptr(page, slot));
+            }
+            page = block.header.next_page;
         }
-        
+    }
+}
+
+void HashingFile::scan_pages(long first_page, long end_page, const std::function<void(long, const DataBlock&)>& visit) {
+    if (!read_only) {
+        throw std::runtime_error("ERRO: scan_pages exige o arquivo de dados aberto somente para leitura.");
+    }
+    first_page = std::max(first_page, 1L);
+    end_page = std::min(end_page, static_cast<long>(file_header.total_pages) + 1);
+    if (first_page >= end_page) return;
+
+    // o trecho inteiro é pedido ao kernel de uma vez (leitura sequencial, sem esperar)
+    mapped_file.advise_range(page_offset(first_page), (end_page - first_page) * PAGE_SIZE, MADV_WILLNEED);
+    DataBlock scratch;
+    for (long page = first_page; page < end_page; page++) {
+        const DataBlock& block = fetch_block(page, scratch);
+        if (block.header.kind == PAGE_PRIMARY || block.header.kind == PAGE_OVERFLOW) visit(page, block);
+    }
+}
+
+//FUNÇÕES PRIVADAS
 
-        current_block_num = (current_block_num + 1) % total_blocks;
+// Divide o bucket next_split: os registros dele são redistribuídos entre ele e o bucket novo (next_split + n)
+// usando a função de hash do próximo nível. Só as páginas desse bucket são lidas e regravadas
+void HashingFile::split_next_bucket() {
+    long old_bucket = static_cast<long>(file_header.next_split);
+    long new_bucket = get_bucket_count();
 
-        if (current_block_num == initial_block) {
-            break; // Foi dado a volta no arquivo todo e ainda não achado
+    struct MovedRecord {
+        Artigo artigo;
+        f_ptr old_ptr;
+        f_ptr new_ptr;
+    };
+    std::vector<MovedRecord> records;
+    std::vector<long> old_pages = bucket_pages(old_bucket);
+    prefetch_blocks(old_pages);
+    for (long page : old_pages) {
+        DataBlock block = read_block(page);
+        for (int slot = 0; slot < block.record_count(); slot++) {
+            MovedRecord record;
+            if (block.read(slot, record.artigo)) {
+                record.old_ptr = make_record_ptr(page, slot);
+                records.push_back(record);
+            }
         }
     }
 
-    Artigo not_found_artigo;
-    not_found_artigo.ID = -1;
-    return not_found_artigo;
-    
+    // avança o ponteiro de split antes de redistribuir, assim hash_function já enxerga o bucket novo
+    file_header.next_split++;
+    if (file_header.next_split == static_cast<int64_t>(file_header.initial_buckets) << file_header.level) {
+        file_header.level++;
+        file_header.next_split = 0;
+    }
+    bucket_directory.push_back(0);
+
+    // monta as páginas de cada bucket em memória (first-fit), depois escolhe onde cada uma vai ficar
+    std::vector<DataBlock> blocks[2];
+    std::vector<std::pair<int, size_t>> placement(records.size()); // (bucket 0 = antigo / 1 = novo, página)
+    std::vector<int> slots(records.size());
+    for (size_t i = 0; i < records.size(); i++) {
+        int target = hash_function(records[i].artigo.ID) == old_bucket ? 0 : 1;
+        std::vector<DataBlock>& target_blocks = blocks[target];
+        long bucket = target == 0 ? old_bucket : new_bucket;
+        int slot = -1;
+        size_t index = 0;
+        for (; index < target_blocks.size() && slot < 0; index++) {
+            slot = target_blocks[index].insert(records[i].artigo);
+        }
+        if (slot < 0) {
+            target_blocks.emplace_back(target_blocks.empty() ? PAGE_PRIMARY : PAGE_OVERFLOW, static_cast<uint32_t>(bucket));
+            slot = target_blocks.back().insert(records[i].artigo);
+            index = target_blocks.size();
+        }
+        placement[i] = {target, index - 1};
+        slots[i] = slot;
+    }
+    // um bucket sem registros ainda precisa da página primária
+    for (int target = 0; target < 2; target++) {
+        if (blocks[target].empty()) {
+            blocks[target].emplace_back(PAGE_PRIMARY, static_cast<uint32_t>(target == 0 ? old_bucket : new_bucket));
+        }
+    }
+
+    // o bucket antigo reaproveita as próprias páginas e o novo recebe páginas alocadas
+    std::vector<long> pages[2];
+    for (size_t i = 0; i < blocks[0].size(); i++) {
+        pages[0].push_back(i < old_pages.size() ? old_pages[i] : allocate_page());
+    }
+    for (size_t i = 0; i < blocks[1].size(); i++) {
+        pages[1].push_back(allocate_page());
+    }
+    for (size_t i = blocks[0].size(); i < old_pages.size(); i++) {
+        free_page(old_pages[i]);
+    }
+
+    for (int target = 0; target < 2; target++) {
+        for (size_t i = 0; i < blocks[target].size(); i++) {
+            long page = pages[target][i];
+            long next = i + 1 < blocks[target].size() ? pages[target][i + 1] : 0;
+            blocks[target][i].header.next_page = static_cast<uint32_t>(next);
+            write_block(page, blocks[target][i]);
+            occupancy[page - 1] = static_cast<uint16_t>(blocks[target][i].free_space());
+            page_links[page - 1] = static_cast<uint32_t>(next);
+        }
+    }
+    bucket_directory[old_bucket] = static_cast<uint32_t>(pages[0][0]);
+    bucket_directory[new_bucket] = static_cast<uint32_t>(pages[1][0]);
+
+    if (relocation_listener) {
+        for (size_t i = 0; i < records.size(); i++) {
+            f_ptr new_ptr = make_record_ptr(pages[placement[i].first][placement[i].second], slots[i]);
+            if (new_ptr != records[i].old_ptr) relocation_listener(records[i].artigo, records[i].old_ptr, new_ptr);
+        }
+    }
 }
 
-//FUNÇÕES PRIVADAS 
+bool HashingFile::over_load_factor() const {
+    double capacity = static_cast<double>(get_bucket_count()) * EMPTY_PAGE_FREE_SPACE;
+    return static_cast<double>(file_header.used_bytes) > MAX_LOAD_FACTOR * capacity;
+}
 
-long HashingFile::hash_function(int key) { // Padrão da indústria, tenta gerar um número bastante único
-    return key % total_blocks;
+long HashingFile::allocate_page() {
+    if (file_header.free_page != 0) {
+        long page = static_cast<long>(file_header.free_page);
+        file_header.free_page = read_block(page).header.next_page;
+        page_links[page - 1] = 0;
+        occupancy[page - 1] = static_cast<uint16_t>(EMPTY_PAGE_FREE_SPACE);
+        return page;
+    }
+
+    long page = static_cast<long>(++file_header.total_pages);
+    if (page > allocated_pages) {
+        // cresce em pedaços (esparso): as páginas novas nunca são lidas antes de serem gravadas
+        allocated_pages += std::max(GROWTH_PAGES, allocated_pages / 8);
+        if (!data_file.resize(page_offset(allocated_pages + 1))) {
+            LOG_ERROR("[HASHING]: Falha ao aumentar o arquivo de dados para " << allocated_pages << " paginas");
+            throw std::runtime_error("ERRO: não foi possível aumentar o arquivo de dados");
+        }
+    }
+    page_links.push_back(0);
+    occupancy.push_back(static_cast<uint16_t>(EMPTY_PAGE_FREE_SPACE));
+    return page;
+}
+
+void HashingFile::free_page(long page_number) {
+    DataBlock block(PAGE_FREE, 0);
+    block.header.next_page = static_cast<uint32_t>(file_header.free_page);
+    write_block(page_number, block);
+    file_header.free_page = page_number;
+    page_links[page_number - 1] = 0;
+    occupancy[page_number - 1] = static_cast<uint16_t>(EMPTY_PAGE_FREE_SPACE);
+}
+
+// Carrega os metadados do sidecar, false se estiver ausente ou não bater com o arquivo de dados
+bool HashingFile::load_occupancy() {
+    std::ifstream occ_file(occupancy_path, std::ios::in | std::ios::binary);
+    OccupancyHeader header{};
+    if (!occ_file || !occ_file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        header.magic != OCCUPANCY_MAGIC || header.clean != 1 ||
+        header.total_pages != file_header.total_pages || header.bucket_count != expected_bucket_count()) {
+        return false;
+    }
+    bucket_directory.resize(header.bucket_count);
+    page_links.resize(header.total_pages);
+    occupancy.resize(header.total_pages);
+    if (!occ_file.read(reinterpret_cast<char*>(bucket_directory.data()), bucket_directory.size() * sizeof(uint32_t)) ||
+        !occ_file.read(reinterpret_cast<char*>(page_links.data()), page_links.size() * sizeof(uint32_t)) ||
+        !occ_file.read(reinterpret_cast<char*>(occupancy.data()), occupancy.size() * sizeof(uint16_t))) {
+        return false;
+    }
+    LOG_DEBUG("[HASHING]: Metadados dos buckets carregados de " << occupancy_path);
+    return true;
+}
+
+// Lê o cabeçalho de todas as páginas (só acontece quando o sidecar não é confiável)
+void HashingFile::rebuild_occupancy() {
+    long bucket_count = expected_bucket_count();
+    bucket_directory.assign(bucket_count, 0);
+    page_links.assign(file_header.total_pages, 0);
+    occupancy.assign(file_header.total_pages, static_cast<uint16_t>(EMPTY_PAGE_FREE_SPACE));
+    // sem mmap os cabeçalhos são lidos em lotes de READ_BATCH páginas (com O_DIRECT a página inteira)
+    AlignedArray<DataBlock> pages(READ_BATCH);
+    size_t read_length = data_file.is_direct() ? sizeof(DataBlock) : sizeof(PageHeader);
+    std::vector<PageRequest> requests;
+    for (long page = 1; page <= file_header.total_pages; page++) {
+        PageHeader page_header{};
+        if (read_only) {
+            std::memcpy(&page_header, mapped_file.data() + page_offset(page), sizeof(page_header));
+        } else {
+            size_t index = static_cast<size_t>(page - 1) % READ_BATCH;
+            if (index == 0) {
+                long count = std::min<long>(READ_BATCH, file_header.total_pages - page + 1);
+                requests.clear();
+                for (long i = 0; i < count; i++) {
+                    requests.push_back({page_offset(page + i), reinterpret_cast<char*>(&pages[i]), read_length});
+                }
+                if (!data_file.read_batch(requests)) break;
+            }
+            page_header = pages[index].header;
+        }
+        if (page_header.kind == PAGE_PRIMARY && page_header.bucket < static_cast<uint32_t>(bucket_count)) {
+            bucket_directory[page_header.bucket] = static_cast<uint32_t>(page);
+        }
+        if (page_header.kind == PAGE_PRIMARY || page_header.kind == PAGE_OVERFLOW) {
+            page_links[page - 1] = page_header.next_page;
+            occupancy[page - 1] = static_cast<uint16_t>(DataBlock::free_space(page_header));
+        }
+    }
+    for (long bucket = 0; bucket < bucket_count; bucket++) {
+        if (bucket_directory[bucket] == 0) {
+            LOG_ERROR("[HASHING]: Bucket " << bucket << " sem pagina primaria no arquivo de dados");
+            throw std::runtime_error("ERRO: arquivo de dados corrompido");
+        }
+    }
+}
+
+// Grava o sidecar inteiro, clean indica se os metadados correspondem ao arquivo de dados já gravado
+void HashingFile::save_occupancy(bool clean) {
+    std::ofstream occ_file(occupancy_path, std::ios::out | std::ios::binary | std::ios::trunc);
+    OccupancyHeader header{OCCUPANCY_MAGIC, clean ? 1u : 0u, file_header.total_pages, get_bucket_count()};
+    if (!occ_file.write(reinterpret_cast<const char*>(&header), sizeof(header)) ||
+        !occ_file.write(reinterpret_cast<const char*>(bucket_directory.data()), bucket_directory.size() * sizeof(uint32_t)) ||
+        !occ_file.write(reinterpret_cast<const char*>(page_links.data()), page_links.size() * sizeof(uint32_t)) ||
+        !occ_file.write(reinterpret_cast<const char*>(occupancy.data()), occupancy.size() * sizeof(uint16_t))) {
+        LOG_ERROR("[HASHING]: Falha ao gravar os metadados dos buckets " << occupancy_path);
+        throw std::runtime_error("ERRO: não foi possível gravar o mapa de ocupação");
+    }
 }
 
-DataBlock HashingFile::read_block(long block_number) {
+// Página 0: identifica o formato e guarda o estado do hashing linear
+void HashingFile::write_file_header() {
+    AlignedBuffer header_page(PAGE_SIZE); // página inteira zerada, o cabeçalho ocupa só o começo
+    std::memset(header_page.data(), 0, PAGE_SIZE);
+    std::memcpy(header_page.data(), &file_header, sizeof(file_header));
+    if (!data_file.write(0, header_page.data(), PAGE_SIZE)) {
+        LOG_ERROR("[HASHING]: Falha ao gravar o cabecalho do arquivo de dados");
+        throw std::runtime_error("ERRO: não foi possível gravar o cabeçalho do arquivo de dados");
+    }
+}
+
+// Recusa arquivos de outro formato (ex: o layout antigo com quantidade fixa de blocos)
+void HashingFile::check_file_header(const DataFileHeader& header) {
+    if (header.magic != DATA_FILE_MAGIC || header.format_version != DATA_FILE_FORMAT_VERSION ||
+        header.page_size != PAGE_SIZE || header.initial_buckets == 0 || header.total_pages <= 0) {
+        LOG_ERROR("[HASHING]: Arquivo de dados em formato desconhecido ou antigo (esperada versao "
+                  << DATA_FILE_FORMAT_VERSION << "), refaca o upload");
+        throw std::runtime_error("ERRO: formato do arquivo de dados incompatível");
+    }
+}
+
+long HashingFile::expected_bucket_count() const {
+    return (static_cast<long>(file_header.initial_buckets) << file_header.level) + static_cast<long>(file_header.next_split);
+}
+
+// Hashing linear: bucket = chave mod (n * 2^level), e os buckets já divididos nesta rodada usam o dobro
+long HashingFile::hash_function(int key) const {
+    uint64_t unsigned_key = static_cast<uint32_t>(key);
+    uint64_t round_buckets = static_cast<uint64_t>(file_header.initial_buckets) << file_header.level;
+    uint64_t bucket = unsigned_key % round_buckets;
+    if (bucket < static_cast<uint64_t>(file_header.next_split)) {
+        bucket = unsigned_key % (round_buckets * 2);
+    }
+    return static_cast<long>(bucket);
+}
+
+DataBlock HashingFile::read_block(long page_number) {
     // Procurando bloco no cache
-    auto it = block_cache.find(block_number);
+    const DataBlock* cached = block_cache.lookup(page_number);
     //Verificando se o bloco foi encontrado no cache
-    if (it != block_cache.end()) { 
-        return it->second; // Retorna o bloco diretamente da memória
+    if (cached != nullptr) {
+        return *cached; // Retorna o bloco diretamente da memória
     }
 
     //Se o bloco não está no cache precisamos ler ele do arquivo
-    DataBlock block;
-    f_ptr offset = block_number * sizeof(DataBlock);
-    data_file.seekg(offset);
-    data_file.read(reinterpret_cast<char*>(&block), sizeof(DataBlock));
+    alignas(PAGE_IO_ALIGNMENT) DataBlock block; // alinhado para o O_DIRECT ler direto nele
+    if (!data_file.read(page_offset(page_number), &block, sizeof(DataBlock))) {
+        LOG_ERROR("[HASHING] Falha em ler o bloco " << page_number);
+        throw std::runtime_error("ERRO HASHING READ: Falha ao ler bloco");
+    }
 
+    block_cache.load(page_number, block); // se o cache estiver cheio, o CLOCK escolhe quem sai
     return block;
 }
 
-// Escreve todos os blocos dentro do cache de volta no disco
-void HashingFile::flush_cache() {
-    for (const auto& pair : block_cache) {
-        long block_number = pair.first; // Pegando o número do bloco
-        const DataBlock& block = pair.second; // Pegando para o bloco de dados
+const DataBlock& HashingFile::fetch_block(long page_number, DataBlock& scratch) {
+    if (read_only) {
+        return *reinterpret_cast<const DataBlock*>(mapped_file.data() + page_offset(page_number));
+    }
+    scratch = read_block(page_number);
+    return scratch;
+}
+
+void HashingFile::prefetch_blocks(const std::vector<long>& pages) {
+    if (read_only) return;
+    std::vector<long> missing;
+    for (long page : pages) {
+        if (!block_cache.contains(page)) missing.push_back(page);
+    }
+    if (missing.size() < 2) return; // uma página só vai pelo read_block normal
+    // sem passar da metade do cache, senão o próprio lote tiraria as primeiras páginas antes do uso
+    missing.resize(std::min(missing.size(), std::max<size_t>(2, block_cache.capacity_frames() / 2)));
+
+    AlignedArray<DataBlock> blocks(missing.size());
+    std::vector<PageRequest> requests;
+    requests.reserve(missing.size());
+    for (size_t i = 0; i < missing.size(); i++) {
+        requests.push_back({page_offset(missing[i]), reinterpret_cast<char*>(&blocks[i]), sizeof(DataBlock)});
+    }
+    if (!data_file.read_batch(requests)) {
+        LOG_ERROR("[HASHING] Falha em ler um lote de " << missing.size() << " blocos");
+        throw std::runtime_error("ERRO HASHING READ: Falha ao ler bloco");
+    }
+    for (size_t i = 0; i < missing.size(); i++) block_cache.load(missing[i], blocks[i]);
+}
+
+std::vector<long> HashingFile::bucket_pages(long bucket) const {
+    std::vector<long> pages;
+    for (long page = bucket_directory[bucket]; page != 0; page = page_links[page - 1]) pages.push_back(page);
+    return pages;
+}
+
+void HashingFile::attach_wal(WriteAheadLog& wal_log) {
+    if (read_only) {
+        LOG_ERROR("[HASHING]: Tentativa de ligar o log com o arquivo aberto somente para leitura");
+        throw std::runtime_error("ERRO: arquivo de dados aberto somente para leitura");
+    }
+    wal = &wal_log;
+    block_cache.set_hold_dirty(true);
+    wal_id = wal->attach([this] {
+        if (!data_file.sync()) throw std::runtime_error("ERRO: falha ao sincronizar o arquivo de dados");
+    });
+    pending_inserts = 0;
+    last_commit = std::chrono::steady_clock::now();
+}
+
+// o commit acontece entre duas operações, quando as páginas e o cabeçalho estão consistentes
+void HashingFile::commit_if_due() {
+    if (wal != nullptr && (wal->group_due(pending_inserts, last_commit) || block_cache.dirty_count() * 2 >= block_cache.capacity_frames())) {
+        commit();
+    }
+}
 
-        f_ptr offset = block_number * sizeof(DataBlock);
-        data_file.seekp(offset);
-        data_file.write(reinterpret_cast<const char*>(&block), sizeof(DataBlock));
+void HashingFile::commit() {
+    if (wal == nullptr) {
+        flush_cache();
+        return;
     }
+    AlignedBuffer header_page(PAGE_SIZE);
+    std::memset(header_page.data(), 0, PAGE_SIZE);
+    std::memcpy(header_page.data(), &file_header, sizeof(file_header));
+    std::vector<PageRequest> pages{{0, header_page.data(), PAGE_SIZE}};
+    for (const auto& entry : block_cache.dirty_pages()) {
+        pages.push_back({page_offset(entry.first), reinterpret_cast<char*>(const_cast<DataBlock*>(entry.second)), sizeof(DataBlock)});
+    }
+    wal->commit(data_file_path, pages, [this] { flush_cache(); });
+    pending_inserts = 0;
+    last_commit = std::chrono::steady_clock::now();
+}
 
-    data_file.flush();
-    block_cache.clear();
+// Escreve os blocos sujos do cache e o cabeçalho de volta no disco (o cache continua carregado)
+void HashingFile::flush_cache() {
+    block_cache.flush_all();
+    write_file_header();
 }
 
-void HashingFile::write_block(long block_number, const DataBlock& block) {
-    f_ptr offset = block_number * sizeof(DataBlock);
-    data_file.seekp(offset); // Posiciona o leitor de escritura
+void HashingFile::write_block(long page_number, const DataBlock& block) {
+    block_cache.put(page_number, block); // só marca como sujo, sem ir ao disco a cada inserção
+}
 
-    if (!data_file.write(reinterpret_cast<const char*>(&block), sizeof(DataBlock))) {
-        LOG_ERROR("[HASHING] Falha em escrever um bloco");
+// O lote vem do cache em ordem de página e vai para o disco de uma vez (io_uring quando disponível)
+void HashingFile::write_blocks_to_disk(const std::vector<std::pair<f_ptr, const DataBlock*>>& blocks) {
+    std::vector<PageRequest> requests;
+    requests.reserve(blocks.size());
+    for (const auto& entry : blocks) {
+        requests.push_back({page_offset(entry.first), reinterpret_cast<char*>(const_cast<DataBlock*>(entry.second)), sizeof(DataBlock)});
+    }
+    if (!data_file.write_batch(requests)) {
+        LOG_ERROR("[HASHING] Falha em escrever um lote de " << blocks.size() << " blocos");
         throw std::runtime_error ("ERRO HASHING WRITE: Falha ao escrever bloco ");
     }
-    data_file.flush(); 
-}
\ No newline at end of file
+}
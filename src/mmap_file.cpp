@@ -0,0 +1,68 @@
+#include "mmap_file.hpp"
+
+#include <stdexcept>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <algorithm>
+
+#include "log.hpp"
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+void MappedFile::open(const std::string& path) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        LOG_ERROR("[MMAP] Nao foi possivel abrir '" << path << "': " << std::strerror(errno));
+        throw std::runtime_error("ERRO: não foi possível abrir o arquivo '" + path + "' para leitura");
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        ::close(fd);
+        LOG_ERROR("[MMAP] Arquivo '" << path << "' vazio ou inacessivel");
+        throw std::runtime_error("ERRO: arquivo '" + path + "' vazio ou inacessível");
+    }
+
+    void* mapped = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd); // o mapeamento continua válido depois de fechar o descritor
+    if (mapped == MAP_FAILED) {
+        LOG_ERROR("[MMAP] Falha ao mapear '" << path << "': " << std::strerror(errno));
+        throw std::runtime_error("ERRO: falha ao mapear o arquivo '" + path + "' em memória");
+    }
+
+    base = static_cast<char*>(mapped);
+    length = static_cast<size_t>(info.st_size);
+    LOG_DEBUG("[MMAP] '" << path << "' mapeado (" << length << " bytes)");
+}
+
+void MappedFile::close() {
+    if (base != nullptr) {
+        munmap(base, length);
+        base = nullptr;
+        length = 0;
+    }
+}
+
+void MappedFile::advise(int advice) {
+    if (base == nullptr) return;
+    if (madvise(base, length, advice) != 0) {
+        LOG_DEBUG("[MMAP] madvise falhou: " << std::strerror(errno));
+    }
+}
+
+void MappedFile::advise_range(size_t offset, size_t range_length, int advice) {
+    if (base == nullptr || offset >= length) return;
+    // madvise exige endereço alinhado à página
+    static const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t start = offset - (offset % page);
+    size_t end = std::min(length, offset + range_length);
+    if (madvise(base + start, end - start, advice) != 0) {
+        LOG_DEBUG("[MMAP] madvise do trecho " << offset << " falhou: " << std::strerror(errno));
+    }
+}
@@ -0,0 +1,234 @@
+#include "node_search.hpp"
+
+#include <cstdlib>
+#include <string>
+#include <algorithm>
+
+#include "log.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define NODE_SEARCH_X86 1
+#include <immintrin.h>
+#endif
+
+using node_search_detail::key_before;
+using node_search_detail::binary_count;
+
+namespace {
+
+// laço original: compara chave por chave até achar a posição
+template <bool Upper, typename Key>
+int linear_count(const Key* keys, int n, Key key) {
+    int i = 0;
+    while (i < n && key_before<Upper>(keys[i], key)) {
+        i++;
+    }
+    return i;
+}
+
+#ifdef NODE_SEARCH_X86
+
+// busca binária sem desvios até sobrar uma janela de 'window' chaves e devolve o início da janela
+// as chaves antes da janela satisfazem o predicado e as depois dela não, então basta contar dentro dela
+// a janela é recuada quando passaria do fim do nó (as chaves a mais no começo também satisfazem o predicado)
+template <bool Upper, typename Key>
+inline const Key* narrow_window(const Key* keys, int n, Key key, int window) {
+    const Key* base = keys;
+    int len = n;
+    while (len > window) {
+        int half = len / 2;
+        base += key_before<Upper>(base[half], key) ? half : 0;
+        len -= half;
+    }
+    const Key* last = keys + n - window;
+    return base < last ? base : last;
+}
+
+// AVX2, int: janela de 16 chaves (2 vetores de 8)
+template <bool Upper>
+__attribute__((target("avx2,popcnt")))
+int avx2_count_int(const int* keys, int n, int key) {
+    if (n < 16) return binary_count<Upper>(keys, n, key);
+    const int* s = narrow_window<Upper>(keys, n, key, 16);
+    const __m256i k = _mm256_set1_epi32(key);
+    const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s));
+    const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + 8));
+    int base = static_cast<int>(s - keys);
+    if constexpr (Upper) { // conta as chaves > key e devolve o resto
+        unsigned mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(a, k)))
+                      | _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(b, k))) << 8;
+        return base + 16 - __builtin_popcount(mask);
+    } else {
+        unsigned mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(k, a)))
+                      | _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(k, b))) << 8;
+        return base + __builtin_popcount(mask);
+    }
+}
+
+// AVX2, long long: janela de 8 chaves (2 vetores de 4)
+template <bool Upper>
+__attribute__((target("avx2,popcnt")))
+int avx2_count_long(const long long* keys, int n, long long key) {
+    if (n < 8) return binary_count<Upper>(keys, n, key);
+    const long long* s = narrow_window<Upper>(keys, n, key, 8);
+    const __m256i k = _mm256_set1_epi64x(key);
+    const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s));
+    const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + 4));
+    int base = static_cast<int>(s - keys);
+    if constexpr (Upper) {
+        unsigned mask = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(a, k)))
+                      | _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(b, k))) << 4;
+        return base + 8 - __builtin_popcount(mask);
+    } else {
+        unsigned mask = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(k, a)))
+                      | _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(k, b))) << 4;
+        return base + __builtin_popcount(mask);
+    }
+}
+
+// SSE4.2, int: janela de 8 chaves (2 vetores de 4)
+template <bool Upper>
+__attribute__((target("sse4.2,popcnt")))
+int sse4_count_int(const int* keys, int n, int key) {
+    if (n < 8) return binary_count<Upper>(keys, n, key);
+    const int* s = narrow_window<Upper>(keys, n, key, 8);
+    const __m128i k = _mm_set1_epi32(key);
+    const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s));
+    const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 4));
+    int base = static_cast<int>(s - keys);
+    if constexpr (Upper) {
+        unsigned mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(a, k)))
+                      | _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(b, k))) << 4;
+        return base + 8 - __builtin_popcount(mask);
+    } else {
+        unsigned mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(k, a)))
+                      | _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(k, b))) << 4;
+        return base + __builtin_popcount(mask);
+    }
+}
+
+// SSE4.2, long long: janela de 4 chaves (2 vetores de 2, _mm_cmpgt_epi64 é do SSE4.2)
+template <bool Upper>
+__attribute__((target("sse4.2,popcnt")))
+int sse4_count_long(const long long* keys, int n, long long key) {
+    if (n < 4) return binary_count<Upper>(keys, n, key);
+    const long long* s = narrow_window<Upper>(keys, n, key, 4);
+    const __m128i k = _mm_set1_epi64x(key);
+    const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s));
+    const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 2));
+    int base = static_cast<int>(s - keys);
+    if constexpr (Upper) {
+        unsigned mask = _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(a, k)))
+                      | _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(b, k))) << 2;
+        return base + 4 - __builtin_popcount(mask);
+    } else {
+        unsigned mask = _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(k, a)))
+                      | _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(k, b))) << 2;
+        return base + __builtin_popcount(mask);
+    }
+}
+
+#endif // NODE_SEARCH_X86
+
+NodeSearchKernel active_kernel = NodeSearchKernel::BINARY;
+
+// kernel padrão: o mais largo que a CPU suporta
+NodeSearchKernel best_kernel() {
+    if (node_search_kernel_supported(NodeSearchKernel::AVX2)) return NodeSearchKernel::AVX2;
+    if (node_search_kernel_supported(NodeSearchKernel::SSE4)) return NodeSearchKernel::SSE4;
+    return NodeSearchKernel::BINARY;
+}
+
+// escolhe o kernel antes do main (NODE_SEARCH_KERNEL=linear|binary|sse4|avx2 força um deles)
+struct KernelSelector {
+    KernelSelector() {
+        NodeSearchKernel kernel = best_kernel();
+        const char* env = std::getenv("NODE_SEARCH_KERNEL");
+        if (env != nullptr) {
+            std::string name = trim(env);
+            std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+            bool found = false;
+            for (NodeSearchKernel k : {NodeSearchKernel::LINEAR, NodeSearchKernel::BINARY, NodeSearchKernel::SSE4, NodeSearchKernel::AVX2}) {
+                if (name == node_search_kernel_name(k)) {
+                    found = true;
+                    if (node_search_kernel_supported(k)) kernel = k;
+                    else LOG_WARN("NODE_SEARCH_KERNEL=" << name << " nao suportado nesta CPU. Usando " << node_search_kernel_name(kernel));
+                }
+            }
+            if (!found) LOG_WARN("NODE_SEARCH_KERNEL invalido ('" << env << "'). Usando " << node_search_kernel_name(kernel));
+        }
+        set_node_search_kernel(kernel);
+    }
+};
+KernelSelector kernel_selector;
+
+} // namespace
+
+namespace node_search_detail {
+// inicialização constante: valem mesmo antes do KernelSelector rodar
+int (*lower_int)(const int*, int, int) = binary_count<false, int>;
+int (*upper_int)(const int*, int, int) = binary_count<true, int>;
+int (*lower_long)(const long long*, int, long long) = binary_count<false, long long>;
+int (*upper_long)(const long long*, int, long long) = binary_count<true, long long>;
+} // namespace node_search_detail
+
+const char* node_search_kernel_name(NodeSearchKernel kernel) {
+    switch (kernel) {
+        case NodeSearchKernel::LINEAR: return "linear";
+        case NodeSearchKernel::BINARY: return "binary";
+        case NodeSearchKernel::SSE4:   return "sse4";
+        case NodeSearchKernel::AVX2:   return "avx2";
+    }
+    return "?";
+}
+
+bool node_search_kernel_supported(NodeSearchKernel kernel) {
+    switch (kernel) {
+        case NodeSearchKernel::LINEAR:
+        case NodeSearchKernel::BINARY:
+            return true;
+#ifdef NODE_SEARCH_X86
+        case NodeSearchKernel::SSE4:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("popcnt");
+        case NodeSearchKernel::AVX2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt");
+#endif
+        default:
+            return false;
+    }
+}
+
+NodeSearchKernel node_search_kernel() {
+    return active_kernel;
+}
+
+bool set_node_search_kernel(NodeSearchKernel kernel) {
+    if (!node_search_kernel_supported(kernel)) return false;
+    using namespace node_search_detail;
+    switch (kernel) {
+        case NodeSearchKernel::LINEAR:
+            lower_int = linear_count<false, int>;         upper_int = linear_count<true, int>;
+            lower_long = linear_count<false, long long>;  upper_long = linear_count<true, long long>;
+            break;
+        case NodeSearchKernel::BINARY:
+            lower_int = binary_count<false, int>;         upper_int = binary_count<true, int>;
+            lower_long = binary_count<false, long long>;  upper_long = binary_count<true, long long>;
+            break;
+#ifdef NODE_SEARCH_X86
+        case NodeSearchKernel::SSE4:
+            lower_int = sse4_count_int<false>;            upper_int = sse4_count_int<true>;
+            lower_long = sse4_count_long<false>;          upper_long = sse4_count_long<true>;
+            break;
+        case NodeSearchKernel::AVX2:
+            lower_int = avx2_count_int<false>;            upper_int = avx2_count_int<true>;
+            lower_long = avx2_count_long<false>;          upper_long = avx2_count_long<true>;
+            break;
+#endif
+        default:
+            return false;
+    }
+    active_kernel = kernel;
+    return true;
+}
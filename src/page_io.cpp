@@ -0,0 +1,397 @@
+#include "page_io.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+#include "log.hpp"
+
+// Anel do io_uring montado direto pelas syscalls (sem liburing): fila de submissão (SQ), fila de conclusão (CQ)
+// e o array de SQEs, os três mapeados do descritor do anel
+class IoRing {
+public:
+    explicit IoRing(unsigned entries) {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        ring_fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (ring_fd < 0) return;
+        // IORING_OP_READ/WRITE existem desde o 5.6, junto com IORING_FEAT_RW_CUR_POS
+        if (!(params.features & IORING_FEAT_RW_CUR_POS)) {
+            errno = ENOSYS;
+            release();
+            return;
+        }
+
+        sq_length = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_length = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single_mmap) sq_length = cq_length = std::max(sq_length, cq_length);
+
+        sq_ring = map(sq_length, IORING_OFF_SQ_RING);
+        cq_ring = single_mmap ? sq_ring : map(cq_length, IORING_OFF_CQ_RING);
+        sqe_length = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqe_area = map(sqe_length, IORING_OFF_SQES);
+        if (sq_ring == nullptr || cq_ring == nullptr || sqe_area == nullptr) {
+            if (sqe_area != nullptr) munmap(sqe_area, sqe_length);
+            release();
+            return;
+        }
+        separate_cq = !single_mmap;
+        sqes = static_cast<io_uring_sqe*>(sqe_area);
+
+        char* sq = static_cast<char*>(sq_ring);
+        sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sq_mask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        char* cq = static_cast<char*>(cq_ring);
+        cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cq_mask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        depth = params.sq_entries;
+    }
+
+    ~IoRing() {
+        if (sqes != nullptr) munmap(sqes, sqe_length);
+        release();
+    }
+
+    IoRing(const IoRing&) = delete;
+    IoRing& operator=(const IoRing&) = delete;
+
+    bool ok() const { return sqes != nullptr; }
+    unsigned get_depth() const { return depth; }
+
+    // coloca os pedidos (count <= depth) na fila, envia e espera todos terminarem
+    // results[i] recebe o retorno do pedido i (bytes transferidos ou -errno); false se o próprio anel falhou
+    bool submit_and_wait(int fd, const PageRequest* requests, size_t count, bool write, int* results, long& submissions) {
+        unsigned tail = *sq_tail; // só este processo escreve no tail da SQ
+        for (size_t i = 0; i < count; ++i) {
+            unsigned index = tail & sq_mask;
+            io_uring_sqe* sqe = &sqes[index];
+            std::memset(sqe, 0, sizeof(*sqe));
+            sqe->opcode = write ? IORING_OP_WRITE : IORING_OP_READ;
+            sqe->fd = fd;
+            sqe->off = static_cast<uint64_t>(requests[i].offset);
+            sqe->addr = reinterpret_cast<uint64_t>(requests[i].buffer);
+            sqe->len = static_cast<uint32_t>(requests[i].length);
+            sqe->user_data = i;
+            sq_array[index] = index;
+            tail++;
+        }
+        __atomic_store_n(sq_tail, tail, __ATOMIC_RELEASE); // o kernel só enxerga as SQEs depois de preenchidas
+
+        size_t submitted = 0, completed = 0;
+        while (completed < count) {
+            unsigned to_submit = static_cast<unsigned>(count - submitted);
+            unsigned wait_for = static_cast<unsigned>(count - completed);
+            long ret = syscall(__NR_io_uring_enter, ring_fd, to_submit, wait_for, IORING_ENTER_GETEVENTS, nullptr, 0);
+            if (ret < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            submitted += static_cast<size_t>(ret);
+            submissions++;
+
+            unsigned head = *cq_head;
+            unsigned ready = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+            for (; head != ready; ++head) {
+                const io_uring_cqe& cqe = cqes[head & cq_mask];
+                results[cqe.user_data] = cqe.res;
+                completed++;
+            }
+            __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+        }
+        return true;
+    }
+
+private:
+    int ring_fd = -1;
+    void* sq_ring = nullptr;
+    void* cq_ring = nullptr;
+    size_t sq_length = 0, cq_length = 0, sqe_length = 0;
+    bool separate_cq = false;
+    io_uring_sqe* sqes = nullptr;
+    unsigned* sq_tail = nullptr;
+    unsigned* sq_array = nullptr;
+    unsigned sq_mask = 0;
+    unsigned* cq_head = nullptr;
+    unsigned* cq_tail = nullptr;
+    unsigned cq_mask = 0;
+    io_uring_cqe* cqes = nullptr;
+    unsigned depth = 0;
+
+    void* map(size_t length, off_t offset) {
+        void* area = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, offset);
+        return area == MAP_FAILED ? nullptr : area;
+    }
+
+    void release() {
+        if (cq_ring != nullptr && separate_cq) munmap(cq_ring, cq_length);
+        if (sq_ring != nullptr) munmap(sq_ring, sq_length);
+        sq_ring = cq_ring = nullptr;
+        sqes = nullptr;
+        if (ring_fd >= 0) ::close(ring_fd);
+        ring_fd = -1;
+    }
+};
+
+namespace {
+
+// PAGE_IO=uring|sync escolhe o backend dos lotes, PAGE_IO_DEPTH a quantidade de pedidos em voo
+// e PAGE_IO_DIRECT=1 liga o O_DIRECT. A escolha acontece no primeiro uso: os programas que só leem
+// por mmap nem chegam a criar um anel
+struct PageIoConfig {
+    bool use_uring = false;
+    bool direct = false;
+    unsigned depth = 64;
+
+    PageIoConfig() {
+        const char* direct_env = std::getenv("PAGE_IO_DIRECT");
+        if (direct_env != nullptr) {
+            std::string value = trim(direct_env);
+            if (value == "1") direct = true;
+            else if (value != "0") LOG_WARN("PAGE_IO_DIRECT invalido ('" << direct_env << "'). Usando 0");
+        }
+        const char* depth_env = std::getenv("PAGE_IO_DEPTH");
+        if (depth_env != nullptr) {
+            int value = std::atoi(depth_env);
+            if (value >= 1 && value <= 4096) depth = static_cast<unsigned>(value);
+            else LOG_WARN("PAGE_IO_DEPTH invalido ('" << depth_env << "'). Usando o padrao de " << depth);
+        }
+        const char* env = std::getenv("PAGE_IO");
+        std::string wanted = (env != nullptr) ? trim(env) : "uring";
+        if (wanted != "uring" && wanted != "sync") {
+            LOG_WARN("PAGE_IO invalido ('" << env << "'). Usando o padrao");
+            wanted = "uring";
+        }
+        if (wanted == "sync") return;
+        IoRing probe(depth);
+        use_uring = probe.ok();
+        if (!use_uring) {
+            LOG_DEBUG("[PAGE_IO] io_uring indisponivel (" << std::strerror(errno) << "). Usando pread/pwrite");
+            if (env != nullptr) LOG_WARN("PAGE_IO=uring nao suportado neste kernel. Usando sync");
+        }
+    }
+};
+
+const PageIoConfig& page_io_config() {
+    static const PageIoConfig config;
+    return config;
+}
+
+} // namespace
+
+const char* page_io_backend() {
+    return page_io_config().use_uring ? "io_uring" : "sync";
+}
+
+unsigned page_io_depth() {
+    return page_io_config().depth;
+}
+
+bool page_io_direct() {
+    return page_io_config().direct;
+}
+
+PageFile::PageFile() = default;
+
+PageFile::~PageFile() {
+    close();
+}
+
+bool PageFile::open(const std::string& path, bool create, bool use_direct) {
+    close();
+    int flags = O_RDWR | O_CLOEXEC;
+    if (create) flags |= O_CREAT | O_TRUNC;
+    direct = false;
+    if (use_direct) {
+        fd = ::open(path.c_str(), flags | O_DIRECT, 0644);
+        if (fd >= 0) {
+            direct = true;
+            return true;
+        }
+        if (errno != EINVAL) {
+            LOG_DEBUG("[PAGE_IO] Nao foi possivel abrir '" << path << "': " << std::strerror(errno));
+            return false;
+        }
+        // EINVAL: o sistema de arquivos não aceita O_DIRECT (tmpfs, por exemplo)
+        LOG_WARN("[PAGE_IO] O_DIRECT nao suportado para '" << path << "'. Usando o cache do kernel");
+    }
+    fd = ::open(path.c_str(), flags, 0644);
+    if (fd < 0) {
+        LOG_DEBUG("[PAGE_IO] Nao foi possivel abrir '" << path << "': " << std::strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+void PageFile::close() {
+    ring.reset();
+    if (fd >= 0) ::close(fd);
+    fd = -1;
+}
+
+bool PageFile::read(long offset, void* buffer, size_t length) {
+    stats.reads++;
+    return transfer(PageRequest{offset, static_cast<char*>(buffer), length}, 0, false);
+}
+
+bool PageFile::write(long offset, const void* buffer, size_t length) {
+    stats.writes++;
+    return transfer(PageRequest{offset, static_cast<char*>(const_cast<void*>(buffer)), length}, 0, true);
+}
+
+bool PageFile::read_batch(const std::vector<PageRequest>& requests) {
+    return run_batch(requests, false);
+}
+
+bool PageFile::write_batch(const std::vector<PageRequest>& requests) {
+    return run_batch(requests, true);
+}
+
+long PageFile::size() const {
+    struct stat info;
+    if (fd < 0 || fstat(fd, &info) != 0) return -1;
+    return static_cast<long>(info.st_size);
+}
+
+bool PageFile::resize(long new_size) {
+    return fd >= 0 && ftruncate(fd, static_cast<off_t>(new_size)) == 0;
+}
+
+bool PageFile::sync() {
+    return fd >= 0 && fdatasync(fd) == 0;
+}
+
+// pedidos isolados vão direto por pread/pwrite; lotes vão pelo anel em grupos de até 'depth' pedidos
+bool PageFile::run_batch(const std::vector<PageRequest>& requests, bool write) {
+    (write ? stats.writes : stats.reads) += static_cast<long>(requests.size());
+    if (requests.empty()) return true;
+    if (requests.size() == 1) return transfer(requests[0], 0, write);
+    stats.batches++;
+
+    if (ring == nullptr && !ring_failed && page_io_config().use_uring) {
+        ring = std::make_unique<IoRing>(page_io_config().depth);
+        if (!ring->ok()) {
+            LOG_DEBUG("[PAGE_IO] Falha ao criar o anel do io_uring: " << std::strerror(errno));
+            ring.reset();
+            ring_failed = true;
+        }
+    }
+
+    bool ok = true;
+    if (ring == nullptr) {
+        for (const PageRequest& request : requests) ok = transfer(request, 0, write) && ok;
+        return ok;
+    }
+
+    // com O_DIRECT os pedidos desalinhados não podem ir para o anel, passam pelo buffer alinhado
+    const std::vector<PageRequest>* queued = &requests;
+    std::vector<PageRequest> aligned_requests;
+    if (direct) {
+        for (const PageRequest& request : requests) {
+            if (aligned(request)) aligned_requests.push_back(request);
+            else ok = transfer_unaligned(request, write) && ok;
+        }
+        queued = &aligned_requests;
+    }
+
+    std::vector<int> results;
+    for (size_t first = 0; first < queued->size(); first += ring->get_depth()) {
+        size_t count = std::min<size_t>(ring->get_depth(), queued->size() - first);
+        results.assign(count, 0);
+        if (!ring->submit_and_wait(fd, &(*queued)[first], count, write, results.data(), stats.submissions)) {
+            LOG_WARN("[PAGE_IO] io_uring falhou (" << std::strerror(errno) << "). Usando pread/pwrite neste arquivo");
+            ring.reset();
+            ring_failed = true;
+            for (size_t i = first; i < queued->size(); ++i) ok = transfer((*queued)[i], 0, write) && ok;
+            return ok;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            const PageRequest& request = (*queued)[first + i];
+            if (results[i] == static_cast<int>(request.length)) continue;
+            // transferência curta ou interrompida: o resto do pedido vai por pread/pwrite
+            ok = transfer(request, results[i] > 0 ? static_cast<size_t>(results[i]) : 0, write) && ok;
+        }
+    }
+    return ok;
+}
+
+bool PageFile::aligned(const PageRequest& request) const {
+    return (static_cast<size_t>(request.offset) | request.length | reinterpret_cast<uintptr_t>(request.buffer))
+           % PAGE_IO_ALIGNMENT == 0;
+}
+
+bool PageFile::transfer(const PageRequest& request, size_t done, bool write) {
+    if (fd < 0) return false;
+    while (done < request.length) {
+        if (direct) {
+            PageRequest rest{request.offset + static_cast<long>(done), request.buffer + done, request.length - done};
+            if (!aligned(rest)) return transfer_unaligned(rest, write);
+        }
+        ssize_t n = write
+            ? ::pwrite(fd, request.buffer + done, request.length - done, static_cast<off_t>(request.offset + done))
+            : ::pread(fd, request.buffer + done, request.length - done, static_cast<off_t>(request.offset + done));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        if (n == 0) return false; // fim do arquivo
+        done += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// O_DIRECT com pedido desalinhado: o trecho de páginas alinhadas que contém o pedido é lido no buffer alinhado;
+// na leitura a parte pedida é copiada, na escrita ela é sobreposta e o trecho inteiro é regravado
+bool PageFile::transfer_unaligned(const PageRequest& request, bool write) {
+    long start = request.offset / static_cast<long>(PAGE_IO_ALIGNMENT) * static_cast<long>(PAGE_IO_ALIGNMENT);
+    long end = request.offset + static_cast<long>(request.length);
+    long aligned_end = (end + static_cast<long>(PAGE_IO_ALIGNMENT) - 1) / static_cast<long>(PAGE_IO_ALIGNMENT)
+                       * static_cast<long>(PAGE_IO_ALIGNMENT);
+    size_t span = static_cast<size_t>(aligned_end - start);
+    bounce.reserve(span);
+
+    // o fim do arquivo pode cortar a última página do trecho
+    size_t got = 0;
+    while (got < span) {
+        ssize_t n = ::pread(fd, bounce.data() + got, span - got, static_cast<off_t>(start + static_cast<long>(got)));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        if (n == 0) break;
+        got += static_cast<size_t>(n);
+        if (got % PAGE_IO_ALIGNMENT != 0) break; // só o fim do arquivo deixa a leitura desalinhada
+    }
+    size_t offset_in_span = static_cast<size_t>(request.offset - start);
+    if (!write) {
+        if (got < offset_in_span + request.length) return false;
+        std::memcpy(request.buffer, bounce.data() + offset_in_span, request.length);
+        return true;
+    }
+
+    std::memset(bounce.data() + got, 0, span - got);
+    std::memcpy(bounce.data() + offset_in_span, request.buffer, request.length);
+    long old_size = size();
+    for (size_t written = 0; written < span;) {
+        ssize_t n = ::pwrite(fd, bounce.data() + written, span - written, static_cast<off_t>(start + static_cast<long>(written)));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        written += static_cast<size_t>(n);
+    }
+    // a regravação da página inteira não pode deixar o arquivo maior do que a escrita pedida deixaria
+    if (aligned_end > old_size && ftruncate(fd, static_cast<off_t>(std::max(old_size, end))) != 0) return false;
+    return true;
+}
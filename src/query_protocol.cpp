@@ -0,0 +1,221 @@
+#include "query_protocol.hpp"
+
+#include <cstring>
+#include <cstdlib>
+#include <cerrno>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "data_page.hpp" // encode_record / decode_record
+#include "log.hpp"
+
+namespace {
+
+template <typename T>
+void append_value(std::vector<unsigned char>& out, T value) {
+    size_t at = out.size();
+    out.resize(at + sizeof(T));
+    std::memcpy(out.data() + at, &value, sizeof(T));
+}
+
+template <typename T>
+bool take_value(const std::vector<unsigned char>& in, size_t& pos, T& value) {
+    if (pos + sizeof(T) > in.size()) return false;
+    std::memcpy(&value, in.data() + pos, sizeof(T));
+    pos += sizeof(T);
+    return true;
+}
+
+// escreve/lê exatamente 'length' bytes
+bool write_all(int fd, const unsigned char* data, size_t length) {
+    while (length > 0) {
+        ssize_t sent = ::send(fd, data, length, MSG_NOSIGNAL); // sem SIGPIPE se o outro lado fechou
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent <= 0) return false;
+        data += sent;
+        length -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+bool read_all(int fd, unsigned char* data, size_t length) {
+    while (length > 0) {
+        ssize_t received = ::recv(fd, data, length, 0);
+        if (received < 0 && errno == EINTR) continue;
+        if (received <= 0) return false;
+        data += received;
+        length -= static_cast<size_t>(received);
+    }
+    return true;
+}
+
+} // namespace
+
+std::vector<unsigned char> encode_request(const QueryRequest& request) {
+    std::vector<unsigned char> out;
+    append_value<uint8_t>(out, static_cast<uint8_t>(request.op));
+    if (request.op == QueryOp::FIND_BY_TITLE) {
+        out.insert(out.end(), request.titulo.begin(), request.titulo.end());
+    } else {
+        append_value<int32_t>(out, request.id);
+    }
+    return out;
+}
+
+bool decode_request(const std::vector<unsigned char>& frame, QueryRequest& out) {
+    size_t pos = 0;
+    uint8_t op;
+    if (!take_value(frame, pos, op)) return false;
+    out.op = static_cast<QueryOp>(op);
+    switch (out.op) {
+        case QueryOp::FIND_BY_ID_HASH:
+        case QueryOp::FIND_BY_ID_INDEX: {
+            int32_t id;
+            if (!take_value(frame, pos, id) || pos != frame.size()) return false;
+            out.id = id;
+            return true;
+        }
+        case QueryOp::FIND_BY_TITLE:
+            out.titulo.assign(frame.begin() + pos, frame.end());
+            return true;
+    }
+    return false;
+}
+
+std::vector<unsigned char> encode_response(const QueryResponse& response) {
+    std::vector<unsigned char> out;
+    append_value<uint8_t>(out, static_cast<uint8_t>(response.status));
+    append_value<int32_t>(out, response.blocks_read);
+    append_value<int64_t>(out, response.total_blocks);
+    if (response.status == QueryStatus::FOUND) {
+        append_value<uint32_t>(out, static_cast<uint32_t>(response.artigos.size()));
+        for (const Artigo& artigo : response.artigos) {
+            uint32_t length = static_cast<uint32_t>(DataBlock::encoded_size(artigo));
+            append_value<uint32_t>(out, length);
+            size_t at = out.size();
+            out.resize(at + length);
+            encode_record(artigo, out.data() + at);
+        }
+    } else if (response.status == QueryStatus::ERROR) {
+        out.insert(out.end(), response.error.begin(), response.error.end());
+    }
+    return out;
+}
+
+bool decode_response(const std::vector<unsigned char>& frame, QueryResponse& out) {
+    size_t pos = 0;
+    uint8_t status;
+    int32_t blocks_read;
+    int64_t total_blocks;
+    if (!take_value(frame, pos, status) || !take_value(frame, pos, blocks_read) || !take_value(frame, pos, total_blocks)) {
+        return false;
+    }
+    out.status = static_cast<QueryStatus>(status);
+    out.blocks_read = blocks_read;
+    out.total_blocks = static_cast<long>(total_blocks);
+    switch (out.status) {
+        case QueryStatus::FOUND: {
+            uint32_t count;
+            if (!take_value(frame, pos, count) || count == 0) return false;
+            out.artigos.clear();
+            for (uint32_t i = 0; i < count; i++) {
+                uint32_t length;
+                if (!take_value(frame, pos, length) || pos + length > frame.size()) return false;
+                out.artigos.emplace_back();
+                if (!decode_record(frame.data() + pos, length, out.artigos.back())) return false;
+                pos += length;
+            }
+            return pos == frame.size();
+        }
+        case QueryStatus::ERROR:
+            out.error.assign(frame.begin() + pos, frame.end());
+            return true;
+        case QueryStatus::NOT_FOUND:
+            return pos == frame.size();
+    }
+    return false;
+}
+
+bool send_frame(int fd, const std::vector<unsigned char>& payload) {
+    uint32_t length = static_cast<uint32_t>(payload.size());
+    return write_all(fd, reinterpret_cast<const unsigned char*>(&length), sizeof(length)) &&
+           write_all(fd, payload.data(), payload.size());
+}
+
+bool recv_frame(int fd, std::vector<unsigned char>& payload, uint32_t max_length) {
+    uint32_t length;
+    if (!read_all(fd, reinterpret_cast<unsigned char*>(&length), sizeof(length))) return false;
+    if (length > max_length) {
+        LOG_WARN("Quadro de " << length << " bytes recusado (maximo " << max_length << ")");
+        return false;
+    }
+    payload.resize(length);
+    return read_all(fd, payload.data(), length);
+}
+
+std::string default_socket_path(const std::string& data_dir) {
+    const char* env = std::getenv("DBSERVER_SOCKET");
+    if (env != nullptr && *env != '\0') return env;
+    return data_dir + "/dbserver.sock";
+}
+
+QueryClient::~QueryClient() {
+    close();
+}
+
+bool QueryClient::connect(const std::string& socket_path) {
+    close();
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(address.sun_path)) {
+        LOG_ERROR("Caminho do socket muito longo: " << socket_path);
+        return false;
+    }
+    std::strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+
+    fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return false;
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+QueryResponse QueryClient::query(const QueryRequest& request) {
+    std::vector<unsigned char> frame;
+    QueryResponse response;
+    if (fd < 0 || !send_frame(fd, encode_request(request)) || !recv_frame(fd, frame, MAX_RESPONSE_FRAME) || !decode_response(frame, response)) {
+        LOG_ERROR("Falha na comunicacao com o dbserver");
+        throw std::runtime_error("ERRO: conexão com o dbserver perdida.");
+    }
+    return response;
+}
+
+void QueryClient::close() {
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+bool forward_to_server(const QueryRequest& request, QueryResponse& out) {
+    const char* socket_path = std::getenv("DBSERVER_SOCKET");
+    if (socket_path == nullptr || *socket_path == '\0') return false;
+
+    QueryClient client;
+    if (!client.connect(socket_path)) {
+        LOG_WARN("dbserver nao encontrado em " << socket_path << ". Fazendo a busca direto nos arquivos");
+        return false;
+    }
+    try {
+        out = client.query(request);
+    } catch (const std::runtime_error&) {
+        LOG_WARN("Fazendo a busca direto nos arquivos");
+        return false;
+    }
+    LOG_DEBUG("Busca respondida pelo dbserver em " << socket_path);
+    return true;
+}
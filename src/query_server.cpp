@@ -0,0 +1,99 @@
+#include "query_server.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+#include "log.hpp"
+
+QueryDatabase::QueryDatabase(const std::string& data_dir)
+    : data_file(data_dir + "/data_file.dat", OpenMode::READ_ONLY),
+      primary_index(data_dir + "/primary_index.idx", OpenMode::READ_ONLY),
+      secondary_index(data_dir + "/secondary_index.idx", OpenMode::READ_ONLY) {}
+
+QueryResponse QueryDatabase::answer(const QueryRequest& request) {
+    QueryResponse response;
+    switch (request.op) {
+        case QueryOp::FIND_BY_ID_HASH: {
+            Artigo artigo = data_file.find_by_id(request.id, response.blocks_read);
+            response.total_blocks = data_file.get_total_blocks();
+            response.status = (artigo.ID != -1) ? QueryStatus::FOUND : QueryStatus::NOT_FOUND;
+            if (response.status == QueryStatus::FOUND) response.artigos.push_back(artigo);
+            break;
+        }
+        case QueryOp::FIND_BY_ID_INDEX: {
+            f_ptr data_ptr = primary_index.search(request.id, response.blocks_read);
+            response.total_blocks = primary_index.get_total_blocks();
+            Artigo artigo;
+            response.status = read_record(data_ptr, artigo, response);
+            if (response.status == QueryStatus::FOUND) response.artigos.push_back(artigo);
+            break;
+        }
+        case QueryOp::FIND_BY_TITLE: {
+            // mesmo truncamento do seek2; percorre todas as postagens do hash e lê só as de impressão igual,
+            // respondendo com todos os registros cujo título confere (títulos repetidos trazem vários)
+            char titulo[301];
+            std::strncpy(titulo, request.titulo.c_str(), 300);
+            titulo[300] = '\0';
+            long long hash = hash_string_to_long(titulo);
+            uint16_t fingerprint = title_fingerprint(titulo);
+            response.status = QueryStatus::NOT_FOUND;
+            long index_blocks = secondary_index.scan(hash, hash, [&](long long, f_ptr posting) {
+                if (!title_posting_matches(posting, fingerprint)) return true;
+                Artigo artigo;
+                QueryStatus status = read_record(title_posting_ptr(posting), artigo, response);
+                if (status == QueryStatus::ERROR) {
+                    response.status = status;
+                    response.artigos.clear();
+                    return false;
+                }
+                if (status == QueryStatus::FOUND && std::strcmp(artigo.Titulo, titulo) != 0) {
+                    LOG_DEBUG("Colisao de hash no indice secundario para \"" << titulo << "\"");
+                    return true;
+                }
+                response.status = status;
+                response.artigos.push_back(artigo);
+                return true;
+            });
+            response.blocks_read = static_cast<int>(index_blocks);
+            response.total_blocks = secondary_index.get_total_blocks();
+            break;
+        }
+        default:
+            response.status = QueryStatus::ERROR;
+            response.error = "operacao desconhecida";
+    }
+    return response;
+}
+
+QueryStatus QueryDatabase::read_record(f_ptr data_ptr, Artigo& out, QueryResponse& response) {
+    if (data_ptr == -1) return QueryStatus::NOT_FOUND;
+    if (!data_file.read_record(data_ptr, out)) {
+        response.error = "falha ao ler o registro no offset " + std::to_string(data_ptr);
+        return QueryStatus::ERROR;
+    }
+    return QueryStatus::FOUND;
+}
+
+void serve_connection(int fd, QueryDatabase& database, ServerStats& stats) {
+    std::vector<unsigned char> frame;
+    while (recv_frame(fd, frame)) {
+        QueryRequest request;
+        QueryResponse response;
+        if (!decode_request(frame, request)) {
+            response.status = QueryStatus::ERROR;
+            response.error = "pedido invalido";
+        } else {
+            try {
+                response = database.answer(request);
+            } catch (const std::exception& e) {
+                response = QueryResponse();
+                response.status = QueryStatus::ERROR;
+                response.error = e.what();
+            }
+        }
+        stats.requests++;
+        if (response.status == QueryStatus::FOUND) stats.found++;
+        if (response.status == QueryStatus::ERROR) stats.errors++;
+        if (!send_frame(fd, encode_response(response))) break;
+    }
+}
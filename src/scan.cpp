@@ -0,0 +1,420 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <stdexcept>
+#include <cstdlib>
+#include <climits>
+#include <chrono>
+#include <iomanip>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <unordered_map>
+#include <cstring>
+#include <filesystem>
+
+#include "record.hpp"
+#include "hashing.hpp"
+#include "column_store.hpp"
+#include "pipeline.hpp"
+#include "log.hpp"
+
+// scan: consulta com filtros e agregações sobre o arquivo de dados inteiro, sem índice
+// As páginas são lidas em ordem física por várias threads: cada uma pega o próximo trecho de SCAN_CHUNK_PAGES
+// páginas, avalia os filtros direto nos bytes da página (números primeiro, textos só se os números passarem)
+// e acumula um estado parcial próprio; os estados são juntados no final
+// Com as colunas do upload --columns (columns.dat) os filtros numéricos rodam nas colunas com kernels vetoriais
+// e só os registros selecionados são lidos do arquivo de dados (nenhum, se não houver filtro de texto)
+
+const long SCAN_CHUNK_PAGES = 1024; // 4 MiB por trecho
+const int DEFAULT_TOP_K = 0;        // sem --top não há ranking
+
+// Faixa inclusiva de um filtro numérico ("A", "A:B", "A:" ou ":B")
+struct IntRange {
+    long long lo = LLONG_MIN;
+    long long hi = LLONG_MAX;
+
+    bool contains(long long value) const { return value >= lo && value <= hi; }
+    bool active() const { return lo != LLONG_MIN || hi != LLONG_MAX; }
+};
+
+bool parse_range(const std::string& text, IntRange& out) {
+    try {
+        size_t colon = text.find(':');
+        if (colon == std::string::npos) {
+            out.lo = out.hi = std::stoll(text);
+            return true;
+        }
+        if (colon > 0) out.lo = std::stoll(text.substr(0, colon));
+        if (colon + 1 < text.size()) out.hi = std::stoll(text.substr(colon + 1));
+        return colon > 0 || colon + 1 < text.size();
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+inline char ascii_lower(char c) { return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c; }
+
+// o texto (sem '\0') contém 'needle' (já em minúsculas)? Sem diferenciar maiúsculas ASCII
+bool contains_text(const char* text, size_t length, const std::string& needle) {
+    if (needle.empty()) return true;
+    return std::search(text, text + length, needle.begin(), needle.end(),
+                       [](char a, char b) { return ascii_lower(a) == b; }) != text + length;
+}
+
+struct ScanFilter {
+    IntRange ano;
+    IntRange citacoes;
+    IntRange atualizacao;
+    std::string titulo;
+    std::string autores;
+    std::string snippet;
+
+    bool matches(const RecordView& record) const {
+        if (!ano.contains(record.ano) || !citacoes.contains(record.citacoes) || !atualizacao.contains(record.atualizacao)) return false;
+        return contains_text(record.titulo, record.titulo_len, titulo) &&
+               contains_text(record.autores, record.autores_len, autores) &&
+               contains_text(record.snippet, record.snippet_len, snippet);
+    }
+
+    bool has_text() const { return !titulo.empty() || !autores.empty() || !snippet.empty(); }
+};
+
+// mesmo formato da página para um artigo já decodificado (caminho das colunas)
+RecordView view_artigo(const Artigo& artigo) {
+    RecordView view;
+    view.id = artigo.ID;
+    view.ano = artigo.Ano;
+    view.citacoes = artigo.Citacoes;
+    view.atualizacao = static_cast<int64_t>(artigo.Atualizacao_timestamp);
+    view.titulo = artigo.Titulo;
+    view.autores = artigo.Autores;
+    view.snippet = artigo.Snippet;
+    view.titulo_len = static_cast<uint16_t>(std::strlen(artigo.Titulo));
+    view.autores_len = static_cast<uint16_t>(std::strlen(artigo.Autores));
+    view.snippet_len = static_cast<uint16_t>(std::strlen(artigo.Snippet));
+    return view;
+}
+
+// Um artigo do ranking por citações
+struct TopEntry {
+    int citacoes;
+    int id;
+    f_ptr data_ptr;
+};
+
+// mais citado primeiro, empate pelo menor ID
+inline bool ranks_before(const TopEntry& a, const TopEntry& b) {
+    return a.citacoes != b.citacoes ? a.citacoes > b.citacoes : a.id < b.id;
+}
+
+struct YearGroup {
+    long count = 0;
+    long long citacoes = 0;
+};
+
+// Estado parcial de uma thread (e, depois do merge, o resultado)
+struct ScanAggregate {
+    long pages = 0;
+    long records = 0;
+    long matches = 0;
+    long long citacoes_sum = 0;
+    int citacoes_min = 0, citacoes_max = 0;
+    int ano_min = 0, ano_max = 0;
+    std::map<int, YearGroup> by_year;
+    std::vector<TopEntry> top; // heap com o pior dos k no topo
+
+    void add(int id, int ano, int citacoes, f_ptr data_ptr, size_t top_k, bool group_by_year) {
+        if (matches == 0) {
+            citacoes_min = citacoes_max = citacoes;
+            ano_min = ano_max = ano;
+        } else {
+            citacoes_min = std::min(citacoes_min, citacoes);
+            citacoes_max = std::max(citacoes_max, citacoes);
+            ano_min = std::min(ano_min, ano);
+            ano_max = std::max(ano_max, ano);
+        }
+        matches++;
+        citacoes_sum += citacoes;
+        if (group_by_year) {
+            YearGroup& group = by_year[ano];
+            group.count++;
+            group.citacoes += citacoes;
+        }
+        if (top_k > 0) push_top({citacoes, id, data_ptr}, top_k);
+    }
+
+    void push_top(const TopEntry& entry, size_t top_k) {
+        if (top.size() == top_k && !ranks_before(entry, top.front())) return;
+        top.push_back(entry);
+        std::push_heap(top.begin(), top.end(), ranks_before);
+        if (top.size() > top_k) {
+            std::pop_heap(top.begin(), top.end(), ranks_before);
+            top.pop_back();
+        }
+    }
+
+    void merge(const ScanAggregate& other, size_t top_k) {
+        pages += other.pages;
+        records += other.records;
+        if (other.matches > 0) {
+            citacoes_min = (matches == 0) ? other.citacoes_min : std::min(citacoes_min, other.citacoes_min);
+            citacoes_max = (matches == 0) ? other.citacoes_max : std::max(citacoes_max, other.citacoes_max);
+            ano_min = (matches == 0) ? other.ano_min : std::min(ano_min, other.ano_min);
+            ano_max = (matches == 0) ? other.ano_max : std::max(ano_max, other.ano_max);
+        }
+        matches += other.matches;
+        citacoes_sum += other.citacoes_sum;
+        for (const auto& entry : other.by_year) {
+            by_year[entry.first].count += entry.second.count;
+            by_year[entry.first].citacoes += entry.second.citacoes;
+        }
+        for (const TopEntry& entry : other.top) push_top(entry, top_k);
+    }
+};
+
+// threads da varredura: --threads, SCAN_THREADS ou a quantidade de núcleos
+int scan_thread_count(int requested) {
+    if (requested > 0) return requested;
+    int threads = static_cast<int>(std::thread::hardware_concurrency());
+    const char* env = std::getenv("SCAN_THREADS");
+    if (env != nullptr) {
+        int value = std::atoi(env);
+        if (value > 0) threads = value;
+        else LOG_WARN("SCAN_THREADS invalido ('" << env << "'). Usando o padrao");
+    }
+    return std::max(1, threads);
+}
+
+// Métricas de cada caminho da varredura
+struct ScanStats {
+    int threads = 1;
+    long row_pages = 0;      // páginas do arquivo de dados lidas na varredura (ou só as dos selecionados, nas colunas)
+    long column_bytes = 0;   // bytes das colunas lidos pelos filtros e pelas agregações
+};
+
+// varredura das páginas do arquivo de dados por várias threads
+ScanAggregate scan_rows(HashingFile& data_file, const ScanFilter& filter, size_t top_k, bool group_by_year,
+                        int requested_threads, ScanStats& stats) {
+    long total_pages = data_file.get_total_blocks();
+    int threads = static_cast<int>(std::min<long>(requested_threads,
+                                                  std::max(1L, (total_pages + SCAN_CHUNK_PAGES - 1) / SCAN_CHUNK_PAGES)));
+
+    // cada thread pega o próximo trecho livre até as páginas acabarem (as mais rápidas pegam mais trechos)
+    std::atomic<long> next_page{1};
+    std::vector<ScanAggregate> partials(threads);
+    PipelineError scan_error;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            try {
+                ScanAggregate& partial = partials[t];
+                RecordView record;
+                for (long first = next_page.fetch_add(SCAN_CHUNK_PAGES); first <= total_pages;
+                     first = next_page.fetch_add(SCAN_CHUNK_PAGES)) {
+                    data_file.scan_pages(first, first + SCAN_CHUNK_PAGES, [&](long page, const DataBlock& block) {
+                        partial.pages++;
+                        for (int slot = 0; slot < block.record_count(); slot++) {
+                            if (!block.view(slot, record)) continue;
+                            partial.records++;
+                            if (filter.matches(record)) {
+                                partial.add(record.id, record.ano, record.citacoes, make_record_ptr(page, slot), top_k, group_by_year);
+                            }
+                        }
+                    });
+                }
+            } catch (...) {
+                scan_error.set(std::current_exception());
+            }
+        });
+    }
+    for (std::thread& worker : workers) worker.join();
+    scan_error.rethrow_if_set();
+
+    ScanAggregate result;
+    for (const ScanAggregate& partial : partials) result.merge(partial, top_k);
+    stats.threads = threads;
+    stats.row_pages = result.pages;
+    return result;
+}
+
+// filtros numéricos nas colunas; sem filtro de texto as agregações também saem das colunas, senão os registros
+// selecionados são lidos em lotes (ordem de offset) e terminam de ser filtrados
+const size_t COLUMN_READ_BATCH = 4096;
+
+ScanAggregate scan_columns(const ColumnStore& columns, HashingFile& data_file, const ScanFilter& filter, size_t top_k,
+                           bool group_by_year, ScanStats& stats) {
+    size_t rows = static_cast<size_t>(columns.row_count());
+    std::vector<uint64_t> selection = column_select_all(rows);
+    if (filter.ano.active()) {
+        column_filter_i32(columns.anos(), rows, filter.ano.lo, filter.ano.hi, selection.data());
+        stats.column_bytes += static_cast<long>(rows * sizeof(int32_t));
+    }
+    if (filter.citacoes.active()) {
+        column_filter_i32(columns.citacoes(), rows, filter.citacoes.lo, filter.citacoes.hi, selection.data());
+        stats.column_bytes += static_cast<long>(rows * sizeof(int32_t));
+    }
+    if (filter.atualizacao.active()) {
+        column_filter_i64(columns.atualizacoes(), rows, filter.atualizacao.lo, filter.atualizacao.hi, selection.data());
+        stats.column_bytes += static_cast<long>(rows * sizeof(int64_t));
+    }
+
+    ScanAggregate result;
+    result.records = static_cast<long>(rows);
+    std::vector<f_ptr> pending;
+    auto read_pending = [&]() {
+        BatchReadStats read_stats = data_file.read_records(pending, [&](f_ptr data_ptr, const Artigo& artigo) {
+            if (filter.matches(view_artigo(artigo))) result.add(artigo.ID, artigo.Ano, artigo.Citacoes, data_ptr, top_k, group_by_year);
+        });
+        stats.row_pages += read_stats.pages;
+        pending.clear();
+    };
+
+    const int32_t* ids = columns.ids();
+    const int32_t* anos = columns.anos();
+    const int32_t* citacoes = columns.citacoes();
+    const int64_t* data_ptrs = columns.data_ptrs();
+    for (size_t w = 0; w < selection.size(); ++w) {
+        for (uint64_t bits = selection[w]; bits != 0; bits &= bits - 1) {
+            size_t row = w * 64 + static_cast<size_t>(__builtin_ctzll(bits));
+            if (filter.has_text()) {
+                pending.push_back(static_cast<f_ptr>(data_ptrs[row]));
+                if (pending.size() >= COLUMN_READ_BATCH) read_pending();
+            } else {
+                result.add(ids[row], anos[row], citacoes[row], static_cast<f_ptr>(data_ptrs[row]), top_k, group_by_year);
+                stats.column_bytes += 3 * sizeof(int32_t) + sizeof(int64_t);
+            }
+        }
+    }
+    if (!pending.empty()) read_pending();
+    return result;
+}
+
+void print_usage(const char* program) {
+    LOG_ERROR("Uso: " << program << " [filtros] [--por-ano] [--top K] [--threads N] [--no-columns]");
+    LOG_ERROR("  filtros: --ano A[:B]  --citacoes A[:B]  --atualizacao A[:B]   (faixas inclusivas, um dos lados pode ficar vazio: 2010: ou :5)");
+    LOG_ERROR("           --titulo TEXTO  --autores TEXTO  --snippet TEXTO   (contém o texto, sem diferenciar maiusculas)");
+    LOG_ERROR("  sempre mostra quantidade, soma, media, menor e maior de Citacoes e o intervalo de Ano dos artigos filtrados");
+    LOG_ERROR("  --no-columns ignora o columns.dat e varre as paginas do arquivo de dados");
+}
+
+int main(int argc, char* argv[]) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    ScanFilter filter;
+    bool group_by_year = false;
+    size_t top_k = DEFAULT_TOP_K;
+    int requested_threads = 0;
+    bool no_columns = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--por-ano") {
+            group_by_year = true;
+            continue;
+        }
+        if (arg == "--no-columns") {
+            no_columns = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            print_usage(argv[0]);
+            return 1;
+        }
+        std::string value = argv[++i];
+        bool ok = true;
+        if (arg == "--ano") ok = parse_range(value, filter.ano);
+        else if (arg == "--citacoes") ok = parse_range(value, filter.citacoes);
+        else if (arg == "--atualizacao") ok = parse_range(value, filter.atualizacao);
+        else if (arg == "--titulo" || arg == "--autores" || arg == "--snippet") {
+            std::transform(value.begin(), value.end(), value.begin(), ascii_lower);
+            (arg == "--titulo" ? filter.titulo : arg == "--autores" ? filter.autores : filter.snippet) = value;
+        } else if (arg == "--top") {
+            int k = std::atoi(value.c_str());
+            ok = k > 0;
+            top_k = static_cast<size_t>(k);
+        } else if (arg == "--threads") {
+            requested_threads = std::atoi(value.c_str());
+            ok = requested_threads > 0;
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            LOG_ERROR("ERRO: argumento invalido: " << arg << " " << value);
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    const char* data_dir_env = std::getenv("DATA_DIR");
+    if (data_dir_env == nullptr) {
+        LOG_ERROR("ERRO FATAL: Variavel de ambiente DATA_DIR nao definida.");
+        LOG_INFO("Execute: export DATA_DIR=./data");
+        return 1;
+    }
+    std::string data_dir(data_dir_env);
+
+    try {
+        HashingFile data_file(data_dir + "/data_file.dat", OpenMode::READ_ONLY);
+        std::string columns_path = data_dir + "/columns.dat";
+        bool use_columns = !no_columns && std::filesystem::exists(columns_path);
+        ScanStats stats;
+        ScanAggregate result = use_columns
+            ? scan_columns(ColumnStore(columns_path), data_file, filter, top_k, group_by_year, stats)
+            : scan_rows(data_file, filter, top_k, group_by_year, scan_thread_count(requested_threads), stats);
+        std::chrono::duration<double, std::milli> scan_elapsed = std::chrono::high_resolution_clock::now() - start_time;
+
+        std::cout << "Artigos filtrados: " << result.matches << " de " << result.records << std::endl;
+        if (result.matches > 0) {
+            std::cout << "Citacoes: soma " << result.citacoes_sum << " | media " << std::fixed << std::setprecision(2)
+                      << static_cast<double>(result.citacoes_sum) / result.matches
+                      << " | menor " << result.citacoes_min << " | maior " << result.citacoes_max << std::endl;
+            std::cout << "Ano: de " << result.ano_min << " a " << result.ano_max << std::endl;
+        }
+        if (group_by_year) {
+            std::cout << "Ano;Artigos;Citacoes" << std::endl;
+            for (const auto& entry : result.by_year) {
+                std::cout << entry.first << ';' << entry.second.count << ';' << entry.second.citacoes << std::endl;
+            }
+        }
+
+        // só os k primeiros do ranking são decodificados inteiros, lidos em ordem de offset
+        BatchReadStats top_stats;
+        if (top_k > 0) {
+            std::sort(result.top.begin(), result.top.end(), ranks_before);
+            std::vector<f_ptr> data_ptrs;
+            for (const TopEntry& entry : result.top) data_ptrs.push_back(entry.data_ptr);
+            std::unordered_map<f_ptr, Artigo> records;
+            top_stats = data_file.read_records(data_ptrs, [&](f_ptr data_ptr, const Artigo& artigo) { records[data_ptr] = artigo; });
+            std::cout << "Mais citados:" << std::endl;
+            for (size_t i = 0; i < result.top.size(); ++i) {
+                const Artigo& artigo = records[result.top[i].data_ptr];
+                std::cout << std::setw(4) << i + 1 << ". ID " << artigo.ID << " | " << artigo.Citacoes << " citacoes | "
+                          << artigo.Ano << " | " << artigo.Titulo << std::endl;
+            }
+        }
+
+        LOG_INFO("\n--- Metricas da Varredura do Arquivo de Dados ---");
+        double megabytes;
+        if (use_columns) {
+            megabytes = static_cast<double>(stats.column_bytes) / (1024.0 * 1024.0);
+            LOG_INFO("Colunas: " << columns_path << " (kernel " << column_kernel_name() << ")");
+            LOG_INFO("Bytes lidos nas colunas: " << stats.column_bytes);
+            LOG_INFO("Blocos lidos no arquivo de dados: " << stats.row_pages << " de " << data_file.get_total_blocks()
+                     << " (mais " << top_stats.pages << " para o ranking)");
+        } else {
+            megabytes = static_cast<double>(stats.row_pages) * PAGE_SIZE / (1024.0 * 1024.0);
+            LOG_INFO("Threads: " << stats.threads << " (trechos de " << SCAN_CHUNK_PAGES << " paginas)");
+            LOG_INFO("Blocos lidos no arquivo de dados: " << stats.row_pages << " de " << data_file.get_total_blocks()
+                     << " (mais " << top_stats.pages << " para o ranking)");
+        }
+        LOG_INFO("Tempo da varredura: " << std::fixed << std::setprecision(3) << scan_elapsed.count() << " ms ("
+                 << std::setprecision(1) << (scan_elapsed.count() > 0 ? megabytes / (scan_elapsed.count() / 1000.0) : 0.0) << " MB/s)");
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start_time;
+        LOG_INFO("Tempo de execucao do scan: " << std::fixed << std::setprecision(3) << elapsed.count() << " ms");
+    } catch (const std::runtime_error& e) {
+        LOG_ERROR("ERRO FATAL durante a varredura: " << e.what());
+        return 1;
+    }
+    return 0;
+}
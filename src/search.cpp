@@ -0,0 +1,132 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <cstdlib>
+#include <chrono>
+#include <iomanip>
+#include <algorithm>
+#include <unordered_map>
+
+#include "record.hpp"
+#include "hashing.hpp"
+#include "text_index.hpp"
+#include "log.hpp"
+
+// search: busca por palavras no índice invertido (Titulo, Autores e Snippet)
+// Todas as palavras precisam aparecer no artigo (E) ou basta uma delas (--or); os resultados são
+// ordenados por Citacoes (maior primeiro) e só os k primeiros são lidos do arquivo de dados
+
+const int DEFAULT_TOP_K = 10;
+
+// Função auxiliar para imprimir os campos de um artigo
+//não tem porquê de inserir log aqui, essa é a  principal funcionalidade do código !
+void print_artigo(const Artigo& artigo) {
+    std::cout << "------------------------------------------" << std::endl;
+    std::cout << "ID: " << artigo.ID << std::endl;
+    std::cout << "Titulo: " << artigo.Titulo << std::endl;
+    std::cout << "Ano: " << artigo.Ano << std::endl;
+    std::cout << "Autores: " << artigo.Autores << std::endl;
+    std::cout << "Citacoes: " << artigo.Citacoes << std::endl;
+    std::cout << "Atualização: " << artigo.Atualizacao_timestamp << std::endl;
+    std::cout << "Snippet: " << artigo.Snippet << std::endl;
+    std::cout << "------------------------------------------" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    bool match_any = false;
+    int top_k = DEFAULT_TOP_K;
+    std::vector<std::string> words;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--or") {
+            match_any = true;
+        } else if (arg == "-k" && i + 1 < argc) {
+            top_k = std::atoi(argv[++i]);
+            if (top_k <= 0) {
+                LOG_ERROR("ERRO: -k precisa ser um numero positivo.");
+                return 1;
+            }
+        } else {
+            words.push_back(arg);
+        }
+    }
+
+    // os termos da consulta passam pela mesma normalização do upload ("Redes-Neurais" vira "redes" e "neurais")
+    std::vector<std::string> terms;
+    for (const std::string& word : words) {
+        tokenize_text(word.c_str(), [&](const std::string& term) { terms.push_back(term); });
+    }
+    std::sort(terms.begin(), terms.end());
+    terms.erase(std::unique(terms.begin(), terms.end()), terms.end());
+    if (terms.empty()) {
+        LOG_ERROR("Uso: " << argv[0] << " [--or] [-k N] <palavras...>");
+        LOG_ERROR("     todas as palavras precisam aparecer (ou uma delas com --or); mostra os N artigos mais citados (padrao " << DEFAULT_TOP_K << ")");
+        return 1;
+    }
+
+    const char* data_dir_env = std::getenv("DATA_DIR");
+    if (data_dir_env == nullptr) {
+        LOG_ERROR("ERRO FATAL: Variavel de ambiente DATA_DIR nao definida.");
+        LOG_INFO("Execute: export DATA_DIR=./data");
+        return 1;
+    }
+    std::string data_dir(data_dir_env);
+
+    try {
+        TextIndex text_index(data_dir);
+
+        // listas de cada termo; no modo E a interseção começa pelas menores (o resultado só diminui)
+        long dict_blocks = 0;
+        std::vector<std::vector<uint32_t>> lists;
+        for (const std::string& term : terms) {
+            lists.push_back(text_index.postings(term, dict_blocks));
+            LOG_INFO("Termo \"" << term << "\": " << lists.back().size() << " artigos");
+        }
+        std::vector<uint32_t> matches;
+        if (match_any) {
+            for (const auto& list : lists) matches = unite_postings(matches, list);
+        } else {
+            std::sort(lists.begin(), lists.end(), [](const auto& a, const auto& b) { return a.size() < b.size(); });
+            matches = lists[0];
+            for (size_t i = 1; i < lists.size() && !matches.empty(); ++i) matches = intersect_postings(matches, lists[i]);
+        }
+
+        // ranking pela tabela de documentos (Citacoes, depois ID), sem ler o arquivo de dados
+        size_t shown = std::min(matches.size(), static_cast<size_t>(top_k));
+        auto more_cited = [&](uint32_t a, uint32_t b) {
+            const TextDocument& da = text_index.document(a);
+            const TextDocument& db = text_index.document(b);
+            return da.citacoes != db.citacoes ? da.citacoes > db.citacoes : da.id < db.id;
+        };
+        std::partial_sort(matches.begin(), matches.begin() + shown, matches.end(), more_cited);
+
+        // só os k primeiros são lidos, em ordem de offset, e impressos na ordem do ranking
+        std::vector<f_ptr> data_ptrs;
+        for (size_t i = 0; i < shown; ++i) data_ptrs.push_back(static_cast<f_ptr>(text_index.document(matches[i]).data_ptr));
+        std::unordered_map<f_ptr, Artigo> records;
+        HashingFile data_file(data_dir + "/data_file.dat", OpenMode::READ_ONLY);
+        BatchReadStats data_stats = data_file.read_records(data_ptrs, [&](f_ptr record_ptr, const Artigo& artigo) {
+            records[record_ptr] = artigo;
+        });
+        for (f_ptr data_ptr : data_ptrs) {
+            auto it = records.find(data_ptr);
+            if (it == records.end()) throw std::runtime_error("ERRO: registro do índice de texto não encontrado no arquivo de dados.");
+            print_artigo(it->second);
+        }
+
+        LOG_INFO("\n--- Metricas da Busca por Palavras ---");
+        LOG_INFO("Termos: " << terms.size() << " (" << (match_any ? "qualquer um" : "todos") << ")");
+        LOG_INFO("Artigos encontrados: " << matches.size() << " (mostrados: " << shown << ")");
+        LOG_INFO("Blocos lidos no dicionario de termos: " << dict_blocks);
+        LOG_INFO("Blocos lidos no arquivo de dados: " << data_stats.pages);
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start_time;
+        LOG_INFO("Tempo de execucao do search: " << std::fixed << std::setprecision(3) << elapsed.count() << " ms");
+    } catch (const std::runtime_error& e) {
+        LOG_ERROR("ERRO FATAL durante a busca: " << e.what());
+        return 1;
+    }
+    return 0;
+}
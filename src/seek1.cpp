@@ -5,10 +5,17 @@
 #include <cstdlib>
 #include <chrono>
 #include <iomanip>
+#include <vector>
+#include <algorithm>
+#include <sstream>
+#include <filesystem>
 
 #include "record.hpp"
 #include "BPlusTree.hpp"
+#include "BPlusTree_covering.hpp"
+#include "hashing.hpp"
 #include "log.hpp"
+#include "query_protocol.hpp"
 
 // Função auxiliar para imprimir os campos de um artigo
 //não tem porquê de inserir log aqui, essa é a  principal funcionalidade do código !
@@ -24,20 +31,301 @@ void print_artigo(const Artigo& artigo) {
     std::cout << "------------------------------------------" << std::endl;
 }
 
+// Modo lote: lê um ID por linha (do arquivo ou da entrada padrão), busca todos com uma única descida
+// pela árvore e lê os registros em ordem crescente de offset no arquivo de dados
+// Os registros são impressos na ordem do arquivo de dados
+int run_batch(const std::string& source, const std::string& data_dir) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    std::ifstream file;
+    if (source != "-") {
+        file.open(source);
+        if (!file) {
+            LOG_ERROR("ERRO: Nao foi possivel abrir o arquivo de IDs " << source);
+            return 1;
+        }
+    }
+    std::istream& input = (source == "-") ? std::cin : file;
+
+    std::vector<int> ids;
+    long lines = 0;
+    std::string line;
+    while (std::getline(input, line)) {
+        line = trim(line);
+        if (line.empty()) continue;
+        lines++;
+        try {
+            ids.push_back(std::stoi(line));
+        } catch (const std::exception&) {
+            LOG_WARN("Linha ignorada, ID invalido: '" << line << "'");
+        }
+    }
+    // ordenadas e sem repetição: chaves vizinhas compartilham os nós internos da descida
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+    try {
+        BPlusTree primary_index(data_dir + "/primary_index.idx", OpenMode::READ_ONLY);
+        std::vector<f_ptr> data_ptrs;
+        long index_blocks = primary_index.search_batch(ids, data_ptrs);
+
+        std::vector<f_ptr> found_ptrs;
+        for (size_t i = 0; i < ids.size(); i++) {
+            if (data_ptrs[i] != -1) found_ptrs.push_back(data_ptrs[i]);
+            else LOG_DEBUG("ID " << ids[i] << " nao encontrado no indice");
+        }
+
+        HashingFile data_file(data_dir + "/data_file.dat", OpenMode::READ_ONLY);
+        BatchReadStats data_stats = data_file.read_records(found_ptrs, [](f_ptr, const Artigo& artigo) {
+            print_artigo(artigo);
+        });
+
+        LOG_INFO("\n--- Metricas da Busca em Lote no Indice Primario ---");
+        LOG_INFO("IDs lidos: " << lines << " (distintos: " << ids.size() << ")");
+        LOG_INFO("Registros encontrados: " << data_stats.records << " (nao encontrados: " << ids.size() - found_ptrs.size() << ")");
+        LOG_INFO("Blocos lidos no arquivo de indice: " << index_blocks);
+        LOG_INFO("Total de blocos no arquivo de indice primario: " << primary_index.get_total_blocks());
+        LOG_INFO("Blocos lidos no arquivo de dados: " << data_stats.pages << " em " << data_stats.runs << " trechos contiguos");
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start_time;
+        LOG_INFO("Tempo de execucao do seek1 (lote): " << std::fixed << std::setprecision(3) << elapsed.count() << " ms");
+    } catch (const std::runtime_error& e) {
+        LOG_ERROR("ERRO FATAL durante a busca em lote: " << e.what());
+        return 1;
+    }
+    return 0;
+}
+
+// Modo faixa: visita todos os IDs em [lo, hi] pela lista encadeada das folhas do índice primário
+// e lê os registros em lotes de RANGE_BATCH ponteiros, cada lote em ordem crescente de offset no arquivo de dados
+// Cada lote é impresso na ordem do arquivo de dados (os lotes seguem a ordem dos IDs)
+const size_t RANGE_BATCH = 4096;
+
+int run_range(int lo, int hi, const std::string& data_dir) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+    try {
+        BPlusTree primary_index(data_dir + "/primary_index.idx", OpenMode::READ_ONLY);
+        HashingFile data_file(data_dir + "/data_file.dat", OpenMode::READ_ONLY);
+
+        std::vector<f_ptr> pending;
+        pending.reserve(RANGE_BATCH);
+        long keys = 0;
+        BatchReadStats data_stats;
+        auto read_pending = [&]() {
+            BatchReadStats stats = data_file.read_records(pending, [](f_ptr, const Artigo& artigo) {
+                print_artigo(artigo);
+            });
+            data_stats.records += stats.records;
+            data_stats.pages += stats.pages;
+            data_stats.runs += stats.runs;
+            pending.clear();
+        };
+
+        long index_blocks = primary_index.scan(lo, hi, [&](int, f_ptr data_ptr) {
+            keys++;
+            pending.push_back(data_ptr);
+            if (pending.size() >= RANGE_BATCH) read_pending();
+            return true;
+        });
+        read_pending();
+
+        LOG_INFO("\n--- Metricas da Varredura no Indice Primario ---");
+        LOG_INFO("Faixa: [" << lo << ", " << hi << "]");
+        LOG_INFO("Chaves na faixa: " << keys << " (registros lidos: " << data_stats.records << ")");
+        LOG_INFO("Blocos lidos no arquivo de indice: " << index_blocks);
+        LOG_INFO("Total de blocos no arquivo de indice primario: " << primary_index.get_total_blocks());
+        LOG_INFO("Blocos lidos no arquivo de dados: " << data_stats.pages << " em " << data_stats.runs << " trechos contiguos");
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start_time;
+        LOG_INFO("Tempo de execucao do seek1 (faixa): " << std::fixed << std::setprecision(3) << elapsed.count() << " ms");
+    } catch (const std::runtime_error& e) {
+        LOG_ERROR("ERRO FATAL durante a varredura: " << e.what());
+        return 1;
+    }
+    return 0;
+}
+
+// Modo atributos (--fields ano,citacoes): imprime só ID e os atributos pedidos, uma linha por artigo em ordem de ID,
+// e mostra o agregado (quantidade, soma e média das citações, menor e maior ano) nas métricas
+// Com o índice de cobertura (upload --covering) tudo sai das folhas, sem ler o arquivo de dados;
+// sem ele os ponteiros vêm do índice primário e os registros são lidos em ordem de offset
+struct FieldsQuery {
+    bool ano = false;
+    bool citacoes = false;
+};
+
+int run_fields(const FieldsQuery& fields, const std::vector<std::pair<int, int>>& ranges, const std::string& data_dir) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+    try {
+        std::vector<CoveringKey> rows;
+        long index_blocks = 0, index_total_blocks = 0;
+        BatchReadStats data_stats;
+        std::string covering_path = data_dir + "/primary_covering.idx";
+        bool covering = std::filesystem::exists(covering_path);
+        if (covering) {
+            BPlusTree_covering covering_index(covering_path, OpenMode::READ_ONLY);
+            for (const auto& range : ranges) {
+                index_blocks += covering_index.scan(covering_key(range.first), covering_key(range.second), [&](CoveringKey key, f_ptr) {
+                    rows.push_back(key);
+                    return true;
+                });
+            }
+            index_total_blocks = covering_index.get_total_blocks();
+        } else {
+            LOG_WARN("Indice de cobertura nao encontrado (upload --covering); os atributos serao lidos do arquivo de dados");
+            BPlusTree primary_index(data_dir + "/primary_index.idx", OpenMode::READ_ONLY);
+            std::vector<f_ptr> data_ptrs;
+            for (const auto& range : ranges) {
+                index_blocks += primary_index.scan(range.first, range.second, [&](int, f_ptr data_ptr) {
+                    data_ptrs.push_back(data_ptr);
+                    return true;
+                });
+            }
+            index_total_blocks = primary_index.get_total_blocks();
+            HashingFile data_file(data_dir + "/data_file.dat", OpenMode::READ_ONLY);
+            data_stats = data_file.read_records(data_ptrs, [&](f_ptr, const Artigo& artigo) {
+                rows.push_back(covering_key(artigo));
+            });
+            std::sort(rows.begin(), rows.end());
+        }
+
+        long long citacoes_total = 0;
+        int ano_min = 0, ano_max = 0;
+        for (size_t i = 0; i < rows.size(); ++i) {
+            const CoveringKey& row = rows[i];
+            std::cout << row.id;
+            if (fields.ano) std::cout << ';' << row.ano;
+            if (fields.citacoes) std::cout << ';' << row.citacoes;
+            std::cout << '\n';
+            citacoes_total += row.citacoes;
+            ano_min = (i == 0) ? row.ano : std::min(ano_min, row.ano);
+            ano_max = (i == 0) ? row.ano : std::max(ano_max, row.ano);
+        }
+        std::cout.flush();
+
+        LOG_INFO("\n--- Metricas da Busca de Atributos no Indice Primario ---");
+        LOG_INFO("Indice usado: " << (covering ? "cobertura (primary_covering.idx)" : "primario + arquivo de dados"));
+        LOG_INFO("Artigos: " << rows.size());
+        if (!rows.empty()) {
+            LOG_INFO("Citacoes: soma " << citacoes_total << ", media " << std::fixed << std::setprecision(2)
+                     << static_cast<double>(citacoes_total) / rows.size());
+            LOG_INFO("Ano: de " << ano_min << " a " << ano_max);
+        }
+        LOG_INFO("Blocos lidos no arquivo de indice: " << index_blocks);
+        LOG_INFO("Total de blocos no arquivo de indice: " << index_total_blocks);
+        LOG_INFO("Blocos lidos no arquivo de dados: " << data_stats.pages);
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start_time;
+        LOG_INFO("Tempo de execucao do seek1 (atributos): " << std::fixed << std::setprecision(3) << elapsed.count() << " ms");
+    } catch (const std::runtime_error& e) {
+        LOG_ERROR("ERRO FATAL durante a busca de atributos: " << e.what());
+        return 1;
+    }
+    return 0;
+}
+
+// lê a lista de --fields ("ano", "citacoes" ou os dois separados por vírgula)
+bool parse_fields(const std::string& list, FieldsQuery& fields) {
+    std::istringstream in(list);
+    std::string field;
+    while (std::getline(in, field, ',')) {
+        if (field == "ano") fields.ano = true;
+        else if (field == "citacoes") fields.citacoes = true;
+        else return false;
+    }
+    return fields.ano || fields.citacoes;
+}
+
+// IDs do modo lote para o modo atributos (cada ID vira a faixa [ID, ID])
+bool read_id_ranges(const std::string& source, std::vector<std::pair<int, int>>& ranges) {
+    std::ifstream file;
+    if (source != "-") {
+        file.open(source);
+        if (!file) {
+            LOG_ERROR("ERRO: Nao foi possivel abrir o arquivo de IDs " << source);
+            return false;
+        }
+    }
+    std::istream& input = (source == "-") ? std::cin : file;
+    std::vector<int> ids;
+    std::string line;
+    while (std::getline(input, line)) {
+        line = trim(line);
+        if (line.empty()) continue;
+        try {
+            ids.push_back(std::stoi(line));
+        } catch (const std::exception&) {
+            LOG_WARN("Linha ignorada, ID invalido: '" << line << "'");
+        }
+    }
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    for (int id : ids) ranges.push_back({id, id});
+    return true;
+}
+
 int main(int argc, char* argv[]) {
     
     auto start_time = std::chrono::high_resolution_clock::now();
+    // --fields pode vir em qualquer posição; o resto dos argumentos segue o formato de sempre
+    std::vector<std::string> args = {argv[0]};
+    bool fields_mode = false;
+    FieldsQuery fields;
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == "--fields" && i + 1 < argc) {
+            fields_mode = true;
+            if (!parse_fields(argv[++i], fields)) {
+                LOG_ERROR("ERRO: --fields aceita ano, citacoes ou ano,citacoes (recebido '" << argv[i] << "').");
+                return 1;
+            }
+        } else {
+            args.push_back(argv[i]);
+        }
+    }
+    int arg_count = static_cast<int>(args.size());
+
     // 1. Validação dos argumentos
-    if (argc != 2) {
+    std::string mode = (arg_count >= 2) ? args[1] : "";
+    bool batch = (mode == "--batch");
+    bool range = (mode == "--range");
+    if ((batch && arg_count > 3) || (range && arg_count != 4) || (!batch && !range && arg_count != 2)) {
         LOG_ERROR("Uso: " << argv[0] << " <ID_do_artigo>");
+        LOG_ERROR("     " << argv[0] << " --batch [arquivo_de_IDs]   (um ID por linha, sem arquivo ou '-' le da entrada padrao)");
+        LOG_ERROR("     " << argv[0] << " --range <ID_inicial> <ID_final>");
+        LOG_ERROR("     qualquer modo aceita --fields ano,citacoes (so os atributos, pelo indice de cobertura)");
         return 1;
     }
 
+    if (batch || range || fields_mode) {
+        const char* data_dir_env = std::getenv("DATA_DIR");
+        if (data_dir_env == nullptr) {
+            LOG_ERROR("ERRO FATAL: Variavel de ambiente DATA_DIR nao definida.");
+            LOG_INFO("Execute: export DATA_DIR=./data");
+            return 1;
+        }
+        if (batch && !fields_mode) return run_batch(arg_count == 3 ? args[2] : "-", data_dir_env);
+
+        std::vector<std::pair<int, int>> ranges;
+        if (batch) {
+            if (!read_id_ranges(arg_count == 3 ? args[2] : "-", ranges)) return 1;
+        } else {
+            int lo, hi;
+            try {
+                lo = std::stoi(args[range ? 2 : 1]);
+                hi = std::stoi(args[range ? 3 : 1]);
+            } catch (const std::exception&) {
+                if (range) LOG_ERROR("ERRO: A faixa informada ('" << args[2] << "' a '" << args[3] << "') não e valida.");
+                else LOG_ERROR("ERRO: O ID informado ('" << args[1] << "') não e um numero valido.");
+                return 1;
+            }
+            ranges.push_back({lo, hi});
+        }
+        if (fields_mode) return run_fields(fields, ranges, data_dir_env);
+        return run_range(ranges[0].first, ranges[0].second, data_dir_env);
+    }
+
     int search_id;
     try {
-        search_id = std::stoi(argv[1]);
+        search_id = std::stoi(args[1]);
     } catch (const std::exception& e) {
-        LOG_ERROR("ERRO: O ID informado ('" << argv[1] << "') não e um numero valido.");
+        LOG_ERROR("ERRO: O ID informado ('" << args[1] << "') não e um numero valido.");
         return 1;
     }
 
@@ -55,9 +343,33 @@ int main(int argc, char* argv[]) {
 
     LOG_INFO("Buscando pelo ID no indice primario: ");
 
+    // modo cliente: com DBSERVER_SOCKET definida a busca é respondida pelo dbserver (índice e dados já abertos e quentes)
+    QueryRequest request;
+    request.op = QueryOp::FIND_BY_ID_INDEX;
+    request.id = search_id;
+    QueryResponse response;
+    if (forward_to_server(request, response)) {
+        if (response.status == QueryStatus::ERROR) {
+            LOG_ERROR("ERRO FATAL durante a busca no dbserver: " << response.error);
+            return 1;
+        }
+        if (response.status == QueryStatus::FOUND) {
+            LOG_INFO("\nRegistro encontrado com sucesso!");
+            print_artigo(response.artigos.front());
+        } else {
+            LOG_INFO("\nRegistro com ID " << search_id << " não foi encontrado no indice.");
+        }
+        LOG_INFO("\n--- Metricas da Busca no Indice Primario (dbserver) ---");
+        LOG_INFO("Blocos lidos no arquivo de indice: " << response.blocks_read);
+        LOG_INFO("Total de blocos no arquivo de indice primario: " << response.total_blocks);
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start_time;
+        LOG_INFO("Tempo de execucao do seek1: " << std::fixed << std::setprecision(3) << elapsed.count() << " ms");
+        return 0;
+    }
+
     try {
-        // 2. Inicializa o índice (que agora deve ABRIR o arquivo existente)
-        BPlusTree primary_index(primary_index_path);
+        // 2. Inicializa o índice (ABRE o arquivo existente, mapeado em memória somente para leitura)
+        BPlusTree primary_index(primary_index_path, OpenMode::READ_ONLY);
         int blocks_read_index = 0;
 
         // 3. Executa a busca no índice
@@ -68,32 +380,14 @@ int main(int argc, char* argv[]) {
             LOG_INFO("\nChave encontrada no indice! Ponteiro para dados: " << data_ptr);
             LOG_INFO("Lendo registro do arquivo de dados...");
 
-            // Abre o arquivo de dados para ler o registro
-            std::ifstream data_file(data_file_path, std::ios::binary);
-            if (!data_file) {
-
-                LOG_ERROR("ERRO FALTAR: Não foi possivel abrir o arquivo de dados '" << data_file_path << "' para leitura.");
-                throw std::runtime_error("Falha ao abrir arquivo de dados.");
-            }
-
-            // Posiciona no local exato
-            data_file.seekg(data_ptr);
-            if (!data_file) { // Verifica se seekg falhou
-                data_file.close();
-                LOG_ERROR("ERRO FATAL: Falha ao posicionar no arquivo de dados no offset " << data_ptr);
-                throw std::runtime_error("Falha no seekg do arquivo de dados.");
-            }
-
-
+            // Abre o arquivo de dados (mapeado em memória) e lê o registro no local exato
+            HashingFile data_file(data_file_path, OpenMode::READ_ONLY);
             Artigo found_artigo;
-            // Lê o registro
-            if (!data_file.read(reinterpret_cast<char*>(&found_artigo), sizeof(Artigo))) {
-                data_file.close();
+            if (!data_file.read_record(data_ptr, found_artigo)) {
                 LOG_ERROR("ERRO FATAL: Falha ao ler o registro do arquivo de dados no offset " << data_ptr);
                 LOG_ERROR("  -> Verifique se o data_ptr esta correto e se o arquivo de dados não esta corrompido.");
                 throw std::runtime_error("Falha na leitura do arquivo de dados.");
             }
-            data_file.close();
 
             LOG_INFO("\nRegistro encontrado com sucesso!");
             print_artigo(found_artigo);
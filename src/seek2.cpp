@@ -8,11 +8,16 @@
 #include <functional>     // Para std::hash
 #include <chrono>
 #include <iomanip> // Para stepprecision
+#include <algorithm>
+#include <unordered_map>
 
 // === Headers do projeto ===
 #include "record.hpp"         // Define a struct Artigo
 #include "BPlusTree_long.hpp" // Define a classe BPlusTree_long (para índice secundário)
+#include "string_bplus_tree.hpp" // Índice de títulos ordenado (prefixo e faixa)
+#include "hashing.hpp"        // Define a classe HashingFile (leitura do registro)
 #include "log.hpp" //para log levels
+#include "query_protocol.hpp" // Modo cliente do dbserver
 
 
 // === Função auxiliar para imprimir artigo ===
@@ -37,6 +42,131 @@ void print_artigo(const Artigo& artigo) {
     std::cout << "------------------------------------------" << std::endl;
 }
 
+// === Modo lote ===
+// Lê um título por linha (do arquivo ou da entrada padrão), busca todos os hashes com uma única descida
+// pela árvore e lê os registros em ordem crescente de offset, verificando o título de cada um
+// Os registros são impressos na ordem do arquivo de dados
+int run_batch(const std::string& source, const std::string& data_dir) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    std::ifstream file;
+    if (source != "-") {
+        file.open(source);
+        if (!file) {
+            LOG_ERROR("ERRO: Nao foi possivel abrir o arquivo de titulos " << source);
+            return 1;
+        }
+    }
+    std::istream& input = (source == "-") ? std::cin : file;
+
+    // (hash, título truncado), ordenado pelo hash e sem títulos repetidos
+    std::vector<std::pair<long long, std::string>> titles;
+    long lines = 0;
+    std::string line;
+    while (std::getline(input, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty()) continue;
+        lines++;
+        std::string titulo = line.substr(0, 300);
+        titles.push_back({hash_string_to_long(titulo.c_str()), titulo});
+    }
+    std::sort(titles.begin(), titles.end());
+    titles.erase(std::unique(titles.begin(), titles.end()), titles.end());
+
+    std::vector<long long> hashes;
+    for (const auto& title : titles) {
+        if (hashes.empty() || hashes.back() != title.first) hashes.push_back(title.first);
+    }
+
+    try {
+        BPlusTree_long secondary_index(data_dir + "/secondary_index.idx", OpenMode::READ_ONLY);
+        auto titles_with_hash = [&](long long hash) {
+            return std::equal_range(titles.begin(), titles.end(), std::make_pair(hash, std::string()),
+                                    [](const auto& a, const auto& b) { return a.first < b.first; });
+        };
+
+        // postagens de todos os hashes; ficam só as que têm a impressão de algum título buscado com aquele hash
+        std::unordered_map<f_ptr, long long> hash_of_ptr; // para verificar o título quando o registro for lido
+        long postings = 0;
+        long index_blocks = secondary_index.search_batch_all(hashes, [&](size_t k, f_ptr posting) {
+            postings++;
+            auto range = titles_with_hash(hashes[k]);
+            for (auto it = range.first; it != range.second; ++it) {
+                if (title_posting_matches(posting, title_fingerprint(it->second.c_str()))) {
+                    hash_of_ptr[title_posting_ptr(posting)] = hashes[k];
+                    return;
+                }
+            }
+        });
+        std::vector<f_ptr> found_ptrs;
+        found_ptrs.reserve(hash_of_ptr.size());
+        for (const auto& entry : hash_of_ptr) found_ptrs.push_back(entry.first);
+
+        long verified = 0;
+        long collisions = 0;
+        HashingFile data_file(data_dir + "/data_file.dat", OpenMode::READ_ONLY);
+        BatchReadStats data_stats = data_file.read_records(found_ptrs, [&](f_ptr record_ptr, const Artigo& artigo) {
+            // --- VERIFICAÇÃO (Contra Colisões de Hash) --- algum título buscado com esse hash tem que bater
+            auto range = titles_with_hash(hash_of_ptr[record_ptr]);
+            for (auto it = range.first; it != range.second; ++it) {
+                if (strcmp(artigo.Titulo, it->second.c_str()) == 0) {
+                    verified++;
+                    print_artigo(artigo);
+                    return;
+                }
+            }
+            collisions++;
+            LOG_DEBUG("Colisao de hash: registro " << artigo.ID << " nao corresponde a nenhum titulo buscado");
+        });
+
+        LOG_INFO("\n--- Metricas da Busca em Lote no Indice Secundario ---");
+        LOG_INFO("Titulos lidos: " << lines << " (distintos: " << titles.size() << ")");
+        LOG_INFO("Registros encontrados (titulo verificado): " << verified << " (postagens lidas no indice: " << postings
+                 << ", lidas no arquivo de dados: " << found_ptrs.size() << ", colisoes de hash: " << collisions << ")");
+        LOG_INFO("Blocos lidos no arquivo de indice: " << index_blocks);
+        LOG_INFO("Total de blocos no arquivo de indice secundario: " << secondary_index.get_total_blocks());
+        LOG_INFO("Blocos lidos no arquivo de dados: " << data_stats.pages << " em " << data_stats.runs << " trechos contiguos");
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start_time;
+        LOG_INFO("Tempo de execucao do seek2 (lote): " << std::fixed << std::setprecision(3) << elapsed.count() << " ms");
+    } catch (const std::runtime_error& e) {
+        LOG_ERROR("ERRO FATAL durante a busca em lote: " << e.what());
+        return 1;
+    }
+    return 0;
+}
+
+// === Modos prefixo e faixa ===
+// Percorrem o índice de títulos em ordem e imprimem os títulos encontrados, um por linha, sem ler o arquivo
+// de dados (o título é a própria chave). prefix_mode: todos que começam com 'lo'; senão a faixa [lo, hi]
+int run_title_scan(bool prefix_mode, const std::string& lo, const std::string& hi, const std::string& data_dir) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+    try {
+        StringBPlusTree title_index(data_dir + "/title_index.idx", OpenMode::READ_ONLY);
+        long matches = 0;
+        auto print_title = [&](const std::string& titulo, f_ptr) {
+            matches++;
+            std::cout << titulo << '\n';
+            return true;
+        };
+        long index_blocks = prefix_mode ? title_index.scan_prefix(lo, print_title) : title_index.scan(lo, hi, print_title);
+        std::cout.flush();
+
+        LOG_INFO("\n--- Metricas da Varredura no Indice de Titulos ---");
+        if (prefix_mode) LOG_INFO("Prefixo: \"" << lo << "\"");
+        else LOG_INFO("Faixa: [\"" << lo << "\", \"" << hi << "\"]");
+        LOG_INFO("Titulos encontrados: " << matches);
+        LOG_INFO("Blocos lidos no arquivo de indice: " << index_blocks);
+        LOG_INFO("Total de blocos no arquivo de indice de titulos: " << title_index.get_total_blocks());
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start_time;
+        LOG_INFO("Tempo de execucao do seek2 (" << (prefix_mode ? "prefixo" : "faixa") << "): "
+                 << std::fixed << std::setprecision(3) << elapsed.count() << " ms");
+    } catch (const std::runtime_error& e) {
+        LOG_ERROR("ERRO FATAL durante a varredura: " << e.what());
+        return 1;
+    }
+    return 0;
+}
+
 // === Função principal do programa seek2 ===
 int main(int argc, char* argv[]) {
     
@@ -45,9 +175,47 @@ int main(int argc, char* argv[]) {
     if (argc < 2) {
         LOG_ERROR("Uso: " << argv[0] << " <Titulo_do_artigo>" << std::endl);
         LOG_ERROR("Dica: Se o titulo contiver espacos, não precisa de aspas." << std::endl);
+        LOG_ERROR("     " << argv[0] << " --batch [arquivo_de_titulos]   (um titulo por linha, sem arquivo ou '-' le da entrada padrao)");
+        LOG_ERROR("     " << argv[0] << " --prefix <inicio_do_titulo>");
+        LOG_ERROR("     " << argv[0] << " --range <titulo_inicial> <titulo_final>   (ordem lexicografica, use aspas)");
         return 1;
     }
 
+    std::string mode = argv[1];
+    if (mode == "--prefix" || mode == "--range") {
+        bool prefix_mode = (mode == "--prefix");
+        if ((prefix_mode && argc < 3) || (!prefix_mode && argc != 4)) {
+            LOG_ERROR("Uso: " << argv[0] << " --prefix <inicio_do_titulo>");
+            LOG_ERROR("     " << argv[0] << " --range <titulo_inicial> <titulo_final>");
+            return 1;
+        }
+        const char* data_dir_env = std::getenv("DATA_DIR");
+        if (data_dir_env == nullptr) {
+            LOG_ERROR("ERRO FATAL: Variavel de ambiente DATA_DIR nao definida.");
+            LOG_INFO("Execute: export DATA_DIR=./data");
+            return 1;
+        }
+        if (!prefix_mode) return run_title_scan(false, argv[2], argv[3], data_dir_env);
+        // o prefixo pode vir em várias palavras, como o título da busca exata
+        std::string prefix = argv[2];
+        for (int i = 3; i < argc; ++i) prefix += std::string(" ") + argv[i];
+        return run_title_scan(true, prefix, prefix, data_dir_env);
+    }
+
+    if (std::string(argv[1]) == "--batch") {
+        if (argc > 3) {
+            LOG_ERROR("Uso: " << argv[0] << " --batch [arquivo_de_titulos]");
+            return 1;
+        }
+        const char* data_dir_env = std::getenv("DATA_DIR");
+        if (data_dir_env == nullptr) {
+            LOG_ERROR("ERRO FATAL: Variavel de ambiente DATA_DIR nao definida.");
+            LOG_INFO("Execute: export DATA_DIR=./data");
+            return 1;
+        }
+        return run_batch(argc == 3 ? argv[2] : "-", data_dir_env);
+    }
+
     // Reconstruindo o título completo a partir de todos os argumentos
     std::ostringstream oss;
     for (int i = 1; i < argc; ++i) {
@@ -75,86 +243,78 @@ int main(int argc, char* argv[]) {
 
     LOG_INFO("Buscando pelo Titulo (truncado para 300 caracteres): \"" << truncated_search_titulo << "\"");
 
+    // modo cliente: com DBSERVER_SOCKET definida a busca (e a verificação do título) é feita pelo dbserver
+    QueryRequest request;
+    request.op = QueryOp::FIND_BY_TITLE;
+    request.titulo = truncated_search_titulo;
+    QueryResponse response;
+    if (forward_to_server(request, response)) {
+        if (response.status == QueryStatus::ERROR) {
+            LOG_ERROR("ERRO FATAL durante a busca no dbserver: " << response.error);
+            return 1;
+        }
+        if (response.status == QueryStatus::FOUND) {
+            std::cout << "\nRegistro encontrado com sucesso (titulo verificado)!" << std::endl;
+            for (const Artigo& artigo : response.artigos) print_artigo(artigo); // títulos repetidos: todos os registros
+        } else {
+            LOG_INFO("\nRegistro com o titulo (truncado) \"" << truncated_search_titulo << "\" não foi encontrado.");
+        }
+        LOG_INFO("\n--- Metricas da Busca no Indice Secundario (dbserver) ---");
+        LOG_INFO("Registros encontrados: " << response.artigos.size());
+        LOG_INFO("Blocos lidos no arquivo de indice: " << response.blocks_read);
+        LOG_INFO("Total de blocos no arquivo de indice secundario: " << response.total_blocks);
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start_time;
+        LOG_INFO("Tempo de execucao do seek2: " << std::fixed << std::setprecision(3) << elapsed.count() << " ms");
+        return 0;
+    }
+
     try {
-        // Calculando o hash DO TÍTULO TRUNCADO
-        long long search_hash = BPlusTree_long::hash_string_to_long(truncated_search_titulo);
-        LOG_DEBUG("Hash gerado: " << search_hash);
+        // Calculando o hash e a impressão digital DO TÍTULO TRUNCADO
+        long long search_hash = hash_string_to_long(truncated_search_titulo);
+        uint16_t fingerprint = title_fingerprint(truncated_search_titulo);
+        LOG_DEBUG("Hash gerado: " << search_hash << " (impressao " << fingerprint << ")");
 
         // Inicializando a B+Tree secundária (deve abrir o arquivo existente)
-        BPlusTree_long secondary_index(secondary_index_path);
-        int blocks_read_index = 0;
-
-        //Buscando o HASH na árvore B+
-        f_ptr data_ptr = secondary_index.search(search_hash, blocks_read_index);
-
-        bool record_found_and_verified = false; // Flag para rastrear sucesso final
-
-        // Se o hash foi encontrado no índice
-        if (data_ptr != -1) {
-            LOG_INFO("Hash encontrado no indice! Ponteiro para dados: " << data_ptr);
-            LOG_INFO("Lendo registro do arquivo de dados para verificacao...");
-
-            // abre o arquivo de dados principal para ler o registro completo
-            std::ifstream data_file(data_file_path, std::ios::binary);
-            if (!data_file) {
-                LOG_ERROR("Erro ao tentar abrir o arquivo de dados");
-                throw std::runtime_error("ERRO FATAL: Não foi possivel abrir o arquivo de dados '" + data_file_path + "'");
-            }
+        BPlusTree_long secondary_index(secondary_index_path, OpenMode::READ_ONLY);
+        HashingFile data_file(data_file_path, OpenMode::READ_ONLY);
 
-            // Posiciona no local indicado pelo índice
-            data_file.seekg(data_ptr);
-            if (!data_file) {
-                data_file.close();
-                LOG_ERROR("Falha ao posicionar cursor no arquivo de dados");
-                throw std::runtime_error("ERRO FATAL: Falha ao posicionar no arquivo de dados no offset " + std::to_string(data_ptr));
-            }
-
-            Artigo found_artigo; // Cria struct para receber os dados
-            // Lê o registro completo do arquivo de dados
-            if (!data_file.read(reinterpret_cast<char*>(&found_artigo), sizeof(Artigo))) {
-                data_file.close();
+        // Percorre a lista de postagens do hash: títulos repetidos (reimpressões, erratas) e colisões ficam lado a lado
+        // Só as postagens com a impressão do título buscado são lidas no arquivo de dados e verificadas
+        long postings = 0, data_reads = 0, found = 0, collisions = 0;
+        long blocks_read_index = secondary_index.scan(search_hash, search_hash, [&](long long, f_ptr posting) {
+            postings++;
+            if (!title_posting_matches(posting, fingerprint)) return true;
+            f_ptr data_ptr = title_posting_ptr(posting);
+            Artigo found_artigo;
+            data_reads++;
+            if (!data_file.read_record(data_ptr, found_artigo)) {
                 LOG_ERROR("Falha ao ler o registro no arquivo de dados na posição do offset");
                 throw std::runtime_error("ERRO FATAL: Falha ao ler o registro do arquivo de dados no offset " + std::to_string(data_ptr));
             }
-            data_file.close();
-
             // --- VERIFICAÇÃO FINAL (Contra Colisões de Hash) ---
-            // Compara o título BUSCADO (truncado) com o título LIDO DO ARQUIVO (já truncado na struct)
             if (strcmp(found_artigo.Titulo, truncated_search_titulo) == 0) {
-                // Os títulos (truncados) coincidem! Encontramos o registro correto
-                record_found_and_verified = true;
-                std::cout << "\nRegistro encontrado com sucesso (titulo verificado)!" << std::endl;
+                if (found == 0) std::cout << "\nRegistro encontrado com sucesso (titulo verificado)!" << std::endl;
+                found++;
                 print_artigo(found_artigo);
             } else {
-                // Hash coincidiu, mas os títulos não. É uma colisão de hash (muito rara em hash de long long)
-                 std::cout << "\nAVISO: Colisao de hash detectada ou erro de dados." << std::endl;
-                 std::cout << "  Hash encontrado, mas o titulo no registro não corresponde ao buscado." << std::endl;
-                 std::cout << "  Titulo Buscado (truncado): " << truncated_search_titulo << std::endl;
-                 std::cout << "  Titulo no Registro Lido: "; std::cout.write(found_artigo.Titulo, strnlen(found_artigo.Titulo, 300)); std::cout << std::endl;
+                collisions++;
+                LOG_DEBUG("Colisao de hash: registro " << found_artigo.ID << " tem outro titulo");
             }
+            return true;
+        });
 
-        }
-
-        // Se o hash não foi encontrado OU se foi colisão...
-        if (!record_found_and_verified) {
+        if (found == 0) {
             LOG_INFO("\nRegistro com o titulo (truncado) \"" << truncated_search_titulo << "\" não foi encontrado.");
         }
 
         // Exibe as métricas de busca no índice secundário
         LOG_INFO("\n--- Metricas da Busca no Indice Secundario ---");
+        LOG_INFO("Registros encontrados: " << found << " (postagens do hash: " << postings << ", lidas no arquivo de dados: "
+                 << data_reads << ", colisoes: " << collisions << ")");
         LOG_INFO("Blocos lidos no arquivo de indice: " << blocks_read_index);
-        try {
-            LOG_INFO("Total de blocos no arquivo de indice secundario: " << secondary_index.get_total_blocks());
-        } catch (...) {
-            LOG_ERROR("AVISO: Não foi possivel obter o total de blocos do indice secundario.");
-        }
-        auto end_time = std::chrono::high_resolution_clock::now();
-        auto duration = end_time - start_time;
-        std::chrono::duration<double, std::milli> duration_ms_fp = duration;
-        auto duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
-        LOG_INFO("Tempo de execucao do seek2: "
-                        << std::fixed << std::setprecision(3) // mostra 3 casas decimais
-                        << duration_ms_fp.count() << " ms");
+        LOG_INFO("Total de blocos no arquivo de indice secundario: " << secondary_index.get_total_blocks());
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start_time;
+        LOG_INFO("Tempo de execucao do seek2: " << std::fixed << std::setprecision(3) << elapsed.count() << " ms");
 
     } catch (const std::runtime_error& e) {
         LOG_ERROR("ERRO FATAL durante a busca: " << e.what());
@@ -0,0 +1,106 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <iomanip>
+#include <algorithm>
+
+#include "record.hpp"
+#include "hashing.hpp"
+#include "string_bplus_tree.hpp"
+#include "text_index.hpp"
+#include "log.hpp"
+
+// seek_author: todos os artigos de um autor pelo índice de autores (author_index.idx)
+// O nome passa pela mesma normalização do upload; os artigos saem por ID ou, com --ano / --citacoes,
+// dos mais recentes / mais citados para os outros
+
+// Função auxiliar para imprimir os campos de um artigo
+//não tem porquê de inserir log aqui, essa é a  principal funcionalidade do código !
+void print_artigo(const Artigo& artigo) {
+    std::cout << "------------------------------------------" << std::endl;
+    std::cout << "ID: " << artigo.ID << std::endl;
+    std::cout << "Titulo: " << artigo.Titulo << std::endl;
+    std::cout << "Ano: " << artigo.Ano << std::endl;
+    std::cout << "Autores: " << artigo.Autores << std::endl;
+    std::cout << "Citacoes: " << artigo.Citacoes << std::endl;
+    std::cout << "Atualização: " << artigo.Atualizacao_timestamp << std::endl;
+    std::cout << "Snippet: " << artigo.Snippet << std::endl;
+    std::cout << "------------------------------------------" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    std::string order = "id";
+    std::string query;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--ano" || arg == "--citacoes") {
+            order = arg.substr(2);
+        } else {
+            if (!query.empty()) query += " ";
+            query += arg;
+        }
+    }
+
+    // "KM Carter", "km carter" e "K.M. Carter" viram o mesmo nome
+    std::vector<std::string> names;
+    split_authors(query.c_str(), [&](const std::string& name) { names.push_back(name); });
+    if (names.size() != 1) {
+        LOG_ERROR("Uso: " << argv[0] << " [--ano | --citacoes] <nome do autor>");
+        LOG_ERROR("     um unico autor; --ano mostra os mais recentes primeiro e --citacoes os mais citados");
+        return 1;
+    }
+    const std::string& author = names[0];
+
+    const char* data_dir_env = std::getenv("DATA_DIR");
+    if (data_dir_env == nullptr) {
+        LOG_ERROR("ERRO FATAL: Variavel de ambiente DATA_DIR nao definida.");
+        LOG_INFO("Execute: export DATA_DIR=./data");
+        return 1;
+    }
+    std::string data_dir(data_dir_env);
+
+    try {
+        // as postagens do autor ficam lado a lado nas folhas, uma varredura [autor, autor] pega todas
+        StringBPlusTree author_index(data_dir + "/author_index.idx", OpenMode::READ_ONLY);
+        std::vector<f_ptr> data_ptrs;
+        long index_blocks = author_index.scan(author, author, [&](const std::string&, f_ptr data_ptr) {
+            data_ptrs.push_back(data_ptr);
+            return true;
+        });
+
+        // os registros são lidos em ordem de offset e ordenados depois
+        std::vector<Artigo> artigos;
+        HashingFile data_file(data_dir + "/data_file.dat", OpenMode::READ_ONLY);
+        BatchReadStats data_stats = data_file.read_records(data_ptrs, [&](f_ptr, const Artigo& artigo) {
+            artigos.push_back(artigo);
+        });
+        if (artigos.size() != data_ptrs.size()) {
+            throw std::runtime_error("ERRO: registro do índice de autores não encontrado no arquivo de dados.");
+        }
+        std::sort(artigos.begin(), artigos.end(), [&](const Artigo& a, const Artigo& b) {
+            if (order == "ano" && a.Ano != b.Ano) return a.Ano > b.Ano;
+            if (order == "citacoes" && a.Citacoes != b.Citacoes) return a.Citacoes > b.Citacoes;
+            return a.ID < b.ID;
+        });
+        for (const Artigo& artigo : artigos) print_artigo(artigo);
+
+        LOG_INFO("\n--- Metricas da Busca por Autor ---");
+        LOG_INFO("Autor: \"" << author << "\" (ordem: " << order << ")");
+        LOG_INFO("Artigos encontrados: " << artigos.size());
+        LOG_INFO("Blocos lidos no arquivo de indice: " << index_blocks);
+        LOG_INFO("Total de blocos no arquivo de indice de autores: " << author_index.get_total_blocks());
+        LOG_INFO("Blocos lidos no arquivo de dados: " << data_stats.pages);
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start_time;
+        LOG_INFO("Tempo de execucao do seek_author: " << std::fixed << std::setprecision(3) << elapsed.count() << " ms");
+    } catch (const std::runtime_error& e) {
+        LOG_ERROR("ERRO FATAL durante a busca: " << e.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,622 @@
+#include "string_bplus_tree.hpp"
+
+#include <cstring>
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+
+#include "varint.hpp"
+#include "wal.hpp"
+#include "log.hpp"
+
+namespace {
+
+const size_t BODY_SIZE = sizeof(StringTreePage::body);
+
+size_t common_prefix(const std::string& a, const std::string& b) {
+    size_t limit = std::min(a.size(), b.size()), i = 0;
+    while (i < limit && a[i] == b[i]) i++;
+    return i;
+}
+
+// menor prefixo de 'right' que ainda é maior que 'left' (left < right); se forem iguais, a própria chave
+// Com chaves repetidas o separador igual mantém a regra da descida: ficam à direita as chaves >= separador
+std::string shortest_separator(const std::string& left, const std::string& right) {
+    if (left == right) return right;
+    return right.substr(0, std::min(right.size(), common_prefix(left, right) + 1));
+}
+
+// Monta uma folha: cada chave entra como varint(prefixo comum) varint(resto) resto varint(ponteiro)
+class LeafBuilder {
+public:
+    LeafBuilder(StringTreePage& page, size_t limit) : page(page), limit(limit) { reset(); }
+
+    void reset() {
+        std::memset(&page, 0, sizeof(page));
+        page.header.is_leaf = 1;
+        page.header.next_leaf = -1;
+        page.header.used = static_cast<uint16_t>(sizeof(StringNodeHeader)); // folha vazia: used nunca fica abaixo do cabeçalho
+        used = 0;
+        last_key.clear();
+    }
+
+    // false se a chave não cabe mais nesta folha (uma folha vazia sempre aceita)
+    bool add(const std::string& key, f_ptr ptr) {
+        size_t shared = (page.header.count == 0) ? 0 : common_prefix(last_key, key);
+        size_t suffix = key.size() - shared;
+        size_t need = varint_size(shared) + varint_size(suffix) + suffix + varint_size(static_cast<uint64_t>(ptr));
+        if (page.header.count > 0 && used + need > limit) return false;
+        unsigned char* out = page.body + used;
+        out += put_varint(out, shared);
+        out += put_varint(out, suffix);
+        std::memcpy(out, key.data() + shared, suffix);
+        out += suffix;
+        out += put_varint(out, static_cast<uint64_t>(ptr));
+        used = static_cast<size_t>(out - page.body);
+        page.header.count++;
+        page.header.used = static_cast<uint16_t>(sizeof(StringNodeHeader) + used);
+        last_key = key;
+        return true;
+    }
+
+    const std::string& last() const { return last_key; }
+
+private:
+    StringTreePage& page;
+    size_t limit;
+    size_t used = 0;
+    std::string last_key;
+};
+
+// Monta um nó interno: int64 primeiro filho, depois (uint16 tamanho, separador, int64 filho) para cada filho seguinte
+class InternalBuilder {
+public:
+    InternalBuilder(StringTreePage& page, size_t limit) : page(page), limit(limit) {}
+
+    void start(int64_t first_child) {
+        std::memset(&page, 0, sizeof(page));
+        page.header.is_leaf = 0;
+        page.header.next_leaf = -1;
+        std::memcpy(page.body, &first_child, sizeof(first_child));
+        used = sizeof(first_child);
+        page.header.count = 1;
+        page.header.used = static_cast<uint16_t>(sizeof(StringNodeHeader) + used);
+    }
+
+    bool add(const std::string& separator, int64_t child) {
+        size_t need = sizeof(uint16_t) + separator.size() + sizeof(child);
+        if (page.header.count > 1 && used + need > limit) return false;
+        uint16_t length = static_cast<uint16_t>(separator.size());
+        unsigned char* out = page.body + used;
+        std::memcpy(out, &length, sizeof(length));
+        std::memcpy(out + sizeof(length), separator.data(), separator.size());
+        std::memcpy(out + sizeof(length) + separator.size(), &child, sizeof(child));
+        used += need;
+        page.header.count++;
+        page.header.used = static_cast<uint16_t>(sizeof(StringNodeHeader) + used);
+        return true;
+    }
+
+private:
+    StringTreePage& page;
+    size_t limit;
+    size_t used = 0;
+};
+
+// filho de um nó interno onde ficam as primeiras chaves >= key (quantidade de separadores < key)
+int64_t child_for(const StringTreePage& page, const std::string& key) {
+    const unsigned char* in = page.body;
+    const unsigned char* end = page.body + (page.header.used - sizeof(StringNodeHeader));
+    int64_t child;
+    std::memcpy(&child, in, sizeof(child));
+    in += sizeof(child);
+    for (int i = 1; i < page.header.count; ++i) {
+        uint16_t length;
+        std::memcpy(&length, in, sizeof(length));
+        in += sizeof(length);
+        if (in + length + sizeof(int64_t) > end) throw std::runtime_error("ERRO: nó do índice de títulos corrompido.");
+        // separador < key ?
+        int cmp = std::memcmp(in, key.data(), std::min<size_t>(length, key.size()));
+        if (cmp > 0 || (cmp == 0 && length >= key.size())) break;
+        in += length;
+        std::memcpy(&child, in, sizeof(child));
+        in += sizeof(child);
+    }
+    return child;
+}
+
+using Entry = StringBPlusTree::Entry;
+
+bool entry_key_less(const Entry& a, const Entry& b) {
+    return a.first < b.first;
+}
+
+// pares (chave, ponteiro) de uma folha, em ordem
+std::vector<Entry> decode_leaf(const StringTreePage& page) {
+    std::vector<Entry> entries;
+    entries.reserve(page.header.count);
+    const unsigned char* in = page.body;
+    const unsigned char* end = page.body + (page.header.used - sizeof(StringNodeHeader));
+    std::string key;
+    for (int i = 0; i < page.header.count; ++i) {
+        size_t shared = static_cast<size_t>(get_varint(in, end));
+        size_t suffix = static_cast<size_t>(get_varint(in, end));
+        if (shared > key.size() || in + suffix > end) throw std::runtime_error("ERRO: folha do índice de títulos corrompida.");
+        key.resize(shared);
+        key.append(reinterpret_cast<const char*>(in), suffix);
+        in += suffix;
+        entries.push_back({key, static_cast<f_ptr>(get_varint(in, end))});
+    }
+    return entries;
+}
+
+// filhos e separadores de um nó interno (separators[i] fica entre children[i] e children[i + 1])
+void decode_internal(const StringTreePage& page, std::vector<int64_t>& children, std::vector<std::string>& separators) {
+    const unsigned char* in = page.body;
+    const unsigned char* end = page.body + (page.header.used - sizeof(StringNodeHeader));
+    int64_t child;
+    std::memcpy(&child, in, sizeof(child));
+    in += sizeof(child);
+    children.push_back(child);
+    for (int i = 1; i < page.header.count; ++i) {
+        uint16_t length;
+        std::memcpy(&length, in, sizeof(length));
+        in += sizeof(length);
+        if (in + length + sizeof(int64_t) > end) throw std::runtime_error("ERRO: nó do índice de títulos corrompido.");
+        separators.emplace_back(reinterpret_cast<const char*>(in), length);
+        in += length;
+        std::memcpy(&child, in, sizeof(child));
+        in += sizeof(child);
+        children.push_back(child);
+    }
+}
+
+// onde cada folha começa se as entradas forem gravadas em sequência com o limite dado; total recebe os bytes usados
+std::vector<size_t> leaf_starts(const std::vector<Entry>& entries, size_t limit, size_t& total) {
+    StringTreePage scratch;
+    LeafBuilder leaf(scratch, limit);
+    std::vector<size_t> starts{0};
+    total = 0;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        if (!leaf.add(entries[i].first, entries[i].second)) {
+            total += scratch.header.used - sizeof(StringNodeHeader);
+            starts.push_back(i);
+            leaf.reset();
+            leaf.add(entries[i].first, entries[i].second);
+        }
+    }
+    total += scratch.header.used - sizeof(StringNodeHeader);
+    return starts;
+}
+
+// idem para um nó interno: onde cada nó começa (índices em children)
+std::vector<size_t> internal_starts(const std::vector<int64_t>& children, const std::vector<std::string>& separators,
+                                    size_t limit, size_t& total) {
+    StringTreePage scratch;
+    InternalBuilder node(scratch, limit);
+    std::vector<size_t> starts{0};
+    total = 0;
+    node.start(children[0]);
+    for (size_t i = 1; i < children.size(); ++i) {
+        if (!node.add(separators[i - 1], children[i])) {
+            total += scratch.header.used - sizeof(StringNodeHeader);
+            starts.push_back(i);
+            node.start(children[i]);
+        }
+    }
+    total += scratch.header.used - sizeof(StringNodeHeader);
+    return starts;
+}
+
+} // namespace
+
+StringBPlusTree::StringBPlusTree(const std::string& index_file_path, OpenMode mode) : index_path(index_file_path) {
+    ensure_no_pending_recovery(index_file_path, mode);
+    if (mode == OpenMode::READ_ONLY) {
+        read_only = true;
+        mapped_file.open(index_file_path);
+        if (mapped_file.size() < 2 * STRING_TREE_PAGE_SIZE) {
+            LOG_ERROR("Arquivo de indice muito pequeno para leitura: " << index_path);
+            throw std::runtime_error("ERRO: arquivo de índice inválido.");
+        }
+        std::memcpy(&metadata, mapped_file.data(), sizeof(metadata));
+        if (metadata.magic != STRING_TREE_MAGIC || metadata.version != STRING_TREE_VERSION ||
+            static_cast<size_t>(metadata.page_count + 1) * STRING_TREE_PAGE_SIZE > mapped_file.size()) {
+            LOG_ERROR("Metadados do indice " << index_path << " invalidos. Refaca o upload.");
+            throw std::runtime_error("ERRO: arquivo de índice em formato inválido.");
+        }
+        // buscas exatas e de prefixo descem por caminhos aleatórios; a raiz é usada por todas
+        mapped_file.advise(MADV_RANDOM);
+        mapped_file.advise_range(static_cast<size_t>(metadata.root_page) * STRING_TREE_PAGE_SIZE, STRING_TREE_PAGE_SIZE, MADV_WILLNEED);
+        LOG_DEBUG("CONSTRUTOR DA ARVORE B+ DE STRINGS (" << index_path << "): Arquivo mapeado em memoria. "
+                  << metadata.entry_count << " chaves, altura " << metadata.height);
+        return;
+    }
+
+    index_file.open(index_file_path, std::ios::in | std::ios::out | std::ios::binary);
+    bool valid = false;
+    if (index_file.is_open()) {
+        index_file.read(reinterpret_cast<char*>(&metadata), sizeof(metadata));
+        valid = index_file && metadata.magic == STRING_TREE_MAGIC && metadata.version == STRING_TREE_VERSION;
+        index_file.clear();
+        if (!valid) {
+            LOG_DEBUG("CONSTRUTOR DA ARVORE B+ DE STRINGS (" << index_path << "): Arquivo existente invalido. Re-inicializando...");
+            index_file.close();
+        }
+    }
+    if (!valid) {
+        index_file.open(index_file_path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!index_file) {
+            LOG_ERROR("Erro na criação do índice " << index_path);
+            throw std::runtime_error("ERRO: Não foi possível criar o arquivo de índice");
+        }
+        initialize_empty_tree();
+    }
+    LOG_DEBUG("CONSTRUTOR DA ARVORE B+ DE STRINGS (" << index_path << "): Arvore aberta com " << metadata.entry_count << " chaves");
+}
+
+StringBPlusTree::~StringBPlusTree() {
+    if (index_file.is_open()) {
+        try {
+            write_metadata();
+            index_file.flush();
+        } catch (const std::exception&) {
+            LOG_ERROR("Falha ao salvar metadados no destrutor da árvore B+ de strings (" << index_path << ")!");
+        }
+        index_file.close();
+    }
+}
+
+void StringBPlusTree::initialize_empty_tree() {
+    metadata = StringTreeMetadata{};
+    metadata.magic = STRING_TREE_MAGIC;
+    metadata.version = STRING_TREE_VERSION;
+    metadata.root_page = 1;
+    metadata.page_count = 1;
+    metadata.leaf_count = 1;
+    metadata.height = 1;
+
+    StringTreePage empty_leaf;
+    LeafBuilder empty(empty_leaf, BODY_SIZE); // só prepara a página como folha vazia
+    write_metadata();
+    write_page(1, empty_leaf);
+}
+
+void StringBPlusTree::write_metadata() {
+    std::vector<char> page(STRING_TREE_PAGE_SIZE, 0);
+    std::memcpy(page.data(), &metadata, sizeof(metadata));
+    index_file.seekp(0);
+    if (!index_file.write(page.data(), page.size())) {
+        LOG_ERROR("Falha em escrever metadados do índice " << index_path);
+        throw std::runtime_error("ERRO: Falha ao escrever metadados.");
+    }
+}
+
+void StringBPlusTree::write_page(long page_number, const StringTreePage& page) {
+    index_file.seekp(static_cast<std::streamoff>(page_number) * STRING_TREE_PAGE_SIZE);
+    if (!index_file.write(reinterpret_cast<const char*>(&page), sizeof(page))) {
+        LOG_ERROR("(WRITE B+ " << index_path << ") Falha ao escrever a pagina " << page_number);
+        throw std::runtime_error("ERRO: Falha ao escrever nó do índice.");
+    }
+}
+
+const StringTreePage& StringBPlusTree::fetch_page(long page_number, StringTreePage& scratch) {
+    if (page_number < 1 || page_number > metadata.page_count) {
+        LOG_ERROR("(READ B+ " << index_path << ") ERRO FATAL: Tentativa de ler pagina invalida: " << page_number);
+        throw std::runtime_error("Pagina de leitura invalida.");
+    }
+    if (read_only) {
+        return *reinterpret_cast<const StringTreePage*>(mapped_file.data() + page_number * STRING_TREE_PAGE_SIZE);
+    }
+    index_file.seekg(static_cast<std::streamoff>(page_number) * STRING_TREE_PAGE_SIZE);
+    if (!index_file.read(reinterpret_cast<char*>(&scratch), sizeof(scratch))) {
+        LOG_ERROR("(READ B+ " << index_path << ") Falha ao ler a pagina " << page_number);
+        index_file.clear();
+        throw std::runtime_error("ERRO: Falha ao ler nó do índice.");
+    }
+    return scratch;
+}
+
+void StringBPlusTree::bulk_load(ExternalSorter<std::string>& entries, double fill_factor) {
+    if (read_only) throw std::runtime_error("ERRO: bulk_load em índice aberto somente para leitura.");
+    if (metadata.entry_count != 0) {
+        LOG_ERROR("bulk_load chamado em um indice nao vazio (" << index_path << ")");
+        throw std::runtime_error("ERRO: bulk_load exige um índice vazio.");
+    }
+    fill_factor = std::min(1.0, std::max(0.1, fill_factor));
+    const size_t limit = static_cast<size_t>(BODY_SIZE * fill_factor);
+
+    // cada nível é a lista de (separador antes do nó, página); o primeiro nó do nível não tem separador
+    struct LevelEntry {
+        std::string separator;
+        int64_t page;
+    };
+    std::vector<LevelEntry> level;
+
+    // folhas: gravadas em sequência a partir da página 1, cada uma apontando para a seguinte
+    StringTreePage page;
+    LeafBuilder leaf(page, limit);
+    int64_t next_page = 1;
+    std::string pending_separator;
+    long loaded = 0;
+    ExternalSorter<std::string>::Entry entry;
+    while (entries.next(entry)) {
+        if (entry.first.size() > MAX_KEY_SIZE) {
+            LOG_ERROR("Chave de " << entry.first.size() << " bytes excede o limite do indice " << index_path);
+            throw std::runtime_error("ERRO: chave grande demais para o índice de strings.");
+        }
+        if (!leaf.add(entry.first, entry.second)) {
+            page.header.next_leaf = next_page + 1;
+            write_page(next_page, page);
+            level.push_back({pending_separator, next_page});
+            pending_separator = shortest_separator(leaf.last(), entry.first);
+            next_page++;
+            leaf.reset();
+            leaf.add(entry.first, entry.second);
+        }
+        loaded++;
+    }
+    write_page(next_page, page); // última folha (ou a única, vazia)
+    level.push_back({pending_separator, next_page});
+    metadata.leaf_count = next_page;
+    next_page++;
+    int height = 1;
+
+    // níveis internos até sobrar um nó só
+    while (level.size() > 1) {
+        std::vector<LevelEntry> upper;
+        InternalBuilder node(page, limit);
+        node.start(level[0].page);
+        std::string node_separator = level[0].separator;
+        for (size_t i = 1; i < level.size(); ++i) {
+            if (!node.add(level[i].separator, level[i].page)) {
+                write_page(next_page, page);
+                upper.push_back({node_separator, next_page++});
+                node.start(level[i].page);
+                node_separator = level[i].separator;
+            }
+        }
+        write_page(next_page, page);
+        upper.push_back({node_separator, next_page++});
+        level.swap(upper);
+        height++;
+    }
+
+    metadata.root_page = level[0].page;
+    metadata.page_count = next_page - 1;
+    metadata.entry_count = loaded;
+    metadata.height = height;
+    write_metadata();
+    index_file.flush();
+    LOG_DEBUG("[BULK] " << index_path << ": " << loaded << " chaves em " << metadata.leaf_count << " folhas, "
+             << metadata.page_count << " paginas, altura " << height);
+}
+
+long StringBPlusTree::merge_batch(const std::vector<Entry>& insertions, const std::vector<Entry>& removals) {
+    if (read_only) throw std::runtime_error("ERRO: merge_batch em índice aberto somente para leitura.");
+    for (const Entry& entry : insertions) {
+        if (entry.first.size() > MAX_KEY_SIZE) {
+            LOG_ERROR("Chave de " << entry.first.size() << " bytes excede o limite do indice " << index_path);
+            throw std::runtime_error("ERRO: chave grande demais para o índice de strings.");
+        }
+    }
+    long missing = 0;
+    std::vector<Entry> pending = removals;
+    std::vector<Sibling> siblings;
+    merge_node(static_cast<long>(metadata.root_page), insertions.data(), insertions.size(), pending, missing, siblings);
+    missing += static_cast<long>(pending.size()); // passaram da última folha
+
+    // a raiz se dividiu: ela e os irmãos novos ficam embaixo de uma raiz nova (que também pode se dividir)
+    while (!siblings.empty()) {
+        std::vector<int64_t> children{metadata.root_page};
+        std::vector<std::string> separators;
+        for (Sibling& sibling : siblings) {
+            separators.push_back(std::move(sibling.separator));
+            children.push_back(sibling.page);
+        }
+        siblings.clear();
+        long root = allocate_page();
+        write_internal(root, children, separators, siblings);
+        metadata.root_page = root;
+        metadata.height++;
+    }
+
+    metadata.entry_count += static_cast<int64_t>(insertions.size()) - static_cast<int64_t>(removals.size() - missing);
+    write_metadata();
+    index_file.flush();
+    LOG_DEBUG("[MERGE] " << index_path << ": +" << insertions.size() << " -" << (removals.size() - missing)
+              << " chaves, " << metadata.page_count << " paginas, altura " << metadata.height);
+    return missing;
+}
+
+void StringBPlusTree::merge_node(long page_number, const Entry* insertions, size_t count, std::vector<Entry>& removals,
+                                 long& missing, std::vector<Sibling>& siblings) {
+    StringTreePage scratch;
+    const StringTreePage& page = fetch_page(page_number, scratch);
+
+    if (page.header.is_leaf) {
+        std::vector<Entry> entries = decode_leaf(page);
+        int64_t next_leaf = page.header.next_leaf;
+        bool changed = false;
+        // uma remoção que não está aqui pode estar na folha seguinte só se a chave não for menor que a última
+        bool empty_leaf = entries.empty();
+        std::string last_key = empty_leaf ? std::string() : entries.back().first;
+        std::vector<Entry> carried;
+        for (const Entry& removal : removals) {
+            auto range = std::equal_range(entries.begin(), entries.end(), removal, entry_key_less);
+            auto it = std::find(range.first, range.second, removal);
+            if (it != range.second) {
+                entries.erase(it);
+                changed = true;
+            } else if (empty_leaf || !(removal.first < last_key)) {
+                carried.push_back(removal);
+            } else {
+                missing++;
+            }
+        }
+        removals.swap(carried);
+        if (count > 0) {
+            // as chaves novas ficam depois das iguais que já estavam na folha
+            std::vector<Entry> merged;
+            merged.reserve(entries.size() + count);
+            std::merge(entries.begin(), entries.end(), insertions, insertions + count, std::back_inserter(merged), entry_key_less);
+            entries.swap(merged);
+            changed = true;
+        }
+        if (changed) write_leaves(page_number, next_leaf, entries, siblings);
+        return;
+    }
+
+    // cada filho recebe as chaves que a busca mandaria para ele (separadores < chave); as remoções que sobram de
+    // um filho passam para o seguinte, que começa na folha seguinte
+    std::vector<int64_t> children;
+    std::vector<std::string> separators;
+    decode_internal(page, children, separators);
+    std::vector<int64_t> new_children;
+    std::vector<std::string> new_separators;
+    std::vector<Entry> pending;
+    size_t insert_first = 0, remove_first = 0;
+    for (size_t i = 0; i < children.size(); ++i) {
+        size_t insert_end = count, remove_end = removals.size();
+        if (i + 1 < children.size()) {
+            Entry bound{separators[i], 0};
+            insert_end = static_cast<size_t>(std::upper_bound(insertions + insert_first, insertions + count, bound, entry_key_less) - insertions);
+            remove_end = static_cast<size_t>(std::upper_bound(removals.begin() + remove_first, removals.end(), bound, entry_key_less) - removals.begin());
+        }
+        pending.insert(pending.end(), removals.begin() + remove_first, removals.begin() + remove_end);
+        if (i > 0) new_separators.push_back(separators[i - 1]);
+        new_children.push_back(children[i]);
+        if (insert_end > insert_first || !pending.empty()) {
+            std::vector<Sibling> created;
+            merge_node(static_cast<long>(children[i]), insertions + insert_first, insert_end - insert_first, pending, missing, created);
+            for (Sibling& sibling : created) {
+                new_separators.push_back(std::move(sibling.separator));
+                new_children.push_back(sibling.page);
+            }
+        }
+        insert_first = insert_end;
+        remove_first = remove_end;
+    }
+    removals.swap(pending);
+    if (new_children.size() != children.size()) write_internal(page_number, new_children, new_separators, siblings);
+}
+
+void StringBPlusTree::write_leaves(long page_number, int64_t next_leaf, const std::vector<Entry>& entries, std::vector<Sibling>& siblings) {
+    // numa página só quando cabe; senão o limite divide os bytes por igual entre as folhas (com uma folga para a
+    // primeira chave de cada uma, que vai inteira)
+    size_t total = 0;
+    std::vector<size_t> starts = leaf_starts(entries, BODY_SIZE, total);
+    if (starts.size() > 1) starts = leaf_starts(entries, std::min(BODY_SIZE, total / starts.size() + BODY_SIZE / 8), total);
+
+    std::vector<long> pages{page_number};
+    for (size_t p = 1; p < starts.size(); ++p) pages.push_back(allocate_page());
+    StringTreePage page;
+    LeafBuilder leaf(page, BODY_SIZE);
+    for (size_t p = 0; p < starts.size(); ++p) {
+        size_t end = (p + 1 < starts.size()) ? starts[p + 1] : entries.size();
+        leaf.reset();
+        for (size_t i = starts[p]; i < end; ++i) {
+            if (!leaf.add(entries[i].first, entries[i].second)) throw std::runtime_error("ERRO: folha do índice de strings estourou.");
+        }
+        page.header.next_leaf = (p + 1 < starts.size()) ? pages[p + 1] : next_leaf;
+        write_page(pages[p], page);
+        if (p > 0) siblings.push_back({shortest_separator(entries[starts[p] - 1].first, entries[starts[p]].first), pages[p]});
+    }
+}
+
+void StringBPlusTree::write_internal(long page_number, const std::vector<int64_t>& children, const std::vector<std::string>& separators,
+                                     std::vector<Sibling>& siblings) {
+    size_t total = 0;
+    std::vector<size_t> starts = internal_starts(children, separators, BODY_SIZE, total);
+    if (starts.size() > 1) starts = internal_starts(children, separators, std::min(BODY_SIZE, total / starts.size() + BODY_SIZE / 8), total);
+
+    std::vector<long> pages{page_number};
+    for (size_t p = 1; p < starts.size(); ++p) pages.push_back(allocate_page());
+    StringTreePage page;
+    InternalBuilder node(page, BODY_SIZE);
+    for (size_t p = 0; p < starts.size(); ++p) {
+        size_t end = (p + 1 < starts.size()) ? starts[p + 1] : children.size();
+        node.start(children[starts[p]]);
+        for (size_t i = starts[p] + 1; i < end; ++i) {
+            if (!node.add(separators[i - 1], children[i])) throw std::runtime_error("ERRO: nó do índice de strings estourou.");
+        }
+        write_page(pages[p], page);
+        // o separador antes do primeiro filho do nó sobe para o pai
+        if (p > 0) siblings.push_back({separators[starts[p] - 1], pages[p]});
+    }
+}
+
+long StringBPlusTree::scan_from(const std::string& lo, const Visitor& visit) {
+    long blocks_read = 0;
+    StringTreePage scratch;
+    long page_number = static_cast<long>(metadata.root_page);
+    const StringTreePage* page = &fetch_page(page_number, scratch);
+    blocks_read++;
+    while (!page->header.is_leaf) {
+        page_number = static_cast<long>(child_for(*page, lo));
+        page = &fetch_page(page_number, scratch);
+        blocks_read++;
+    }
+
+    // nas folhas: decodifica a codificação frontal e pula as chaves < lo (só na primeira folha)
+    long readahead_until = page_number + 1;
+    std::string key;
+    bool skipping = true;
+    while (true) {
+        const unsigned char* in = page->body;
+        const unsigned char* end = page->body + (page->header.used - sizeof(StringNodeHeader));
+        for (int i = 0; i < page->header.count; ++i) {
+            size_t shared = static_cast<size_t>(get_varint(in, end));
+            size_t suffix = static_cast<size_t>(get_varint(in, end));
+            if (shared > key.size() || in + suffix > end) throw std::runtime_error("ERRO: folha do índice de títulos corrompida.");
+            key.resize(shared);
+            key.append(reinterpret_cast<const char*>(in), suffix);
+            in += suffix;
+            f_ptr ptr = static_cast<f_ptr>(get_varint(in, end));
+            if (skipping) {
+                if (key < lo) continue;
+                skipping = false;
+            }
+            if (!visit(key, ptr)) return blocks_read;
+        }
+
+        if (page->header.next_leaf < 0) return blocks_read;
+        page_number = static_cast<long>(page->header.next_leaf);
+        // a varredura passou da primeira folha: as seguintes estão lado a lado no arquivo, pedimos um lote
+        // adiantado ao kernel sempre que a metade da janela anterior foi consumida
+        if (read_only && page_number >= readahead_until - SCAN_READAHEAD_LEAVES / 2) {
+            long first = std::max(page_number, readahead_until);
+            long last = std::min<long>(page_number + SCAN_READAHEAD_LEAVES, static_cast<long>(metadata.leaf_count));
+            if (last >= first) {
+                mapped_file.advise_range(static_cast<size_t>(first) * STRING_TREE_PAGE_SIZE,
+                                         static_cast<size_t>(last - first + 1) * STRING_TREE_PAGE_SIZE, MADV_WILLNEED);
+                readahead_until = last + 1;
+            }
+        }
+        page = &fetch_page(page_number, scratch);
+        blocks_read++;
+    }
+}
+
+f_ptr StringBPlusTree::search(const std::string& key, int& blocks_read) {
+    f_ptr found = -1;
+    blocks_read = static_cast<int>(scan_from(key, [&](const std::string& current, f_ptr ptr) {
+        if (current == key) found = ptr;
+        return false; // a primeira chave >= key decide
+    }));
+    return found;
+}
+
+long StringBPlusTree::scan(const std::string& lo, const std::string& hi, const Visitor& visit) {
+    if (hi < lo) return 0;
+    return scan_from(lo, [&](const std::string& key, f_ptr ptr) {
+        return key <= hi && visit(key, ptr);
+    });
+}
+
+long StringBPlusTree::scan_prefix(const std::string& prefix, const Visitor& visit) {
+    return scan_from(prefix, [&](const std::string& key, f_ptr ptr) {
+        return key.compare(0, prefix.size(), prefix) == 0 && visit(key, ptr);
+    });
+}
@@ -0,0 +1,544 @@
+#include "text_index.hpp"
+
+#include <fstream>
+#include <algorithm>
+#include <queue>
+#include <iterator>
+#include <cstring>
+#include <cstdio>
+#include <stdexcept>
+
+#include "varint.hpp"
+#include "log.hpp"
+
+namespace {
+
+// segundo byte das letras latinas em UTF-8 que começam com 0xC3 (U+00C0 a U+00FF) -> letra sem acento
+// '\0' marca os símbolos (× ÷ Þ þ), tratados como separadores
+const char LATIN1_FOLD[64] = {
+    'a', 'a', 'a', 'a', 'a', 'a', 'a', 'c', 'e', 'e', 'e', 'e', 'i', 'i', 'i', 'i',
+    'd', 'n', 'o', 'o', 'o', 'o', 'o', '\0', 'o', 'u', 'u', 'u', 'u', 'y', '\0', 's',
+    'a', 'a', 'a', 'a', 'a', 'a', 'a', 'c', 'e', 'e', 'e', 'e', 'i', 'i', 'i', 'i',
+    'd', 'n', 'o', 'o', 'o', 'o', 'o', '\0', 'o', 'u', 'u', 'u', 'u', 'y', '\0', 'y'};
+
+// normaliza o caractere em p: letra ou dígito minúsculo e sem acento, '\0' para separadores; os outros
+// caracteres UTF-8 (gregos, cirílicos...) ficam como estão. Nas letras latinas acentuadas avança p até o segundo byte
+char fold_char(const unsigned char*& p) {
+    unsigned char c = *p;
+    if (c < 0x80) {
+        if (c >= 'A' && c <= 'Z') return static_cast<char>(c - 'A' + 'a');
+        if ((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9')) return static_cast<char>(c);
+        return '\0';
+    }
+    if (c == 0xC3 && p[1] >= 0x80 && p[1] <= 0xBF) {
+        ++p;
+        return LATIN1_FOLD[p[0] - 0x80];
+    }
+    return static_cast<char>(c);
+}
+
+const size_t TERM_OVERHEAD = 96; // memória aproximada de cada termo no mapa, além do texto e das postagens
+
+void write_header(std::ofstream& out, uint64_t count) {
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&TEXT_INDEX_MAGIC), sizeof(TEXT_INDEX_MAGIC));
+    out.write(reinterpret_cast<const char*>(&TEXT_INDEX_VERSION), sizeof(TEXT_INDEX_VERSION));
+    out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+}
+
+// lê o cabeçalho de um arquivo mapeado, retorna a quantidade guardada nele
+uint64_t read_header(const MappedFile& file, const std::string& path) {
+    uint32_t magic, version;
+    uint64_t count;
+    if (file.size() < TEXT_INDEX_HEADER_SIZE) throw std::runtime_error("ERRO: arquivo do índice de texto inválido.");
+    std::memcpy(&magic, file.data(), sizeof(magic));
+    std::memcpy(&version, file.data() + 4, sizeof(version));
+    std::memcpy(&count, file.data() + 8, sizeof(count));
+    if (magic != TEXT_INDEX_MAGIC || version != TEXT_INDEX_VERSION) {
+        LOG_ERROR("Arquivo " << path << " nao e um indice de texto valido. Refaca o upload.");
+        throw std::runtime_error("ERRO: arquivo do índice de texto em formato inválido.");
+    }
+    return count;
+}
+
+// termos do artigo (Titulo, Autores e Snippet), em ordem e sem repetições
+void document_terms(const Artigo& artigo, std::vector<std::string>& terms) {
+    terms.clear();
+    auto collect = [&terms](const std::string& term) { terms.push_back(term); };
+    tokenize_text(artigo.Titulo, collect);
+    tokenize_text(artigo.Autores, collect);
+    tokenize_text(artigo.Snippet, collect);
+    std::sort(terms.begin(), terms.end());
+    terms.erase(std::unique(terms.begin(), terms.end()), terms.end());
+}
+
+// Um pedaço da lista de um termo (de uma run ou da memória): os documentos de um pedaço são todos maiores que
+// os do pedaço anterior, então a lista final é só a concatenação com a primeira diferença recalculada
+struct Segment {
+    uint32_t count;
+    uint32_t first_doc;
+    uint32_t last_doc;
+    std::vector<unsigned char> bytes;
+};
+
+// Leitor sequencial de uma run: (u32 tamanho, termo, u32 quantidade, u32 primeiro, u32 último, u32 bytes, bytes)
+struct RunReader {
+    std::ifstream file;
+    std::string term;
+    Segment segment;
+
+    bool next() {
+        uint32_t length, byte_length;
+        if (!file.read(reinterpret_cast<char*>(&length), sizeof(length))) return false;
+        term.resize(length);
+        file.read(&term[0], length);
+        file.read(reinterpret_cast<char*>(&segment.count), sizeof(segment.count));
+        file.read(reinterpret_cast<char*>(&segment.first_doc), sizeof(segment.first_doc));
+        file.read(reinterpret_cast<char*>(&segment.last_doc), sizeof(segment.last_doc));
+        file.read(reinterpret_cast<char*>(&byte_length), sizeof(byte_length));
+        segment.bytes.resize(byte_length);
+        file.read(reinterpret_cast<char*>(segment.bytes.data()), byte_length);
+        if (!file) throw std::runtime_error("ERRO: run do índice de texto truncada.");
+        return true;
+    }
+};
+
+} // namespace
+
+void tokenize_text(const char* text, const std::function<void(const std::string&)>& emit) {
+    std::string term;
+    bool too_long = false;
+    auto flush = [&]() {
+        if (term.size() >= 2 && !too_long) emit(term);
+        term.clear();
+        too_long = false;
+    };
+    for (const unsigned char* p = reinterpret_cast<const unsigned char*>(text); *p != '\0'; ++p) {
+        char folded = fold_char(p);
+        if (folded == '\0') {
+            flush();
+        } else if (term.size() < MAX_TERM_SIZE) {
+            term.push_back(folded);
+        } else {
+            too_long = true;
+        }
+    }
+    flush();
+}
+
+void split_authors(const char* autores, const std::function<void(const std::string&)>& emit) {
+    size_t length = strnlen(autores, sizeof(Artigo::Autores) - 1);
+    const unsigned char* end = reinterpret_cast<const unsigned char*>(autores) + length;
+    std::string name;
+    bool pending_space = false;
+    for (const unsigned char* p = reinterpret_cast<const unsigned char*>(autores); p < end; ++p) {
+        if (*p == ',' || *p == ';' || *p == '|') {
+            if (!name.empty()) emit(name);
+            name.clear();
+            pending_space = false;
+            continue;
+        }
+        char folded = fold_char(p);
+        if (folded == '\0') {
+            pending_space = !name.empty(); // espaços, pontos e hífens viram um único espaço entre as partes
+            continue;
+        }
+        if (pending_space) name.push_back(' ');
+        pending_space = false;
+        name.push_back(folded);
+    }
+    // com o campo cheio o último nome provavelmente foi cortado no upload
+    if (!name.empty() && length < sizeof(Artigo::Autores) - 1) emit(name);
+}
+
+TextIndexBuilder::TextIndexBuilder(const std::string& data_dir, size_t memory_budget)
+    : data_dir(data_dir), memory_budget(memory_budget) {}
+
+TextIndexBuilder::~TextIndexBuilder() {
+    for (const std::string& path : run_paths) std::remove(path.c_str());
+}
+
+void TextIndexBuilder::add_document(const Artigo& artigo, f_ptr data_ptr) {
+    uint32_t doc = static_cast<uint32_t>(documents.size());
+    documents.push_back({static_cast<int64_t>(data_ptr), artigo.ID, artigo.Citacoes});
+
+    document_terms(artigo, doc_terms);
+    for (const std::string& term : doc_terms) add_posting(term, doc);
+
+    if (memory_used >= memory_budget) spill();
+}
+
+void TextIndexBuilder::add_posting(const std::string& term, uint32_t doc) {
+    auto it = postings.find(term);
+    if (it == postings.end()) {
+        TermPostings& fresh = postings[term];
+        fresh.count = 1;
+        fresh.first_doc = doc;
+        fresh.last_doc = doc;
+        memory_used += TERM_OVERHEAD + term.size();
+        return;
+    }
+    TermPostings& list = it->second;
+    unsigned char encoded[10];
+    size_t length = put_varint(encoded, doc - list.last_doc);
+    list.bytes.insert(list.bytes.end(), encoded, encoded + length);
+    list.count++;
+    list.last_doc = doc;
+    memory_used += length;
+}
+
+// grava as listas em memória, ordenadas pelo termo, como uma nova run
+void TextIndexBuilder::spill() {
+    std::vector<const std::pair<const std::string, TermPostings>*> sorted;
+    sorted.reserve(postings.size());
+    for (const auto& entry : postings) sorted.push_back(&entry);
+    std::sort(sorted.begin(), sorted.end(), [](const auto* a, const auto* b) { return a->first < b->first; });
+
+    std::string path = data_dir + "/text_index.run" + std::to_string(run_paths.size()) + ".tmp";
+    std::ofstream out(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    for (const auto* entry : sorted) {
+        uint32_t length = static_cast<uint32_t>(entry->first.size());
+        uint32_t byte_length = static_cast<uint32_t>(entry->second.bytes.size());
+        out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+        out.write(entry->first.data(), length);
+        out.write(reinterpret_cast<const char*>(&entry->second.count), sizeof(uint32_t));
+        out.write(reinterpret_cast<const char*>(&entry->second.first_doc), sizeof(uint32_t));
+        out.write(reinterpret_cast<const char*>(&entry->second.last_doc), sizeof(uint32_t));
+        out.write(reinterpret_cast<const char*>(&byte_length), sizeof(byte_length));
+        out.write(reinterpret_cast<const char*>(entry->second.bytes.data()), byte_length);
+    }
+    if (!out) {
+        LOG_ERROR("[TEXTO] Falha ao gravar a run " << path);
+        throw std::runtime_error("ERRO: não foi possível gravar arquivo temporário do índice de texto");
+    }
+    run_paths.push_back(path);
+    LOG_DEBUG("[TEXTO] Run " << path << " gravada com " << postings.size() << " termos");
+    postings.clear();
+    memory_used = 0;
+}
+
+void TextIndexBuilder::finish(double fill_factor) {
+    std::string post_path = data_dir + "/text_index.post";
+    std::ofstream post(post_path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!post) {
+        LOG_ERROR("Erro na criação do arquivo " << post_path);
+        throw std::runtime_error("ERRO: Não foi possível criar o arquivo do índice de texto");
+    }
+    write_header(post, 0);
+    uint64_t offset = TEXT_INDEX_HEADER_SIZE;
+    ExternalSorter<std::string> dictionary_entries(data_dir, "text_index.dict.sort", memory_budget);
+
+    // grava a lista de um termo juntando os pedaços em ordem de documento (um segmento só, sem anterior)
+    auto write_term = [&](const std::string& term, const std::vector<const Segment*>& segments) {
+        uint32_t total = 0;
+        for (const Segment* segment : segments) total += segment->count;
+        unsigned char encoded[20];
+        size_t length = put_varint(encoded, total);
+        length += put_varint(encoded + length, 0);
+        post.write(reinterpret_cast<const char*>(encoded), length);
+        uint64_t term_offset = offset;
+        offset += length;
+        uint32_t previous = 0;
+        for (const Segment* segment : segments) {
+            length = put_varint(encoded, segment->first_doc - previous);
+            post.write(reinterpret_cast<const char*>(encoded), length);
+            post.write(reinterpret_cast<const char*>(segment->bytes.data()), segment->bytes.size());
+            offset += length + segment->bytes.size();
+            previous = segment->last_doc;
+        }
+        dictionary_entries.add(term, static_cast<f_ptr>(term_offset));
+        terms_written++;
+        postings_total += total;
+    };
+
+    if (run_paths.empty()) {
+        // tudo coube na memória: basta ordenar os termos
+        std::vector<std::pair<const std::string, TermPostings>*> sorted;
+        sorted.reserve(postings.size());
+        for (auto& entry : postings) sorted.push_back(&entry);
+        std::sort(sorted.begin(), sorted.end(), [](const auto* a, const auto* b) { return a->first < b->first; });
+        Segment segment;
+        for (auto* entry : sorted) {
+            segment.count = entry->second.count;
+            segment.first_doc = entry->second.first_doc;
+            segment.last_doc = entry->second.last_doc;
+            segment.bytes.swap(entry->second.bytes);
+            write_term(entry->first, {&segment});
+        }
+        postings.clear();
+    } else {
+        if (!postings.empty()) spill(); // o resto também vira run para o merge ficar uniforme
+        std::vector<std::unique_ptr<RunReader>> runs;
+        // heap de mínimo por (termo, run): o mesmo termo sai na ordem das runs, que é a ordem dos documentos
+        using HeapItem = std::pair<std::string, size_t>;
+        std::priority_queue<HeapItem, std::vector<HeapItem>, std::greater<HeapItem>> heap;
+        for (size_t i = 0; i < run_paths.size(); ++i) {
+            auto run = std::make_unique<RunReader>();
+            run->file.open(run_paths[i], std::ios::in | std::ios::binary);
+            if (!run->file) {
+                LOG_ERROR("[TEXTO] Falha ao reabrir a run " << run_paths[i]);
+                throw std::runtime_error("ERRO: não foi possível reabrir arquivo temporário do índice de texto");
+            }
+            if (run->next()) heap.push({run->term, i});
+            runs.push_back(std::move(run));
+        }
+        std::vector<size_t> current_runs;
+        std::vector<const Segment*> segments;
+        while (!heap.empty()) {
+            std::string term = heap.top().first;
+            current_runs.clear();
+            segments.clear();
+            while (!heap.empty() && heap.top().first == term) {
+                current_runs.push_back(heap.top().second);
+                segments.push_back(&runs[heap.top().second]->segment);
+                heap.pop();
+            }
+            write_term(term, segments);
+            for (size_t i : current_runs) {
+                if (runs[i]->next()) heap.push({runs[i]->term, i});
+            }
+        }
+        LOG_DEBUG("[TEXTO] " << run_paths.size() << " runs intercaladas");
+    }
+
+    write_header(post, static_cast<uint64_t>(terms_written));
+    post.flush();
+    if (!post) {
+        LOG_ERROR("Falha ao gravar " << post_path);
+        throw std::runtime_error("ERRO: Falha ao gravar o índice de texto.");
+    }
+
+    // tabela de documentos
+    std::string docs_path = data_dir + "/text_index.docs";
+    std::ofstream docs(docs_path, std::ios::out | std::ios::binary | std::ios::trunc);
+    write_header(docs, documents.size());
+    docs.write(reinterpret_cast<const char*>(documents.data()), documents.size() * sizeof(TextDocument));
+    if (!docs) {
+        LOG_ERROR("Falha ao gravar " << docs_path);
+        throw std::runtime_error("ERRO: Falha ao gravar o índice de texto.");
+    }
+
+    // dicionário: os termos já saem em ordem, a ordenação externa só repassa para a carga em lote
+    StringBPlusTree dictionary(data_dir + "/text_index.dict");
+    dictionary_entries.finish();
+    dictionary.bulk_load(dictionary_entries, fill_factor);
+}
+
+TextIndexUpdater::TextIndexUpdater(const std::string& data_dir) : data_dir(data_dir) {
+    std::string docs_path = data_dir + "/text_index.docs";
+    MappedFile docs_file;
+    docs_file.open(docs_path);
+    uint64_t count = read_header(docs_file, docs_path);
+    if (TEXT_INDEX_HEADER_SIZE + count * sizeof(TextDocument) > docs_file.size()) {
+        LOG_ERROR("Tabela de documentos " << docs_path << " truncada");
+        throw std::runtime_error("ERRO: arquivo do índice de texto inválido.");
+    }
+    const TextDocument* rows = reinterpret_cast<const TextDocument*>(docs_file.data() + TEXT_INDEX_HEADER_SIZE);
+    documents.assign(rows, rows + count);
+    first_new_document = static_cast<uint32_t>(count);
+    live_documents.reserve(count);
+    for (uint32_t doc = 0; doc < first_new_document; ++doc) {
+        if (documents[doc].data_ptr >= 0) live_documents[documents[doc].id] = doc;
+    }
+}
+
+void TextIndexUpdater::add_document(const Artigo& artigo, f_ptr data_ptr) {
+    uint32_t doc = static_cast<uint32_t>(documents.size());
+    documents.push_back({static_cast<int64_t>(data_ptr), artigo.ID, artigo.Citacoes});
+    live_documents[artigo.ID] = doc;
+    document_terms(artigo, doc_terms);
+    for (const std::string& term : doc_terms) new_postings[term].push_back(doc);
+    added++;
+}
+
+void TextIndexUpdater::move_document(int id, f_ptr data_ptr) {
+    auto it = live_documents.find(id);
+    if (it == live_documents.end()) {
+        LOG_WARN("AVISO: Registro sem documento no indice de texto ao mudar de endereco. ID: " << id);
+        return;
+    }
+    documents[it->second].data_ptr = static_cast<int64_t>(data_ptr);
+    if (it->second < first_new_document) changed_documents.push_back(it->second);
+}
+
+void TextIndexUpdater::remove_document(int id) {
+    auto it = live_documents.find(id);
+    if (it == live_documents.end()) {
+        LOG_WARN("AVISO: Registro apagado sem documento no indice de texto. ID: " << id);
+        return;
+    }
+    documents[it->second].data_ptr = -1;
+    if (it->second < first_new_document) changed_documents.push_back(it->second);
+    live_documents.erase(it);
+    removed++;
+}
+
+void TextIndexUpdater::finish() {
+    std::vector<std::string> terms;
+    terms.reserve(new_postings.size());
+    for (const auto& entry : new_postings) terms.push_back(entry.first);
+    std::sort(terms.begin(), terms.end());
+
+    // segmento atual de cada termo tocado: uma varredura do dicionário pela faixa dos termos, intercalada com a
+    // lista ordenada (0 = termo novo)
+    StringBPlusTree dictionary(data_dir + "/text_index.dict");
+    std::vector<f_ptr> previous(terms.size(), 0);
+    if (!terms.empty()) {
+        size_t next = 0;
+        dictionary.scan(terms.front(), terms.back(), [&](const std::string& key, f_ptr segment) {
+            while (next < terms.size() && terms[next] < key) next++;
+            if (next == terms.size()) return false;
+            if (terms[next] == key) previous[next] = segment;
+            return true;
+        });
+    }
+
+    // os segmentos novos vão para o fim de text_index.post, em ordem de termo
+    std::string post_path = data_dir + "/text_index.post";
+    std::fstream post(post_path, std::ios::in | std::ios::out | std::ios::binary);
+    uint64_t term_total = 0;
+    post.seekg(8);
+    post.read(reinterpret_cast<char*>(&term_total), sizeof(term_total));
+    post.seekp(0, std::ios::end);
+    uint64_t offset = static_cast<uint64_t>(post.tellp());
+    if (!post) {
+        LOG_ERROR("Falha ao abrir " << post_path << " para a carga incremental");
+        throw std::runtime_error("ERRO: Falha ao gravar o índice de texto.");
+    }
+    std::vector<StringBPlusTree::Entry> insertions, removals;
+    insertions.reserve(terms.size());
+    std::vector<unsigned char> segment;
+    unsigned char encoded[10];
+    for (size_t i = 0; i < terms.size(); ++i) {
+        const std::vector<uint32_t>& docs = new_postings[terms[i]];
+        segment.clear();
+        auto put = [&](uint64_t value) {
+            size_t length = put_varint(encoded, value);
+            segment.insert(segment.end(), encoded, encoded + length);
+        };
+        put(docs.size());
+        put(static_cast<uint64_t>(previous[i]));
+        uint32_t last = 0;
+        for (uint32_t doc : docs) {
+            put(doc - last);
+            last = doc;
+        }
+        post.write(reinterpret_cast<const char*>(segment.data()), segment.size());
+        insertions.push_back({terms[i], static_cast<f_ptr>(offset)});
+        if (previous[i] != 0) {
+            removals.push_back({terms[i], previous[i]});
+        } else {
+            term_total++;
+        }
+        offset += segment.size();
+    }
+    post.seekp(8);
+    post.write(reinterpret_cast<const char*>(&term_total), sizeof(term_total));
+    post.flush();
+    if (!post) {
+        LOG_ERROR("Falha ao gravar " << post_path);
+        throw std::runtime_error("ERRO: Falha ao gravar o índice de texto.");
+    }
+    long missing = dictionary.merge_batch(insertions, removals);
+    if (missing > 0) LOG_WARN("AVISO: " << missing << " termos sem entrada no dicionario ao trocar o segmento");
+
+    // tabela de documentos: as linhas que mudaram são regravadas no lugar e as novas vão para o fim
+    std::string docs_path = data_dir + "/text_index.docs";
+    std::fstream docs(docs_path, std::ios::in | std::ios::out | std::ios::binary);
+    std::sort(changed_documents.begin(), changed_documents.end());
+    changed_documents.erase(std::unique(changed_documents.begin(), changed_documents.end()), changed_documents.end());
+    for (uint32_t doc : changed_documents) {
+        docs.seekp(static_cast<std::streamoff>(TEXT_INDEX_HEADER_SIZE + doc * sizeof(TextDocument)));
+        docs.write(reinterpret_cast<const char*>(&documents[doc]), sizeof(TextDocument));
+    }
+    docs.seekp(static_cast<std::streamoff>(TEXT_INDEX_HEADER_SIZE + first_new_document * sizeof(TextDocument)));
+    docs.write(reinterpret_cast<const char*>(documents.data() + first_new_document),
+               (documents.size() - first_new_document) * sizeof(TextDocument));
+    uint64_t document_total = documents.size();
+    docs.seekp(8);
+    docs.write(reinterpret_cast<const char*>(&document_total), sizeof(document_total));
+    docs.flush();
+    if (!docs) {
+        LOG_ERROR("Falha ao gravar " << docs_path);
+        throw std::runtime_error("ERRO: Falha ao gravar o índice de texto.");
+    }
+    LOG_INFO("[TEXTO] Carga incremental: " << added << " documentos novos, " << removed << " apagados, "
+             << terms.size() << " segmentos acrescentados");
+}
+
+TextIndex::TextIndex(const std::string& data_dir)
+    : dictionary(data_dir + "/text_index.dict", OpenMode::READ_ONLY) {
+    std::string post_path = data_dir + "/text_index.post";
+    std::string docs_path = data_dir + "/text_index.docs";
+    postings_file.open(post_path);
+    read_header(postings_file, post_path);
+    documents_file.open(docs_path);
+    document_total = read_header(documents_file, docs_path);
+    if (TEXT_INDEX_HEADER_SIZE + document_total * sizeof(TextDocument) > documents_file.size()) {
+        LOG_ERROR("Tabela de documentos " << docs_path << " truncada");
+        throw std::runtime_error("ERRO: arquivo do índice de texto inválido.");
+    }
+    documents = reinterpret_cast<const TextDocument*>(documents_file.data() + TEXT_INDEX_HEADER_SIZE);
+    postings_file.advise(MADV_RANDOM);
+}
+
+std::vector<uint32_t> TextIndex::postings(const std::string& term, long& dict_blocks) {
+    std::vector<uint32_t> docs;
+    int blocks = 0;
+    f_ptr offset = dictionary.search(term, blocks);
+    dict_blocks += blocks;
+    if (offset == -1) return docs;
+    if (static_cast<size_t>(offset) >= postings_file.size()) throw std::runtime_error("ERRO: offset inválido no dicionário de termos.");
+
+    // segmentos do mais novo para o mais antigo (cada um aponta para um offset menor), lidos depois na ordem inversa
+    const unsigned char* base = reinterpret_cast<const unsigned char*>(postings_file.data());
+    const unsigned char* end = base + postings_file.size();
+    std::vector<std::pair<uint64_t, const unsigned char*>> segments;
+    uint64_t next = static_cast<uint64_t>(offset);
+    while (next != 0) {
+        const unsigned char* in = base + next;
+        uint64_t count = get_varint(in, end);
+        uint64_t previous = get_varint(in, end);
+        if (count > document_total || previous >= next) throw std::runtime_error("ERRO: lista de postagens corrompida.");
+        segments.push_back({count, in});
+        next = previous;
+    }
+    for (auto it = segments.rbegin(); it != segments.rend(); ++it) {
+        const unsigned char* in = it->second;
+        uint32_t doc = 0;
+        for (uint64_t i = 0; i < it->first; ++i) {
+            doc += static_cast<uint32_t>(get_varint(in, end));
+            if (doc >= document_total) throw std::runtime_error("ERRO: lista de postagens corrompida.");
+            if (documents[doc].data_ptr >= 0) docs.push_back(doc); // lápides ficam de fora
+        }
+    }
+    return docs;
+}
+
+std::vector<uint32_t> intersect_postings(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b) {
+    const std::vector<uint32_t>& small = (a.size() <= b.size()) ? a : b;
+    const std::vector<uint32_t>& large = (a.size() <= b.size()) ? b : a;
+    std::vector<uint32_t> out;
+    size_t low = 0;
+    for (uint32_t doc : small) {
+        // galope: dobra o passo até passar do documento, depois busca binária só nesse trecho
+        size_t step = 1, high = low;
+        while (high < large.size() && large[high] < doc) {
+            low = high;
+            high += step;
+            step *= 2;
+        }
+        high = std::min(high, large.size());
+        low = static_cast<size_t>(std::lower_bound(large.begin() + low, large.begin() + high, doc) - large.begin());
+        if (low == large.size()) break;
+        if (large[low] == doc) out.push_back(doc);
+    }
+    return out;
+}
+
+std::vector<uint32_t> unite_postings(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b) {
+    std::vector<uint32_t> out;
+    out.reserve(a.size() + b.size());
+    std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(out));
+    return out;
+}
@@ -12,17 +12,32 @@
 #include <chrono>
 #include <iomanip>
 #include <filesystem>
+#include <thread>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <fcntl.h>
+#include <unistd.h>
 
 // === Headers do projeto ===
 #include "record.hpp"
 #include "hashing.hpp"
 #include "BPlusTree.hpp"
 #include "BPlusTree_long.hpp"
+#include "BPlusTree_covering.hpp"
+#include "string_bplus_tree.hpp"
+#include "text_index.hpp"
+#include "column_store.hpp"
 #include "upload.hpp"
+#include "pipeline.hpp"
+#include "external_sort.hpp"
+#include "wal.hpp"
 #include "log.hpp"
 
-//quantidade de blocos
-long blocks_qntd = 750000;
+// quantidade de registros em cada lote que passa pelo pipeline de carga
+const size_t BATCH_SIZE = 1024;
+// quantos lotes cada fila entre estágios guarda antes de segurar o produtor
+const size_t QUEUE_CAPACITY = 8;
 
 // Remove espaços em branco do início e fim da string (modifica in-place)
 void trim(std::string& s) {
@@ -136,6 +151,897 @@ bool parse_csv_line(const std::string& line, Artigo& artigo) {
 }
 
 
+// === Estruturas que circulam pelo pipeline de carga ===
+
+// Registro bruto do CSV (pode ocupar mais de uma linha física)
+struct RawRecord {
+    long line_number;  // linha física onde o registro termina (para as mensagens de aviso)
+    std::string text;
+};
+
+// Lote de registros brutos, seq define a ordem original no CSV
+struct RawBatch {
+    long seq = 0;
+    std::vector<RawRecord> records;
+};
+
+// Lote de artigos válidos, mantém o seq do lote bruto de origem
+struct ParsedBatch {
+    long seq = 0;
+    std::vector<Artigo> records;
+};
+
+// Lote de pares (chave, ponteiro) para um dos índices
+template <typename Key>
+struct IndexBatch {
+    std::vector<std::pair<Key, f_ptr>> entries;
+};
+
+// Lote de registros (com o endereço definitivo) para o índice de texto
+struct TextBatch {
+    std::vector<Artigo> records;
+    std::vector<f_ptr> data_ptrs;
+};
+
+// Estado compartilhado entre as threads do pipeline
+struct UploadPipeline {
+    BoundedQueue<RawBatch> raw_queue{QUEUE_CAPACITY};
+    BoundedQueue<ParsedBatch> parsed_queue{QUEUE_CAPACITY};
+    BoundedQueue<IndexBatch<CoveringKey>> primary_queue{QUEUE_CAPACITY}; // ID com Ano e Citacoes (índice de cobertura)
+    BoundedQueue<IndexBatch<long long>> secondary_queue{QUEUE_CAPACITY};
+    BoundedQueue<IndexBatch<std::string>> title_queue{QUEUE_CAPACITY};
+    BoundedQueue<IndexBatch<std::string>> author_queue{QUEUE_CAPACITY};
+    BoundedQueue<TextBatch> text_queue{QUEUE_CAPACITY};
+    PipelineError error;
+
+    // aborta todas as filas para destravar as outras threads quando um estágio falha
+    void abort_all() {
+        raw_queue.abort();
+        parsed_queue.abort();
+        primary_queue.abort();
+        secondary_queue.abort();
+        title_queue.abort();
+        author_queue.abort();
+        text_queue.abort();
+    }
+
+    // executa o corpo de um estágio guardando a exceção (se houver) para a thread principal
+    template <typename Fn>
+    void run_stage(Fn&& body) {
+        try {
+            body();
+        } catch (...) {
+            if (error.set(std::current_exception())) abort_all();
+        }
+    }
+};
+
+// Quantidade de threads de parsing (UPLOAD_THREADS sobrescreve o padrão)
+static int parser_thread_count() {
+    const char* env = std::getenv("UPLOAD_THREADS");
+    if (env != nullptr) {
+        int value = std::atoi(env);
+        if (value > 0) return value;
+        LOG_WARN("UPLOAD_THREADS invalido ('" << env << "'). Usando o padrao.");
+    }
+    // leitor, escritor de dados e os dois escritores de índice já ocupam parte dos núcleos
+    int hw = static_cast<int>(std::thread::hardware_concurrency());
+    return std::max(2, hw - 2);
+}
+
+// ESTÁGIO 1: leitor. Junta as linhas físicas em registros completos (respeitando as aspas) e agrupa em lotes
+static void reader_stage(std::ifstream& input_file, UploadPipeline& pipeline, StageStats& stats) {
+    auto stage_start = std::chrono::steady_clock::now();
+    std::string line_buffer;
+    std::string complete_record_line;
+    std::getline(input_file, line_buffer); // descarta o cabeçalho
+    long physical_line_number = 1;
+    size_t quote_count = 0; // aspas (não escapadas) acumuladas no registro atual
+    RawBatch batch;
+    long next_seq = 0;
+
+    while (true) {
+        {
+            BusyTimer busy(stats.busy_ms);
+            if (!std::getline(input_file, line_buffer)) break;
+            physical_line_number++;
+            if (complete_record_line.empty()) {
+                complete_record_line = line_buffer;
+            } else {
+                complete_record_line += "\n" + line_buffer;
+            }
+
+            // conta só as aspas da linha nova, as anteriores já estão em quote_count
+            for (size_t i = 0; i < line_buffer.length(); ++i) {
+                if (line_buffer[i] == '"') {
+                    if (i + 1 == line_buffer.length() || line_buffer[i+1] != '"') {
+                        quote_count++;
+                    } else { i++; }
+                }
+            }
+
+            if (quote_count % 2 != 0) continue; // registro continua na próxima linha
+
+            batch.records.push_back({physical_line_number, std::move(complete_record_line)});
+            complete_record_line.clear();
+            quote_count = 0;
+            stats.items++;
+            if (batch.records.size() < BATCH_SIZE) continue;
+            batch.seq = next_seq++;
+        }
+        if (!pipeline.raw_queue.push(std::move(batch))) return;
+        batch = RawBatch();
+    }
+
+    if (!batch.records.empty()) {
+        batch.seq = next_seq++;
+        pipeline.raw_queue.push(std::move(batch));
+    }
+    std::chrono::duration<double, std::milli> wall = std::chrono::steady_clock::now() - stage_start;
+    stats.wall_ms = wall.count();
+}
+
+// ESTÁGIO 2: parsers. Convertem os registros brutos em Artigos válidos (várias threads em paralelo)
+static void parser_stage(UploadPipeline& pipeline, StageStats& stats) {
+    auto stage_start = std::chrono::steady_clock::now();
+    RawBatch raw;
+    while (pipeline.raw_queue.pop(raw)) {
+        ParsedBatch parsed;
+        {
+            BusyTimer busy(stats.busy_ms);
+            parsed.seq = raw.seq;
+            parsed.records.reserve(raw.records.size());
+            for (const RawRecord& record : raw.records) {
+                stats.items++;
+                Artigo artigo;
+                // Chama a função de parsing
+                if (!parse_csv_line(record.text, artigo)) {
+                    LOG_WARN("Aviso: A linha " << record.line_number << " foi ignorada. Título vazio ou inválido: " << record.text.substr(0,100) << "...\n");
+                    continue;
+                }
+                // Rejeita títulos vazios
+                if (artigo.Titulo[0] == '\0') {
+                    LOG_WARN("Aviso: Título vazio encontrado, artigo ignorado.\n");
+                    continue;
+                }
+                // Validação do Ano
+                if (artigo.Ano < 1000 || artigo.Ano > 2025) {
+                    LOG_WARN("Aviso: Ano inválido para o artigo com ID: " << artigo.ID << "\n");
+                    continue;
+                }
+                parsed.records.push_back(artigo);
+            }
+        }
+        // lotes vazios também seguem adiante para não deixar buraco na sequência
+        if (!pipeline.parsed_queue.push(std::move(parsed))) return;
+    }
+    std::chrono::duration<double, std::milli> wall = std::chrono::steady_clock::now() - stage_start;
+    stats.wall_ms = wall.count();
+}
+
+// Reordena os lotes pelo seq (os parsers terminam fora de ordem) e entrega cada um a consume na ordem do CSV
+template <typename Consume>
+static void consume_in_order(UploadPipeline& pipeline, StageStats& stats, Consume consume) {
+    auto stage_start = std::chrono::steady_clock::now();
+    std::map<long, ParsedBatch> pending; // lotes que chegaram antes da vez
+    long next_seq = 0;
+    ParsedBatch parsed;
+    while (pipeline.parsed_queue.pop(parsed)) {
+        pending.emplace(parsed.seq, std::move(parsed));
+
+        // processa todos os lotes que já estão na ordem certa
+        auto it = pending.find(next_seq);
+        while (it != pending.end()) {
+            BusyTimer busy(stats.busy_ms);
+            consume(it->second.records);
+            pending.erase(it);
+            next_seq++;
+            it = pending.find(next_seq);
+        }
+    }
+    std::chrono::duration<double, std::milli> wall = std::chrono::steady_clock::now() - stage_start;
+    stats.wall_ms = wall.count();
+}
+
+// ESTÁGIO 3: escritor do arquivo de dados. Insere os lotes no hashing na ordem do CSV
+static void data_writer_stage(HashingFile& data_file, UploadPipeline& pipeline, StageStats& stats, int& inserted_count) {
+    consume_in_order(pipeline, stats, [&](const std::vector<Artigo>& records) {
+        for (const Artigo& artigo : records) {
+            if (data_file.insert(artigo) == -1) {
+                LOG_WARN("AVISO: Falha ao inserir artigo. ID: " << artigo.ID << "\n");
+                continue;
+            }
+            if (inserted_count % 5000 == 0) {
+                LOG_INFO("Carregando dados... " << inserted_count << " artigos processados até agora.\n");
+            }
+            inserted_count++;
+            stats.items++;
+        }
+    });
+}
+
+// Nomes normalizados dos autores do artigo, sem repetição (um autor repetido entra uma vez só no índice)
+static void unique_authors(const Artigo& artigo, std::vector<std::string>& authors) {
+    authors.clear();
+    split_authors(artigo.Autores, [&](const std::string& name) { authors.push_back(name); });
+    std::sort(authors.begin(), authors.end());
+    authors.erase(std::unique(authors.begin(), authors.end()), authors.end());
+}
+
+// ESTÁGIO 4: varredura do arquivo de dados. Os splits do hashing linear mudam o endereço dos registros
+// durante a carga, então os pares (chave, ponteiro) dos índices só são coletados depois da última inserção
+// com with_text os registros também vão para o índice de texto; com columns os números vão direto para as colunas
+static void index_scan_stage(HashingFile& data_file, UploadPipeline& pipeline, StageStats& stats, bool with_text,
+                             ColumnWriter* columns) {
+    auto stage_start = std::chrono::steady_clock::now();
+    double waiting_ms = 0; // tempo bloqueado nas filas dos índices
+    IndexBatch<CoveringKey> primary_batch;
+    IndexBatch<long long> secondary_batch;
+    IndexBatch<std::string> title_batch;
+    IndexBatch<std::string> author_batch;
+    TextBatch text_batch;
+    std::vector<std::string> authors; // nomes do registro atual
+    bool queues_open = true;
+
+    auto push_batches = [&] {
+        BusyTimer waiting(waiting_ms);
+        queues_open = pipeline.primary_queue.push(std::move(primary_batch)) &&
+                      pipeline.secondary_queue.push(std::move(secondary_batch)) &&
+                      pipeline.title_queue.push(std::move(title_batch)) &&
+                      pipeline.author_queue.push(std::move(author_batch)) &&
+                      (!with_text || pipeline.text_queue.push(std::move(text_batch)));
+        primary_batch = IndexBatch<CoveringKey>();
+        secondary_batch = IndexBatch<long long>();
+        title_batch = IndexBatch<std::string>();
+        author_batch = IndexBatch<std::string>();
+        text_batch = TextBatch();
+    };
+
+    data_file.for_each_record([&](const Artigo& artigo, f_ptr data_ptr) {
+        if (!queues_open) return;
+        primary_batch.entries.push_back({covering_key(artigo), data_ptr});
+        secondary_batch.entries.push_back({hash_string_to_long(artigo.Titulo),
+                                           make_title_posting(data_ptr, title_fingerprint(artigo.Titulo))});
+        title_batch.entries.push_back({artigo.Titulo, data_ptr});
+        unique_authors(artigo, authors);
+        for (std::string& name : authors) author_batch.entries.push_back({std::move(name), data_ptr});
+        if (columns != nullptr) columns->add(artigo, data_ptr);
+        if (with_text) {
+            text_batch.records.push_back(artigo);
+            text_batch.data_ptrs.push_back(data_ptr);
+        }
+        stats.items++;
+        if (primary_batch.entries.size() >= BATCH_SIZE) push_batches();
+    });
+    if (queues_open && !primary_batch.entries.empty()) push_batches();
+
+    std::chrono::duration<double, std::milli> wall = std::chrono::steady_clock::now() - stage_start;
+    stats.wall_ms = wall.count();
+    stats.busy_ms = stats.wall_ms - waiting_ms;
+}
+
+// ESTÁGIO 5: escritor de um índice. Só começa a receber lotes na varredura (ESTÁGIO 4), depois do escritor do
+// arquivo de dados; os lotes vêm na ordem da varredura, então a árvore final é determinística
+// sink recebe cada par: insere direto na árvore ou alimenta a ordenação externa da carga em lote
+template <typename Key, typename Sink>
+static void index_writer_stage(BoundedQueue<IndexBatch<Key>>& queue, StageStats& stats, Sink sink) {
+    auto stage_start = std::chrono::steady_clock::now();
+    IndexBatch<Key> batch;
+    while (queue.pop(batch)) {
+        BusyTimer busy(stats.busy_ms);
+        for (auto& entry : batch.entries) {
+            sink(std::move(entry.first), entry.second);
+        }
+        stats.items += static_cast<long>(batch.entries.size());
+    }
+    std::chrono::duration<double, std::milli> wall = std::chrono::steady_clock::now() - stage_start;
+    stats.wall_ms = wall.count();
+}
+
+// ESTÁGIO 5b: índice de texto. Os documentos são numerados na ordem da varredura
+static void text_writer_stage(UploadPipeline& pipeline, TextIndexBuilder& builder, StageStats& stats) {
+    auto stage_start = std::chrono::steady_clock::now();
+    TextBatch batch;
+    while (pipeline.text_queue.pop(batch)) {
+        BusyTimer busy(stats.busy_ms);
+        for (size_t i = 0; i < batch.records.size(); ++i) builder.add_document(batch.records[i], batch.data_ptrs[i]);
+        stats.items += static_cast<long>(batch.records.size());
+    }
+    std::chrono::duration<double, std::milli> wall = std::chrono::steady_clock::now() - stage_start;
+    stats.wall_ms = wall.count();
+}
+
+// Lê um valor numérico opcional de uma variável de ambiente
+static double env_double(const char* name, double default_value) {
+    const char* env = std::getenv(name);
+    if (env == nullptr) return default_value;
+    char* end_ptr = nullptr;
+    double value = std::strtod(env, &end_ptr);
+    if (end_ptr == env || value <= 0) {
+        LOG_WARN(name << " invalido ('" << env << "'). Usando o padrao " << default_value);
+        return default_value;
+    }
+    return value;
+}
+
+// Constrói a árvore pela carga em lote e mostra quanto tempo levou
+template <typename Tree, typename Key>
+static void bulk_load_index(Tree& index, ExternalSorter<Key>& entries, double fill_factor, const std::string& name) {
+    auto start = std::chrono::steady_clock::now();
+    entries.finish();
+    index.bulk_load(entries, fill_factor);
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    LOG_INFO("[BULK LOAD] " << name << ": " << entries.size() << " chaves, " << entries.spilled_runs()
+             << " runs em disco, " << index.get_total_blocks() << " blocos, "
+             << std::fixed << std::setprecision(1) << elapsed.count() << " ms");
+}
+
+// Mostra a vazão de cada estágio no log
+static void log_stage_stats(const StageStats& stats) {
+    double per_second = stats.wall_ms > 0 ? stats.items / (stats.wall_ms / 1000.0) : 0.0;
+    LOG_INFO("[PIPELINE] " << std::left << std::setw(18) << stats.name << std::right
+             << " registros: " << std::setw(8) << stats.items
+             << " | ocupado: " << std::fixed << std::setprecision(1) << std::setw(9) << stats.busy_ms << " ms"
+             << " | total: " << std::setw(9) << stats.wall_ms << " ms"
+             << " | vazao: " << std::setprecision(0) << per_second << " registros/s");
+}
+
+// Mostra os contadores do buffer pool de um índice
+static void log_cache_stats(const std::string& name, const BufferPoolStats& stats) {
+    LOG_INFO("[CACHE] " << std::left << std::setw(18) << name << std::right
+             << " acertos: " << stats.hits << " | faltas: " << stats.misses
+             << " | taxa de acerto: " << std::fixed << std::setprecision(1) << stats.hit_rate() * 100 << "%"
+             << " | substituicoes: " << stats.evictions << " | gravacoes: " << stats.writebacks);
+}
+
+// Mostra os pedidos de E/S de um arquivo e quantos foram em lote
+static void log_io_stats(const std::string& name, const PageIoStats& stats) {
+    LOG_INFO("[E/S] " << std::left << std::setw(20) << name << std::right
+             << " leituras: " << stats.reads << " | escritas: " << stats.writes
+             << " | lotes: " << stats.batches << " | submissoes io_uring: " << stats.submissions);
+}
+
+// === Carga incremental (upload --append) ===
+
+// Contadores da carga incremental
+struct AppendCounts {
+    long inserted = 0;  // IDs novos gravados
+    long skipped = 0;   // IDs que já existiam (sem --update-existing)
+    long updated = 0;   // registros existentes atualizados
+    long moved = 0;     // atualizações que não couberam no lugar (apagadas e inseridas de novo)
+    long deleted = 0;   // registros apagados (--delete)
+    long missing = 0;   // IDs do --delete que não existiam
+    long rejected = 0;  // inserções que falharam
+    long relocated = 0; // registros antigos movidos pelos splits (endereço corrigido nos índices)
+};
+
+// Registro que já estava nos índices de carga em lote (títulos, autores, texto e colunas) e mudou na carga
+// incremental: as chaves são as da versão que está nesses índices
+struct ChangedRecord {
+    std::string titulo;
+    std::vector<std::string> authors;
+    f_ptr original_ptr = -1;  // endereço nos índices
+    f_ptr current_ptr = -1;   // endereço atual no arquivo de dados (-1: apagado)
+    bool rewritten = false;   // conteúdo novo (--update-existing), não só outro endereço
+};
+
+// Árvores de inteiros mantidas em dia durante a carga incremental. Os IDs novos ficam em fresh (ID -> endereço)
+// e só entram nas árvores no final, em ordem de chave; os registros que já estavam nelas são corrigidos na hora
+// Os índices de carga em lote só recebem as mudanças no final: os registros antigos tocados ficam em changed
+struct IncrementalIndexes {
+    BPlusTree<>& primary;
+    BPlusTree_covering* covering; // só se já existia
+    BPlusTree_long& secondary;
+    std::unordered_map<int, f_ptr> fresh;
+    std::unordered_map<int, ChangedRecord> changed;
+
+    // entrada de um registro antigo em changed (criada na primeira mudança, com as chaves da versão indexada)
+    ChangedRecord& track(const Artigo& old_version, f_ptr old_ptr) {
+        auto it = changed.find(old_version.ID);
+        if (it != changed.end()) return it->second;
+        ChangedRecord& record = changed[old_version.ID];
+        record.titulo = old_version.Titulo;
+        unique_authors(old_version, record.authors);
+        record.original_ptr = old_ptr;
+        record.current_ptr = old_ptr;
+        return record;
+    }
+
+    // o registro old_version em old_ptr agora é artigo em new_ptr (split do hashing ou atualização)
+    void move(const Artigo& old_version, f_ptr old_ptr, const Artigo& artigo, f_ptr new_ptr) {
+        auto it = fresh.find(artigo.ID);
+        if (it != fresh.end() && it->second == old_ptr) {
+            it->second = new_ptr;
+            return;
+        }
+        bool ok = old_ptr == new_ptr || primary.replace_entry(artigo.ID, old_ptr, artigo.ID, new_ptr);
+        if (covering != nullptr) {
+            ok = covering->replace_entry(covering_key(old_version), old_ptr, covering_key(artigo), new_ptr) && ok;
+        }
+        long long old_hash = hash_string_to_long(old_version.Titulo);
+        long long new_hash = hash_string_to_long(artigo.Titulo);
+        f_ptr old_posting = make_title_posting(old_ptr, title_fingerprint(old_version.Titulo));
+        f_ptr new_posting = make_title_posting(new_ptr, title_fingerprint(artigo.Titulo));
+        if (old_hash == new_hash) {
+            ok = (old_posting == new_posting || secondary.replace_entry(old_hash, old_posting, new_hash, new_posting)) && ok;
+        } else {
+            // título novo: a entrada muda de lugar na árvore
+            ok = secondary.remove(old_hash, old_posting) && ok;
+            secondary.insert(new_hash, new_posting);
+        }
+        if (!ok) LOG_WARN("AVISO: Registro sem entrada em algum indice ao mudar de endereco. ID: " << artigo.ID);
+        track(old_version, old_ptr).current_ptr = new_ptr;
+    }
+
+    // nova versão (--update-existing): como move, mas o conteúdo também mudou
+    void update(const Artigo& old_version, f_ptr old_ptr, const Artigo& artigo, f_ptr new_ptr) {
+        move(old_version, old_ptr, artigo, new_ptr);
+        auto it = changed.find(artigo.ID);
+        if (it != changed.end()) it->second.rewritten = true;
+    }
+
+    // o registro que estava em data_ptr foi apagado
+    void erase(const Artigo& artigo, f_ptr data_ptr) {
+        auto it = fresh.find(artigo.ID);
+        if (it != fresh.end() && it->second == data_ptr) {
+            fresh.erase(it);
+            return;
+        }
+        bool ok = primary.remove(artigo.ID, data_ptr);
+        if (covering != nullptr) ok = covering->remove(covering_key(artigo), data_ptr) && ok;
+        ok = secondary.remove(hash_string_to_long(artigo.Titulo), make_title_posting(data_ptr, title_fingerprint(artigo.Titulo))) && ok;
+        if (!ok) LOG_WARN("AVISO: Registro apagado sem entrada em algum indice. ID: " << artigo.ID);
+        track(artigo, data_ptr).current_ptr = -1;
+    }
+};
+
+// ESTÁGIO 3 (--append): escritor da carga incremental. Cada lote do CSV faz uma busca em lote no índice primário;
+// os IDs novos vão para o hashing e para indexes.fresh, os existentes são ignorados ou atualizados
+static void append_writer_stage(HashingFile& data_file, IncrementalIndexes& indexes, bool update_existing,
+                                UploadPipeline& pipeline, StageStats& stats, AppendCounts& counts) {
+    std::vector<int> ids;
+    std::vector<f_ptr> found;
+    consume_in_order(pipeline, stats, [&](const std::vector<Artigo>& records) {
+        ids.clear();
+        for (const Artigo& artigo : records) {
+            if (indexes.fresh.count(artigo.ID) == 0) ids.push_back(artigo.ID);
+        }
+        std::sort(ids.begin(), ids.end());
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+        indexes.primary.search_batch(ids, found);
+
+        for (const Artigo& artigo : records) {
+            stats.items++;
+            bool exists = indexes.fresh.count(artigo.ID) > 0; // repetido dentro da própria carga
+            if (!exists) {
+                auto it = std::lower_bound(ids.begin(), ids.end(), artigo.ID);
+                exists = it != ids.end() && *it == artigo.ID && found[it - ids.begin()] != -1;
+            }
+            if (!exists) {
+                f_ptr data_ptr = data_file.insert(artigo);
+                if (data_ptr == -1) {
+                    LOG_WARN("AVISO: Falha ao inserir artigo. ID: " << artigo.ID);
+                    counts.rejected++;
+                    continue;
+                }
+                indexes.fresh[artigo.ID] = data_ptr;
+                counts.inserted++;
+                continue;
+            }
+            if (!update_existing) {
+                counts.skipped++;
+                continue;
+            }
+
+            // no lugar quando cabe na página (o endereço não muda), senão a versão antiga sai e a nova entra
+            int blocks_read = 0;
+            Artigo old_version = data_file.find_by_id(artigo.ID, blocks_read);
+            f_ptr old_ptr = -1;
+            f_ptr new_ptr = data_file.update(artigo, old_ptr);
+            if (new_ptr == -1) {
+                // a versão antiga já saiu do arquivo quando a nova não coube em página nenhuma
+                LOG_WARN("AVISO: Falha ao atualizar artigo. ID: " << artigo.ID);
+                if (old_ptr != -1) indexes.erase(old_version, old_ptr);
+                counts.rejected++;
+                continue;
+            }
+            counts.updated++;
+            if (new_ptr != old_ptr) counts.moved++;
+            indexes.update(old_version, old_ptr, artigo, new_ptr);
+        }
+    });
+}
+
+// --delete: um ID por linha; cada registro apagado sai também das árvores de inteiros
+static void delete_stage(std::ifstream& input_file, HashingFile& data_file, IncrementalIndexes& indexes,
+                         StageStats& stats, AppendCounts& counts) {
+    auto stage_start = std::chrono::steady_clock::now();
+    std::string line;
+    long line_number = 0;
+    while (std::getline(input_file, line)) {
+        BusyTimer busy(stats.busy_ms);
+        line_number++;
+        trim(line);
+        if (line.empty()) continue;
+        char* end_ptr = nullptr;
+        long id = std::strtol(line.c_str(), &end_ptr, 10);
+        if (*end_ptr != '\0' || id < INT_MIN || id > INT_MAX) {
+            LOG_WARN("Aviso: A linha " << line_number << " foi ignorada, ID invalido: " << line.substr(0, 100));
+            continue;
+        }
+        stats.items++;
+        Artigo removed;
+        f_ptr data_ptr = data_file.remove(static_cast<int>(id), removed);
+        if (data_ptr == -1) {
+            counts.missing++;
+            continue;
+        }
+        indexes.erase(removed, data_ptr);
+        counts.deleted++;
+    }
+    std::chrono::duration<double, std::milli> wall = std::chrono::steady_clock::now() - stage_start;
+    stats.wall_ms = wall.count();
+}
+
+// Índices reconstruídos por uma varredura do arquivo de dados na carga incremental
+struct RebuildTargets {
+    BPlusTree<>* primary = nullptr;            // índices de inteiros: só no reparo de uma carga interrompida
+    BPlusTree_covering* covering = nullptr;
+    BPlusTree_long* secondary = nullptr;
+    bool strings = false;                      // title_index.idx e author_index.idx (só têm carga em lote)
+    bool text = false;                         // índice de texto
+    bool columns = false;                      // columns.dat
+};
+
+// Varre o arquivo de dados uma vez e constrói os índices pedidos por carga em lote, em paralelo
+static void rebuild_from_data_file(HashingFile& data_file, const RebuildTargets& targets, const std::string& data_dir,
+                                   size_t sort_memory, double fill_factor) {
+    std::string title_index_path = data_dir + "/title_index.idx";
+    std::string author_index_path = data_dir + "/author_index.idx";
+    std::string columns_path = data_dir + "/columns.dat";
+    // as árvores de strings e o índice de texto só são montados vazios: os arquivos antigos saem antes
+    if (targets.strings) {
+        std::filesystem::remove(title_index_path);
+        std::filesystem::remove(author_index_path);
+    }
+    if (targets.text) {
+        for (const char* name : {"text_index.dict", "text_index.post", "text_index.docs"}) std::filesystem::remove(data_dir + "/" + name);
+    }
+
+    ExternalSorter<int> primary_entries(data_dir, "primary_index.sort", sort_memory);
+    ExternalSorter<CoveringKey> covering_entries(data_dir, "primary_covering.sort", sort_memory);
+    ExternalSorter<long long> secondary_entries(data_dir, "secondary_index.sort", sort_memory);
+    ExternalSorter<std::string> title_entries(data_dir, "title_index.sort", sort_memory);
+    ExternalSorter<std::string> author_entries(data_dir, "author_index.sort", sort_memory);
+    TextIndexBuilder text_builder(data_dir, sort_memory);
+    std::unique_ptr<ColumnWriter> columns;
+    if (targets.columns) columns = std::make_unique<ColumnWriter>(columns_path);
+
+    auto start = std::chrono::steady_clock::now();
+    long records = 0;
+    std::vector<std::string> authors;
+    data_file.for_each_record([&](const Artigo& artigo, f_ptr data_ptr) {
+        records++;
+        if (targets.primary != nullptr) primary_entries.add(artigo.ID, data_ptr);
+        if (targets.covering != nullptr) covering_entries.add(covering_key(artigo), data_ptr);
+        if (targets.secondary != nullptr) {
+            secondary_entries.add(hash_string_to_long(artigo.Titulo), make_title_posting(data_ptr, title_fingerprint(artigo.Titulo)));
+        }
+        if (targets.strings) {
+            title_entries.add(artigo.Titulo, data_ptr);
+            unique_authors(artigo, authors);
+            for (std::string& name : authors) author_entries.add(std::move(name), data_ptr);
+        }
+        if (targets.text) text_builder.add_document(artigo, data_ptr);
+        if (columns) columns->add(artigo, data_ptr);
+    });
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    LOG_INFO("[APPEND] Varredura do arquivo de dados: " << records << " registros, "
+             << std::fixed << std::setprecision(1) << elapsed.count() << " ms");
+
+    PipelineError bulk_error;
+    std::vector<std::thread> builders;
+    auto build = [&](std::function<void()> body) {
+        builders.emplace_back([&bulk_error, body] {
+            try { body(); }
+            catch (...) { bulk_error.set(std::current_exception()); }
+        });
+    };
+    if (targets.primary != nullptr) build([&] { bulk_load_index(*targets.primary, primary_entries, fill_factor, "indice primario"); });
+    if (targets.covering != nullptr) build([&] { bulk_load_index(*targets.covering, covering_entries, fill_factor, "indice de cobertura"); });
+    if (targets.secondary != nullptr) build([&] { bulk_load_index(*targets.secondary, secondary_entries, fill_factor, "indice secundario"); });
+    if (targets.strings) {
+        build([&] {
+            StringBPlusTree title_index(title_index_path);
+            bulk_load_index(title_index, title_entries, fill_factor, "indice de titulos");
+        });
+        build([&] {
+            StringBPlusTree author_index(author_index_path);
+            bulk_load_index(author_index, author_entries, fill_factor, "indice de autores");
+        });
+    }
+    if (targets.text) {
+        build([&] {
+            text_builder.finish(fill_factor);
+            LOG_INFO("[TEXTO] indice de texto: " << text_builder.document_count() << " documentos, "
+                     << text_builder.term_count() << " termos");
+        });
+    }
+    if (columns) {
+        build([&] {
+            columns->finish();
+            LOG_INFO("[COLUNAS] " << columns->row_count() << " linhas em " << columns_path);
+        });
+    }
+    for (std::thread& builder : builders) builder.join();
+    bulk_error.rethrow_if_set();
+}
+
+// Cria o marcador de carga incremental em andamento e garante que ele chegou ao disco antes da primeira escrita
+static void create_append_marker(const std::string& path) {
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0 || ::fsync(fd) != 0) {
+        if (fd >= 0) ::close(fd);
+        LOG_ERROR("Falha ao criar o marcador " << path << ": " << std::strerror(errno));
+        throw std::runtime_error("ERRO: não foi possível criar o marcador da carga incremental");
+    }
+    ::close(fd);
+    int dir_fd = ::open(std::filesystem::path(path).parent_path().c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir_fd >= 0) {
+        ::fsync(dir_fd);
+        ::close(dir_fd);
+    }
+}
+
+// O que a carga incremental faz com a entrada
+enum class IncrementalMode {
+    APPEND,  // --append: CSV com artigos novos (ou novas versões, com --update-existing)
+    DELETE,  // --delete: lista de IDs a apagar
+    RECOVER  // --recover: sem entrada, só termina o trabalho de uma carga interrompida
+};
+
+// Carga incremental: os artigos do CSV com IDs novos entram no arquivo de dados e nas árvores de inteiros existentes,
+// ligados ao log de escrita antecipada (no DELETE, a entrada é uma lista de IDs a apagar); no final, os índices de
+// títulos, autores, texto e colunas recebem só os registros novos, apagados, atualizados ou movidos
+// Um marcador (append.pending) fica no diretório enquanto a carga roda: se ele sobrar de uma execução interrompida,
+// as árvores de inteiros são refeitas a partir do arquivo de dados antes da entrada (basta repetir o mesmo comando
+// ou rodar o RECOVER). Enquanto o log ou o marcador existirem, as buscas se recusam a abrir os arquivos
+static void run_incremental(const std::string& data_dir, std::ifstream& input_file, IncrementalMode mode, bool update_existing) {
+    std::string data_file_path = data_dir + "/data_file.dat";
+    std::string primary_index_path = data_dir + "/primary_index.idx";
+    std::string covering_index_path = data_dir + "/primary_covering.idx";
+    std::string secondary_index_path = data_dir + "/secondary_index.idx";
+    std::string marker_path = data_dir + "/" + APPEND_MARKER_NAME;
+    std::string wal_path = data_dir + "/" + WAL_FILE_NAME;
+    bool delete_mode = mode == IncrementalMode::DELETE;
+    if (!std::filesystem::exists(data_file_path)) {
+        LOG_ERROR("Arquivo de dados " << data_file_path << " nao existe. Faca a carga inicial sem --append/--delete/--recover.");
+        throw std::runtime_error("ERRO: --append, --delete e --recover exigem uma carga anterior");
+    }
+    bool repair = std::filesystem::exists(marker_path) || !std::filesystem::exists(primary_index_path);
+    if (mode == IncrementalMode::RECOVER && !repair) {
+        WriteAheadLog wal(wal_path); // reaplica o que tiver sobrado no log
+        LOG_INFO("[RECOVER] Nenhuma carga incremental interrompida em " << data_dir << ", nada a refazer");
+        return;
+    }
+    bool with_covering = std::filesystem::exists(covering_index_path);
+    bool with_text = std::filesystem::exists(data_dir + "/text_index.dict");
+    bool with_columns = std::filesystem::exists(data_dir + "/columns.dat");
+    double fill_factor = env_double("INDEX_FILL_FACTOR", 1.0);
+    size_t sort_memory = static_cast<size_t>(env_double("SORT_MEMORY_MB", 64) * 1024 * 1024);
+    AppendCounts counts;
+    StageStats reader_stats{"leitor"};
+    StageStats data_stats{delete_mode ? "remocao" : "carga incremental"};
+    int parser_threads = parser_thread_count();
+    std::vector<StageStats> parser_stats(parser_threads, StageStats{"parsers"});
+
+    {
+        // o log reaplica os commits de uma execução interrompida antes de qualquer arquivo ser aberto
+        WriteAheadLog wal(wal_path);
+        create_append_marker(marker_path);
+        if (repair) {
+            LOG_WARN("[APPEND] Carga incremental anterior interrompida: os indices de inteiros serao refeitos a partir do arquivo de dados");
+            for (const std::string& path : {primary_index_path, covering_index_path, secondary_index_path}) std::filesystem::remove(path);
+        }
+
+        HashingFile data_file(data_file_path);
+        BPlusTree primary_index(primary_index_path);
+        std::unique_ptr<BPlusTree_covering> covering_index;
+        if (with_covering) covering_index = std::make_unique<BPlusTree_covering>(covering_index_path);
+        BPlusTree_long secondary_index(secondary_index_path);
+        data_file.attach_wal(wal);
+        primary_index.attach_wal(wal);
+        if (covering_index) covering_index->attach_wal(wal);
+        secondary_index.attach_wal(wal);
+        LOG_INFO("[APPEND] " << data_file.get_record_count() << " artigos em " << data_dir
+                 << (mode == IncrementalMode::RECOVER ? ", recuperacao sem entrada"
+                     : delete_mode ? ", remocao por lista de IDs"
+                     : update_existing ? ", IDs existentes serao atualizados" : ", IDs existentes serao ignorados"));
+
+        if (repair) {
+            RebuildTargets targets;
+            targets.primary = &primary_index;
+            targets.covering = covering_index.get();
+            targets.secondary = &secondary_index;
+            rebuild_from_data_file(data_file, targets, data_dir, sort_memory, fill_factor);
+        }
+
+        // os splits movem registros antigos (já nas árvores: o endereço é trocado na hora) e novos (só em fresh)
+        IncrementalIndexes indexes{primary_index, covering_index.get(), secondary_index, {}};
+        data_file.set_relocation_listener([&](const Artigo& artigo, f_ptr old_ptr, f_ptr new_ptr) {
+            if (indexes.fresh.count(artigo.ID) == 0) counts.relocated++;
+            indexes.move(artigo, old_ptr, artigo, new_ptr);
+        });
+
+        if (delete_mode) {
+            delete_stage(input_file, data_file, indexes, data_stats, counts);
+        } else if (mode == IncrementalMode::APPEND) {
+            UploadPipeline pipeline;
+            std::vector<std::thread> parsers;
+            for (int i = 0; i < parser_threads; ++i) {
+                parsers.emplace_back([&, i] { pipeline.run_stage([&] { parser_stage(pipeline, parser_stats[i]); }); });
+            }
+            std::thread data_writer([&] { pipeline.run_stage([&] {
+                append_writer_stage(data_file, indexes, update_existing, pipeline, data_stats, counts);
+            }); });
+            pipeline.run_stage([&] { reader_stage(input_file, pipeline, reader_stats); });
+            pipeline.raw_queue.close();
+            for (std::thread& parser : parsers) parser.join();
+            pipeline.parsed_queue.close();
+            data_writer.join();
+            pipeline.error.rethrow_if_set();
+        }
+        data_file.set_relocation_listener(nullptr);
+
+        // só a diferença entra nos índices: uma leitura em lote dos registros novos e dos antigos que mudaram
+        auto merge_start = std::chrono::steady_clock::now();
+        std::vector<std::pair<int, f_ptr>> primary_new;
+        std::vector<std::pair<CoveringKey, f_ptr>> covering_new;
+        std::vector<std::pair<long long, f_ptr>> secondary_new;
+        std::vector<StringBPlusTree::Entry> title_insertions, title_removals, author_insertions, author_removals;
+        // no reparo a carga anterior pode ter parado no meio desses índices: eles são refeitos inteiros no final
+        std::unique_ptr<TextIndexUpdater> text_updater;
+        std::unique_ptr<ColumnUpdater> column_updater;
+        if (!repair && with_text) text_updater = std::make_unique<TextIndexUpdater>(data_dir);
+        if (!repair && with_columns) column_updater = std::make_unique<ColumnUpdater>(data_dir + "/columns.dat");
+
+        std::vector<f_ptr> read_ptrs;
+        read_ptrs.reserve(indexes.fresh.size() + indexes.changed.size());
+        for (const auto& entry : indexes.fresh) read_ptrs.push_back(entry.second);
+        std::unordered_map<f_ptr, const ChangedRecord*> changed_alive; // endereço atual -> registro antigo
+        if (!repair) {
+            // os apagados saem antes: um ID apagado pode voltar como novo na mesma carga
+            for (const auto& entry : indexes.changed) {
+                const ChangedRecord& record = entry.second;
+                if (record.current_ptr == record.original_ptr && !record.rewritten) continue;
+                title_removals.push_back({record.titulo, record.original_ptr});
+                for (const std::string& name : record.authors) author_removals.push_back({name, record.original_ptr});
+                if (record.current_ptr != -1) {
+                    changed_alive[record.current_ptr] = &record;
+                    read_ptrs.push_back(record.current_ptr);
+                    continue;
+                }
+                if (text_updater) text_updater->remove_document(entry.first);
+                if (column_updater) column_updater->remove(entry.first);
+            }
+        }
+
+        std::vector<std::string> authors;
+        data_file.read_records(std::move(read_ptrs), [&](f_ptr data_ptr, const Artigo& artigo) {
+            auto changed_it = changed_alive.find(data_ptr);
+            bool fresh = changed_it == changed_alive.end();
+            if (fresh) {
+                primary_new.push_back({artigo.ID, data_ptr});
+                if (covering_index) covering_new.push_back({covering_key(artigo), data_ptr});
+                secondary_new.push_back({hash_string_to_long(artigo.Titulo), make_title_posting(data_ptr, title_fingerprint(artigo.Titulo))});
+            }
+            if (repair) return;
+            title_insertions.push_back({artigo.Titulo, data_ptr});
+            unique_authors(artigo, authors);
+            for (std::string& name : authors) author_insertions.push_back({std::move(name), data_ptr});
+            if (text_updater) {
+                if (fresh) {
+                    text_updater->add_document(artigo, data_ptr);
+                } else if (changed_it->second->rewritten) {
+                    text_updater->remove_document(artigo.ID);
+                    text_updater->add_document(artigo, data_ptr);
+                } else {
+                    text_updater->move_document(artigo.ID, data_ptr);
+                }
+            }
+            if (column_updater) column_updater->put(artigo, data_ptr);
+        });
+
+        // cada índice na sua thread: as árvores de inteiros recebem os trechos ordenados de uma vez (insert_batch),
+        // as de strings intercalam inserções e remoções (merge_batch)
+        auto by_key = [](const auto& a, const auto& b) { return a.first < b.first || (!(b.first < a.first) && a.second < b.second); };
+        PipelineError merge_error;
+        std::vector<std::thread> mergers;
+        auto run = [&](std::function<void()> body) {
+            mergers.emplace_back([&merge_error, body] {
+                try { body(); }
+                catch (...) { merge_error.set(std::current_exception()); }
+            });
+        };
+        auto merge = [&](auto& tree, auto& entries) {
+            run([&tree, &entries, &by_key] {
+                std::sort(entries.begin(), entries.end(), by_key);
+                tree.insert_batch(entries);
+                tree.commit();
+            });
+        };
+        auto merge_strings = [&](const std::string& path, std::vector<StringBPlusTree::Entry>& insertions,
+                                 std::vector<StringBPlusTree::Entry>& removals, const char* name) {
+            if (insertions.empty() && removals.empty()) return;
+            run([&path, &insertions, &removals, &by_key, name] {
+                std::sort(insertions.begin(), insertions.end(), by_key);
+                std::sort(removals.begin(), removals.end(), by_key);
+                StringBPlusTree tree(path);
+                long missing = tree.merge_batch(insertions, removals);
+                if (missing > 0) LOG_WARN("AVISO: " << missing << " entradas a remover nao encontradas no " << name);
+            });
+        };
+        merge(primary_index, primary_new);
+        if (covering_index) merge(*covering_index, covering_new);
+        merge(secondary_index, secondary_new);
+        std::string title_index_path = data_dir + "/title_index.idx";
+        std::string author_index_path = data_dir + "/author_index.idx";
+        merge_strings(title_index_path, title_insertions, title_removals, "indice de titulos");
+        merge_strings(author_index_path, author_insertions, author_removals, "indice de autores");
+        if (text_updater) run([&] { text_updater->finish(); });
+        if (column_updater) run([&] { column_updater->finish(); });
+        for (std::thread& merger : mergers) merger.join();
+        merge_error.rethrow_if_set();
+        data_file.commit();
+        std::chrono::duration<double, std::milli> merge_ms = std::chrono::steady_clock::now() - merge_start;
+        LOG_INFO("[APPEND] " << primary_new.size() << " chaves novas intercaladas nos indices de inteiros em "
+                 << std::fixed << std::setprecision(1) << merge_ms.count() << " ms");
+
+        if (repair) {
+            RebuildTargets targets;
+            targets.strings = true;
+            targets.text = with_text;
+            targets.columns = with_columns;
+            rebuild_from_data_file(data_file, targets, data_dir, sort_memory, fill_factor);
+        } else {
+            LOG_INFO("[APPEND] Indices de carga em lote: " << title_insertions.size() << " titulos inseridos e "
+                     << title_removals.size() << " removidos, " << author_insertions.size() << " autores inseridos e "
+                     << author_removals.size() << " removidos");
+            if (column_updater) LOG_INFO("[COLUNAS] " << column_updater->row_count() << " linhas");
+        }
+
+        StageStats parsers_total{"parsers"};
+        for (const StageStats& stats : parser_stats) parsers_total.merge(stats);
+        if (mode == IncrementalMode::APPEND) {
+            log_stage_stats(reader_stats);
+            log_stage_stats(parsers_total);
+        }
+        if (mode != IncrementalMode::RECOVER) log_stage_stats(data_stats);
+        log_cache_stats("arquivo de dados", data_file.get_cache_stats());
+        log_cache_stats("indice primario", primary_index.get_cache_stats());
+        if (covering_index) log_cache_stats("indice de cobertura", covering_index->get_cache_stats());
+        log_cache_stats("indice secundario", secondary_index.get_cache_stats());
+        LOG_INFO("Arquivo de dados: " << data_file.get_record_count() << " artigos, " << data_file.get_bucket_count()
+                 << " buckets em " << data_file.get_total_blocks() << " blocos");
+        WalStats wal_stats = wal.get_stats();
+        LOG_INFO("[WAL] grupos: " << wal_stats.groups << " | paginas: " << wal_stats.pages << " | fdatasync: " << wal_stats.syncs
+                 << " | checkpoints: " << wal_stats.checkpoints);
+    } // os arquivos fazem o último commit e saem do log, que então é esvaziado
+
+    std::filesystem::remove(marker_path);
+    if (mode == IncrementalMode::RECOVER) {
+        LOG_INFO("[RECOVER] Carga interrompida concluida: indices refeitos a partir do arquivo de dados");
+        return;
+    }
+    if (delete_mode) {
+        LOG_INFO("[APPEND] Apagados: " << counts.deleted << " | IDs inexistentes: " << counts.missing);
+        return;
+    }
+    LOG_INFO("[APPEND] Inseridos: " << counts.inserted << " | ignorados (ja existiam): " << counts.skipped
+             << " | atualizados: " << counts.updated << " (" << counts.moved << " mudaram de endereco)"
+             << " | rejeitados: " << counts.rejected << " | registros movidos por splits: " << counts.relocated);
+}
+
 int main(int argc, char* argv[]) {
 
     auto start_time = std::chrono::high_resolution_clock::now();
@@ -149,98 +1055,290 @@ int main(int argc, char* argv[]) {
     }
     std::string data_dir(data_dir_env);
 
-    // Validando o argumento de entrada (path do CSV)
-    if (argc < 2) {
+    // Validando os argumentos de entrada (path do CSV e opções)
+    std::string input_csv_path;
+    bool use_bulk_load = true; // --no-bulk volta para as inserções uma a uma
+    bool build_text_index = true; // --no-text pula o índice de palavras (usado pelo search)
+    bool build_covering_index = false; // --covering monta também o índice primário com Ano e Citacoes nas folhas
+    bool build_columns = false; // --columns grava as colunas numéricas (columns.dat, usadas pelo scan)
+    bool append = false; // --append acrescenta o CSV a uma carga anterior em vez de recriar tudo
+    bool update_existing = false; // --update-existing: no --append, IDs que já existem são atualizados
+    bool delete_mode = false; // --delete: o arquivo de entrada traz IDs (um por linha) a apagar de uma carga anterior
+    bool recover = false; // --recover: termina uma carga incremental interrompida (sem arquivo de entrada)
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--no-bulk") {
+            use_bulk_load = false;
+        } else if (arg == "--no-text") {
+            build_text_index = false;
+        } else if (arg == "--covering") {
+            build_covering_index = true;
+        } else if (arg == "--columns") {
+            build_columns = true;
+        } else if (arg == "--append") {
+            append = true;
+        } else if (arg == "--update-existing") {
+            update_existing = true;
+        } else if (arg == "--delete") {
+            delete_mode = true;
+        } else if (arg == "--recover") {
+            recover = true;
+        } else if (input_csv_path.empty()) {
+            input_csv_path = arg;
+        } else {
+            LOG_ERROR("ERRO FATAL: Argumento desconhecido: " << arg);
+            return 1;
+        }
+    }
+    if (recover && (append || delete_mode || !input_csv_path.empty())) {
+        LOG_ERROR("ERRO FATAL: --recover nao recebe arquivo de entrada nem outras opcoes de carga.");
+        return 1;
+    }
+    if (input_csv_path.empty() && !recover) {
         LOG_ERROR("ERRO FATAL: Caminho para o .csv nao fornecido.");
-        LOG_INFO("Uso: ./bin/upload <caminho_para_csv>");
+        LOG_INFO("Uso: ./bin/upload [--no-bulk] [--no-text] [--covering] [--columns] <caminho_para_csv>");
+        LOG_INFO("     ./bin/upload --append [--update-existing] <caminho_para_csv>");
+        LOG_INFO("     ./bin/upload --delete <arquivo_com_ids>");
+        LOG_INFO("     ./bin/upload --recover");
         return 1;
     }
-    const std::string input_csv_path = argv[1];
+    if (update_existing && !append) {
+        LOG_ERROR("ERRO FATAL: --update-existing so vale junto com --append.");
+        return 1;
+    }
+    if (delete_mode && append) {
+        LOG_ERROR("ERRO FATAL: --delete e --append nao podem ser usados juntos.");
+        return 1;
+    }
+    if ((append || delete_mode) && (!use_bulk_load || !build_text_index || build_covering_index || build_columns)) {
+        LOG_WARN("Opcoes da carga completa ignoradas no --append/--delete: os indices opcionais que ja existem sao mantidos.");
+    }
     std::ifstream input_file;
 
     try {
 
         std::filesystem::create_directories(data_dir);
 
+        if (recover) {
+            run_incremental(data_dir, input_file, IncrementalMode::RECOVER, false);
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start_time;
+            LOG_INFO("Tempo de execucao do upload: " << std::fixed << std::setprecision(3) << elapsed.count() << " ms");
+            return 0;
+        }
+
         input_file.open(input_csv_path);
         if (!input_file.is_open()) {
             LOG_ERROR("Erro ao abrir aquivo: " + input_csv_path);
             return 1;
         }
 
+        if (append || delete_mode) {
+            run_incremental(data_dir, input_file, delete_mode ? IncrementalMode::DELETE : IncrementalMode::APPEND, update_existing);
+            input_file.close();
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start_time;
+            LOG_INFO("Tempo de execucao do upload: " << std::fixed << std::setprecision(3) << elapsed.count() << " ms");
+            return 0;
+        }
+
         std::string data_file_path = data_dir + "/data_file.dat";
         std::string primary_index_path = data_dir + "/primary_index.idx";
+        std::string covering_index_path = data_dir + "/primary_covering.idx";
         std::string secondary_index_path = data_dir + "/secondary_index.idx";
+        std::string title_index_path = data_dir + "/title_index.idx";
+        std::string author_index_path = data_dir + "/author_index.idx";
+        std::string columns_path = data_dir + "/columns.dat";
+
+        // a carga inicial sempre recria os arquivos (a carga em lote exige índices vazios)
+        std::vector<std::string> old_files = {data_file_path, primary_index_path, covering_index_path, secondary_index_path, title_index_path, author_index_path, columns_path};
+        // um log de escrita antecipada antigo seria reaplicado por cima dos arquivos novos, e o marcador de uma carga
+        // incremental interrompida faria as buscas recusarem os arquivos novos
+        for (const char* name : {"text_index.dict", "text_index.post", "text_index.docs", WAL_FILE_NAME, APPEND_MARKER_NAME}) old_files.push_back(data_dir + "/" + name);
+        for (const std::string& path : old_files) {
+            if (std::filesystem::remove(path)) {
+                LOG_INFO("Removendo arquivo de uma carga anterior: " << path);
+            }
+        }
 
-        HashingFile data_file(data_file_path, blocks_qntd);
+        HashingFile data_file(data_file_path); // começa pequeno e cresce com os splits do hashing linear
         BPlusTree primary_index(primary_index_path);
+        std::unique_ptr<BPlusTree_covering> covering_index;
+        if (build_covering_index) covering_index = std::make_unique<BPlusTree_covering>(covering_index_path);
+        std::unique_ptr<ColumnWriter> columns;
+        if (build_columns) columns = std::make_unique<ColumnWriter>(columns_path);
         BPlusTree_long secondary_index(secondary_index_path);
+        StringBPlusTree title_index(title_index_path); // só é construído pela carga em lote, mesmo com --no-bulk
+        StringBPlusTree author_index(author_index_path); // idem, uma entrada (autor, ponteiro) por autor de cada artigo
         LOG_INFO("Estrutura inicializadas em: " + data_dir);
 
-        std::string line_buffer;
-        std::string complete_record_line;
-        std::getline(input_file, line_buffer); 
+        int parser_threads = parser_thread_count();
+        LOG_INFO("Pipeline de carga: 1 leitor, " << parser_threads << " parsers, 1 escritor de dados, 1 varredura e " << (build_text_index ? 5 : 4) << " escritores de indice");
+
+        // ordenação externa das chaves de cada índice (só usada na carga em lote)
+        double fill_factor = env_double("INDEX_FILL_FACTOR", 1.0);
+        size_t sort_memory = static_cast<size_t>(env_double("SORT_MEMORY_MB", 64) * 1024 * 1024);
+        ExternalSorter<int> primary_entries(data_dir, "primary_index.sort", sort_memory);
+        ExternalSorter<CoveringKey> covering_entries(data_dir, "primary_covering.sort", sort_memory);
+        ExternalSorter<long long> secondary_entries(data_dir, "secondary_index.sort", sort_memory);
+        ExternalSorter<std::string> title_entries(data_dir, "title_index.sort", sort_memory);
+        ExternalSorter<std::string> author_entries(data_dir, "author_index.sort", sort_memory);
+        TextIndexBuilder text_builder(data_dir, sort_memory);
+        if (use_bulk_load) {
+            LOG_INFO("Indices serao construidos por carga em lote (fator de preenchimento " << fill_factor << ")");
+        }
+
+        UploadPipeline pipeline;
         int inserted_count = 0;
-        long physical_line_number = 1;
+        StageStats reader_stats{"leitor"};
+        StageStats data_stats{"arquivo de dados"};
+        StageStats scan_stats{"varredura"};
+        StageStats primary_stats{"indice primario"};
+        StageStats secondary_stats{"indice secundario"};
+        StageStats title_stats{"indice de titulos"};
+        StageStats author_stats{"indice de autores"};
+        StageStats text_stats{"indice de texto"};
+        std::vector<StageStats> parser_stats(parser_threads, StageStats{"parsers"});
 
-        while (std::getline(input_file, line_buffer)) {
-            physical_line_number++;
-            if (complete_record_line.empty()) {
-                complete_record_line = line_buffer;
-            } else {
-                complete_record_line += "\n" + line_buffer;
-            }
+        std::vector<std::thread> parsers;
+        for (int i = 0; i < parser_threads; ++i) {
+            parsers.emplace_back([&, i] { pipeline.run_stage([&] { parser_stage(pipeline, parser_stats[i]); }); });
+        }
+        std::thread data_writer([&] { pipeline.run_stage([&] { data_writer_stage(data_file, pipeline, data_stats, inserted_count); }); });
+        std::thread primary_writer([&] { pipeline.run_stage([&] {
+            // o mesmo escritor alimenta o índice primário e o de cobertura (quando pedido)
+            index_writer_stage(pipeline.primary_queue, primary_stats, [&](CoveringKey key, f_ptr ptr) {
+                if (use_bulk_load) primary_entries.add(key.id, ptr);
+                else primary_index.insert(key.id, ptr);
+                if (!covering_index) return;
+                if (use_bulk_load) covering_entries.add(key, ptr);
+                else covering_index->insert(key, ptr);
+            });
+        }); });
+        std::thread secondary_writer([&] { pipeline.run_stage([&] {
+            index_writer_stage(pipeline.secondary_queue, secondary_stats, [&](long long key, f_ptr ptr) {
+                if (use_bulk_load) secondary_entries.add(key, ptr);
+                else secondary_index.insert(key, ptr);
+            });
+        }); });
+        std::thread title_writer([&] { pipeline.run_stage([&] {
+            index_writer_stage(pipeline.title_queue, title_stats, [&](std::string key, f_ptr ptr) {
+                title_entries.add(std::move(key), ptr);
+            });
+        }); });
+        std::thread author_writer([&] { pipeline.run_stage([&] {
+            index_writer_stage(pipeline.author_queue, author_stats, [&](std::string key, f_ptr ptr) {
+                author_entries.add(std::move(key), ptr);
+            });
+        }); });
+        std::thread text_writer([&] { pipeline.run_stage([&] { text_writer_stage(pipeline, text_builder, text_stats); }); });
 
-            size_t quote_count = 0;
-            for (size_t i = 0; i < complete_record_line.length(); ++i) {
-                if (complete_record_line[i] == '"') {
-                    if (i + 1 == complete_record_line.length() || complete_record_line[i+1] != '"') {
-                        quote_count++;
-                    } else { i++; }
-                }
-            }
+        // o leitor roda na própria thread principal
+        pipeline.run_stage([&] { reader_stage(input_file, pipeline, reader_stats); });
 
-            if (quote_count % 2 == 0) {
-                Artigo artigo; 
-                // Chama a função de parsing
-                if (parse_csv_line(complete_record_line, artigo)) {
-                    // Rejeita títulos vazios
-                    if (artigo.Titulo[0] == '\0') {
-                        LOG_WARN("Aviso: Título vazio encontrado, artigo ignorado.\n");
-                        continue; // Pula para a próxima linha
-                    }
-
-                    // Validação do Ano
-                    if (artigo.Ano < 1000 || artigo.Ano > 2025) {
-                        LOG_WARN("Aviso: Ano inválido para o artigo com ID: " << artigo.ID << "\n");
-                        continue; 
-                    }
-
-                    f_ptr data_ptr = data_file.insert(artigo);
-                    if (data_ptr != -1) {
-                        if (inserted_count % 5000 == 0) {
-                           LOG_INFO("Carregando dados... " << inserted_count << " artigos processados até agora.\n");
-                        }
-                        primary_index.insert(artigo.ID, data_ptr);
-                        long long titulo_hash = BPlusTree_long::hash_string_to_long(artigo.Titulo);
-                        secondary_index.insert(titulo_hash, data_ptr);
-                        inserted_count++;
-                    } else {
-                        LOG_WARN("AVISO: Falha ao inserir artigo. ID: " << artigo.ID << "\n");
-                    }
-                } else {
-                    LOG_WARN("Aviso: A linha " << physical_line_number << " foi ignorada. Título vazio ou inválido: " << complete_record_line.substr(0,100) << "...\n");
-                }
-                complete_record_line.clear();
+        // cada estágio só fecha a fila seguinte quando todos os seus produtores terminaram
+        pipeline.raw_queue.close();
+        for (std::thread& parser : parsers) parser.join();
+        pipeline.parsed_queue.close();
+        data_writer.join();
+        // os índices só recebem os endereços definitivos, depois que todos os artigos foram inseridos
+        pipeline.run_stage([&] { index_scan_stage(data_file, pipeline, scan_stats, build_text_index, columns.get()); });
+        pipeline.primary_queue.close();
+        pipeline.secondary_queue.close();
+        pipeline.title_queue.close();
+        pipeline.author_queue.close();
+        pipeline.text_queue.close();
+        primary_writer.join();
+        secondary_writer.join();
+        title_writer.join();
+        author_writer.join();
+        text_writer.join();
+        pipeline.error.rethrow_if_set();
+
+        input_file.close();
+
+        // as árvores são independentes, então são construídas em paralelo
+        PipelineError bulk_error;
+        std::vector<std::thread> builders;
+        if (use_bulk_load) {
+            builders.emplace_back([&] {
+                try { bulk_load_index(primary_index, primary_entries, fill_factor, "indice primario"); }
+                catch (...) { bulk_error.set(std::current_exception()); }
+            });
+            if (covering_index) {
+                builders.emplace_back([&] {
+                    try { bulk_load_index(*covering_index, covering_entries, fill_factor, "indice de cobertura"); }
+                    catch (...) { bulk_error.set(std::current_exception()); }
+                });
             }
+            builders.emplace_back([&] {
+                try { bulk_load_index(secondary_index, secondary_entries, fill_factor, "indice secundario"); }
+                catch (...) { bulk_error.set(std::current_exception()); }
+            });
         }
+        builders.emplace_back([&] {
+            try { bulk_load_index(author_index, author_entries, fill_factor, "indice de autores"); }
+            catch (...) { bulk_error.set(std::current_exception()); }
+        });
+        if (columns) {
+            builders.emplace_back([&] {
+                try {
+                    auto start = std::chrono::steady_clock::now();
+                    columns->finish();
+                    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+                    LOG_INFO("[COLUNAS] " << columns->row_count() << " linhas em " << columns_path << ", "
+                             << std::fixed << std::setprecision(1) << elapsed.count() << " ms");
+                }
+                catch (...) { bulk_error.set(std::current_exception()); }
+            });
+        }
+        if (build_text_index) {
+            builders.emplace_back([&] {
+                try {
+                    auto start = std::chrono::steady_clock::now();
+                    text_builder.finish(fill_factor);
+                    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+                    LOG_INFO("[TEXTO] indice de texto: " << text_builder.document_count() << " documentos, "
+                             << text_builder.term_count() << " termos, " << text_builder.posting_count() << " postagens, "
+                             << text_builder.spilled_runs() << " runs em disco, "
+                             << std::fixed << std::setprecision(1) << elapsed.count() << " ms");
+                }
+                catch (...) { bulk_error.set(std::current_exception()); }
+            });
+        }
+        try { bulk_load_index(title_index, title_entries, fill_factor, "indice de titulos"); }
+        catch (...) { bulk_error.set(std::current_exception()); }
+        for (std::thread& builder : builders) builder.join();
+        bulk_error.rethrow_if_set();
 
-        input_file.close();
+        StageStats parsers_total{"parsers"};
+        for (const StageStats& stats : parser_stats) parsers_total.merge(stats);
+        LOG_INFO("Total de artigos inseridos: " << inserted_count);
+        LOG_INFO("Arquivo de dados: " << data_file.get_bucket_count() << " buckets em "
+                 << data_file.get_total_blocks() << " blocos");
+        log_stage_stats(reader_stats);
+        log_stage_stats(parsers_total);
+        log_stage_stats(data_stats);
+        log_stage_stats(scan_stats);
+        log_stage_stats(primary_stats);
+        log_stage_stats(secondary_stats);
+        log_stage_stats(title_stats);
+        log_stage_stats(author_stats);
+        if (build_text_index) log_stage_stats(text_stats);
+
+        log_cache_stats("arquivo de dados", data_file.get_cache_stats());
+        log_cache_stats("indice primario", primary_index.get_cache_stats());
+        if (covering_index) log_cache_stats("indice de cobertura", covering_index->get_cache_stats());
+        log_cache_stats("indice secundario", secondary_index.get_cache_stats());
+
+        LOG_INFO("[E/S] backend: " << page_io_backend() << " (profundidade " << page_io_depth() << ")"
+                 << (page_io_direct() ? ", O_DIRECT" : ""));
+        log_io_stats("arquivo de dados", data_file.get_io_stats());
+        log_io_stats("indice primario", primary_index.get_io_stats());
+        if (covering_index) log_io_stats("indice de cobertura", covering_index->get_io_stats());
+        log_io_stats("indice secundario", secondary_index.get_io_stats());
 
         auto end_time = std::chrono::high_resolution_clock::now();
         auto duration = end_time - start_time;
         std::chrono::duration<double, std::milli> duration_ms_fp = duration;
-        auto duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
         LOG_INFO("Tempo de execucao do upload: "
                         << std::fixed << std::setprecision(3) // mostra 3 casas decimais
                         << duration_ms_fp.count() << " ms");
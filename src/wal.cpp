@@ -0,0 +1,329 @@
+#include "wal.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <cstdlib>
+#include <set>
+#include <stdexcept>
+#include <filesystem>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "log.hpp"
+
+namespace {
+
+// Cabeçalho de um grupo; depois dele vêm o nome do arquivo e, para cada página, offset (int64), tamanho (uint32) e bytes
+struct WalGroupHeader {
+    uint32_t magic;         // WAL_GROUP_MAGIC
+    uint32_t page_count;
+    uint32_t name_length;
+    uint32_t checksum;      // CRC32 do resto do grupo (nome e páginas)
+    uint64_t payload_bytes; // bytes depois do cabeçalho
+};
+const uint32_t WAL_GROUP_MAGIC = 0x314C4157; // "WAL1"
+
+// CRC-32 (polinômio 0xEDB88320), tabela montada no primeiro uso
+uint32_t crc32(const char* data, size_t length) {
+    static const std::vector<uint32_t> table = [] {
+        std::vector<uint32_t> t(256);
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[i] = c;
+        }
+        return t;
+    }();
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < length; ++i) crc = table[(crc ^ static_cast<unsigned char>(data[i])) & 0xFF] ^ (crc >> 8);
+    return crc ^ 0xFFFFFFFFu;
+}
+
+long env_long(const char* name, long default_value, long min_value) {
+    const char* env = std::getenv(name);
+    if (env == nullptr) return default_value;
+    char* end_ptr = nullptr;
+    long value = std::strtol(env, &end_ptr, 10);
+    if (end_ptr == env || value < min_value) {
+        LOG_WARN(name << " invalido ('" << env << "'). Usando o padrao " << default_value);
+        return default_value;
+    }
+    return value;
+}
+
+bool read_exact(int fd, char* buffer, size_t length, off_t offset) {
+    size_t done = 0;
+    while (done < length) {
+        ssize_t n = ::pread(fd, buffer + done, length - done, offset + static_cast<off_t>(done));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        done += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool write_exact(int fd, const char* buffer, size_t length, off_t offset) {
+    size_t done = 0;
+    while (done < length) {
+        ssize_t n = ::pwrite(fd, buffer + done, length - done, offset + static_cast<off_t>(done));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        done += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// Logs abertos por este processo: os grupos deles são do próprio processo, não de uma execução interrompida
+std::mutex open_logs_mutex;
+std::set<std::string> open_logs;
+
+std::string log_key(const std::string& path) {
+    return std::filesystem::absolute(path).lexically_normal().string();
+}
+
+} // namespace
+
+WriteAheadLog::WriteAheadLog(const std::string& log_path) : path(log_path) {
+    directory = std::filesystem::path(path).parent_path().string();
+    if (directory.empty()) directory = ".";
+    group_inserts = env_long("WAL_GROUP_INSERTS", group_inserts, 1);
+    group_ms = env_long("WAL_GROUP_MS", group_ms, 0);
+    checkpoint_bytes = env_long("WAL_CHECKPOINT_MB", checkpoint_bytes / (1024 * 1024), 1) * 1024 * 1024;
+
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        LOG_ERROR("[WAL] Nao foi possivel abrir o log " << path << ": " << std::strerror(errno));
+        throw std::runtime_error("ERRO: não foi possível abrir o log de escrita antecipada");
+    }
+    try {
+        recover();
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+    std::lock_guard<std::mutex> lock(open_logs_mutex);
+    open_logs.insert(log_key(path));
+}
+
+WriteAheadLog::~WriteAheadLog() {
+    if (fd < 0) return;
+    {
+        std::lock_guard<std::mutex> lock(open_logs_mutex);
+        open_logs.erase(log_key(path));
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    if (participants.empty() && inflight == 0) {
+        if (log_bytes > 0) truncate_log();
+    } else {
+        LOG_WARN("[WAL] Log fechado com arquivos ainda ligados a ele, os grupos ficam para a proxima abertura");
+    }
+    ::close(fd);
+}
+
+int WriteAheadLog::attach(std::function<void()> sync_file) {
+    std::lock_guard<std::mutex> lock(mutex);
+    participants[next_id] = std::move(sync_file);
+    return next_id++;
+}
+
+void WriteAheadLog::detach(int id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = participants.find(id);
+    if (it == participants.end()) return;
+    it->second();
+    participants.erase(it);
+}
+
+void WriteAheadLog::commit(const std::string& file_path, const std::vector<PageRequest>& pages,
+                           const std::function<void()>& apply) {
+    // o grupo é montado fora do mutex e acrescentado ao log numa escrita só
+    std::string name = std::filesystem::path(file_path).filename().string();
+    size_t payload = name.size();
+    for (const PageRequest& page : pages) payload += sizeof(int64_t) + sizeof(uint32_t) + page.length;
+    std::vector<char> group(sizeof(WalGroupHeader) + payload);
+    char* out = group.data() + sizeof(WalGroupHeader);
+    std::memcpy(out, name.data(), name.size());
+    out += name.size();
+    for (const PageRequest& page : pages) {
+        int64_t offset = page.offset;
+        uint32_t length = static_cast<uint32_t>(page.length);
+        std::memcpy(out, &offset, sizeof(offset));
+        std::memcpy(out + sizeof(offset), &length, sizeof(length));
+        std::memcpy(out + sizeof(offset) + sizeof(length), page.buffer, page.length);
+        out += sizeof(offset) + sizeof(length) + page.length;
+    }
+    WalGroupHeader header{WAL_GROUP_MAGIC, static_cast<uint32_t>(pages.size()), static_cast<uint32_t>(name.size()),
+                          crc32(group.data() + sizeof(WalGroupHeader), payload), static_cast<uint64_t>(payload)};
+    std::memcpy(group.data(), &header, sizeof(header));
+
+    uint64_t lsn;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!write_exact(fd, group.data(), group.size(), static_cast<off_t>(log_bytes))) {
+            LOG_ERROR("[WAL] Falha ao gravar no log " << path << ": " << std::strerror(errno));
+            throw std::runtime_error("ERRO: falha ao gravar o log de escrita antecipada");
+        }
+        log_bytes += static_cast<long>(group.size());
+        written_lsn += group.size();
+        lsn = written_lsn;
+        inflight++;
+        stats.groups++;
+        stats.pages += static_cast<long>(pages.size());
+        stats.bytes += static_cast<long>(group.size());
+    }
+
+    try {
+        wait_durable(lsn);
+        apply(); // só agora as páginas podem ir para o arquivo
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(mutex);
+        inflight--;
+        throw;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    inflight--;
+    if (inflight == 0 && log_bytes >= checkpoint_bytes) checkpoint();
+}
+
+bool WriteAheadLog::group_due(long pending_inserts, std::chrono::steady_clock::time_point last_commit) const {
+    if (pending_inserts >= group_inserts) return true;
+    return std::chrono::steady_clock::now() - last_commit >= std::chrono::milliseconds(group_ms);
+}
+
+WalStats WriteAheadLog::get_stats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+bool WriteAheadLog::has_pending_groups(const std::string& log_path) {
+    {
+        std::lock_guard<std::mutex> lock(open_logs_mutex);
+        if (open_logs.count(log_key(log_path)) > 0) return false;
+    }
+    std::error_code error;
+    auto size = std::filesystem::file_size(log_path, error);
+    return !error && size > 0;
+}
+
+void ensure_no_pending_recovery(const std::string& file_path, OpenMode mode) {
+    std::string directory = std::filesystem::path(file_path).parent_path().string();
+    if (directory.empty()) directory = ".";
+    std::string log_path = directory + "/" + WAL_FILE_NAME;
+    bool pending_log = WriteAheadLog::has_pending_groups(log_path);
+    bool pending_append = mode == OpenMode::READ_ONLY &&
+                          std::filesystem::exists(directory + "/" + APPEND_MARKER_NAME);
+    if (!pending_log && !pending_append) return;
+    if (pending_log) {
+        LOG_ERROR("O log " << log_path << " tem grupos de uma execucao interrompida que ainda nao foram reaplicados.");
+    } else {
+        LOG_ERROR("Carga incremental interrompida ou em andamento em " << directory << " (" << APPEND_MARKER_NAME
+                  << "): os indices podem nao bater com o arquivo de dados.");
+    }
+    LOG_ERROR("Rode ./bin/upload --recover (com o mesmo DATA_DIR) antes de abrir " << file_path << ".");
+    throw std::runtime_error("ERRO: recuperação pendente em " + directory);
+}
+
+// Commit em grupo: quem chega enquanto outra thread está no fdatasync espera por ela e, se o grupo ainda
+// não estava coberto, faz o próximo fdatasync levando junto tudo o que foi gravado nesse meio tempo
+void WriteAheadLog::wait_durable(uint64_t lsn) {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (durable_lsn < lsn) {
+        if (syncing) {
+            synced.wait(lock);
+            continue;
+        }
+        syncing = true;
+        uint64_t target = written_lsn;
+        lock.unlock();
+        int result = ::fdatasync(fd);
+        int error = errno;
+        lock.lock();
+        syncing = false;
+        synced.notify_all();
+        if (result != 0) {
+            LOG_ERROR("[WAL] fdatasync do log falhou: " << std::strerror(error));
+            throw std::runtime_error("ERRO: falha ao sincronizar o log de escrita antecipada");
+        }
+        durable_lsn = target;
+        stats.syncs++;
+    }
+}
+
+void WriteAheadLog::checkpoint() {
+    for (auto& participant : participants) participant.second();
+    truncate_log();
+    stats.checkpoints++;
+    LOG_DEBUG("[WAL] Checkpoint: arquivos sincronizados e log esvaziado");
+}
+
+void WriteAheadLog::truncate_log() {
+    if (::ftruncate(fd, 0) != 0 || ::fdatasync(fd) != 0) {
+        LOG_ERROR("[WAL] Falha ao esvaziar o log " << path << ": " << std::strerror(errno));
+        throw std::runtime_error("ERRO: falha ao esvaziar o log de escrita antecipada");
+    }
+    log_bytes = 0;
+}
+
+// Redo: reaplica, em ordem, os grupos completos; o primeiro grupo incompleto ou corrompido marca o fim do log
+void WriteAheadLog::recover() {
+    off_t size = ::lseek(fd, 0, SEEK_END);
+    if (size <= 0) return;
+    LOG_INFO("[WAL] Log " << path << " com " << size << " bytes de uma execucao interrompida, reaplicando...");
+
+    std::map<std::string, int> files; // nome -> descritor dos arquivos tocados
+    off_t position = 0;
+    std::vector<char> payload;
+    while (position + static_cast<off_t>(sizeof(WalGroupHeader)) <= size) {
+        WalGroupHeader header;
+        if (!read_exact(fd, reinterpret_cast<char*>(&header), sizeof(header), position)) break;
+        if (header.magic != WAL_GROUP_MAGIC ||
+            header.payload_bytes > static_cast<uint64_t>(size - position - static_cast<off_t>(sizeof(header)))) break;
+        payload.resize(header.payload_bytes);
+        if (!read_exact(fd, payload.data(), payload.size(), position + static_cast<off_t>(sizeof(header)))) break;
+        if (crc32(payload.data(), payload.size()) != header.checksum || header.name_length > payload.size()) break;
+
+        std::string name(payload.data(), header.name_length);
+        auto it = files.find(name);
+        if (it == files.end()) {
+            std::string file_path = directory + "/" + name;
+            int file_fd = ::open(file_path.c_str(), O_RDWR | O_CLOEXEC);
+            if (file_fd < 0) LOG_WARN("[WAL] Arquivo " << file_path << " do log nao existe mais, grupo ignorado");
+            it = files.emplace(name, file_fd).first;
+        }
+        const char* in = payload.data() + header.name_length;
+        const char* end = payload.data() + payload.size();
+        for (uint32_t i = 0; i < header.page_count && it->second >= 0; ++i) {
+            int64_t offset;
+            uint32_t length;
+            std::memcpy(&offset, in, sizeof(offset));
+            std::memcpy(&length, in + sizeof(offset), sizeof(length));
+            in += sizeof(offset) + sizeof(length);
+            if (length > static_cast<size_t>(end - in) ||
+                !write_exact(it->second, in, length, static_cast<off_t>(offset))) {
+                LOG_ERROR("[WAL] Falha ao reaplicar uma pagina em " << name);
+                throw std::runtime_error("ERRO: falha na recuperação pelo log de escrita antecipada");
+            }
+            in += length;
+        }
+        position += static_cast<off_t>(sizeof(header) + header.payload_bytes);
+        stats.recovered++;
+    }
+    if (position < size) {
+        LOG_WARN("[WAL] " << (size - position) << " bytes do fim do log descartados (grupo incompleto)");
+    }
+
+    bool ok = true;
+    for (auto& file : files) {
+        if (file.second < 0) continue;
+        ok = ::fdatasync(file.second) == 0 && ok;
+        ::close(file.second);
+    }
+    if (!ok) {
+        LOG_ERROR("[WAL] Falha ao sincronizar os arquivos recuperados");
+        throw std::runtime_error("ERRO: falha na recuperação pelo log de escrita antecipada");
+    }
+    log_bytes = static_cast<long>(size);
+    truncate_log();
+    LOG_INFO("[WAL] Recuperacao concluida: " << stats.recovered << " grupos reaplicados");
+}
@@ -0,0 +1,113 @@
+//COMANDO PARA USO: make bench && ./bin/bench_node_search [buscas]
+// Microbenchmark da busca dentro de um nó: custo por nó de cada kernel com os nós cheios das árvores de 4 KiB
+// (339 chaves int no índice primário, 254 chaves long long no secundário). Confere também se todos os kernels
+// devolvem as mesmas posições que a busca linear
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+
+#include "BPlusTree.hpp"
+#include "node_search.hpp"
+
+namespace {
+
+const NodeSearchKernel KERNELS[] = {NodeSearchKernel::LINEAR, NodeSearchKernel::BINARY, NodeSearchKernel::SSE4, NodeSearchKernel::AVX2};
+const int NODES = 64; // nós diferentes, todos no cache L1/L2 como numa árvore quente
+
+// gera NODES nós cheios com chaves ordenadas e as buscas (metade chaves existentes, metade aleatórias)
+template <typename Key>
+void make_nodes(int keys_per_node, int queries, std::vector<Key>& keys, std::vector<Key>& probes, std::vector<int>& probe_nodes) {
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<long long> dist(0, 1000000000LL);
+    keys.resize(static_cast<size_t>(NODES) * keys_per_node);
+    for (int n = 0; n < NODES; ++n) {
+        auto first = keys.begin() + static_cast<long>(n) * keys_per_node;
+        for (int i = 0; i < keys_per_node; ++i) first[i] = static_cast<Key>(dist(rng));
+        std::sort(first, first + keys_per_node);
+    }
+    probes.resize(queries);
+    probe_nodes.resize(queries);
+    for (int q = 0; q < queries; ++q) {
+        int node = static_cast<int>(rng() % NODES);
+        probe_nodes[q] = node;
+        probes[q] = (q % 2 == 0) ? keys[static_cast<size_t>(node) * keys_per_node + rng() % keys_per_node]
+                                 : static_cast<Key>(dist(rng));
+    }
+}
+
+template <typename Key>
+bool run(const char* label, int keys_per_node, int queries) {
+    std::vector<Key> keys, probes;
+    std::vector<int> probe_nodes;
+    make_nodes<Key>(keys_per_node, queries, keys, probes, probe_nodes);
+
+    // referência: busca linear
+    set_node_search_kernel(NodeSearchKernel::LINEAR);
+    std::vector<int> expected(static_cast<size_t>(queries) * 2);
+    for (int q = 0; q < queries; ++q) {
+        const Key* node = keys.data() + static_cast<size_t>(probe_nodes[q]) * keys_per_node;
+        expected[2 * q] = node_lower_bound(node, keys_per_node, probes[q]);
+        expected[2 * q + 1] = node_upper_bound(node, keys_per_node, probes[q]);
+    }
+
+    bool ok = true;
+    std::cout << label << " (" << keys_per_node << " chaves por no, " << queries << " buscas)" << std::endl;
+    for (NodeSearchKernel kernel : KERNELS) {
+        if (!set_node_search_kernel(kernel)) {
+            std::cout << "  " << std::setw(7) << node_search_kernel_name(kernel) << ": nao suportado" << std::endl;
+            continue;
+        }
+        // conferência (inclui nós com poucas chaves, que caem nos caminhos curtos dos kernels)
+        for (int q = 0; q < queries && ok; ++q) {
+            const Key* node = keys.data() + static_cast<size_t>(probe_nodes[q]) * keys_per_node;
+            int count = 1 + q % keys_per_node;
+            int lower = node_lower_bound(node, keys_per_node, probes[q]), upper = node_upper_bound(node, keys_per_node, probes[q]);
+            set_node_search_kernel(NodeSearchKernel::LINEAR);
+            int lower_ref = node_lower_bound(node, count, probes[q]), upper_ref = node_upper_bound(node, count, probes[q]);
+            set_node_search_kernel(kernel);
+            if (lower != expected[2 * q] || upper != expected[2 * q + 1] ||
+                node_lower_bound(node, count, probes[q]) != lower_ref || node_upper_bound(node, count, probes[q]) != upper_ref) {
+                std::cout << "  " << node_search_kernel_name(kernel) << ": RESULTADO DIFERENTE na busca " << q << std::endl;
+                ok = false;
+            }
+        }
+
+        // medição: descida (upper) e folha (lower) alternadas
+        long long checksum = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int q = 0; q < queries; ++q) {
+            const Key* node = keys.data() + static_cast<size_t>(probe_nodes[q]) * keys_per_node;
+            checksum += (q & 1) ? node_lower_bound(node, keys_per_node, probes[q])
+                                : node_upper_bound(node, keys_per_node, probes[q]);
+        }
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "  " << std::setw(7) << node_search_kernel_name(kernel) << ": " << std::fixed << std::setprecision(2)
+                  << ns / queries << " ns por no (checksum " << checksum << ")" << std::endl;
+    }
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int queries = (argc > 1) ? std::atoi(argv[1]) : 2000000;
+    if (queries <= 0) queries = 2000000;
+
+    NodeSearchKernel chosen = node_search_kernel();
+    std::cout << "Kernel escolhido na inicializacao: " << node_search_kernel_name(chosen) << std::endl;
+
+    bool ok = run<int>("Indice primario (int)", BPlusTree<int>::ORDER - 1, queries);
+    ok = run<long long>("Indice secundario (long long)", BPlusTree<long long>::ORDER - 1, queries) && ok;
+
+    set_node_search_kernel(chosen);
+    if (!ok) {
+        std::cout << "ERRO: kernels divergem da busca linear" << std::endl;
+        return 1;
+    }
+    return 0;
+}
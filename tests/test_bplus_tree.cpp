@@ -1,19 +1,42 @@
-//COMANDO PARA USO: g++ -std=c++17 -Iinclude src/BPlusTree.cpp tests/test_bplus_tree.cpp -o test_bplus_tree
-//NÃO SE ESQUEÇA DE MUDAR O const int ORDER = 340 PARA const int ORDER = 4
+//COMANDO PARA USO: make test
 
 #include <iostream>
 #include <cassert> // Para usar a função assert()
 #include <cstdio>  // Para usar a função remove()
 #include <vector>  // Para testes mais complexos se necessário
+#include <string>
+#include <algorithm>
+#include <array>
+#include <map>
+#include <iterator>
+#include <random>
+#include <climits>
+#include <tuple>
+#include <fstream>
+#include <filesystem>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <sys/socket.h>
+#include <unistd.h>
 
 #include "BPlusTree.hpp" // Inclui a classe BPlusTree COM CACHE
+#include "string_bplus_tree.hpp"
+#include "BPlusTree_covering.hpp"
+#include "hashing.hpp"
+#include "BPlusTree_long.hpp"
+#include "query_server.hpp"
+#include "text_index.hpp"
+#include "column_store.hpp"
+
+// Árvore com nós de 64 bytes: a ordem derivada da página é 4 (máx 3 chaves por nó), o que força splits com poucas chaves
+using TestTree = BPlusTree<int, 64>;
+static_assert(TestTree::ORDER == 4, "a arvore de teste precisa ter ORDER = 4");
 
 int main() {
-    // IMPORTANTE: Mude ORDER em BPlusTree.hpp para um valor baixo (ex: 4 ou 5) para estes testes!
     const std::string test_file = "test_tree_cached.idx"; // Nome diferente para evitar conflito
 
     std::cout << "--- Iniciando testes da BPlusTree com Cache ---" << std::endl;
-    std::cout << "AVISO: Certifique-se de que ORDER em BPlusTree.hpp esta baixo (ex: 4 ou 5)!" << std::endl;
 
     // Limpa o arquivo de testes anteriores
     remove(test_file.c_str());
@@ -21,7 +44,7 @@ int main() {
     // --- Teste 1: Inserção Simples e Busca Imediata (Cache Hit Provável) ---
     std::cout << "  [TESTE 1] Insercao simples e busca imediata..." << std::endl;
     { // Bloco para controlar o tempo de vida da 'tree1'
-        BPlusTree tree1(test_file);
+        TestTree tree1(test_file);
         int blocks_read = 0;
 
         tree1.insert(10, 1000);
@@ -41,7 +64,7 @@ int main() {
     // --- Teste 2: Persistência (Verifica se flush_cache funcionou) ---
     std::cout << "  [TESTE 2] Verificacao de persistencia apos flush..." << std::endl;
     { // Bloco para controlar o tempo de vida da 'tree2'
-        BPlusTree tree2(test_file); // Cria NOVO objeto, forçando leitura do DISCO
+        TestTree tree2(test_file); // Cria NOVO objeto, forçando leitura do DISCO
         int blocks_read = 0;
 
         // Verifica se os dados inseridos no Teste 1 ainda existem após recarregar
@@ -58,10 +81,10 @@ int main() {
     // --- Teste 3: Split de Folha e Persistência ---
      std::cout << "  [TESTE 3] Split de folha e persistencia..." << std::endl;
     {
-        BPlusTree tree3(test_file); // Reabre com dados dos testes anteriores
+        TestTree tree3(test_file); // Reabre com dados dos testes anteriores
         int blocks_read = 0;
 
-        // Supondo ORDER = 4 (máx 3 chaves por nó)
+        // ORDER = 4 (máx 3 chaves por nó)
         tree3.insert(30, 3000); // Nó folha agora tem {10, 20, 30}
         assert(tree3.search(30, blocks_read) == 3000);
 
@@ -76,7 +99,7 @@ int main() {
         // tree3 é destruída, flush_cache() chamado
     }
     { // Abre novamente para verificar persistência do split
-        BPlusTree tree4(test_file);
+        TestTree tree4(test_file);
         int blocks_read = 0;
         std::cout << "  ---> Verificando persistencia do split de folha..." << std::endl;
         assert(tree4.search(5, blocks_read) == 500);
@@ -90,10 +113,10 @@ int main() {
     // --- Teste 4: Split da Raiz e Persistência ---
     std::cout << "  [TESTE 4] Split da raiz e persistencia..." << std::endl;
      {
-        BPlusTree tree5(test_file); // Reabre
+        TestTree tree5(test_file); // Reabre
         int blocks_read = 0;
 
-        // Continua inserindo (com ORDER=4) para forçar split da raiz
+        // Continua inserindo (ORDER = 4) para forçar split da raiz
         tree5.insert(15, 1500);
         tree5.insert(25, 2500); // Pode causar split interno
         tree5.insert(35, 3500); // Deve causar split da raiz
@@ -106,7 +129,7 @@ int main() {
         std::cout << "  ---> Split da raiz e buscas imediatas OK." << std::endl;
      }
      { // Abre novamente para verificar persistência
-         BPlusTree tree6(test_file);
+         TestTree tree6(test_file);
          int blocks_read = 0;
          std::cout << "  ---> Verificando persistencia do split da raiz..." << std::endl;
          assert(tree6.search(15, blocks_read) == 1500);
@@ -118,10 +141,916 @@ int main() {
     std::cout << "  [PASSOU TESTE 4]" << std::endl;
 
 
+    // --- Teste 5: Varredura por faixa pela lista de folhas ---
+    std::cout << "  [TESTE 5] Varredura por faixa..." << std::endl;
+    {
+        TestTree tree7(test_file); // Reabre (chaves 5, 10, 15, 20, 25, 30, 35 espalhadas em várias folhas)
+        std::vector<int> keys;
+        tree7.scan(10, 30, [&](int key, f_ptr data_ptr) {
+            assert(data_ptr == key * 100);
+            keys.push_back(key);
+            return true;
+        });
+        assert((keys == std::vector<int>{10, 15, 20, 25, 30}));
+
+        keys.clear();
+        tree7.scan(12, 100, [&](int key, f_ptr) { keys.push_back(key); return keys.size() < 2; }); // para no meio
+        assert((keys == std::vector<int>{15, 20}));
+
+        keys.clear();
+        tree7.scan(36, 40, [&](int key, f_ptr) { keys.push_back(key); return true; }); // faixa vazia
+        assert(keys.empty());
+        std::cout << "  ---> Varredura por faixa OK." << std::endl;
+    }
+    std::cout << "  [PASSOU TESTE 5]" << std::endl;
+
+
+    // --- Teste 6: Chaves repetidas (listas de postagens) espalhadas por várias folhas ---
+    std::cout << "  [TESTE 6] Chaves repetidas..." << std::endl;
+    {
+        const std::string dup_file = "test_tree_dup.idx";
+        remove(dup_file.c_str());
+        TestTree tree8(dup_file);
+        // 7 repetições da chave 20 (mais que uma folha inteira) entre chaves únicas
+        for (int i = 0; i < 7; i++) tree8.insert(20, 2000 + i);
+        for (int key : {5, 10, 15, 25, 30, 35}) tree8.insert(key, key * 100);
+        for (int i = 7; i < 9; i++) tree8.insert(20, 2000 + i);
+
+        std::vector<f_ptr> postings;
+        tree8.scan(20, 20, [&](int, f_ptr ptr) { postings.push_back(ptr); return true; });
+        std::sort(postings.begin(), postings.end());
+        assert(postings.size() == 9 && postings.front() == 2000 && postings.back() == 2008);
+
+        std::vector<std::vector<f_ptr>> found(4);
+        tree8.search_batch_all({10, 12, 20, 35}, [&](size_t k, f_ptr ptr) { found[k].push_back(ptr); });
+        std::sort(found[2].begin(), found[2].end());
+        assert((found[0] == std::vector<f_ptr>{1000}));
+        assert(found[1].empty());
+        assert(found[2] == postings);
+        assert((found[3] == std::vector<f_ptr>{3500}));
+        remove(dup_file.c_str());
+        std::cout << "  ---> Chaves repetidas OK." << std::endl;
+    }
+    std::cout << "  [PASSOU TESTE 6]" << std::endl;
+
+
+    // --- Teste 7: Árvore de strings (carga em lote, busca exata, prefixo e faixa) ---
+    std::cout << "  [TESTE 7] Arvore B+ de strings..." << std::endl;
+    {
+        const std::string string_file = "test_string_tree.idx";
+        remove(string_file.c_str());
+        // chaves com prefixos longos em comum e repetidas; o fator de preenchimento baixo força vários níveis
+        std::vector<std::string> expected;
+        {
+            ExternalSorter<std::string> entries(".", "test_string_tree.sort", 1 << 20);
+            for (int i = 0; i < 2000; i++) {
+                std::string key = "titulo " + std::to_string(i % 1000);
+                entries.add(key, i);
+                expected.push_back(key);
+            }
+            entries.add("", 5000); // chave vazia é a menor de todas
+            expected.push_back("");
+            entries.finish();
+            StringBPlusTree tree9(string_file);
+            tree9.bulk_load(entries, 0.1);
+            assert(tree9.get_entry_count() == 2001);
+            assert(tree9.get_height() >= 3);
+        }
+        std::sort(expected.begin(), expected.end());
+
+        StringBPlusTree tree10(string_file, OpenMode::READ_ONLY);
+        int blocks = 0;
+        f_ptr ptr = tree10.search("titulo 42", blocks);
+        assert(ptr == 42 || ptr == 1042);
+        assert(blocks == tree10.get_height());
+        assert(tree10.search("", blocks) == 5000);
+        assert(tree10.search("titulo 4200", blocks) == -1);
+        assert(tree10.search("titulo", blocks) == -1);
+
+        std::vector<std::string> keys;
+        tree10.scan_prefix("titulo 99", [&](const std::string& key, f_ptr) { keys.push_back(key); return true; });
+        std::vector<std::string> with_prefix;
+        for (const std::string& key : expected) if (key.compare(0, 9, "titulo 99") == 0) with_prefix.push_back(key);
+        assert(keys == with_prefix && keys.size() == 22); // 99 e 990..999, cada um duas vezes
+
+        keys.clear();
+        tree10.scan("", "~", [&](const std::string& key, f_ptr) { keys.push_back(key); return true; });
+        assert(keys == expected); // tudo, em ordem, passando por todas as folhas
+
+        keys.clear();
+        tree10.scan("titulo 5", "titulo 50", [&](const std::string& key, f_ptr) { keys.push_back(key); return true; });
+        assert((keys == std::vector<std::string>{"titulo 5", "titulo 5", "titulo 50", "titulo 50"}));
+        remove(string_file.c_str());
+        std::cout << "  ---> Arvore B+ de strings OK." << std::endl;
+    }
+    std::cout << "  [PASSOU TESTE 7]" << std::endl;
+
+    // --- Teste 8: Índice de cobertura (atributos ao lado da chave, inserção e carga em lote) ---
+    std::cout << "  [TESTE 8] Indice de cobertura..." << std::endl;
+    {
+        const std::string inserted_file = "test_tree_covering.idx";
+        const std::string bulk_file = "test_tree_covering_bulk.idx";
+        remove(inserted_file.c_str());
+        remove(bulk_file.c_str());
+        {
+            BPlusTree<CoveringKey, 128> inserted(inserted_file);
+            BPlusTree<CoveringKey, 128> bulk(bulk_file);
+            ExternalSorter<CoveringKey> entries(".", "test_tree_covering.sort", 64 * sizeof(CoveringKey));
+            for (int i = 0; i < 60; i++) {
+                int id = (i * 37) % 60; // fora de ordem, força splits no meio das folhas
+                inserted.insert({id, 1990 + id % 30, id * 10}, id * 100);
+                entries.add({id, 1990 + id % 30, id * 10}, id * 100);
+            }
+            bulk.bulk_load(entries, 1.0);
+        }
+        for (const std::string& file : {inserted_file, bulk_file}) {
+            BPlusTree<CoveringKey, 128> tree(file, OpenMode::READ_ONLY);
+            std::vector<CoveringKey> rows;
+            tree.scan(covering_key(10), covering_key(19), [&](CoveringKey key, f_ptr ptr) {
+                assert(ptr == key.id * 100);
+                rows.push_back(key);
+                return true;
+            });
+            assert(rows.size() == 10);
+            for (int i = 0; i < 10; i++) {
+                assert(rows[i].id == 10 + i && rows[i].ano == 1990 + (10 + i) % 30 && rows[i].citacoes == (10 + i) * 10);
+            }
+            int blocks = 0;
+            assert(tree.search(covering_key(59), blocks) == 5900);
+            assert(tree.search(covering_key(60), blocks) == -1);
+        }
+        remove(inserted_file.c_str());
+        remove(bulk_file.c_str());
+        std::cout << "  ---> Indice de cobertura OK." << std::endl;
+    }
+    std::cout << "  [PASSOU TESTE 8]" << std::endl;
+
+    // --- Teste 9: E/S em lote (PageFile e leituras agrupadas da árvore sem mmap) ---
+    std::cout << "  [TESTE 9] E/S em lote (" << page_io_backend() << ")..." << std::endl;
+    {
+        const std::string pages_file = "test_page_io.dat";
+        PageFile file;
+        assert(file.open(pages_file, true));
+        std::vector<std::vector<char>> pages(100, std::vector<char>(512));
+        std::vector<PageRequest> requests;
+        for (int i = 0; i < 100; i++) {
+            std::fill(pages[i].begin(), pages[i].end(), static_cast<char>(i));
+            requests.push_back({static_cast<long>((99 - i) * 512), pages[i].data(), 512}); // fora de ordem
+        }
+        assert(file.write_batch(requests));
+        for (auto& page : pages) std::fill(page.begin(), page.end(), 0);
+        assert(file.read_batch(requests));
+        for (int i = 0; i < 100; i++) assert(pages[i][0] == static_cast<char>(i) && pages[i][511] == static_cast<char>(i));
+        requests.push_back({100 * 512, pages[0].data(), 512}); // depois do fim do arquivo
+        assert(!file.read_batch(requests));
+        file.close();
+        remove(pages_file.c_str());
+        std::cout << "  ---> read_batch/write_batch OK." << std::endl;
+
+        // O_DIRECT: páginas alinhadas vão direto, trechos desalinhados passam pelo buffer alinhado
+        assert(file.open(pages_file, true, true));
+        AlignedArray<std::array<char, PAGE_IO_ALIGNMENT>> blocks(4);
+        std::vector<PageRequest> aligned_requests;
+        for (int i = 0; i < 4; i++) {
+            blocks[i].fill(static_cast<char>('a' + i));
+            aligned_requests.push_back({static_cast<long>(i * PAGE_IO_ALIGNMENT), blocks[i].data(), PAGE_IO_ALIGNMENT});
+        }
+        assert(file.write_batch(aligned_requests));
+        char middle[10] = "123456789";
+        assert(file.write(PAGE_IO_ALIGNMENT - 4, middle, 9)); // cruza a divisa entre duas páginas
+        assert(file.write(4 * PAGE_IO_ALIGNMENT, middle, 9)); // estende o arquivo só até o fim do pedido
+        assert(file.size() == static_cast<long>(4 * PAGE_IO_ALIGNMENT + 9));
+        char back[12] = {};
+        assert(file.read(PAGE_IO_ALIGNMENT - 5, back, 11));
+        assert(std::string(back, 11) == "a123456789b");
+        for (int i = 0; i < 4; i++) blocks[i].fill(0);
+        assert(file.read_batch(aligned_requests));
+        assert(blocks[0][0] == 'a' && blocks[1][5] == 'b' && blocks[3][PAGE_IO_ALIGNMENT - 1] == 'd');
+        assert(!file.read(4 * PAGE_IO_ALIGNMENT, back, 10)); // passa do fim do arquivo
+        assert(file.read(4 * PAGE_IO_ALIGNMENT + 2, back, 7) && std::string(back, 7) == "3456789");
+        bool direct = file.is_direct();
+        file.close();
+        remove(pages_file.c_str());
+        std::cout << "  ---> O_DIRECT (" << (direct ? "ativo" : "nao suportado") << ") OK." << std::endl;
+
+        const std::string batch_file = "test_tree_batch.idx";
+        remove(batch_file.c_str());
+        {
+            TestTree tree(batch_file);
+            ExternalSorter<int> entries(".", "test_tree_batch.sort", 64 * sizeof(int));
+            for (int i = 0; i < 500; i++) entries.add(i * 2, i * 20);
+            tree.bulk_load(entries, 1.0);
+        }
+        {
+            TestTree tree(batch_file); // leitura e escrita: os filhos de cada nó vêm num lote só
+            std::vector<int> keys;
+            for (int k = 0; k < 1000; k += 3) keys.push_back(k);
+            std::vector<f_ptr> out;
+            tree.search_batch(keys, out);
+            for (size_t i = 0; i < keys.size(); i++) assert(out[i] == (keys[i] % 2 == 0 ? keys[i] * 10 : -1));
+            int count = 0;
+            tree.scan(100, 899, [&](int key, f_ptr ptr) {
+                assert(key == 100 + 2 * count && ptr == key * 10);
+                count++;
+                return true;
+            });
+            assert(count == 400);
+            assert(tree.get_io_stats().batches > 0);
+        }
+        remove(batch_file.c_str());
+        std::cout << "  ---> Busca em lote e varredura sem mmap OK." << std::endl;
+    }
+    std::cout << "  [PASSOU TESTE 9]" << std::endl;
+
+    // --- Teste 10: log de escrita antecipada (commits em grupo e redo depois de uma queda simulada) ---
+    std::cout << "  [TESTE 10] Log de escrita antecipada..." << std::endl;
+    {
+        setenv("WAL_GROUP_MS", "600000", 1); // só os commits pedidos pelo teste
+        const std::string wal_tree = "test_tree_wal.idx";
+        const std::string wal_path = "test_wal.log";
+        const std::string snapshot = "test_tree_wal.snap";
+        const std::string crash_log = "test_wal_crash.log";
+        remove(wal_tree.c_str());
+        remove(wal_path.c_str());
+        {
+            WriteAheadLog wal(wal_path);
+            TestTree tree(wal_tree);
+            tree.attach_wal(wal);
+            for (int i = 0; i < 300; i++) tree.insert(i, i * 10);
+            tree.commit();
+            std::filesystem::copy_file(wal_tree, snapshot, std::filesystem::copy_options::overwrite_existing);
+            for (int i = 300; i < 600; i++) tree.insert(i, i * 10);
+            tree.commit();
+            for (int i = 600; i < 700; i++) tree.insert(i, i * 10); // sem commit: somem na queda
+            // a queda: o log fica como está e o arquivo perde tudo o que foi gravado depois do primeiro commit
+            std::filesystem::copy_file(wal_path, crash_log, std::filesystem::copy_options::overwrite_existing);
+            assert(wal.get_stats().groups == 2 && wal.get_stats().syncs == 2);
+        }
+        assert(std::filesystem::file_size(wal_path) == 0); // fechamento normal: log esvaziado
+        std::filesystem::copy_file(snapshot, wal_tree, std::filesystem::copy_options::overwrite_existing);
+        std::filesystem::copy_file(crash_log, wal_path, std::filesystem::copy_options::overwrite_existing);
+        {
+            std::ofstream torn(wal_path, std::ios::binary | std::ios::app);
+            torn << "grupo cortado no meio"; // fim de log incompleto: ignorado
+        }
+        {
+            WriteAheadLog wal(wal_path);
+            assert(wal.get_stats().recovered == 2);
+            TestTree tree(wal_tree);
+            int blocks_read = 0;
+            for (int i = 0; i < 700; i++) assert(tree.search(i, blocks_read) == (i < 600 ? i * 10 : -1));
+        }
+        for (const std::string& file : {wal_tree, wal_path, snapshot, crash_log}) remove(file.c_str());
+        unsetenv("WAL_GROUP_MS");
+        std::cout << "  ---> Redo dos commits e descarte do grupo incompleto OK." << std::endl;
+
+        // recuperação pendente no diretório: as aberturas recusam os arquivos até o log ser reaplicado
+        const std::string pending_dir = "test_pending_dir";
+        const std::string pending_tree = pending_dir + "/tree.idx";
+        std::filesystem::remove_all(pending_dir);
+        std::filesystem::create_directories(pending_dir);
+        {
+            TestTree tree(pending_tree);
+            for (int i = 0; i < 50; i++) tree.insert(i, i * 10);
+        }
+        auto open_fails = [&](OpenMode mode) {
+            try {
+                TestTree tree(pending_tree, mode);
+            } catch (const std::runtime_error&) {
+                return true;
+            }
+            return false;
+        };
+        {
+            std::ofstream leftover(pending_dir + "/" + WAL_FILE_NAME, std::ios::binary);
+            leftover << "grupo de uma execucao interrompida";
+        }
+        assert(open_fails(OpenMode::READ_ONLY) && open_fails(OpenMode::READ_WRITE));
+        {
+            WriteAheadLog wal(pending_dir + "/" + WAL_FILE_NAME); // reaplica (aqui só descarta o grupo cortado)
+            assert(!open_fails(OpenMode::READ_WRITE));
+        }
+        assert(!open_fails(OpenMode::READ_ONLY));
+        std::ofstream(pending_dir + "/" + APPEND_MARKER_NAME).close();
+        assert(open_fails(OpenMode::READ_ONLY) && !open_fails(OpenMode::READ_WRITE));
+        std::filesystem::remove_all(pending_dir);
+        std::cout << "  ---> Aberturas recusadas com log ou marcador pendente OK." << std::endl;
+    }
+    std::cout << "  [PASSOU TESTE 10]" << std::endl;
+
+    // --- Teste 11: troca de entradas na árvore e atualização no lugar do arquivo de dados (carga incremental) ---
+    std::cout << "  [TESTE 11] Troca de entradas e atualizacao no lugar..." << std::endl;
+    {
+        const std::string replace_file = "test_tree_replace.idx";
+        remove(replace_file.c_str());
+        TestTree tree(replace_file);
+        for (int i = 0; i < 9; i++) tree.insert(20, 2000 + i); // repetições em várias folhas
+        for (int key : {5, 10, 15, 25, 30}) tree.insert(key, key * 100);
+        assert(tree.replace_entry(20, 2007, 20, 7777));
+        assert(tree.replace_entry(30, 3000, 30, 3333));
+        assert(!tree.replace_entry(20, 9999, 20, 1));
+        std::vector<f_ptr> postings;
+        tree.scan(20, 20, [&](int, f_ptr ptr) { postings.push_back(ptr); return true; });
+        assert(postings.size() == 9 && std::count(postings.begin(), postings.end(), 7777) == 1 &&
+               std::count(postings.begin(), postings.end(), 2007) == 0);
+        int blocks_read = 0;
+        assert(tree.search(30, blocks_read) == 3333);
+        remove(replace_file.c_str());
+
+        const std::string data_path = "test_replace_data.dat";
+        remove(data_path.c_str());
+        remove((data_path + ".occ").c_str());
+        {
+            HashingFile data_file(data_path);
+            Artigo artigo;
+            artigo.ID = 42;
+            artigo.Ano = 2001;
+            std::snprintf(artigo.Titulo, sizeof(artigo.Titulo), "titulo");
+            f_ptr ptr = data_file.insert(artigo);
+            artigo.Citacoes = 7; // mesmo tamanho: fica no mesmo lugar
+            assert(data_file.update_in_place(artigo) == ptr);
+            std::string snippet(900, 's'); // maior: vai para o espaço livre da página, mesmo endereço
+            std::snprintf(artigo.Snippet, sizeof(artigo.Snippet), "%s", snippet.c_str());
+            assert(data_file.update_in_place(artigo) == ptr);
+            Artigo read_back;
+            assert(data_file.read_record(ptr, read_back) && read_back.Citacoes == 7 && read_back.Snippet == snippet);
+            artigo.ID = 43;
+            assert(data_file.update_in_place(artigo) == -1); // ID inexistente
+        }
+        remove(data_path.c_str());
+        remove((data_path + ".occ").c_str());
+        std::cout << "  ---> replace_entry e update_in_place OK." << std::endl;
+    }
+    std::cout << "  [PASSOU TESTE 11]" << std::endl;
+
+    // --- Teste 12: remoção com redistribuição/fusão, reuso dos nós livres e lápides no arquivo de dados ---
+    std::cout << "  [TESTE 12] Remocao na arvore e no arquivo de dados..." << std::endl;
+    {
+        const std::string remove_file = "test_tree_remove.idx";
+        remove(remove_file.c_str());
+        const int N = 200;
+        long blocks_full = 0;
+        {
+            TestTree tree(remove_file);
+            for (int i = 0; i < N; i++) tree.insert(i, i * 10);
+            for (int i = 0; i < 6; i++) tree.insert(100, 5000 + i); // repetições espalhadas em folhas vizinhas
+            blocks_full = tree.get_total_blocks();
+            assert(!tree.remove(100, 4242));   // posting que não existe
+            assert(!tree.remove(N + 1, 0));    // chave que não existe
+            assert(tree.remove(100, 5003));
+            for (int i = 0; i < N; i++) {
+                int key = (i * 37) % N; // ordem embaralhada: folhas dos dois lados ficam com poucas chaves
+                if (key % 10 != 0) assert(tree.remove(key, key * 10));
+            }
+        }
+        {
+            TestTree tree(remove_file); // reabre: a lista de nós livres veio do disco
+            std::vector<int> keys;
+            tree.scan(0, N, [&](int key, f_ptr) { keys.push_back(key); return true; });
+            assert(keys.size() == N / 10 + 5 && std::is_sorted(keys.begin(), keys.end()));
+            int blocks_read = 0;
+            assert(tree.search(10, blocks_read) == 100 && tree.search(11, blocks_read) == -1);
+            for (int i = 0; i < N; i++) {
+                if (i % 10 != 0) tree.insert(i, i * 10);
+            }
+            assert(tree.get_total_blocks() <= blocks_full); // os nós liberados voltam antes de o arquivo crescer
+            for (int i = 0; i < N; i++) assert(tree.search(i, blocks_read) != -1);
+            for (int i = 0; i < N; i++) assert(tree.remove(i, i * 10));
+            for (int i = 0; i < 6; i++) assert(tree.remove(100, 5000 + i) == (i != 3));
+            assert(tree.search(100, blocks_read) == -1);
+        }
+        remove(remove_file.c_str());
+
+        DataBlock block(PAGE_PRIMARY, 0);
+        Artigo artigo;
+        artigo.ID = 1;
+        int first = block.insert(artigo);
+        artigo.ID = 2;
+        int second = block.insert(artigo);
+        size_t free_before = block.free_space();
+        assert(block.erase(first) && !block.erase(first) && block.record_id(first) == -1);
+        assert(block.free_space() > free_before);
+        artigo.ID = 3;
+        assert(block.insert(artigo) == first); // a lápide é reaproveitada, o slot 1 não muda
+        assert(block.record_id(second) == 2 && block.record_count() == 2);
+
+        const std::string data_path = "test_remove_data.dat";
+        remove(data_path.c_str());
+        remove((data_path + ".occ").c_str());
+        {
+            HashingFile data_file(data_path);
+            std::map<int, f_ptr> ptrs;
+            data_file.set_relocation_listener([&](const Artigo& relocated, f_ptr, f_ptr new_ptr) {
+                ptrs[relocated.ID] = new_ptr; // os splits movem registros
+            });
+            for (int id = 0; id < 300; id++) {
+                artigo.ID = id;
+                std::snprintf(artigo.Titulo, sizeof(artigo.Titulo), "titulo %d", id);
+                ptrs[id] = data_file.insert(artigo);
+            }
+            Artigo removed;
+            assert(data_file.remove(7, removed) == ptrs[7] && removed.ID == 7);
+            assert(data_file.remove(7, removed) == -1);
+            assert(data_file.get_record_count() == 299);
+            int blocks_read = 0;
+            assert(data_file.find_by_id(7, blocks_read).ID == -1);
+            Artigo read_back;
+            assert(data_file.read_record(ptrs[8], read_back) && read_back.ID == 8);
+
+            // registros que crescem até não caber mais na página: saem e entram de novo em outro endereço
+            std::string title(300, 't');
+            std::string snippet(1024, 's');
+            std::snprintf(artigo.Titulo, sizeof(artigo.Titulo), "%s", title.c_str());
+            std::snprintf(artigo.Snippet, sizeof(artigo.Snippet), "%s", snippet.c_str());
+            int moved = 0;
+            for (int id = 8; id < 300; id++) {
+                artigo.ID = id;
+                f_ptr old_ptr = -1;
+                f_ptr new_ptr = data_file.update(artigo, old_ptr);
+                assert(old_ptr == ptrs[id] && new_ptr != -1);
+                if (new_ptr != old_ptr) moved++;
+                ptrs[id] = new_ptr;
+            }
+            assert(moved > 0);
+            for (int id = 8; id < 300; id++) {
+                assert(data_file.find_by_id(id, blocks_read).ID == id);
+                assert(data_file.read_record(ptrs[id], read_back) && read_back.ID == id && read_back.Snippet == snippet);
+            }
+            assert(data_file.get_record_count() == 299);
+        }
+        remove(data_path.c_str());
+        remove((data_path + ".occ").c_str());
+        std::cout << "  ---> remove, nos livres e lapides OK." << std::endl;
+    }
+    std::cout << "  [PASSOU TESTE 12]" << std::endl;
+
+    // --- Teste 13: busca por título repetido pelo servidor (todos os registros na resposta) ---
+    std::cout << "  [TESTE 13] Titulo repetido pelo dbserver..." << std::endl;
+    {
+        const std::string server_dir = "test_server_db";
+        std::filesystem::remove_all(server_dir);
+        std::filesystem::create_directories(server_dir);
+        const int DUPLICATES = 30;
+        {
+            HashingFile data_file(server_dir + "/data_file.dat");
+            BPlusTree<int> primary_index(server_dir + "/primary_index.idx");
+            BPlusTree_long secondary_index(server_dir + "/secondary_index.idx");
+            for (int id = 1; id <= DUPLICATES + 10; id++) {
+                Artigo artigo;
+                artigo.ID = id;
+                artigo.Ano = 2000;
+                if (id <= DUPLICATES) std::snprintf(artigo.Titulo, sizeof(artigo.Titulo), "Duplicate Title");
+                else std::snprintf(artigo.Titulo, sizeof(artigo.Titulo), "Outro titulo %d", id);
+                std::string snippet(900, 'a' + id % 26); // várias páginas de dados na mesma resposta
+                std::snprintf(artigo.Snippet, sizeof(artigo.Snippet), "%s", snippet.c_str());
+                data_file.insert(artigo);
+            }
+            data_file.for_each_record([&](const Artigo& artigo, f_ptr data_ptr) {
+                primary_index.insert(artigo.ID, data_ptr);
+                secondary_index.insert(hash_string_to_long(artigo.Titulo), make_title_posting(data_ptr, title_fingerprint(artigo.Titulo)));
+            });
+        }
+        {
+            QueryDatabase database(server_dir);
+            ServerStats stats;
+            int fds[2];
+            assert(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+            std::thread server([&] { serve_connection(fds[0], database, stats); });
+
+            auto query = [&](const QueryRequest& request) {
+                std::vector<unsigned char> frame;
+                QueryResponse response;
+                assert(send_frame(fds[1], encode_request(request)));
+                assert(recv_frame(fds[1], frame, MAX_RESPONSE_FRAME) && decode_response(frame, response));
+                return response;
+            };
+            QueryRequest request;
+            request.op = QueryOp::FIND_BY_TITLE;
+            request.titulo = "Duplicate Title";
+            QueryResponse response = query(request);
+            assert(response.status == QueryStatus::FOUND && response.artigos.size() == DUPLICATES);
+            std::vector<int> ids;
+            for (const Artigo& artigo : response.artigos) {
+                assert(std::strcmp(artigo.Titulo, "Duplicate Title") == 0 && std::strlen(artigo.Snippet) == 900);
+                ids.push_back(artigo.ID);
+            }
+            std::sort(ids.begin(), ids.end());
+            assert(std::unique(ids.begin(), ids.end()) == ids.end() && ids.front() == 1 && ids.back() == DUPLICATES);
+
+            request.titulo = "Outro titulo 35";
+            response = query(request);
+            assert(response.status == QueryStatus::FOUND && response.artigos.size() == 1 && response.artigos[0].ID == 35);
+            request.titulo = "Titulo que nao existe";
+            assert(query(request).status == QueryStatus::NOT_FOUND);
+            request.op = QueryOp::FIND_BY_ID_INDEX;
+            request.id = 7;
+            response = query(request);
+            assert(response.status == QueryStatus::FOUND && response.artigos.size() == 1 && response.artigos[0].ID == 7);
+
+            ::shutdown(fds[1], SHUT_RDWR); // o servidor sai do laço no fim da conexão
+            server.join();
+            ::close(fds[0]);
+            ::close(fds[1]);
+            assert(stats.requests == 4 && stats.found == 3);
+        }
+        std::filesystem::remove_all(server_dir);
+        std::cout << "  ---> " << DUPLICATES << " registros na resposta do servidor OK." << std::endl;
+    }
+    std::cout << "  [PASSOU TESTE 13]" << std::endl;
+
+    // --- Teste 14: intercalação em lote (insert_batch nas árvores de inteiros, merge_batch na árvore de strings) ---
+    std::cout << "  [TESTE 14] Intercalacao em lote da carga incremental..." << std::endl;
+    {
+        const std::string batch_tree = "test_tree_insert_batch.idx";
+        remove(batch_tree.c_str());
+        {
+            // chaves pares já na árvore, as ímpares e várias repetições entram num lote só (splits em cascata até a raiz)
+            TestTree tree(batch_tree);
+            for (int i = 0; i < 100; i += 2) tree.insert(i, i * 10);
+            std::vector<std::pair<int, f_ptr>> entries;
+            for (int i = 1; i < 100; i += 2) entries.push_back({i, i * 10});
+            for (int i = 0; i < 8; i++) entries.push_back({40, 9000 + i});
+            entries.push_back({-5, 7});
+            entries.push_back({500, 8});
+            std::sort(entries.begin(), entries.end());
+            tree.insert_batch(entries);
+            tree.commit();
+        }
+        {
+            TestTree tree(batch_tree);
+            int blocks_read = 0;
+            for (int i = 0; i < 100; i++) {
+                if (i != 40) assert(tree.search(i, blocks_read) == i * 10);
+            }
+            assert(tree.search(-5, blocks_read) == 7 && tree.search(500, blocks_read) == 8);
+            std::vector<f_ptr> postings;
+            tree.scan(40, 40, [&](int, f_ptr ptr) { postings.push_back(ptr); return true; });
+            std::sort(postings.begin(), postings.end());
+            assert(postings.size() == 9 && postings.front() == 400 && postings.back() == 9007);
+            std::vector<int> keys;
+            tree.scan(-10, 1000, [&](int key, f_ptr) { keys.push_back(key); return true; });
+            assert(keys.size() == 110 && std::is_sorted(keys.begin(), keys.end()));
+            tree.insert(41, 4242); // a árvore continua aceitando inserções avulsas depois do lote
+            assert(tree.remove(41, 410) && tree.search(41, blocks_read) == 4242);
+        }
+        remove(batch_tree.c_str());
+
+        const std::string merge_file = "test_string_merge.idx";
+        remove(merge_file.c_str());
+        std::multimap<std::string, f_ptr> expected;
+        {
+            ExternalSorter<std::string> entries(".", "test_string_merge.sort", 1 << 20);
+            for (int i = 0; i < 600; i++) {
+                std::string key = "autor " + std::to_string(i % 300);
+                entries.add(key, i);
+                expected.insert({key, i});
+            }
+            entries.finish();
+            StringBPlusTree tree(merge_file);
+            tree.bulk_load(entries, 0.5);
+        }
+        {
+            // chaves novas com prefixo comum longo (as folhas viram várias), repetidas e remoções, uma delas ausente
+            std::vector<StringBPlusTree::Entry> insertions, removals;
+            for (int i = 0; i < 3000; i++) insertions.push_back({"autor 15" + std::string(40, 'x') + std::to_string(i), 10000 + i});
+            for (int i = 0; i < 5; i++) insertions.push_back({"autor 7", 20000 + i});
+            for (int i = 0; i < 300; i += 3) removals.push_back({"autor " + std::to_string(i), i});
+            removals.push_back({"autor 1", 4242});
+            std::sort(insertions.begin(), insertions.end());
+            std::sort(removals.begin(), removals.end());
+            StringBPlusTree tree(merge_file);
+            int height = tree.get_height();
+            assert(tree.merge_batch(insertions, removals) == 1);
+            assert(tree.get_height() >= height);
+            for (const auto& entry : insertions) expected.insert(entry);
+            for (const auto& entry : removals) {
+                auto range = expected.equal_range(entry.first);
+                for (auto it = range.first; it != range.second; ++it) {
+                    if (it->second == entry.second) {
+                        expected.erase(it);
+                        break;
+                    }
+                }
+            }
+        }
+        StringBPlusTree tree(merge_file, OpenMode::READ_ONLY);
+        std::vector<std::pair<std::string, f_ptr>> found;
+        tree.scan("", "~", [&](const std::string& key, f_ptr ptr) { found.push_back({key, ptr}); return true; });
+        std::vector<std::pair<std::string, f_ptr>> wanted(expected.begin(), expected.end());
+        std::sort(found.begin(), found.end());
+        assert(found == wanted);
+        int blocks = 0;
+        assert(tree.search("autor 0", blocks) == 300 && tree.search("autor 3", blocks) == 303);
+        assert(tree.search("autor 15" + std::string(40, 'x') + "2999", blocks) == 12999);
+        size_t repeated = 0;
+        tree.scan_prefix("autor 7", [&](const std::string& key, f_ptr) { repeated += key == "autor 7"; return true; });
+        assert(repeated == 7);
+        remove(merge_file.c_str());
+
+        // folha que esvazia continua válida (used nunca fica abaixo do cabeçalho) e volta a receber chaves
+        const std::string empty_file = "test_string_empty.idx";
+        remove(empty_file.c_str());
+        {
+            StringBPlusTree empty_tree(empty_file);
+            std::vector<StringBPlusTree::Entry> keys{{"a", 1}, {"b", 2}, {"c", 3}};
+            assert(empty_tree.merge_batch(keys, {}) == 0);
+            assert(empty_tree.merge_batch({}, keys) == 0);
+            size_t visited = 0;
+            empty_tree.scan("", "~", [&](const std::string&, f_ptr) { visited++; return true; });
+            assert(visited == 0 && empty_tree.search("b", blocks) == -1);
+            assert(empty_tree.merge_batch({{"b", 7}}, {}) == 0 && empty_tree.search("b", blocks) == 7);
+        }
+        remove(empty_file.c_str());
+        std::cout << "  ---> " << wanted.size() << " entradas depois da intercalacao OK." << std::endl;
+    }
+    std::cout << "  [PASSOU TESTE 14]" << std::endl;
+
+    // --- Teste 15: índice de texto (tokenização, runs no disco, listas AND/OR e carga incremental com lápides) ---
+    std::cout << "  [TESTE 15] Indice de texto..." << std::endl;
+    {
+        std::vector<std::string> tokens;
+        tokenize_text("\xC3\x8D" "ndice B+ de \xC3\x81RVORES: x-2024, a\xC3\xA7\xC3\xA3o " "\xC3\x97" " fim", [&](const std::string& term) { tokens.push_back(term); });
+        assert((tokens == std::vector<std::string>{"indice", "de", "arvores", "2024", "acao", "fim"}));
+        tokens.clear();
+        tokenize_text((std::string(MAX_TERM_SIZE + 1, 'z') + " ok").c_str(), [&](const std::string& term) { tokens.push_back(term); });
+        assert((tokens == std::vector<std::string>{"ok"})); // termo longo demais fica de fora
+
+        const std::string text_dir = "test_text_index";
+        std::filesystem::remove_all(text_dir);
+        std::filesystem::create_directories(text_dir);
+
+        // o documento n (na ordem em que entrou) tem "palavraK" quando n % (K + 2) == 0, "comum" e "silva" sempre,
+        // e "indice" e "arvore" (acentuados no título) quando n % 7 == 0; as listas têm tamanhos bem diferentes
+        const int WORDS = 20;
+        std::vector<std::string> vocabulary{"comum", "silva", "indice", "arvore", "novo", "reescrito", "naoexiste"};
+        for (int k = 0; k < WORDS; k++) vocabulary.push_back("palavra" + std::to_string(k));
+        std::map<int, uint32_t> doc_of;                 // ID -> número do documento vivo
+        std::vector<std::vector<std::string>> doc_terms; // termos de cada número de documento
+        std::vector<bool> alive;
+        auto make_doc = [&](int id, const std::string& extra) {
+            uint32_t doc = static_cast<uint32_t>(doc_terms.size());
+            Artigo artigo;
+            artigo.ID = id;
+            artigo.Citacoes = id % 97;
+            std::vector<std::string> terms{"comum", "silva"};
+            std::string titulo = "Comum";
+            if (doc % 7 == 0) {
+                titulo += " \xC3\x8D" "ndice \xC3\x81rvore";
+                terms.push_back("indice");
+                terms.push_back("arvore");
+            }
+            if (!extra.empty()) {
+                titulo += " " + extra;
+                terms.push_back(extra);
+            }
+            std::string snippet;
+            for (int k = 0; k < WORDS; k++) {
+                if (doc % (k + 2) != 0) continue;
+                snippet += " palavra" + std::to_string(k);
+                terms.push_back("palavra" + std::to_string(k));
+            }
+            std::snprintf(artigo.Titulo, sizeof(artigo.Titulo), "%s", titulo.c_str());
+            std::snprintf(artigo.Autores, sizeof(artigo.Autores), "Silva");
+            std::snprintf(artigo.Snippet, sizeof(artigo.Snippet), "%s", snippet.c_str());
+            doc_terms.push_back(terms);
+            alive.push_back(true);
+            doc_of[id] = doc;
+            return artigo;
+        };
+        auto expected_postings = [&](const std::string& term) {
+            std::vector<uint32_t> docs;
+            for (uint32_t doc = 0; doc < doc_terms.size(); doc++) {
+                if (alive[doc] && std::find(doc_terms[doc].begin(), doc_terms[doc].end(), term) != doc_terms[doc].end()) docs.push_back(doc);
+            }
+            return docs;
+        };
+        // cada termo e cada par (AND e OR) contra a varredura de todos os documentos
+        auto check_index = [&] {
+            TextIndex index(text_dir);
+            assert(index.document_count() == static_cast<long>(doc_terms.size()));
+            long dict_blocks = 0;
+            std::map<std::string, std::vector<uint32_t>> lists;
+            for (const std::string& term : vocabulary) {
+                lists[term] = index.postings(term, dict_blocks);
+                assert(lists[term] == expected_postings(term));
+            }
+            for (const std::string& a : vocabulary) {
+                for (const std::string& b : vocabulary) {
+                    std::vector<uint32_t> both, either;
+                    for (uint32_t doc : expected_postings(a)) {
+                        const auto& terms = doc_terms[doc];
+                        if (std::find(terms.begin(), terms.end(), b) != terms.end()) both.push_back(doc);
+                    }
+                    std::set_union(lists[a].begin(), lists[a].end(), lists[b].begin(), lists[b].end(), std::back_inserter(either));
+                    assert(intersect_postings(lists[a], lists[b]) == both);
+                    assert(unite_postings(lists[a], lists[b]) == either);
+                }
+            }
+            for (const auto& entry : doc_of) {
+                assert(index.document(entry.second).id == entry.first && index.document(entry.second).data_ptr >= 0);
+            }
+        };
+
+        const int DOCS = 400;
+        {
+            // orçamento pequeno: as listas vão várias vezes para o disco e são intercaladas pelo heap no finish
+            TextIndexBuilder builder(text_dir, 2048);
+            for (int i = 0; i < DOCS; i++) builder.add_document(make_doc(1000 + i, ""), i * 100);
+            assert(builder.spilled_runs() >= 2);
+            builder.finish(1.0);
+            assert(builder.document_count() == DOCS);
+        }
+        for (const auto& entry : std::filesystem::directory_iterator(text_dir)) {
+            assert(entry.path().extension() != ".tmp"); // as runs saem junto com o builder
+        }
+        check_index();
+
+        // carga incremental: apaga um quinto, muda um de endereço e acrescenta documentos (um segmento novo por termo)
+        {
+            TextIndexUpdater updater(text_dir);
+            for (int i = 0; i < DOCS; i += 5) {
+                updater.remove_document(1000 + i);
+                alive[doc_of[1000 + i]] = false;
+                doc_of.erase(1000 + i);
+            }
+            updater.move_document(1001, 777);
+            for (int i = 0; i < 60; i++) updater.add_document(make_doc(5000 + i, "novo"), 100000 + i);
+            updater.finish();
+            assert(updater.added_count() == 60 && updater.removed_count() == DOCS / 5);
+        }
+        check_index();
+        {
+            TextIndex index(text_dir);
+            assert(index.document(doc_of[1001]).data_ptr == 777);
+            assert(index.document(0).data_ptr == -1); // lápide na tabela de documentos
+        }
+
+        // segunda carga: três segmentos na cadeia; apaga documentos da carga anterior e regrava um antigo
+        {
+            TextIndexUpdater updater(text_dir);
+            for (int i = 0; i < 60; i += 3) {
+                updater.remove_document(5000 + i);
+                alive[doc_of[5000 + i]] = false;
+                doc_of.erase(5000 + i);
+            }
+            updater.remove_document(1003);
+            alive[doc_of[1003]] = false;
+            updater.add_document(make_doc(1003, "reescrito"), 200000);
+            for (int i = 0; i < 30; i++) updater.add_document(make_doc(6000 + i, "novo"), 300000 + i);
+            updater.finish();
+        }
+        check_index();
+        {
+            TextIndex index(text_dir);
+            long dict_blocks = 0;
+            std::vector<uint32_t> rewritten = index.postings("reescrito", dict_blocks);
+            assert(rewritten.size() == 1 && index.document(rewritten[0]).id == 1003 && index.document(rewritten[0]).data_ptr == 200000);
+            for (const std::string& term : vocabulary) {
+                for (uint32_t doc : index.postings(term, dict_blocks)) {
+                    int id = index.document(doc).id;
+                    assert(!(id >= 1000 && id < 1000 + DOCS && (id - 1000) % 5 == 0)); // apagados não voltam
+                    assert(!(id >= 5000 && id < 5060 && (id - 5000) % 3 == 0));
+                }
+            }
+        }
+        std::filesystem::remove_all(text_dir);
+        std::cout << "  ---> " << doc_terms.size() << " documentos, listas AND/OR e lapides OK." << std::endl;
+    }
+    std::cout << "  [PASSOU TESTE 15]" << std::endl;
+
+    // --- Teste 16: colunas (kernels AVX2 x escalar bit a bit e remoção com a última linha no lugar) ---
+    std::cout << "  [TESTE 16] Colunas e kernels dos filtros..." << std::endl;
+    {
+        bool has_avx2 = set_column_kernel("avx2");
+        std::mt19937_64 rng(16);
+        long compared = 0;
+        // filtra com os dois kernels a partir da mesma seleção (toda marcada ou com palavras já zeradas) e compara
+        // com o esperado, calculado linha a linha
+        auto check_filter = [&](auto* values, size_t rows, int64_t lo, int64_t hi) {
+            for (int start = 0; start < 2; start++) {
+                std::vector<uint64_t> initial = column_select_all(rows);
+                if (start == 1) {
+                    for (size_t w = 0; w < initial.size(); w += 2) initial[w] = 0; // filtro anterior
+                    for (size_t w = 1; w < initial.size(); w += 2) initial[w] &= rng();
+                }
+                std::vector<uint64_t> expected = initial;
+                for (size_t i = 0; i < rows; i++) {
+                    if (values[i] < lo || values[i] > hi) expected[i / 64] &= ~(uint64_t(1) << (i % 64));
+                }
+                std::vector<uint64_t> scalar = initial, vector = initial;
+                assert(set_column_kernel("scalar"));
+                if constexpr (sizeof(*values) == sizeof(int32_t)) column_filter_i32(values, rows, lo, hi, scalar.data());
+                else column_filter_i64(values, rows, lo, hi, scalar.data());
+                assert(scalar == expected);
+                if (!has_avx2) continue;
+                assert(set_column_kernel("avx2"));
+                if constexpr (sizeof(*values) == sizeof(int32_t)) column_filter_i32(values, rows, lo, hi, vector.data());
+                else column_filter_i64(values, rows, lo, hi, vector.data());
+                assert(vector == scalar);
+                compared++;
+            }
+        };
+        for (size_t rows : {size_t(1), size_t(7), size_t(8), size_t(9), size_t(63), size_t(64), size_t(65), size_t(1000)}) {
+            std::vector<int32_t> narrow(rows);
+            std::vector<int64_t> wide(rows);
+            for (size_t i = 0; i < rows; i++) {
+                narrow[i] = static_cast<int32_t>(static_cast<int64_t>(rng() % 201) - 100);
+                wide[i] = static_cast<int64_t>(rng() % 201) - 100;
+            }
+            // extremos nas pontas e no meio
+            narrow[0] = INT32_MIN;
+            narrow[rows / 2] = INT32_MAX;
+            wide[0] = LLONG_MIN;
+            wide[rows / 2] = LLONG_MAX;
+            std::vector<std::pair<int64_t, int64_t>> ranges{
+                {-100, 100}, {-50, -10}, {0, 0}, {-7, -7}, {10, 5}, {LLONG_MIN, LLONG_MAX},
+                {INT32_MIN, INT32_MIN}, {INT32_MAX, INT32_MAX}, {INT32_MIN, -1}, {1, INT32_MAX},
+                {int64_t(INT32_MAX) + 1, LLONG_MAX}, {LLONG_MIN, int64_t(INT32_MIN) - 1},
+                {LLONG_MIN, LLONG_MIN}, {LLONG_MAX, LLONG_MAX}};
+            for (const auto& range : ranges) {
+                check_filter(narrow.data(), rows, range.first, range.second);
+                check_filter(wide.data(), rows, range.first, range.second);
+            }
+        }
+        set_column_kernel("avx2");
+
+        // ColumnUpdater: apagar uma linha do meio traz a última para o lugar dela; depois apaga a (nova) última
+        const std::string columns_dir = "test_columns";
+        std::filesystem::remove_all(columns_dir);
+        std::filesystem::create_directories(columns_dir);
+        const std::string columns_path = columns_dir + "/columns.dat";
+        using Row = std::tuple<int32_t, int32_t, int32_t, int64_t, int64_t>;
+        HashingFile data_file(columns_dir + "/data_file.dat");
+        for (int id = 1; id <= 300; id++) {
+            Artigo artigo;
+            artigo.ID = id;
+            artigo.Ano = 1990 + id % 30;
+            artigo.Citacoes = id * 3;
+            artigo.Atualizacao_timestamp = 1600000000 + id;
+            std::snprintf(artigo.Titulo, sizeof(artigo.Titulo), "Artigo %d", id);
+            data_file.insert(artigo);
+        }
+        {
+            ColumnWriter writer(columns_path);
+            data_file.for_each_record([&](const Artigo& artigo, f_ptr data_ptr) { writer.add(artigo, data_ptr); });
+            writer.finish();
+        }
+        int middle_id = 0, last_id = 0, tail_id = 0;
+        long rows_before = 0;
+        {
+            ColumnStore store(columns_path);
+            rows_before = store.row_count();
+            middle_id = store.ids()[rows_before / 2];
+            last_id = store.ids()[rows_before - 1];
+            tail_id = store.ids()[rows_before - 2]; // vira a última depois da primeira remoção
+        }
+        {
+            ColumnUpdater updater(columns_path);
+            Artigo removed;
+            assert(data_file.remove(middle_id, removed) != -1);
+            updater.remove(middle_id);
+            assert(data_file.remove(tail_id, removed) != -1);
+            updater.remove(tail_id); // agora é a última linha: só sai, sem troca
+            // nova versão de um registro (mesmo tamanho: fica no mesmo endereço)
+            int blocks_read = 0;
+            Artigo changed = data_file.find_by_id(7, blocks_read);
+            changed.Citacoes = 4242;
+            changed.Ano = 2024;
+            f_ptr old_ptr = -1;
+            f_ptr new_ptr = data_file.update(changed, old_ptr);
+            assert(new_ptr != -1 && new_ptr == old_ptr);
+            updater.put(changed, new_ptr);
+            assert(updater.row_count() == rows_before - 2);
+            updater.finish();
+        }
+        {
+            ColumnStore store(columns_path);
+            assert(store.row_count() == rows_before - 2);
+            assert(store.ids()[rows_before / 2] == last_id); // a última linha ocupou o lugar da apagada
+            std::vector<Row> columns, scanned;
+            for (long row = 0; row < store.row_count(); row++) {
+                columns.push_back({store.ids()[row], store.anos()[row], store.citacoes()[row], store.atualizacoes()[row], store.data_ptrs()[row]});
+            }
+            data_file.for_each_record([&](const Artigo& artigo, f_ptr data_ptr) {
+                scanned.push_back({artigo.ID, artigo.Ano, artigo.Citacoes, static_cast<int64_t>(artigo.Atualizacao_timestamp), data_ptr});
+            });
+            assert(std::count_if(columns.begin(), columns.end(), [](const Row& row) {
+                return std::get<0>(row) == 7 && std::get<2>(row) == 4242 && std::get<1>(row) == 2024;
+            }) == 1);
+            std::sort(columns.begin(), columns.end());
+            std::sort(scanned.begin(), scanned.end());
+            assert(columns == scanned);
+        }
+        std::filesystem::remove_all(columns_dir);
+        std::cout << "  ---> kernel " << (has_avx2 ? "avx2" : "scalar (sem avx2)") << ", " << compared
+                  << " comparacoes bit a bit e remocao nas colunas OK." << std::endl;
+    }
+    std::cout << "  [PASSOU TESTE 16]" << std::endl;
+
+
     // --- Limpeza Final ---
     remove(test_file.c_str());
     std::cout << "--- Todos os testes da BPlusTree com Cache passaram! ---" << std::endl;
-    std::cout << "IMPORTANTE: Reverta ORDER em BPlusTree.hpp para o valor alto calculado!" << std::endl;
 
     return 0;
 }
\ No newline at end of file